@@ -29,6 +29,8 @@
 #include "rtkConstantImageSource.h"
 #include "rtkADMMTotalVariationConeBeamReconstructionFilter.h"
 #include "rtkPhaseGatingImageFilter.h"
+#include "rtkIterationCommands.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
 
 int main(int argc, char * argv[])
 {
@@ -105,42 +107,70 @@ int main(int argc, char * argv[])
   // Setup the ADMM filter and run it
   //////////////////////////////////////////////////////////////////////////////////////////
 
-  // Set the reconstruction filter
+  // Shrink factors of the multi-resolution levels, the last one being the
+  // full resolution
+  std::vector<unsigned int> shrinkFactors;
+  for(unsigned int i=0; i<args_info.multires_given; i++)
+    shrinkFactors.push_back(args_info.multires_arg[i]);
+  shrinkFactors.push_back(1);
+
+  // Set the reconstruction filter of each level
   typedef rtk::ADMMTotalVariationConeBeamReconstructionFilter
       <OutputImageType, GradientOutputImageType> ADMM_TV_FilterType;
-    ADMM_TV_FilterType::Pointer admmFilter = ADMM_TV_FilterType::New();
-
-  // Set the forward and back projection filters to be used inside admmFilter
-  admmFilter->SetForwardProjectionFilter(args_info.fp_arg);
-  admmFilter->SetBackProjectionFilter(args_info.bp_arg);
-
-  // Set all four numerical parameters
-  admmFilter->SetCG_iterations(args_info.CGiter_arg);
-  admmFilter->SetAL_iterations(args_info.niterations_arg);
-  admmFilter->SetAlpha(args_info.alpha_arg);
-  admmFilter->SetBeta(args_info.beta_arg);
-
-  // Set the inputs of the ADMM filter
-  admmFilter->SetInput(0, inputFilter->GetOutput() );
-  if (args_info.phases_given)
+  typedef rtk::VerboseIterationCommand<ADMM_TV_FilterType> VerboseIterationCommandType;
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  ADMM_TV_FilterType::Pointer admmFilter;
+  for(unsigned int level=0; level<shrinkFactors.size(); level++)
     {
-    admmFilter->SetInput(1, phaseGating->GetOutput());
-    admmFilter->SetGeometry( phaseGating->GetOutputGeometry() );
-    admmFilter->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+    admmFilter = ADMM_TV_FilterType::New();
+
+    // Set the forward and back projection filters to be used inside admmFilter
+    admmFilter->SetForwardProjectionFilter(args_info.fp_arg);
+    admmFilter->SetBackProjectionFilter(args_info.bp_arg);
+
+    // Set all four numerical parameters
+    admmFilter->SetCG_iterations(args_info.CGiter_arg);
+    if(level+1<shrinkFactors.size())
+      admmFilter->SetAL_iterations(args_info.multiresniter_arg);
+    else
+      admmFilter->SetAL_iterations(args_info.niterations_arg);
+    admmFilter->SetAlpha(args_info.alpha_arg);
+    admmFilter->SetBeta(args_info.beta_arg);
+    admmFilter->SetCG_Tolerance(args_info.CGtolerance_arg);
+
+    // Print the convergence of the conjugate gradient
+    if(args_info.verbose_flag)
+      admmFilter->AddObserver(itk::IterationEvent(), VerboseIterationCommandType::New());
+
+    if (args_info.phases_given)
+      {
+      admmFilter->SetGeometry( phaseGating->GetOutputGeometry() );
+      admmFilter->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+      }
+    else
+      admmFilter->SetGeometry( geometryReader->GetOutputObject() );
+    multires->AddLevel(shrinkFactors[level], admmFilter);
     }
+
+  // Set the inputs of the reconstruction, the full resolution ADMM filter
+  // being used directly without coarse level
+  itk::ImageToImageFilter< OutputImageType, OutputImageType >::Pointer reconstruction = admmFilter.GetPointer();
+  if(args_info.multires_given)
+    reconstruction = multires.GetPointer();
+  reconstruction->SetInput(0, inputFilter->GetOutput() );
+  if (args_info.phases_given)
+    reconstruction->SetInput(1, phaseGating->GetOutput());
   else
-    {
-    admmFilter->SetInput(1, projectionsReader->GetOutput() );
-    admmFilter->SetGeometry( geometryReader->GetOutputObject() );
-    }
+    reconstruction->SetInput(1, projectionsReader->GetOutput() );
 
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( admmFilter->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reconstruction->Update() )
 
   // Set writer and write the output
   typedef itk::ImageFileWriter<  OutputImageType > WriterType;
   WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( args_info.output_arg );
-  writer->SetInput( admmFilter->GetOutput() );
+  writer->SetInput( reconstruction->GetOutput() );
   TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
 
   return EXIT_SUCCESS;
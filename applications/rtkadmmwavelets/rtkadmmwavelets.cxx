@@ -29,6 +29,8 @@
 #include "rtkConstantImageSource.h"
 #include "rtkDisplacedDetectorImageFilter.h"
 #include "rtkADMMWaveletsConeBeamReconstructionFilter.h"
+#include "rtkIterationCommands.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
 
 int main(int argc, char * argv[])
 {
@@ -93,37 +95,64 @@ int main(int argc, char * argv[])
   // Setup the ADMM filter and run it
   //////////////////////////////////////////////////////////////////////////////////////////
 
-  // Set the reconstruction filter
+  // Shrink factors of the multi-resolution levels, the last one being the
+  // full resolution
+  std::vector<unsigned int> shrinkFactors;
+  for(unsigned int i=0; i<args_info.multires_given; i++)
+    shrinkFactors.push_back(args_info.multires_arg[i]);
+  shrinkFactors.push_back(1);
+
+  // Set the reconstruction filter of each level
   typedef rtk::ADMMWaveletsConeBeamReconstructionFilter
       <OutputImageType> ADMM_Wavelets_FilterType;
-    ADMM_Wavelets_FilterType::Pointer admmFilter = ADMM_Wavelets_FilterType::New();
-
-  // Set the forward and back projection filters to be used inside admmFilter
-  admmFilter->SetForwardProjectionFilter(args_info.fp_arg);
-  admmFilter->SetBackProjectionFilter(args_info.bp_arg);
-
-  // Set the geometry and interpolation weights
-  admmFilter->SetGeometry(geometryReader->GetOutputObject());
-
-  // Set all numerical parameters
-  admmFilter->SetCG_iterations(args_info.CGiter_arg);
-  admmFilter->SetAL_iterations(args_info.niterations_arg);
-  admmFilter->SetAlpha(args_info.alpha_arg);
-  admmFilter->SetBeta(args_info.beta_arg);
-  admmFilter->SetNumberOfLevels(args_info.levels_arg);
-  admmFilter->SetOrder(args_info.order_arg);
+  typedef rtk::VerboseIterationCommand<ADMM_Wavelets_FilterType> VerboseIterationCommandType;
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  ADMM_Wavelets_FilterType::Pointer admmFilter;
+  for(unsigned int level=0; level<shrinkFactors.size(); level++)
+    {
+    admmFilter = ADMM_Wavelets_FilterType::New();
+
+    // Set the forward and back projection filters to be used inside admmFilter
+    admmFilter->SetForwardProjectionFilter(args_info.fp_arg);
+    admmFilter->SetBackProjectionFilter(args_info.bp_arg);
+
+    // Set the geometry and interpolation weights
+    admmFilter->SetGeometry(geometryReader->GetOutputObject());
+
+    // Set all numerical parameters
+    admmFilter->SetCG_iterations(args_info.CGiter_arg);
+    if(level+1<shrinkFactors.size())
+      admmFilter->SetAL_iterations(args_info.multiresniter_arg);
+    else
+      admmFilter->SetAL_iterations(args_info.niterations_arg);
+    admmFilter->SetAlpha(args_info.alpha_arg);
+    admmFilter->SetBeta(args_info.beta_arg);
+    admmFilter->SetNumberOfLevels(args_info.levels_arg);
+    admmFilter->SetOrder(args_info.order_arg);
+    admmFilter->SetCG_Tolerance(args_info.CGtolerance_arg);
+
+    // Print the convergence of the conjugate gradient
+    if(args_info.verbose_flag)
+      admmFilter->AddObserver(itk::IterationEvent(), VerboseIterationCommandType::New());
+    multires->AddLevel(shrinkFactors[level], admmFilter);
+    }
 
-  // Set the inputs of the ADMM filter
-  admmFilter->SetInput(0, inputFilter->GetOutput() );
-  admmFilter->SetInput(1, projectionsReader->GetOutput() );
+  // Set the inputs of the reconstruction, the full resolution ADMM filter
+  // being used directly without coarse level
+  itk::ImageToImageFilter< OutputImageType, OutputImageType >::Pointer reconstruction = admmFilter.GetPointer();
+  if(args_info.multires_given)
+    reconstruction = multires.GetPointer();
+  reconstruction->SetInput(0, inputFilter->GetOutput() );
+  reconstruction->SetInput(1, projectionsReader->GetOutput() );
 
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( admmFilter->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reconstruction->Update() )
 
   // Set writer and write the output
   typedef itk::ImageFileWriter<  OutputImageType > WriterType;
   WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( args_info.output_arg );
-  writer->SetInput( admmFilter->GetOutput() );
+  writer->SetInput( reconstruction->GetOutput() );
   TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
 
   return EXIT_SUCCESS;
@@ -24,6 +24,8 @@
 #include "rtkFDKWarpBackProjectionImageFilter.h"
 #include "rtkJosephBackProjectionImageFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkDistanceDrivenBackProjectionImageFilter.h"
 #ifdef RTK_USE_CUDA
 #  include "rtkCudaFDKBackProjectionImageFilter.h"
 #  include "rtkCudaBackProjectionImageFilter.h"
@@ -136,6 +138,12 @@ int main(int argc, char * argv[])
       return EXIT_FAILURE;
 #endif
       break;
+    case(bp_arg_Siddon):
+      bp = rtk::SiddonBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
+      break;
+    case(bp_arg_DistanceDriven):
+      bp = rtk::DistanceDrivenBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
+      break;
     default:
     std::cerr << "Unhandled --method value." << std::endl;
     return EXIT_FAILURE;
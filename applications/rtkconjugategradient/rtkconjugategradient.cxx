@@ -18,10 +18,13 @@
 
 #include "rtkconjugategradient_ggo.h"
 #include "rtkGgoFunctions.h"
+#include "rtkImageBufferPool.h"
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkConjugateGradientConeBeamReconstructionFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkIterationCommands.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include <itkCudaImage.h>
@@ -32,6 +35,10 @@ int main(int argc, char * argv[])
 {
   GGO(rtkconjugategradient, args_info);
 
+  // Reuse the image buffers between iterations
+  if(args_info.bufferpool_flag)
+    rtk::ImageBufferPool::GetInstance()->SetEnabled(true);
+
   typedef float OutputPixelType;
   const unsigned int Dimension = 3;
 
@@ -98,24 +105,56 @@ int main(int argc, char * argv[])
     weightsSource = constantWeightsSource;
     }
 
-  // Set the forward and back projection filters to be used
+  // Shrink factors of the multi-resolution levels, the last one being the
+  // full resolution
+  std::vector<unsigned int> shrinkFactors;
+  for(unsigned int i=0; i<args_info.multires_given; i++)
+    shrinkFactors.push_back(args_info.multires_arg[i]);
+  shrinkFactors.push_back(1);
+
+  // Conjugate gradient filter of each level
   typedef rtk::ConjugateGradientConeBeamReconstructionFilter<OutputImageType> ConjugateGradientFilterType;
-  ConjugateGradientFilterType::Pointer conjugategradient = ConjugateGradientFilterType::New();
-  conjugategradient->SetForwardProjectionFilter(args_info.fp_arg);
-  conjugategradient->SetBackProjectionFilter(args_info.bp_arg);
-  conjugategradient->SetInput( inputFilter->GetOutput() );
-  conjugategradient->SetInput(1, reader->GetOutput());
-  conjugategradient->SetInput(2, weightsSource->GetOutput());
-  conjugategradient->SetPreconditioned(args_info.preconditioned_flag);
-  conjugategradient->SetCudaConjugateGradient(!args_info.nocudacg_flag);
-
-  if (args_info.gamma_given)
+  typedef rtk::VerboseIterationCommand<ConjugateGradientFilterType> VerboseIterationCommandType;
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  ConjugateGradientFilterType::Pointer conjugategradient;
+  for(unsigned int level=0; level<shrinkFactors.size(); level++)
     {
-    conjugategradient->SetRegularized(true);
-    conjugategradient->SetGamma(args_info.gamma_arg);
+    conjugategradient = ConjugateGradientFilterType::New();
+
+    // Set the forward and back projection filters to be used
+    conjugategradient->SetForwardProjectionFilter(args_info.fp_arg);
+    conjugategradient->SetBackProjectionFilter(args_info.bp_arg);
+    conjugategradient->SetPreconditioned(args_info.preconditioned_flag);
+    conjugategradient->SetCudaConjugateGradient(!args_info.nocudacg_flag);
+    conjugategradient->SetRampPreconditioned(args_info.ramp_flag);
+
+    if (args_info.gamma_given)
+      {
+      conjugategradient->SetRegularized(true);
+      conjugategradient->SetGamma(args_info.gamma_arg);
+      }
+    conjugategradient->SetGeometry( geometryReader->GetOutputObject() );
+    if(level+1<shrinkFactors.size())
+      conjugategradient->SetNumberOfIterations( args_info.multiresniter_arg );
+    else
+      conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
+    conjugategradient->SetTolerance( args_info.tolerance_arg );
+
+    // Print the convergence of the conjugate gradient
+    if(args_info.verbose_flag)
+      conjugategradient->AddObserver(itk::IterationEvent(), VerboseIterationCommandType::New());
+    multires->AddLevel(shrinkFactors[level], conjugategradient);
     }
-  conjugategradient->SetGeometry( geometryReader->GetOutputObject() );
-  conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
+
+  // Without coarse level, the full resolution filter is used directly. The
+  // weights are binned as the projections by the multi-resolution filter.
+  itk::ImageToImageFilter< OutputImageType, OutputImageType >::Pointer reconstruction = conjugategradient.GetPointer();
+  if(args_info.multires_given)
+    reconstruction = multires.GetPointer();
+  reconstruction->SetInput( inputFilter->GetOutput() );
+  reconstruction->SetInput(1, reader->GetOutput());
+  reconstruction->SetInput(2, weightsSource->GetOutput());
 
   itk::TimeProbe readerProbe;
   if(args_info.time_flag)
@@ -124,11 +163,12 @@ int main(int argc, char * argv[])
     readerProbe.Start();
     }
 
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reconstruction->Update() )
 
   if(args_info.time_flag)
     {
 //    conjugategradient->PrintTiming(std::cout);
+    rtk::ImageBufferPool::GetInstance()->Report(std::cout);
     readerProbe.Stop();
     std::cout << "It took...  " << readerProbe.GetMean() << ' ' << readerProbe.GetUnit() << std::endl;
     }
@@ -137,7 +177,7 @@ int main(int argc, char * argv[])
   typedef itk::ImageFileWriter< OutputImageType > WriterType;
   WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( args_info.output_arg );
-  writer->SetInput( conjugategradient->GetOutput() );
+  writer->SetInput( reconstruction->GetOutput() );
   TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
 
   return EXIT_SUCCESS;
@@ -0,0 +1,63 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkconvertgeometry_ggo.h"
+#include "rtkGgoFunctions.h"
+
+#include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkThreeDCircularProjectionGeometryBinaryFile.h"
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkconvertgeometry, args_info);
+
+  // Geometry, the XML reader also reads binary files
+  if(args_info.verbose_flag)
+    std::cout << "Reading geometry information from "
+              << args_info.input_arg
+              << "..."
+              << std::endl;
+  rtk::ThreeDCircularProjectionGeometryXMLFileReader::Pointer geometryReader;
+  geometryReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
+  geometryReader->SetFilename(args_info.input_arg);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() )
+
+  if(args_info.verbose_flag)
+    std::cout << "Writing " << geometryReader->GetOutputObject()->GetGantryAngles().size()
+              << " projections to " << args_info.output_arg
+              << "..."
+              << std::endl;
+  if(args_info.binary_flag)
+    {
+    rtk::ThreeDCircularProjectionGeometryBinaryFileWriter::Pointer binaryWriter;
+    binaryWriter = rtk::ThreeDCircularProjectionGeometryBinaryFileWriter::New();
+    binaryWriter->SetFilename(args_info.output_arg);
+    binaryWriter->SetObject(geometryReader->GetOutputObject());
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( binaryWriter->WriteFile() )
+    }
+  else
+    {
+    rtk::ThreeDCircularProjectionGeometryXMLFileWriter::Pointer xmlWriter;
+    xmlWriter = rtk::ThreeDCircularProjectionGeometryXMLFileWriter::New();
+    xmlWriter->SetFilename(args_info.output_arg);
+    xmlWriter->SetObject(geometryReader->GetOutputObject());
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( xmlWriter->WriteFile() )
+    }
+
+  return EXIT_SUCCESS;
+}
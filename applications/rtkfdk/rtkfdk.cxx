@@ -21,9 +21,7 @@
 #include "rtkConfiguration.h"
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
-#include "rtkDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
-#include "rtkParkerShortScanImageFilter.h"
-#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkFDKPipelineFromGgo.h"
 #ifdef RTK_USE_CUDA
 #  include "rtkCudaDisplacedDetectorImageFilter.h"
 //TODO #  include "rtkCudaDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
@@ -33,11 +31,6 @@
 #ifdef RTK_USE_OPENCL
 #  include "rtkOpenCLFDKConeBeamReconstructionFilter.h"
 #endif
-#include "rtkFDKWarpBackProjectionImageFilter.h"
-#include "rtkCyclicDeformationImageFilter.h"
-
-#include <itkStreamingImageFilter.h>
-#include <itkImageFileWriter.h>
 
 int main(int argc, char * argv[])
 {
@@ -53,23 +46,6 @@ int main(int argc, char * argv[])
   typedef CPUOutputImageType                           OutputImageType;
 #endif
 
-  // Projections reader
-  typedef rtk::ProjectionsReader< OutputImageType > ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
-  rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtkfdk>(reader, args_info);
-
-  itk::TimeProbe readerProbe;
-  if(!args_info.lowmem_flag)
-    {
-    if(args_info.verbose_flag)
-      std::cout << "Reading... " << std::flush;
-    readerProbe.Start();
-    TRY_AND_EXIT_ON_ITK_EXCEPTION( reader->Update() )
-    readerProbe.Stop();
-    if(args_info.verbose_flag)
-      std::cout << "It took " << readerProbe.GetMean() << ' ' << readerProbe.GetUnit() << std::endl;
-    }
-
   // Geometry
   if(args_info.verbose_flag)
     std::cout << "Reading geometry information from "
@@ -97,72 +73,23 @@ int main(int argc, char * argv[])
      }
 #endif
 
-  // Displaced detector weighting
-  typedef rtk::DisplacedDetectorImageFilter< OutputImageType >                     DDFCPUType;
-  typedef rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter< OutputImageType > DDFOFFFOVType;
+  // Reader, displaced detector and short scan weighting, source of the
+  // reconstructed volume and motion-compensated objects
+  typedef rtk::FDKPipelineFromGgo< OutputImageType > PipelineType;
+  PipelineType::DDFType::Pointer ddf;
+  PipelineType::PSSFType::Pointer pssf;
 #ifdef RTK_USE_CUDA
-  typedef rtk::CudaDisplacedDetectorImageFilter DDFType;
-#else
-  typedef rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter< OutputImageType > DDFType;
-#endif
-  DDFCPUType::Pointer ddf;
   if(!strcmp(args_info.hardware_arg, "cuda") )
-    ddf = DDFType::New();
-  else
-    ddf = DDFOFFFOVType::New();
-  ddf->SetInput( reader->GetOutput() );
-  ddf->SetGeometry( geometryReader->GetOutputObject() );
-
-  // Short scan image filter
-  typedef rtk::ParkerShortScanImageFilter< OutputImageType > PSSFCPUType;
-#ifdef RTK_USE_CUDA
-  typedef rtk::CudaParkerShortScanImageFilter PSSFType;
-#else
-  typedef rtk::ParkerShortScanImageFilter< OutputImageType > PSSFType;
+    {
+    ddf = rtk::CudaDisplacedDetectorImageFilter::New();
+    pssf = rtk::CudaParkerShortScanImageFilter::New();
+    }
 #endif
-  PSSFCPUType::Pointer pssf;
-  if(!strcmp(args_info.hardware_arg, "cuda") )
-    pssf = PSSFType::New();
-  else
-    pssf = PSSFCPUType::New();
-  pssf->SetInput( ddf->GetOutput() );
-  pssf->SetGeometry( geometryReader->GetOutputObject() );
-  pssf->InPlaceOff();
-
-  // Create reconstructed image
-  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
-  ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
-  rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkfdk>(constantImageSource, args_info);
-
-  // Motion-compensated objects for the compensation of a cyclic deformation.
-  // Although these will only be used if the command line options for motion
-  // compensation are set, we still create the object before hand to avoid auto
-  // destruction.
-  typedef itk::Vector<float,3> DVFPixelType;
-  typedef itk::Image< DVFPixelType, 3 > DVFImageType;
-  typedef rtk::CyclicDeformationImageFilter< DVFImageType > DeformationType;
-  typedef itk::ImageFileReader<DeformationType::InputImageType> DVFReaderType;
-  DVFReaderType::Pointer dvfReader = DVFReaderType::New();
-  DeformationType::Pointer def = DeformationType::New();
-  def->SetInput(dvfReader->GetOutput());
-  typedef rtk::FDKWarpBackProjectionImageFilter<OutputImageType, OutputImageType, DeformationType> WarpBPType;
-  WarpBPType::Pointer bp = WarpBPType::New();
-  bp->SetDeformation(def);
-  bp->SetGeometry( geometryReader->GetOutputObject() );
-
-  // This macro sets options for fdk filter which I can not see how to do better
-  // because TFFTPrecision is not the same, e.g. for CPU and CUDA (SR)
-#define SET_FELDKAMP_OPTIONS(f) \
-    f->SetInput( 0, constantImageSource->GetOutput() ); \
-    f->SetInput( 1, pssf->GetOutput() ); \
-    f->SetGeometry( geometryReader->GetOutputObject() ); \
-    f->GetRampFilter()->SetTruncationCorrection(args_info.pad_arg); \
-    f->GetRampFilter()->SetHannCutFrequency(args_info.hann_arg); \
-    f->GetRampFilter()->SetHannCutFrequencyY(args_info.hannY_arg); \
-    f->SetProjectionSubsetSize(args_info.subsetsize_arg)
+  PipelineType pipeline(args_info, geometryReader->GetOutputObject(), ddf, pssf);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( pipeline.ReadProjectionsFromGgo(args_info) )
 
   // FDK reconstruction filtering
-  typedef rtk::FDKConeBeamReconstructionFilter< OutputImageType > FDKCPUType;
+  typedef PipelineType::FDKType FDKCPUType;
   FDKCPUType::Pointer feldkamp;
 #ifdef RTK_USE_OPENCL
   typedef rtk::OpenCLFDKConeBeamReconstructionFilter FDKOPENCLType;
@@ -176,15 +103,7 @@ int main(int argc, char * argv[])
   if(!strcmp(args_info.hardware_arg, "cpu") )
     {
     feldkamp = FDKCPUType::New();
-    SET_FELDKAMP_OPTIONS( feldkamp );
-
-    // Motion compensated CBCT settings
-    if(args_info.signal_given && args_info.dvf_given)
-      {
-      dvfReader->SetFileName(args_info.dvf_arg);
-      def->SetSignalFilename(args_info.signal_arg);
-      feldkamp->SetBackProjectionFilter( bp.GetPointer() );
-      }
+    pipeline.SetFDKFromGgo(feldkamp.GetPointer(), args_info);
     pfeldkamp = feldkamp->GetOutput();
     }
 #ifdef RTK_USE_CUDA
@@ -198,7 +117,7 @@ int main(int argc, char * argv[])
       }
 
     feldkampCUDA = FDKCUDAType::New();
-    SET_FELDKAMP_OPTIONS( feldkampCUDA );
+    pipeline.SetFDKOptionsFromGgo(feldkampCUDA.GetPointer(), args_info);
     pfeldkamp = feldkampCUDA->GetOutput();
     }
 #endif
@@ -212,23 +131,15 @@ int main(int argc, char * argv[])
       }
 
     feldkampOCL = FDKOPENCLType::New();
-    SET_FELDKAMP_OPTIONS( feldkampOCL );
+    pipeline.SetFDKOptionsFromGgo(feldkampOCL.GetPointer(), args_info);
     pfeldkamp = feldkampOCL->GetOutput();
     }
 #endif
 
 
-  // Streaming depending on streaming capability of writer
-  typedef itk::StreamingImageFilter<CPUOutputImageType, CPUOutputImageType> StreamerType;
-  StreamerType::Pointer streamerBP = StreamerType::New();
-  streamerBP->SetInput( pfeldkamp );
-  streamerBP->SetNumberOfStreamDivisions( args_info.divisions_arg );
-
-  // Write
-  typedef itk::ImageFileWriter<CPUOutputImageType> WriterType;
-  WriterType::Pointer writer = WriterType::New();
-  writer->SetFileName( args_info.output_arg );
-  writer->SetInput( streamerBP->GetOutput() );
+  // Streaming depending on streaming capability of writer or slab streaming
+  PipelineType::WriterType::Pointer writer;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( writer = pipeline.CreateWriterFromGgo(pfeldkamp, args_info) )
 
   if(args_info.verbose_flag)
     std::cout << "Reconstructing and writing... " << std::flush;
@@ -240,7 +151,7 @@ int main(int argc, char * argv[])
 
   if(args_info.verbose_flag)
     {
-    std::cout << "It took " << writerProbe.GetMean() << ' ' << readerProbe.GetUnit() << std::endl;
+    std::cout << "It took " << writerProbe.GetMean() << ' ' << writerProbe.GetUnit() << std::endl;
     if(!strcmp(args_info.hardware_arg, "cpu") )
       feldkamp->PrintTiming(std::cout);
 #ifdef RTK_USE_CUDA
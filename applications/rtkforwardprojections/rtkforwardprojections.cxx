@@ -25,6 +25,8 @@
 #include "rtkCudaForwardProjectionImageFilter.h"
 #endif
 #include "rtkRayCastInterpolatorForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkDistanceDrivenForwardProjectionImageFilter.h"
 
 #include <itkImageFileReader.h>
 #include <itkImageFileWriter.h>
@@ -110,6 +112,12 @@ int main(int argc, char * argv[])
     return EXIT_FAILURE;
 #endif
     break;
+  case(fp_arg_Siddon):
+    forwardProjection = rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    break;
+  case(fp_arg_DistanceDriven):
+    forwardProjection = rtk::DistanceDrivenForwardProjectionImageFilter<OutputImageType, OutputImageType>::New();
+    break;
   default:
     std::cerr << "Unhandled --method value." << std::endl;
     return EXIT_FAILURE;
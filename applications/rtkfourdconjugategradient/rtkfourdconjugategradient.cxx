@@ -23,6 +23,7 @@
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkPhasesToInterpolationWeights.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkIterationCommands.h"
 
 #ifdef RTK_USE_CUDA
   #include "itkCudaImage.h"
@@ -105,9 +106,15 @@ int main(int argc, char * argv[])
   conjugategradient->SetInputProjectionStack(reader->GetOutput());
   conjugategradient->SetGeometry( geometryReader->GetOutputObject() );
   conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
+  conjugategradient->SetTolerance( args_info.tolerance_arg );
   conjugategradient->SetWeights(phaseReader->GetOutput());
   conjugategradient->SetCudaConjugateGradient(args_info.cudacg_flag);
 
+  // Print the convergence of the conjugate gradient
+  typedef rtk::VerboseIterationCommand<ConjugateGradientFilterType> VerboseIterationCommandType;
+  if(args_info.verbose_flag)
+    conjugategradient->AddObserver(itk::IterationEvent(), VerboseIterationCommandType::New());
+
   itk::TimeProbe readerProbe;
   if(args_info.time_flag)
     {
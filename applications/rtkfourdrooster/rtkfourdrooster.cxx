@@ -18,6 +18,7 @@
 
 #include "rtkfourdrooster_ggo.h"
 #include "rtkGgoFunctions.h"
+#include "rtkImageBufferPool.h"
 
 #include "rtkFourDROOSTERConeBeamReconstructionFilter.h"
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
@@ -32,6 +33,10 @@ int main(int argc, char * argv[])
 {
   GGO(rtkfourdrooster, args_info);
 
+  // Reuse the image buffers between iterations
+  if(args_info.bufferpool_flag)
+    rtk::ImageBufferPool::GetInstance()->SetEnabled(true);
+
   typedef float OutputPixelType;
   typedef itk::CovariantVector< OutputPixelType, 3 > DVFVectorType;
 
@@ -218,6 +223,7 @@ int main(int argc, char * argv[])
   if(args_info.time_flag)
     {
     rooster->PrintTiming(std::cout);
+    rtk::ImageBufferPool::GetInstance()->Report(std::cout);
     readerProbe.Stop();
     std::cout << "It took...  " << readerProbe.GetMean() << ' ' << readerProbe.GetUnit() << std::endl;
     }
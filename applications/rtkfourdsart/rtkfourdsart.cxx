@@ -20,6 +20,7 @@
 #include "rtkGgoFunctions.h"
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkProjectionsCacheImageFilter.h"
 #include "rtkFourDSARTConeBeamReconstructionFilter.h"
 #include "rtkPhasesToInterpolationWeights.h"
 #include "rtkDisplacedDetectorImageFilter.h"
@@ -50,6 +51,15 @@ int main(int argc, char * argv[])
   ReaderType::Pointer reader = ReaderType::New();
   rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtkfourdsart>(reader, args_info);
 
+  // Optional cache, projections are then read on demand
+  typedef rtk::ProjectionsCacheImageFilter< ProjectionStackType > CacheType;
+  CacheType::Pointer cache = CacheType::New();
+  cache->SetInput( reader->GetOutput() );
+  cache->SetCacheSize( args_info.cache_arg );
+  itk::ImageSource< ProjectionStackType >::Pointer projectionsSource = reader.GetPointer();
+  if(args_info.cache_arg>0)
+    projectionsSource = cache.GetPointer();
+
   // Geometry
   if(args_info.verbose_flag)
     std::cout << "Reading geometry information from "
@@ -105,7 +115,7 @@ int main(int argc, char * argv[])
   fourdsart->SetForwardProjectionFilter(args_info.fp_arg);
   fourdsart->SetBackProjectionFilter(args_info.bp_arg);
   fourdsart->SetInputVolumeSeries(inputFilter->GetOutput() );
-  fourdsart->SetInputProjectionStack(reader->GetOutput());
+  fourdsart->SetInputProjectionStack(projectionsSource->GetOutput());
   fourdsart->SetGeometry( geometryReader->GetOutputObject() );
   fourdsart->SetNumberOfIterations( args_info.niterations_arg );
   fourdsart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
@@ -128,6 +138,8 @@ int main(int argc, char * argv[])
   if(args_info.time_flag)
     {
     fourdsart->PrintTiming(std::cout);
+    if(args_info.cache_arg>0)
+      std::cout << "Projections cache hit rate: " << 100.*cache->GetHitRate() << '%' << std::endl;
     totalTimeProbe.Stop();
     std::cout << "It took...  " << totalTimeProbe.GetMean() << ' ' << totalTimeProbe.GetUnit() << std::endl;
     }
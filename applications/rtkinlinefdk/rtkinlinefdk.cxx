@@ -22,431 +22,228 @@
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkProjectionsReader.h"
-#include "rtkDisplacedDetectorImageFilter.h"
-#include "rtkParkerShortScanImageFilter.h"
-#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkInlineFDKReconstructor.h"
 #ifdef RTK_USE_CUDA
-# include "rtkCudaFDKConeBeamReconstructionFilter.h"
+# include "rtkCudaFDKBackProjectionImageFilter.h"
 #endif
 #ifdef RTK_USE_OPENCL
-# include "rtkOpenCLFDKConeBeamReconstructionFilter.h"
+# include "rtkOpenCLFDKBackProjectionImageFilter.h"
 #endif
 
 #include <itkRegularExpressionSeriesFileNames.h>
 #include <itkImageFileWriter.h>
-#include <itkSimpleFastMutexLock.h>
-#include <itkMultiThreader.h>
+#include <itkTimeProbe.h>
 #include <itksys/SystemTools.hxx>
-#include <itkNumericTraits.h>
+#include <itksys/RegularExpression.hxx>
 
-// Pass projection name, projection parameters, last
-struct ThreadInfoStruct
-  {
-  itk::SimpleFastMutexLock mutex;
-  args_info_rtkinlinefdk *args_info;
-  bool stop;
-  unsigned int nproj;
-  double sid;
-  double sdd;
-  double gantryAngle;
-  double projOffsetX;
-  double projOffsetY;
-  double outOfPlaneAngle;
-  double inPlaneAngle;
-  double sourceOffsetX;
-  double sourceOffsetY;
-  double minimumOffsetX;    // Used for Wang weighting
-  double maximumOffsetX;
-  std::string fileName;
-  };
+#include <algorithm>
+#include <map>
+#include <set>
 
-void computeOffsetsFromGeometry(rtk::ThreeDCircularProjectionGeometry::Pointer geometry, double *minOffset,
-                                double *maxOffset);
-
-static ITK_THREAD_RETURN_TYPE AcquisitionCallback(void *arg);
-static ITK_THREAD_RETURN_TYPE InlineThreadCallback(void *arg);
-
-int main(int argc, char * argv[])
+template<class TInlineFDKType>
+void WritePreview(TInlineFDKType *inlineFDK, const args_info_rtkinlinefdk &args_info)
 {
-  GGO(rtkinlinefdk, args_info);
-
-  // Launch threads, one for acquisition, one for reconstruction with inline
-  // processing
-  ThreadInfoStruct threadInfo;
-  threadInfo.args_info = &args_info;
-  threadInfo.nproj = 0;
-  threadInfo.minimumOffsetX = 0.0;
-  threadInfo.maximumOffsetX = 0.0;
-
-  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
-  threader->SetMultipleMethod(0, AcquisitionCallback, (void*)&threadInfo);
-  threader->SetMultipleMethod(1, InlineThreadCallback, (void*)&threadInfo);
-  threader->SetNumberOfThreads(2);
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( threader->MultipleMethodExecute () );
-
-  return EXIT_SUCCESS;
+  if(!args_info.previewfile_given || args_info.preview_arg<2)
+    return;
+
+  typedef itk::ImageFileWriter< typename TInlineFDKType::OutputImageType > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( args_info.previewfile_arg );
+  writer->SetInput( inlineFDK->GetPreview() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
 }
 
-// This thread reads in a geometry file and a sequence of projection file names
-// and communicates them one by one to the other thread via a ThreadinfoStruct.
-static ITK_THREAD_RETURN_TYPE AcquisitionCallback(void *arg)
+// Returns the index of the projection in fileName given by the submatch of
+// regexp, false if fileName does not match or if the submatch is not a number
+bool GetProjectionIndex(itksys::RegularExpression &regexp, unsigned int submatch,
+                        const std::string &fileName, unsigned int &index)
 {
-  double minOffset, maxOffset;
-  ThreadInfoStruct *threadInfo = (ThreadInfoStruct *)(((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData);
-
-  threadInfo->mutex.Lock();
-
-  // Generate file names
-  itk::RegularExpressionSeriesFileNames::Pointer names = itk::RegularExpressionSeriesFileNames::New();
-  names->SetDirectory(threadInfo->args_info->path_arg);
-  names->SetNumericSort(threadInfo->args_info->nsort_flag);
-  names->SetRegularExpression(threadInfo->args_info->regexp_arg);
-  names->SetSubMatch(threadInfo->args_info->submatch_arg);
+  if( !regexp.find( itksys::SystemTools::GetFilenameName(fileName) ) )
+    return false;
+  const std::string number = regexp.match(submatch);
+  if( number.empty() || number.find_first_not_of("0123456789") != std::string::npos )
+    return false;
+  index = atoi( number.c_str() );
+  return true;
+}
 
-  if(threadInfo->args_info->verbose_flag)
-    std::cout << "Regular expression matches "
-              << names->GetFileNames().size()
-              << " file(s)..."
-              << std::endl;
+template<class TOutputImageType, class TBackProjectionFilterType>
+int InlineFDK(const args_info_rtkinlinefdk &args_info)
+{
+  typedef TOutputImageType OutputImageType;
 
-  // Geometry
-  if(threadInfo->args_info->verbose_flag)
+  // Geometry of the whole acquisition
+  if(args_info.verbose_flag)
     std::cout << "Reading geometry information from "
-              << threadInfo->args_info->geometry_arg
+              << args_info.geometry_arg
               << "..."
               << std::endl;
   rtk::ThreeDCircularProjectionGeometryXMLFileReader::Pointer geometryReader;
   geometryReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
-  geometryReader->SetFilename(threadInfo->args_info->geometry_arg);
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() );
-
-  // Computes the minimum and maximum offsets from Geometry
-  computeOffsetsFromGeometry(geometryReader->GetOutputObject(), &minOffset, &maxOffset);
-  std::cout << " main :"<<  minOffset << " "<< maxOffset <<std::endl;
+  geometryReader->SetFilename(args_info.geometry_arg);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( geometryReader->GenerateOutputInformation() )
+  const unsigned int nProj = geometryReader->GetOutputObject()->GetGantryAngles().size();
 
-  threadInfo->mutex.Unlock();
-
-  // Mock an inline acquisition
-  unsigned int nproj = geometryReader->GetOutputObject()->GetMatrices().size();
-  rtk::ThreeDCircularProjectionGeometry *geometry = geometryReader->GetOutputObject();
-  for(unsigned int i=0; i<nproj; i++)
-    {
-    threadInfo->mutex.Lock();
-    threadInfo->sdd = geometry->GetSourceToDetectorDistances()[i];
-    threadInfo->sid = geometry->GetSourceToIsocenterDistances()[i];
-    threadInfo->gantryAngle = geometry->GetGantryAngles()[i];
-    threadInfo->sourceOffsetX = geometry->GetSourceOffsetsX()[i];
-    threadInfo->sourceOffsetY = geometry->GetSourceOffsetsY()[i];
-    threadInfo->projOffsetX = geometry->GetProjectionOffsetsX()[i];
-    threadInfo->projOffsetY = geometry->GetProjectionOffsetsY()[i];
-    threadInfo->inPlaneAngle = geometry->GetInPlaneAngles()[i];
-    threadInfo->outOfPlaneAngle = geometry->GetOutOfPlaneAngles()[i];
-    threadInfo->minimumOffsetX = minOffset;
-    threadInfo->maximumOffsetX = maxOffset;
-    threadInfo->fileName = names->GetFileNames()[ vnl_math_min( i, (unsigned int)names->GetFileNames().size()-1 ) ];
-    threadInfo->nproj = i+1;
-    threadInfo->stop = (i==nproj-1);
-    if(threadInfo->args_info->verbose_flag)
-      std::cout << std::endl
-                << "AcquisitionCallback has simulated the acquisition of projection #" << i
-                << std::endl;
-    threadInfo->mutex.Unlock();
-    itksys::SystemTools::Delay(200);
-    }
-
-  return ITK_THREAD_RETURN_VALUE;
-}
-
-// This thread receives information of each projection (one-by-one) and process
-// directly the projections for which it has enough information. This thread
-// currently assumes that the projections are sequentially sent with increasing
-// gantry angles. Specific management with a queue must be implemented if the
-// projections are not exactly sequential. Short scans has not been implemented
-// yet because this filter currently require the full geometry of the
-// acquisition. Management with a mock geometry file would be possible but it is
-// still to be implemented.
-static ITK_THREAD_RETURN_TYPE InlineThreadCallback(void *arg)
-{
-  ThreadInfoStruct *threadInfo = (ThreadInfoStruct *)(((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData);
-  threadInfo->mutex.Lock();
-  typedef float OutputPixelType;
-  const unsigned int Dimension = 3;
-  typedef itk::Image< OutputPixelType, Dimension >     CPUOutputImageType;
-#ifdef RTK_USE_CUDA
-  typedef itk::CudaImage< OutputPixelType, Dimension > OutputImageType;
-#else
-  typedef CPUOutputImageType                           OutputImageType;
-#endif
-
-  rtk::ThreeDCircularProjectionGeometry::Pointer geometry = rtk::ThreeDCircularProjectionGeometry::New();
-  std::vector< std::string >                     fileNames;
-
-  // Projections reader
+  // Projections reader, only used for its pre-processing parameters
   typedef rtk::ProjectionsReader< OutputImageType > ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
+  typename ReaderType::Pointer reader = ReaderType::New();
+  rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtkinlinefdk>(reader, args_info);
 
   // Create reconstructed image
   typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
-  ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
-  rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkinlinefdk>(constantImageSource, *(threadInfo->args_info));
-
-  // Extract filter to process one projection at a time
-  typedef itk::ExtractImageFilter<OutputImageType, OutputImageType> ExtractFilterType;
-  ExtractFilterType::Pointer extract = ExtractFilterType::New();
-  extract->SetInput( reader->GetOutput() );
-  ExtractFilterType::InputImageRegionType subsetRegion;
-
-  // Displaced detector weighting
-  typedef rtk::DisplacedDetectorImageFilter< OutputImageType > DDFType;
-  DDFType::Pointer ddf = DDFType::New();
-  ddf->SetInput( extract->GetOutput() );
-  ddf->SetGeometry( geometry );
-
-  // Short scan image filter
-//  typedef rtk::ParkerShortScanImageFilter< OutputImageType > PSSFType;
-//  PSSFType::Pointer pssf = PSSFType::New();
-//  pssf->SetInput( ddf->GetOutput() );
-//  pssf->SetGeometry( geometryReader->GetOutputObject() );
-//  pssf->InPlaceOff();
-
-  // This macro sets options for fdk filter which I can not see how to do better
-  // because TFFTPrecision is not the same, e.g. for CPU and CUDA (SR)
-#define SET_FELDKAMP_OPTIONS(f) \
-  f->SetInput( 0, constantImageSource->GetOutput() ); \
-  f->SetInput( 1, ddf->GetOutput() ); \
-  f->SetGeometry( geometry ); \
-  f->GetRampFilter()->SetTruncationCorrection(threadInfo->args_info->pad_arg); \
-  f->GetRampFilter()->SetHannCutFrequency(threadInfo->args_info->hann_arg);
-
-  // FDK reconstruction filtering
-  typedef rtk::FDKConeBeamReconstructionFilter< OutputImageType > FDKCPUType;
-  FDKCPUType::Pointer feldkampCPU = FDKCPUType::New();
-#ifdef RTK_USE_CUDA
-  typedef rtk::CudaFDKConeBeamReconstructionFilter FDKCUDAType;
-  FDKCUDAType::Pointer feldkampCUDA = FDKCUDAType::New();
-#endif
-#ifdef RTK_USE_OPENCL
-  typedef rtk::OpenCLFDKConeBeamReconstructionFilter FDKOPENCLType;
-  FDKOPENCLType::Pointer feldkampOCL = FDKOPENCLType::New();
-#endif
-  if(!strcmp(threadInfo->args_info->hardware_arg, "cpu") )
-    {
-    SET_FELDKAMP_OPTIONS(feldkampCPU);
-    }
-  else if(!strcmp(threadInfo->args_info->hardware_arg, "cuda") )
-    {
-#ifdef RTK_USE_CUDA
-    SET_FELDKAMP_OPTIONS( feldkampCUDA );
-#else
-    std::cerr << "The program has not been compiled with cuda option" << std::endl;
-    exit(EXIT_FAILURE);
-#endif
-    }
-  else if(!strcmp(threadInfo->args_info->hardware_arg, "opencl") )
-    {
-#ifdef RTK_USE_OPENCL
-    SET_FELDKAMP_OPTIONS( feldkampOCL );
-#else
-    std::cerr << "The program has not been compiled with opencl option" << std::endl;
-    exit(EXIT_FAILURE);
-#endif
-    }
-
-  // Writer
-  typedef itk::ImageFileWriter<  CPUOutputImageType > WriterType;
-  WriterType::Pointer writer = WriterType::New();
-  writer->SetFileName( threadInfo->args_info->output_arg );
-
-  threadInfo->mutex.Unlock();
-
-  // Inline loop
-  std::cout << "Reconstruction thread has entered in the processing loop" << std::endl;
-  for(;;)
+  typename ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
+  rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkinlinefdk>(constantImageSource, args_info);
+
+  // Inline FDK
+  typedef rtk::InlineFDKReconstructor< OutputImageType > InlineFDKType;
+  typename InlineFDKType::Pointer inlineFDK = InlineFDKType::New();
+  inlineFDK->SetGeometry( geometryReader->GetOutputObject() );
+  inlineFDK->SetVolume( constantImageSource->GetOutput() );
+  inlineFDK->SetProjectionsReader( reader );
+  inlineFDK->SetTruncationCorrection( args_info.pad_arg );
+  inlineFDK->SetHannCutFrequency( args_info.hann_arg );
+  inlineFDK->SetHannCutFrequencyY( args_info.hannY_arg );
+  inlineFDK->SetQueueSize( args_info.queue_arg );
+  inlineFDK->SetPreviewShrinkFactor( args_info.preview_arg );
+  inlineFDK->SetBackProjectionFilter( TBackProjectionFilterType::New() );
+  inlineFDK->SetPreviewBackProjectionFilter( TBackProjectionFilterType::New() );
+  if(args_info.threads_given)
+    inlineFDK->SetNumberOfFilteringThreads( args_info.threads_arg );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineFDK->Start() )
+
+  itk::TimeProbe lastProjectionProbe;
+  if(args_info.watch_flag)
     {
-    threadInfo->mutex.Lock();
-
-    if(geometry->GetMatrices().size()<threadInfo->nproj)
+    // Follow the acquisition by scanning path for new projections. A file is
+    // only pushed once its size and modification time have not changed
+    // between two consecutive scans, i.e., once it has been completely written.
+    itk::RegularExpressionSeriesFileNames::Pointer names = itk::RegularExpressionSeriesFileNames::New();
+    names->SetDirectory(args_info.path_arg);
+    names->SetRegularExpression(args_info.regexp_arg);
+    itksys::RegularExpression regexp(args_info.regexp_arg);
+    std::set<std::string> processedFiles;
+    std::map< std::string, std::pair<unsigned long, long int> > writtenFiles;
+    double timeWithoutProjection = 0.;
+    while(inlineFDK->GetNumberOfPushedProjections() < nProj &&
+          timeWithoutProjection < args_info.timeout_arg)
       {
-      if(threadInfo->args_info->verbose_flag)
-        std::cerr << "InlineThreadCallback has received projection #" << threadInfo->nproj-1 << std::endl;
-
-      if(threadInfo->fileName != "" && (fileNames.size()==0 || fileNames.back() != threadInfo->fileName) )
-        fileNames.push_back(threadInfo->fileName);
+      const std::vector<std::string> &fileNames = names->GetFileNames();
+      bool newProjection = false;
+      for(unsigned int i=0; i<fileNames.size(); i++)
+        {
+        if(processedFiles.find(fileNames[i]) != processedFiles.end())
+          continue;
 
-      geometry->AddProjectionInRadians(threadInfo->sid, threadInfo->sdd, threadInfo->gantryAngle,
-                                       threadInfo->projOffsetX, threadInfo->projOffsetY,
-                                       threadInfo->outOfPlaneAngle, threadInfo->inPlaneAngle,
-                                       threadInfo->sourceOffsetX, threadInfo->sourceOffsetY);
+        unsigned int index;
+        if( !GetProjectionIndex(regexp, args_info.submatch_arg, fileNames[i], index) )
+          {
+          std::cerr << "Ignoring " << fileNames[i]
+                    << " whose name does not give a projection number with the regular expression"
+                    << std::endl;
+          processedFiles.insert(fileNames[i]);
+          continue;
+          }
 
-      std::cout << "Geometry size : "<<geometry->GetMatrices().size() << std::endl;
+        const std::pair<unsigned long, long int> state(itksys::SystemTools::FileLength(fileNames[i].c_str()),
+                                                       itksys::SystemTools::ModifiedTime(fileNames[i].c_str()));
+        std::map< std::string, std::pair<unsigned long, long int> >::iterator it = writtenFiles.find(fileNames[i]);
+        if(it == writtenFiles.end() || it->second != state || state.first == 0)
+          {
+          // Being written, check again at the next scan
+          writtenFiles[fileNames[i]] = state;
+          continue;
+          }
+        writtenFiles.erase(it);
+        processedFiles.insert(fileNames[i]);
 
-      if(geometry->GetMatrices().size()!=threadInfo->nproj)
-        {
-        std::cerr << "Missed one projection in InlineThreadCallback" << std::endl;
-        exit(EXIT_FAILURE);
+        if(args_info.verbose_flag)
+          std::cout << "Projection #" << index << " acquired in " << fileNames[i] << std::endl;
+        TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineFDK->PushProjectionFile(index, fileNames[i]) )
+        newProjection = true;
         }
-      if(geometry->GetMatrices().size()<3)
+      if(newProjection)
         {
-        threadInfo->mutex.Unlock();
-        continue;
+        WritePreview(inlineFDK.GetPointer(), args_info);
+        timeWithoutProjection = 0.;
+        lastProjectionProbe.Reset();
+        lastProjectionProbe.Start();
         }
+      else
+        timeWithoutProjection += 1e-3 * args_info.delay_arg;
 
-      OutputImageType::RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
-      std::cout<<"Reader size : " << region.GetSize()[0]<<" "
-               << region.GetSize()[1]<<" "<< region.GetSize()[2]<<std::endl;
-      std::cout << "Reader index : "<<region.GetIndex()[0]<< " "
-                << region.GetIndex()[1]<< " "
-                << region.GetIndex()[2]<<std::endl;
-
-      reader->SetFileNames( fileNames );
-      reader->UpdateOutputInformation();
-      subsetRegion = reader->GetOutput()->GetLargestPossibleRegion();
-      subsetRegion.SetIndex(Dimension-1, geometry->GetMatrices().size()-2);
-      subsetRegion.SetSize(Dimension-1, 1);
-      extract->SetExtractionRegion(subsetRegion);
+      // Always wait between two scans to detect files being written
+      itksys::SystemTools::Delay(args_info.delay_arg);
+      }
+    }
+  else
+    {
+    // Simulate the acquisition with the projections already in path
+    const std::vector<std::string> &fileNames = reader->GetFileNames();
+    std::vector<unsigned int> order;
+    for(unsigned int i=0; i<vnl_math_min(nProj, (unsigned int)fileNames.size()); i++)
+      order.push_back(i);
+    if(args_info.shuffle_flag)
+      std::random_shuffle( order.begin(), order.end() );
+    for(unsigned int i=0; i<order.size(); i++)
+      {
+      if(i)
+        itksys::SystemTools::Delay(args_info.delay_arg);
+      if(args_info.verbose_flag)
+        std::cout << "Projection #" << order[i] << " acquired in " << fileNames[order[i]] << std::endl;
+      lastProjectionProbe.Reset();
+      lastProjectionProbe.Start();
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineFDK->PushProjectionFile(order[i], fileNames[order[i]]) )
+      WritePreview(inlineFDK.GetPointer(), args_info);
+      }
+    }
 
-      std::cout << "Region size : "<<subsetRegion.GetSize()[0]<< " "
-                << subsetRegion.GetSize()[1]<< " "
-                << subsetRegion.GetSize()[2]<<std::endl;
-      std::cout << "Region index : "<<subsetRegion.GetIndex()[0]<< " "
-                << subsetRegion.GetIndex()[1]<< " "
-                << subsetRegion.GetIndex()[2]<<std::endl;
+  typename OutputImageType::Pointer volume;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volume = inlineFDK->Finalize() )
+  lastProjectionProbe.Stop();
+  if(args_info.verbose_flag)
+    std::cout << inlineFDK->GetNumberOfBackProjectedProjections() << " projections reconstructed, the volume was ready "
+              << lastProjectionProbe.GetTotal() << ' ' << lastProjectionProbe.GetUnit()
+              << " after the last projection." << std::endl;
 
-      ExtractFilterType::InputImageRegionType extractRegion = extract->GetOutput()->GetLargestPossibleRegion();
+  WritePreview(inlineFDK.GetPointer(), args_info);
 
-      std::cout << "Extract region size : "<<extractRegion.GetSize()[0]<< " "
-                << extractRegion.GetSize()[1]<< " "
-                << extractRegion.GetSize()[2]<<std::endl;
-      std::cout << "Extract region index : "<<extractRegion.GetIndex()[0]<< " "
-                << extractRegion.GetIndex()[1]<< " "
-                << extractRegion.GetIndex()[2]<<std::endl;
+  // Write
+  typedef itk::ImageFileWriter< OutputImageType > WriterType;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( args_info.output_arg );
+  writer->SetInput( volume );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() )
 
-      ddf->SetOffsets(threadInfo->minimumOffsetX, threadInfo->maximumOffsetX);
+  return EXIT_SUCCESS;
+}
 
-      if(!strcmp(threadInfo->args_info->hardware_arg, "cpu") )
-        {
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->Update() );
-        OutputImageType::Pointer pimg = feldkampCPU->GetOutput();
-        pimg->DisconnectPipeline();
-        feldkampCPU->SetInput( pimg );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->GetOutput()->UpdateOutputInformation() );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->GetOutput()->PropagateRequestedRegion() );
-        }
-#ifdef RTK_USE_CUDA
-      else if(!strcmp(threadInfo->args_info->hardware_arg, "cuda") )
-        {
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->Update() );
-        OutputImageType::Pointer pimg = feldkampCUDA->GetOutput();
-        pimg->DisconnectPipeline();
-        feldkampCUDA->SetInput( pimg );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->GetOutput()->UpdateOutputInformation() );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->GetOutput()->PropagateRequestedRegion() );
-        }
-#endif
-#ifdef RTK_USE_OPENCL
-      else if(!strcmp(threadInfo->args_info->hardware_arg, "opencl") )
-        {
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->Update() );
-        CPUOutputImageType::Pointer pimg = feldkampOCL->GetOutput();
-        pimg->DisconnectPipeline();
-        feldkampOCL->SetInput( pimg );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->GetOutput()->UpdateOutputInformation() );
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->GetOutput()->PropagateRequestedRegion() );
-        }
-#endif
-      if(threadInfo->args_info->verbose_flag)
-        std::cout << "Projection #" << subsetRegion.GetIndex(Dimension-1)
-                  << " has been processed in reconstruction." << std::endl;
+int main(int argc, char * argv[])
+{
+  GGO(rtkinlinefdk, args_info);
 
-      if(threadInfo->stop)
-        {
-        // Process first projection
-        subsetRegion.SetIndex(Dimension-1, 0);
-        extract->SetExtractionRegion(subsetRegion);
-        if(!strcmp(threadInfo->args_info->hardware_arg, "cpu") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->Update() );
-          OutputImageType::Pointer pimg = feldkampCPU->GetOutput();
-          pimg->DisconnectPipeline();
-          feldkampCPU->SetInput( pimg );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->GetOutput()->UpdateOutputInformation() );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->GetOutput()->PropagateRequestedRegion() );
-          }
-#ifdef RTK_USE_CUDA
-        else if(!strcmp(threadInfo->args_info->hardware_arg, "cuda") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->Update() );
-          OutputImageType::Pointer pimg = feldkampCUDA->GetOutput();
-          pimg->DisconnectPipeline();
-          feldkampCUDA->SetInput( pimg );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->GetOutput()->UpdateOutputInformation() );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->GetOutput()->PropagateRequestedRegion() );
-          }
-#endif
-#ifdef RTK_USE_OPENCL
-        else if(!strcmp(threadInfo->args_info->hardware_arg, "opencl") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->Update() );
-          CPUOutputImageType::Pointer pimg = feldkampOCL->GetOutput();
-          pimg->DisconnectPipeline();
-          feldkampOCL->SetInput( pimg );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->GetOutput()->UpdateOutputInformation() );
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->GetOutput()->PropagateRequestedRegion() );
-          }
-#endif
-        if(threadInfo->args_info->verbose_flag)
-          std::cout << "Projection #" << subsetRegion.GetIndex(Dimension-1)
-                    << " has been processed in reconstruction." << std::endl;
+  typedef float OutputPixelType;
+  const unsigned int Dimension = 3;
+  typedef itk::Image< OutputPixelType, Dimension > CPUOutputImageType;
 
-        // Process last projection
-        subsetRegion.SetIndex(Dimension-1, geometry->GetMatrices().size()-1);
-        extract->SetExtractionRegion(subsetRegion);
-        if(!strcmp(threadInfo->args_info->hardware_arg, "cpu") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCPU->Update() );
-          writer->SetInput( feldkampCPU->GetOutput() );
-          }
+  if(!strcmp(args_info.hardware_arg, "cuda") )
+    {
 #ifdef RTK_USE_CUDA
-        else if(!strcmp(threadInfo->args_info->hardware_arg, "cuda") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCUDA->Update() );
-          writer->SetInput( feldkampCUDA->GetOutput() );
-          }
-#endif
-#ifdef RTK_USE_OPENCL
-        else if(!strcmp(threadInfo->args_info->hardware_arg, "opencl") )
-          {
-          TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampOCL->Update() );
-          writer->SetInput( feldkampOCL->GetOutput() );
-          }
+    return InlineFDK< itk::CudaImage< OutputPixelType, Dimension >,
+                      rtk::CudaFDKBackProjectionImageFilter >(args_info);
+#else
+    std::cerr << "The program has not been compiled with cuda option" << std::endl;
+    return EXIT_FAILURE;
 #endif
-        if(threadInfo->args_info->verbose_flag)
-              std::cout << "Projection #" << subsetRegion.GetIndex(Dimension-1)
-                    << " has been processed in reconstruction." << std::endl;
-
-        //Write to disk and exit
-        TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
-        exit(EXIT_SUCCESS);
-        }
-      }
-
-    threadInfo->mutex.Unlock();
     }
-  return ITK_THREAD_RETURN_VALUE;
-}
-
-void computeOffsetsFromGeometry(rtk::ThreeDCircularProjectionGeometry::Pointer geometry, double *minOffset,
-                                double *maxOffset)
-{
-  double min = itk::NumericTraits<double>::max();
-  double max = itk::NumericTraits<double>::min();
-
-  for(unsigned int i=0; i<geometry->GetProjectionOffsetsX().size(); i++)
+  if(!strcmp(args_info.hardware_arg, "opencl") )
     {
-    min = vnl_math_min(min, geometry->GetProjectionOffsetsX()[i]);
-    max = vnl_math_max(max, geometry->GetProjectionOffsetsX()[i]);
+#ifdef RTK_USE_OPENCL
+    return InlineFDK< CPUOutputImageType, rtk::OpenCLFDKBackProjectionImageFilter >(args_info);
+#else
+    std::cerr << "The program has not been compiled with opencl option" << std::endl;
+    return EXIT_FAILURE;
+#endif
     }
-  *minOffset = min;
-  *maxOffset = max;
+  return InlineFDK< CPUOutputImageType,
+                    rtk::FDKBackProjectionImageFilter<CPUOutputImageType, CPUOutputImageType> >(args_info);
 }
-
@@ -0,0 +1,309 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkprojectorsbenchmark_ggo.h"
+#include "rtkGgoFunctions.h"
+
+#include "rtkConstantImageSource.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkRayCastInterpolatorForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkDistanceDrivenForwardProjectionImageFilter.h"
+#include "rtkFDKBackProjectionImageFilter.h"
+#include "rtkJosephBackProjectionImageFilter.h"
+#include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkDistanceDrivenBackProjectionImageFilter.h"
+#include "rtkThreadPool.h"
+#include "rtkThreadPoolImageFilter.h"
+#include "rtkImageBufferPool.h"
+
+#include <itkTimeProbe.h>
+#include <itkMultiThreader.h>
+
+#include <iomanip>
+
+typedef float                         OutputPixelType;
+typedef itk::Image< OutputPixelType, 3 > OutputImageType;
+
+// Time of the fastest of repeat runs of a projector. The inputs of the
+// projector are up-to-date so only the projection is timed.
+template <class TProjector>
+double TimeProjector(TProjector *projector, unsigned int nThreads, int repeat)
+{
+  double best = itk::NumericTraits<double>::max();
+  for(int r=0; r<repeat; r++)
+    {
+    projector->SetNumberOfThreads(nThreads);
+    projector->InPlaceOff();
+    projector->Modified();
+    itk::TimeProbe probe;
+    probe.Start();
+    projector->Update();
+    probe.Stop();
+    best = std::min(best, probe.GetTotal());
+    projector->GetOutput()->ReleaseData();
+    }
+  return best;
+}
+
+// Time of the fastest of repeat runs of a back projector, in place on a new
+// volume. The pages of the volume are first touched, by one thread or by the
+// workers of the thread pool, before the timing.
+template <class TProjector>
+double TimeBackProjector(TProjector *projector, const OutputImageType *volumeInformation,
+                         unsigned int nThreads, int repeat, bool parallelFirstTouch)
+{
+  double best = itk::NumericTraits<double>::max();
+  for(int r=0; r<repeat; r++)
+    {
+    OutputImageType::Pointer volume = OutputImageType::New();
+    volume->CopyInformation(volumeInformation);
+    volume->SetRegions(volumeInformation->GetLargestPossibleRegion());
+    volume->Allocate();
+    if(parallelFirstTouch)
+      {
+      // Slices along the last dimension, as split by the projector
+      const OutputImageType::SizeType size = volume->GetBufferedRegion().GetSize();
+      rtk::ImageBufferPool::Zero(volume->GetBufferPointer(),
+                                 volume->GetPixelContainer()->Size() * sizeof(OutputPixelType),
+                                 size[0] * size[1] * sizeof(OutputPixelType),
+                                 nThreads);
+      }
+    else
+      volume->FillBuffer(0.);
+
+    projector->SetInput(volume);
+    projector->SetNumberOfThreads(nThreads);
+    projector->InPlaceOn();
+    projector->Modified();
+    itk::TimeProbe probe;
+    probe.Start();
+    projector->Update();
+    probe.Stop();
+    best = std::min(best, probe.GetTotal());
+    projector->GetOutput()->ReleaseData();
+    }
+  return best;
+}
+
+// New projector, dispatched onto the thread pool if pool is true
+template <class TProjector>
+typename TProjector::Pointer NewProjector(bool pool)
+{
+  if(pool)
+    return rtk::ThreadPoolImageFilter<TProjector>::New().GetPointer();
+  return TProjector::New();
+}
+
+void PrintResult(const char *type, const char *name, unsigned int nThreads,
+                 double time, double voxelUpdates)
+{
+  std::cout << std::left  << std::setw(10) << type
+                          << std::setw(28) << name
+            << std::right << std::setw(8)  << nThreads
+                          << std::setw(14) << time
+                          << std::setw(20) << voxelUpdates / time
+            << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkprojectorsbenchmark, args_info);
+
+  const unsigned int dim = args_info.dimension_arg;
+  const unsigned int nproj = args_info.nproj_arg;
+  const unsigned int det = (args_info.detector_given)?args_info.detector_arg:dim;
+
+  // Thread placement and first touch. The buffer pool is disabled so that
+  // each back projected volume is made of new pages.
+  const bool pool = args_info.pool_flag || args_info.pin_flag;
+  const bool parallelFirstTouch = (args_info.firsttouch_arg == firsttouch_arg_parallel);
+  rtk::ThreadPool::GetInstance()->SetThreadPinning(args_info.pin_flag);
+  rtk::ImageBufferPool::GetInstance()->SetEnabled(false);
+  if(args_info.verbose_flag)
+    std::cout << "Projectors run on " << ((pool)?"rtk::ThreadPool":"itk::MultiThreader")
+              << ((args_info.pin_flag)?" with pinned workers":"")
+              << ", volumes are first touched by "
+              << ((parallelFirstTouch)?"the workers of rtk::ThreadPool":"one thread") << "." << std::endl;
+
+  // Circular geometry with a magnification of 1.5
+  const double sid = 1000.;
+  const double sdd = 1500.;
+  rtk::ThreeDCircularProjectionGeometry::Pointer geometry = rtk::ThreeDCircularProjectionGeometry::New();
+  for(unsigned int i=0; i<nproj; i++)
+    geometry->AddProjection(sid, sdd, i*360./nproj);
+
+  // Volume of 256 mm whatever the number of voxels
+  const double volumeSize = 256.;
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+  ConstantImageSourceType::Pointer volumeSource = ConstantImageSourceType::New();
+  size.Fill(dim);
+  spacing.Fill(volumeSize/dim);
+  origin.Fill(-0.5*volumeSize + 0.5*spacing[0]);
+  volumeSource->SetOrigin( origin );
+  volumeSource->SetSpacing( spacing );
+  volumeSource->SetSize( size );
+  volumeSource->SetConstant( 0. );
+
+  // Detector covering the magnified volume
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  size[0] = det;
+  size[1] = det;
+  size[2] = nproj;
+  spacing[0] = volumeSize * sdd / sid / det;
+  spacing[1] = spacing[0];
+  spacing[2] = 1.;
+  origin[0] = -0.5 * spacing[0] * (det-1);
+  origin[1] = origin[0];
+  origin[2] = 0.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Shepp-Logan volume and projections
+  if(args_info.verbose_flag)
+    std::cout << "Simulating " << nproj << " projections of " << det << "x" << det
+              << " pixels and a volume of " << dim << "^3 voxels..." << std::flush;
+  typedef rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType> SLPType;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(0.5*volumeSize);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() )
+
+  typedef rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType> DSLType;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( volumeSource->GetOutput() );
+  dsl->SetPhantomScale(0.5*volumeSize);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volumeSource->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( projectionsSource->Update() )
+  if(args_info.verbose_flag)
+    std::cout << " done." << std::endl;
+
+  // Threads to benchmark
+  std::vector<unsigned int> threads;
+  for(unsigned int i=0; i<args_info.threads_given; i++)
+    threads.push_back(args_info.threads_arg[i]);
+  if(threads.empty())
+    threads.push_back(itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+
+  // Projectors to benchmark, all if none is given
+  std::vector<int> fps, bps;
+  for(unsigned int i=0; i<args_info.fp_given; i++)
+    fps.push_back(args_info.fp_arg[i]);
+  for(unsigned int i=0; i<args_info.bp_given; i++)
+    bps.push_back(args_info.bp_arg[i]);
+  if(fps.empty() && bps.empty())
+    {
+    for(int i=0; cmdline_parser_rtkprojectorsbenchmark_fp_values[i]; i++)
+      fps.push_back(i);
+    for(int i=0; cmdline_parser_rtkprojectorsbenchmark_bp_values[i]; i++)
+      bps.push_back(i);
+    }
+
+  // Number of voxel updates of one projection or backprojection of the
+  // whole set, as in the RabbitCT benchmark
+  const double voxelUpdates = double(dim) * dim * dim * nproj;
+
+  std::cout << std::left  << std::setw(10) << "Type"
+                          << std::setw(28) << "Projector"
+            << std::right << std::setw(8)  << "Threads"
+                          << std::setw(14) << "Time (s)"
+                          << std::setw(20) << "Voxel updates/s"
+            << std::endl;
+
+  for(unsigned int t=0; t<threads.size(); t++)
+    {
+    for(unsigned int i=0; i<fps.size(); i++)
+      {
+      rtk::ForwardProjectionImageFilter<OutputImageType, OutputImageType>::Pointer fp;
+      switch(fps[i])
+        {
+        case(fp_arg_Joseph):
+          fp = NewProjector< rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        case(fp_arg_RayCastInterpolator):
+          fp = NewProjector< rtk::RayCastInterpolatorForwardProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        case(fp_arg_Siddon):
+          fp = NewProjector< rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        case(fp_arg_DistanceDriven):
+          fp = NewProjector< rtk::DistanceDrivenForwardProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        default:
+          std::cerr << "Unhandled --fp value." << std::endl;
+          return EXIT_FAILURE;
+        }
+      fp->SetInput( projectionsSource->GetOutput() );
+      fp->SetInput( 1, dsl->GetOutput() );
+      fp->SetGeometry( geometry );
+      double time = 0.;
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( time = TimeProjector(fp.GetPointer(), threads[t], args_info.repeat_arg) )
+      PrintResult("Forward", cmdline_parser_rtkprojectorsbenchmark_fp_values[fps[i]], threads[t], time, voxelUpdates);
+      }
+
+    for(unsigned int i=0; i<bps.size(); i++)
+      {
+      rtk::BackProjectionImageFilter<OutputImageType, OutputImageType>::Pointer bp;
+      switch(bps[i])
+        {
+        case(bp_arg_VoxelBasedBackProjection):
+          bp = NewProjector< rtk::BackProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        case(bp_arg_FDKBackProjection):
+          bp = NewProjector< rtk::FDKBackProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        // The Joseph back projectors splat the rays sequentially in their
+        // own GenerateData which the pool adapter would skip
+        case(bp_arg_Joseph):
+          bp = rtk::JosephBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
+          break;
+        case(bp_arg_NormalizedJoseph):
+          bp = rtk::NormalizedJosephBackProjectionImageFilter<OutputImageType, OutputImageType>::New();
+          break;
+        case(bp_arg_Siddon):
+          bp = NewProjector< rtk::SiddonBackProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        case(bp_arg_DistanceDriven):
+          bp = NewProjector< rtk::DistanceDrivenBackProjectionImageFilter<OutputImageType, OutputImageType> >(pool);
+          break;
+        default:
+          std::cerr << "Unhandled --bp value." << std::endl;
+          return EXIT_FAILURE;
+        }
+      bp->SetInput( 1, slp->GetOutput() );
+      bp->SetGeometry( geometry.GetPointer() );
+      double time = 0.;
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( time = TimeBackProjector(bp.GetPointer(), volumeSource->GetOutput(), threads[t],
+                                                              args_info.repeat_arg, parallelFirstTouch) )
+      PrintResult("Back", cmdline_parser_rtkprojectorsbenchmark_bp_values[bps[i]], threads[t], time, voxelUpdates);
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
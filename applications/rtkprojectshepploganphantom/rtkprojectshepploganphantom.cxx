@@ -21,7 +21,7 @@
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
 #include "rtkRayEllipsoidIntersectionImageFilter.h"
 #include "rtkSheppLoganPhantomFilter.h"
-#include "rtkAdditiveGaussianNoiseImageFilter.h"
+#include "rtkProjectionNoiseImageFilter.h"
 
 #include <itkImageFileWriter.h>
 
@@ -30,6 +30,12 @@ int main(int argc, char * argv[])
 {
   GGO(rtkprojectshepploganphantom, args_info);
 
+  if(args_info.electronicnoise_given && !args_info.i0_given)
+    {
+    std::cerr << "--electronicnoise requires --i0" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   typedef float OutputPixelType;
   const unsigned int Dimension = 3;
 
@@ -76,13 +82,29 @@ int main(int argc, char * argv[])
 
   // Add noise
   OutputImageType::Pointer output = slp->GetOutput();
-  if(args_info.noise_given)
+  if(args_info.noise_given || args_info.i0_given)
   {
-    typedef rtk::AdditiveGaussianNoiseImageFilter< OutputImageType > NIFType;
+    typedef rtk::ProjectionNoiseImageFilter< OutputImageType > NIFType;
     NIFType::Pointer noisy=NIFType::New();
     noisy->SetInput( slp->GetOutput() );
+    noisy->SetSeed( args_info.seed_arg );
     noisy->SetMean( 0.0 );
-    noisy->SetStandardDeviation( args_info.noise_arg );
+    if(args_info.i0_given)
+      {
+      noisy->SetI0( args_info.i0_arg );
+      if(args_info.electronicnoise_given)
+        {
+        noisy->SetNoiseModel( NIFType::POISSONGAUSSIAN );
+        noisy->SetStandardDeviation( args_info.electronicnoise_arg );
+        }
+      else
+        noisy->SetNoiseModel( NIFType::POISSON );
+      }
+    else
+      {
+      noisy->SetNoiseModel( NIFType::GAUSSIAN );
+      noisy->SetStandardDeviation( args_info.noise_arg );
+      }
     TRY_AND_EXIT_ON_ITK_EXCEPTION( noisy->Update() );
     output = noisy->GetOutput();
   }
@@ -0,0 +1,185 @@
+/** RabbitCT - Version 1.0
+
+  RabbitCT enables easy benchmarking of backprojection algorithms.
+  This module is the CPU counterpart of rtkrabbitct.cpp. Each projection is
+  backprojected with rtk::FDKBackProjectionImageFilter, i.e., bilinear
+  interpolation of the projection and a distance weight, using the RabbitCT
+  projection matrix as geometry and the RabbitCT volume as in place output.
+*/
+
+// include the required header files
+#include <iostream>
+#include <vector>
+
+#include "rabbitct.h"
+
+#include "rtkMacro.h"
+#include "rtkProjectionGeometry.h"
+#include "rtkFDKBackProjectionImageFilter.h"
+
+#include <itkImportImageFilter.h>
+
+//#define WRITE_OUTPUT
+#ifdef WRITE_OUTPUT
+#  include <itkImageFileWriter.h>
+#endif //WRITE_OUTPUT
+
+typedef itk::Image<float, 3>                                          ImageType;
+typedef itk::ImportImageFilter<float, 3>                              ImportType;
+typedef rtk::FDKBackProjectionImageFilter<ImageType, ImageType>       BackProjectionType;
+
+/** Geometry made of the projection matrix given by RabbitCT */
+class RabbitCtGeometry : public rtk::ProjectionGeometry<3>
+{
+public:
+  typedef RabbitCtGeometry                Self;
+  typedef rtk::ProjectionGeometry<3>      Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+  itkNewMacro( Self );
+
+  void SetMatrix(const MatrixType &m)
+    {
+    this->Clear();
+    this->AddMatrix(m);
+    this->Modified();
+    }
+};
+
+ImportType::Pointer         volumeImport;
+ImportType::Pointer         projectionImport;
+RabbitCtGeometry::Pointer   geometry;
+BackProjectionType::Pointer backProjection;
+std::vector<float>          projection;
+
+/** \brief Initialization routine.
+
+  This method is required for initializing the data required for
+  backprojection. It is called right before the first iteration.
+  Here any time intensive preliminary computations and
+  initializations should be performed.
+*/
+FNCSIGN bool RCTLoadAlgorithm(RabbitCtGlobalData* rcgd)
+{
+  // calculate the number of voxels
+  size_t N = (size_t)rcgd->L * rcgd->L * rcgd->L;
+
+  // allocate the required volume, initialized to 0
+  rcgd->f_L = new float[N]();
+
+  // The volume is imported without copy and updated in place
+  ImportType::RegionType volRegion;
+  ImportType::SizeType volSize;
+  volSize.Fill(rcgd->L);
+  volRegion.SetSize(volSize);
+  volumeImport = ImportType::New();
+  volumeImport->SetRegion(volRegion);
+  ImportType::OriginType volOrigin;
+  volOrigin.Fill(rcgd->O_L);
+  volumeImport->SetOrigin(volOrigin);
+  volumeImport->SetSpacing( itk::Vector<double, 3>(rcgd->R_L) );
+  volumeImport->SetImportPointer(rcgd->f_L, N, false);
+
+  // The pixel (i,j) of the projection is at physical coordinates (i,j) so
+  // that the RabbitCT matrix is the projection matrix of the geometry
+  ImportType::RegionType projRegion;
+  ImportType::SizeType projSize;
+  projSize[0] = rcgd->S_x;
+  projSize[1] = rcgd->S_y;
+  projSize[2] = 1;
+  projRegion.SetSize(projSize);
+  projection.resize( rcgd->S_x * rcgd->S_y );
+  projectionImport = ImportType::New();
+  projectionImport->SetRegion(projRegion);
+  projectionImport->SetImportPointer(&(projection[0]), projection.size(), false);
+
+  geometry = RabbitCtGeometry::New();
+
+  backProjection = BackProjectionType::New();
+  backProjection->SetInput(0, volumeImport->GetOutput());
+  backProjection->SetInput(1, projectionImport->GetOutput());
+  backProjection->SetGeometry( geometry.GetPointer() );
+  backProjection->InPlaceOn();
+
+  return true;
+}
+
+/** \brief Finish routine.
+
+  This method is called after the last projection image. Here
+  it should be made sure the the rcgd->out_volume pointer
+  is set correctly.
+*/
+FNCSIGN bool RCTFinishAlgorithm(RabbitCtGlobalData* itkNotUsed(rcgd))
+{
+  // The backprojection is accumulated in place in rcgd->f_L
+  return true;
+}
+
+/** \brief Cleanup routine.
+
+  This method can be used to clean up the allocated
+  data required for backprojection. It is called just before
+  the benchmark finishes.
+*/
+FNCSIGN bool RCTUnloadAlgorithm(RabbitCtGlobalData* rcgd)
+{
+  backProjection = ITK_NULLPTR;
+  geometry = ITK_NULLPTR;
+  projectionImport = ITK_NULLPTR;
+  projection.clear();
+
+#ifdef WRITE_OUTPUT
+  // Write
+  volumeImport->Modified();
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( "rtkrabbitctcpu.mhd" );
+  writer->SetInput( volumeImport->GetOutput() );
+  writer->Update();
+#endif //WRITE_OUTPUT
+  volumeImport = ITK_NULLPTR;
+
+  // delete the previously allocated volume
+  delete [] (rcgd->f_L);
+  rcgd->f_L = NULL;
+  return true;
+}
+
+/** \brief Backprojection iteration.
+
+  This function is the C++ implementation of the pseudo-code
+  in the technical note.
+*/
+FNCSIGN bool RCTAlgorithmBackprojection(RabbitCtGlobalData* rcgd)
+{
+  //Transpose
+  RabbitCtGeometry::MatrixType matrix;
+  for (unsigned int j=0; j<3; j++)
+    for (unsigned int i=0; i<4; i++)
+      matrix[j][i] = rcgd->A_n[i*3+j];
+  geometry->SetMatrix(matrix);
+
+  // rtk::FDKBackProjectionImageFilter normalizes the distance weight 1/w^2 of
+  // RabbitCT by its value at the origin, which is compensated in the
+  // projection
+  const float weight = 1. / ( matrix[2][3] * matrix[2][3] );
+  for(unsigned int i=0; i<projection.size(); i++)
+    projection[i] = rcgd->I_n[i] * weight;
+
+  // The volume buffer is released by the in place filter, it is imported
+  // again at each projection
+  volumeImport->Modified();
+  projectionImport->Modified();
+  try
+    {
+    backProjection->Update();
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    std::cerr << err << std::endl;
+    return false;
+    }
+
+  return true;
+}
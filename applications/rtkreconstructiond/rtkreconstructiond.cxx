@@ -0,0 +1,963 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// The exceptions of the jobs are reported to the clients instead of exiting
+// the service, see rtkMacro.h
+#define TRY_AND_EXIT_ON_ITK_EXCEPTION(execFunc) execFunc;
+
+#include "rtkreconstructiond_ggo.h"
+#include "rtkfdk_ggo.h"
+#include "rtkconjugategradient_ggo.h"
+#include "rtkGgoFunctions.h"
+#include "rtkConfiguration.h"
+
+#include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkFDKPipelineFromGgo.h"
+#include "rtkConjugateGradientConeBeamReconstructionFilter.h"
+#include "rtkIterationCommands.h"
+#include "rtkThreadPool.h"
+#include "rtkImageBufferPool.h"
+
+#include <itkImageFileWriter.h>
+#include <itkMultiThreader.h>
+#include <itkSimpleMutexLock.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkConditionVariable.h>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <ctime>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef float                                 OutputPixelType;
+typedef itk::Image< OutputPixelType, 3 >      OutputImageType;
+typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+typedef rtk::FDKConeBeamReconstructionFilter< OutputImageType > FDKType;
+
+//--------------------------------------------------------------------
+// Communication with the clients: one connection per job, the job is a line
+// of arguments and the service answers with lines.
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void StopHandler(int)
+{
+  stopRequested = 1;
+}
+
+static bool MakeSocketAddress(const std::string &fileName, sockaddr_un &address)
+{
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if( fileName.size() >= sizeof(address.sun_path) )
+    return false;
+  strncpy(address.sun_path, fileName.c_str(), sizeof(address.sun_path)-1);
+  return true;
+}
+
+static bool ReadLine(int fd, std::string &line)
+{
+  line.clear();
+  char c;
+  for(;;)
+    {
+    const ssize_t n = read(fd, &c, 1);
+    if(n<0 && errno==EINTR)
+      continue;
+    if(n<=0)
+      return !line.empty();
+    if(c=='\n')
+      return true;
+    if(c!='\r')
+      line += c;
+    }
+}
+
+static void WriteLine(int fd, const std::string &line)
+{
+  const std::string buffer = line + '\n';
+  size_t written = 0;
+  while( written<buffer.size() )
+    {
+    const ssize_t n = write(fd, buffer.c_str()+written, buffer.size()-written);
+    if(n<0 && errno==EINTR)
+      continue;
+    if(n<=0)
+      return;
+    written += n;
+    }
+}
+
+// Splits a line in arguments separated by blanks. Like in a shell, quotes
+// group blanks in an argument and backslash escapes the next character.
+static bool SplitArguments(const std::string &line, std::vector<std::string> &arguments)
+{
+  arguments.clear();
+  std::string argument;
+  bool inArgument = false;
+  char quote = 0;
+  for(size_t i=0; i<line.size(); i++)
+    {
+    const char c = line[i];
+    if(c=='\\' && quote!='\'')
+      {
+      if(++i == line.size())
+        return false;
+      argument += line[i];
+      inArgument = true;
+      }
+    else if(quote)
+      {
+      if(c==quote)
+        quote = 0;
+      else
+        argument += c;
+      }
+    else if(c=='"' || c=='\'')
+      {
+      quote = c;
+      inArgument = true;
+      }
+    else if(c==' ' || c=='\t')
+      {
+      if(inArgument)
+        arguments.push_back(argument);
+      argument.clear();
+      inArgument = false;
+      }
+    else
+      {
+      argument += c;
+      inArgument = true;
+      }
+    }
+  if(quote)
+    return false;
+  if(inArgument)
+    arguments.push_back(argument);
+  return true;
+}
+
+static std::string QuoteArgument(const std::string &argument)
+{
+  std::string quoted = "\"";
+  for(size_t i=0; i<argument.size(); i++)
+    {
+    if(argument[i]=='"' || argument[i]=='\\')
+      quoted += '\\';
+    quoted += argument[i];
+    }
+  return quoted + '"';
+}
+
+// Options of rtkfdk and rtkconjugategradient whose value is a file name. They
+// are made absolute with the working directory of the client since the jobs
+// share the working directory of the service.
+static const char *pathOptions[] = { "-g", "--geometry", "-o", "--output", "-p", "--path",
+                                     "-i", "--input", "-w", "--weights", "--like", "--signal",
+                                     "--dvf", "--tuningcache", "--config", NULL };
+
+static void MakeAbsolutePaths(std::vector<std::string> &arguments, const std::string &workingDirectory)
+{
+  for(size_t i=1; i<arguments.size() && arguments[i]!="--"; i++)
+    {
+    for(unsigned int o=0; pathOptions[o]; o++)
+      {
+      const std::string option = pathOptions[o];
+      if(arguments[i] == option)
+        {
+        if(i+1 < arguments.size() )
+          arguments[i+1] = itksys::SystemTools::CollapseFullPath(arguments[i+1], workingDirectory.c_str());
+        i++;
+        break;
+        }
+      std::string::size_type valuePos = std::string::npos;
+      if(option[1]=='-' && arguments[i].compare(0, option.size()+1, option+'=') == 0)
+        valuePos = option.size()+1;
+      else if(option[1]!='-' && arguments[i].size()>2 && arguments[i].compare(0, 2, option) == 0)
+        valuePos = 2;
+      if(valuePos != std::string::npos)
+        {
+        arguments[i] = arguments[i].substr(0, valuePos) +
+                       itksys::SystemTools::CollapseFullPath(arguments[i].substr(valuePos),
+                                                            workingDirectory.c_str());
+        break;
+        }
+      }
+    }
+}
+
+// Parses the options of a job like the GGO macro of rtkMacro.h but returns
+// false instead of exiting on errors
+template< class TArgsInfo, class TParams >
+bool
+ParseJobOptions(const std::vector<std::string> &arguments,
+                TArgsInfo &args_info,
+                void (*paramsInit)(TParams *),
+                int (*parser)(int, char **, TArgsInfo *, TParams *),
+                int (*configFileParser)(const char *, TArgsInfo *, TParams *),
+                void (*freeArgsInfo)(TArgsInfo *))
+{
+  // The help and the version would exit the service
+  for(size_t i=1; i<arguments.size(); i++)
+    if(arguments[i]=="-h" || arguments[i]=="--help" || arguments[i]=="--full-help" ||
+       arguments[i]=="-V" || arguments[i]=="--version")
+      return false;
+
+  std::vector<char *> argv;
+  for(size_t i=0; i<arguments.size(); i++)
+    argv.push_back( const_cast<char *>(arguments[i].c_str()) );
+  argv.push_back(NULL);
+  const int argc = arguments.size();
+
+  TParams params;
+  paramsInit(&params);
+  params.print_errors = 1;
+  params.check_required = 0;
+  params.override = 1;
+  params.initialize = 1;
+  if( 0 != parser(argc, &argv[0], &args_info, &params) )
+    return false;
+  std::string configFile;
+  if(args_info.config_given)
+    configFile = args_info.config_arg;
+  freeArgsInfo(&args_info);
+  if(configFile != "")
+    {
+    if( 0 != configFileParser(configFile.c_str(), &args_info, &params) )
+      return false;
+    params.initialize = 0;
+    }
+  params.check_required = 1;
+  return ( 0 == parser(argc, &argv[0], &args_info, &params) );
+}
+
+// Frees the options of a job. Unlike rtk::args_info_manager, it does not
+// flush the rtk::TraceCollector: its buffers must not be read while the other
+// jobs record spans. The trace is flushed once the workers are stopped.
+template< class TArgsInfo >
+class JobOptionsManager
+{
+public:
+  JobOptionsManager(TArgsInfo &args_info, void (*freeArgsInfo)(TArgsInfo *)):
+    m_ArgsInfo(&args_info),
+    m_FreeArgsInfo(freeArgsInfo)
+    {}
+  ~JobOptionsManager()
+    {
+    m_FreeArgsInfo(m_ArgsInfo);
+    }
+
+private:
+  TArgsInfo *m_ArgsInfo;
+  void     (*m_FreeArgsInfo)(TArgsInfo *);
+};
+
+//--------------------------------------------------------------------
+/** Queue of the jobs, caches shared by the jobs and workers processing the
+ * jobs. Each worker keeps its FDK filters between jobs, hence their ramp
+ * kernels, weights tables, field of view ranges and tuned parameters. The
+ * geometries are read once per file (and modification time) and shared by
+ * all jobs. This is safe because the filters only read the geometry, whose
+ * matrices are all computed when the projections are added. Image buffers are reused through rtk::ImageBufferPool, threads
+ * through rtk::ThreadPool and FFT plans through the FFTW wisdom of ITK. */
+class ReconstructionService
+{
+public:
+  struct JobType
+  {
+    unsigned int             Id;
+    int                      Socket;
+    std::vector<std::string> Arguments;
+  };
+
+  ReconstructionService(unsigned int numberOfWorkers, bool verbose);
+  ~ReconstructionService();
+
+  /** Queue a job. The answer is written to the socket of the job, which is
+   * closed once the job is completed. */
+  void Push(JobType job);
+
+  /** Complete the queued jobs and join the workers */
+  void Stop();
+
+  std::string GetStatus();
+
+  /** Geometry of a file, read if it is not in the cache or if it has been
+   * modified since it was read */
+  GeometryType::Pointer GetGeometry(const std::string &fileName);
+
+protected:
+  struct WorkerType
+  {
+    ReconstructionService *Service;
+    FDKType::Pointer       Feldkamp[2]; // without and with fused weighting
+  };
+
+  bool Pop(JobType &job);
+  void RunJob(WorkerType &worker, const JobType &job);
+  void RunFDK(WorkerType &worker, const args_info_rtkfdk &args_info);
+  void RunConjugateGradient(const args_info_rtkconjugategradient &args_info);
+
+  static ITK_THREAD_RETURN_TYPE WorkerCallback(void *arg);
+
+private:
+  bool                            m_Verbose;
+  itk::MultiThreader::Pointer     m_Threader;
+  std::vector<ThreadIdType>       m_ThreadIds;
+  std::vector<WorkerType>         m_Workers;
+
+  /** Queue and statistics, protected by m_Mutex */
+  itk::SimpleMutexLock            m_Mutex;
+  itk::ConditionVariable::Pointer m_JobsAvailable;
+  std::deque<JobType>             m_Jobs;
+  bool                            m_Stop;
+  unsigned int                    m_NumberOfJobs;
+  unsigned int                    m_NumberOfRunningJobs;
+  unsigned int                    m_NumberOfCompletedJobs;
+  unsigned int                    m_NumberOfFailedJobs;
+
+  /** The parsers of gengetopt are not reentrant */
+  itk::SimpleFastMutexLock        m_ParserMutex;
+
+  /** Geometry cache, protected by m_GeometryMutex */
+  typedef std::map< std::string, std::pair<long int, GeometryType::Pointer> > GeometryCacheType;
+  itk::SimpleFastMutexLock        m_GeometryMutex;
+  GeometryCacheType               m_Geometries;
+};
+
+ReconstructionService
+::ReconstructionService(unsigned int numberOfWorkers, bool verbose):
+  m_Verbose(verbose),
+  m_Stop(false),
+  m_NumberOfJobs(0),
+  m_NumberOfRunningJobs(0),
+  m_NumberOfCompletedJobs(0),
+  m_NumberOfFailedJobs(0)
+{
+  m_JobsAvailable = itk::ConditionVariable::New();
+  m_Threader = itk::MultiThreader::New();
+  m_Workers.resize(numberOfWorkers);
+  for(unsigned int i=0; i<numberOfWorkers; i++)
+    {
+    m_Workers[i].Service = this;
+    m_ThreadIds.push_back( m_Threader->SpawnThread(WorkerCallback, &(m_Workers[i])) );
+    }
+}
+
+ReconstructionService
+::~ReconstructionService()
+{
+  this->Stop();
+}
+
+void
+ReconstructionService
+::Push(JobType job)
+{
+  m_Mutex.Lock();
+  job.Id = ++m_NumberOfJobs;
+  m_Jobs.push_back(job);
+  m_JobsAvailable->Signal();
+  m_Mutex.Unlock();
+}
+
+bool
+ReconstructionService
+::Pop(JobType &job)
+{
+  m_Mutex.Lock();
+  while( m_Jobs.empty() && !m_Stop )
+    m_JobsAvailable->Wait(&m_Mutex);
+  const bool available = !m_Jobs.empty();
+  if(available)
+    {
+    job = m_Jobs.front();
+    m_Jobs.pop_front();
+    m_NumberOfRunningJobs++;
+    }
+  m_Mutex.Unlock();
+  return available;
+}
+
+void
+ReconstructionService
+::Stop()
+{
+  m_Mutex.Lock();
+  m_Stop = true;
+  m_JobsAvailable->Broadcast();
+  m_Mutex.Unlock();
+
+  for(unsigned int i=0; i<m_ThreadIds.size(); i++)
+    m_Threader->TerminateThread(m_ThreadIds[i]);
+  m_ThreadIds.clear();
+}
+
+std::string
+ReconstructionService
+::GetStatus()
+{
+  std::ostringstream status;
+  m_Mutex.Lock();
+  status << m_Jobs.size() << " queued, "
+         << m_NumberOfRunningJobs << " running, "
+         << m_NumberOfCompletedJobs << " completed, "
+         << m_NumberOfFailedJobs << " failed jobs";
+  m_Mutex.Unlock();
+  m_GeometryMutex.Lock();
+  status << ", " << m_Geometries.size() << " cached geometries";
+  m_GeometryMutex.Unlock();
+  rtk::ImageBufferPool::Pointer pool = rtk::ImageBufferPool::GetInstance();
+  status << ", " << pool->GetPooledBytes() / (1024*1024) << " MB of pooled buffers ("
+         << 100. * pool->GetReuseRate() << "% reused)";
+  return status.str();
+}
+
+GeometryType::Pointer
+ReconstructionService
+::GetGeometry(const std::string &fileName)
+{
+  const long int modifiedTime = itksys::SystemTools::ModifiedTime( fileName.c_str() );
+
+  m_GeometryMutex.Lock();
+  GeometryCacheType::const_iterator it = m_Geometries.find(fileName);
+  if( it != m_Geometries.end() && it->second.first == modifiedTime )
+    {
+    GeometryType::Pointer geometry = it->second.second;
+    m_GeometryMutex.Unlock();
+    return geometry;
+    }
+  m_GeometryMutex.Unlock();
+
+  rtk::ThreeDCircularProjectionGeometryXMLFileReader::Pointer geometryReader;
+  geometryReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
+  geometryReader->SetFilename(fileName);
+  geometryReader->GenerateOutputInformation();
+  GeometryType::Pointer geometry = geometryReader->GetOutputObject();
+
+  m_GeometryMutex.Lock();
+  m_Geometries[fileName] = std::make_pair(modifiedTime, geometry);
+  m_GeometryMutex.Unlock();
+  return geometry;
+}
+
+ITK_THREAD_RETURN_TYPE
+ReconstructionService
+::WorkerCallback(void *arg)
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  WorkerType *worker = static_cast<WorkerType *>( static_cast<ThreadInfoType *>(arg)->UserData );
+
+  JobType job;
+  while( worker->Service->Pop(job) )
+    worker->Service->RunJob(*worker, job);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void
+ReconstructionService
+::RunJob(WorkerType &worker, const JobType &job)
+{
+  if(m_Verbose)
+    std::cout << "Job " << job.Id << " started: " << job.Arguments[0] << std::endl;
+
+  itk::TimeProbe probe;
+  probe.Start();
+  std::string error;
+  try
+    {
+    if(job.Arguments[0] == "rtkfdk")
+      {
+      args_info_rtkfdk args_info;
+      m_ParserMutex.Lock();
+      const bool parsed = ParseJobOptions(job.Arguments, args_info,
+                                          cmdline_parser_rtkfdk_params_init,
+                                          cmdline_parser_rtkfdk_ext,
+                                          cmdline_parser_rtkfdk_config_file,
+                                          cmdline_parser_rtkfdk_free);
+      m_ParserMutex.Unlock();
+      if(parsed)
+        {
+        JobOptionsManager< args_info_rtkfdk > manager(args_info, cmdline_parser_rtkfdk_free);
+        this->RunFDK(worker, args_info);
+        }
+      else
+        error = "invalid options";
+      }
+    else if(job.Arguments[0] == "rtkconjugategradient")
+      {
+      args_info_rtkconjugategradient args_info;
+      m_ParserMutex.Lock();
+      const bool parsed = ParseJobOptions(job.Arguments, args_info,
+                                          cmdline_parser_rtkconjugategradient_params_init,
+                                          cmdline_parser_rtkconjugategradient_ext,
+                                          cmdline_parser_rtkconjugategradient_config_file,
+                                          cmdline_parser_rtkconjugategradient_free);
+      m_ParserMutex.Unlock();
+      if(parsed)
+        {
+        JobOptionsManager< args_info_rtkconjugategradient >
+           manager(args_info, cmdline_parser_rtkconjugategradient_free);
+        this->RunConjugateGradient(args_info);
+        }
+      else
+        error = "invalid options";
+      }
+    else
+      error = "unknown application " + job.Arguments[0];
+    }
+  catch( itk::ExceptionObject & err )
+    {
+    error = err.GetDescription();
+    }
+  catch( std::exception & err )
+    {
+    error = err.what();
+    }
+  probe.Stop();
+
+  m_Mutex.Lock();
+  m_NumberOfRunningJobs--;
+  if( error.empty() )
+    m_NumberOfCompletedJobs++;
+  else
+    m_NumberOfFailedJobs++;
+  m_Mutex.Unlock();
+
+  std::ostringstream reply;
+  if( error.empty() )
+    reply << "DONE " << probe.GetTotal() << ' ' << probe.GetUnit();
+  else
+    {
+    std::replace(error.begin(), error.end(), '\n', ' ');
+    reply << "FAILED " << error;
+    }
+  if(m_Verbose)
+    std::cout << "Job " << job.Id << ": " << reply.str() << std::endl;
+  WriteLine(job.Socket, reply.str());
+  close(job.Socket);
+}
+
+void
+ReconstructionService
+::RunFDK(WorkerType &worker, const args_info_rtkfdk &args_info)
+{
+  if( strcmp(args_info.hardware_arg, "cpu") )
+    itkGenericExceptionMacro(<< "Only the cpu hardware is supported by rtkreconstructiond");
+
+  // Reader, weighting, volume source and writer shared with rtkfdk, with
+  // the geometry of the cache
+  typedef rtk::FDKPipelineFromGgo< OutputImageType > PipelineType;
+  PipelineType pipeline(args_info, this->GetGeometry(args_info.geometry_arg));
+  pipeline.ReadProjectionsFromGgo(args_info);
+
+  // FDK filter of the worker, a new one for motion-compensated jobs since
+  // their back projection filter is replaced
+  const bool motionCompensation = args_info.signal_given && args_info.dvf_given;
+  FDKType::Pointer feldkamp;
+  if(!motionCompensation)
+    feldkamp = worker.Feldkamp[ args_info.fused_flag ];
+  if( feldkamp.IsNull() )
+    {
+    feldkamp = FDKType::New();
+    if(!motionCompensation)
+      worker.Feldkamp[ args_info.fused_flag ] = feldkamp;
+    }
+
+  // Options of the job, all set since the filter may come from a previous
+  // job. The block size may have been tuned by the previous job.
+  pipeline.SetFDKFromGgo(feldkamp.GetPointer(), args_info);
+  feldkamp->SetBackProjectionBlockSize(0);
+
+  pipeline.CreateWriterFromGgo(feldkamp->GetOutput(), args_info)->Update();
+
+  if(args_info.verbose_flag)
+    feldkamp->PrintTiming(std::cout);
+
+  // The filters of the worker keep references to their last inputs and
+  // outputs, their buffers are given back to rtk::ImageBufferPool for the
+  // next jobs
+  pipeline.GetReader()->GetOutput()->ReleaseData();
+  pipeline.GetPSSF()->GetOutput()->ReleaseData();
+  feldkamp->GetWeightFilter()->GetOutput()->ReleaseData();
+  feldkamp->GetRampFilter()->GetOutput()->ReleaseData();
+  feldkamp->GetBackProjectionFilter()->GetOutput()->ReleaseData();
+  feldkamp->GetOutput()->ReleaseData();
+}
+
+void
+ReconstructionService
+::RunConjugateGradient(const args_info_rtkconjugategradient &args_info)
+{
+  // Projections reader
+  typedef rtk::ProjectionsReader< OutputImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtkconjugategradient>(reader, args_info);
+
+  // Geometry
+  GeometryType::Pointer geometry = this->GetGeometry(args_info.geometry_arg);
+
+  // Input volume, see rtkconjugategradient
+  itk::ImageSource< OutputImageType >::Pointer inputFilter;
+  if(args_info.input_given)
+    {
+    typedef itk::ImageFileReader<  OutputImageType > InputReaderType;
+    InputReaderType::Pointer inputReader = InputReaderType::New();
+    inputReader->SetFileName( args_info.input_arg );
+    inputFilter = inputReader;
+    }
+  else
+    {
+    typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+    ConstantImageSourceType::Pointer constantImageSource = ConstantImageSourceType::New();
+    rtk::SetConstantImageSourceFromGgo<ConstantImageSourceType, args_info_rtkconjugategradient>(constantImageSource, args_info);
+    inputFilter = constantImageSource;
+    }
+
+  // Weights
+  itk::ImageSource< OutputImageType >::Pointer weightsSource;
+  if(args_info.weights_given)
+    {
+    typedef itk::ImageFileReader<  OutputImageType > WeightsReaderType;
+    WeightsReaderType::Pointer weightsReader = WeightsReaderType::New();
+    weightsReader->SetFileName( args_info.weights_arg );
+    weightsSource = weightsReader;
+    }
+  else
+    {
+    typedef rtk::ConstantImageSource< OutputImageType > ConstantWeightsSourceType;
+    ConstantWeightsSourceType::Pointer constantWeightsSource = ConstantWeightsSourceType::New();
+    reader->UpdateOutputInformation();
+    constantWeightsSource->SetInformationFromImage(reader->GetOutput());
+    constantWeightsSource->SetConstant(1.0);
+    weightsSource = constantWeightsSource;
+    }
+
+  typedef rtk::ConjugateGradientConeBeamReconstructionFilter<OutputImageType> ConjugateGradientFilterType;
+  ConjugateGradientFilterType::Pointer conjugategradient = ConjugateGradientFilterType::New();
+  conjugategradient->SetForwardProjectionFilter(args_info.fp_arg);
+  conjugategradient->SetBackProjectionFilter(args_info.bp_arg);
+  conjugategradient->SetInput( inputFilter->GetOutput() );
+  conjugategradient->SetInput(1, reader->GetOutput());
+  conjugategradient->SetInput(2, weightsSource->GetOutput());
+  conjugategradient->SetPreconditioned(args_info.preconditioned_flag);
+  conjugategradient->SetCudaConjugateGradient(!args_info.nocudacg_flag);
+  conjugategradient->SetRampPreconditioned(args_info.ramp_flag);
+  conjugategradient->SetHannCutFrequency(args_info.hann_arg);
+  if (args_info.gamma_given)
+    {
+    conjugategradient->SetRegularized(true);
+    conjugategradient->SetGamma(args_info.gamma_arg);
+    }
+  conjugategradient->SetGeometry( geometry );
+  conjugategradient->SetNumberOfIterations( args_info.niterations_arg );
+  conjugategradient->SetTolerance( args_info.tolerance_arg );
+
+  typedef rtk::VerboseIterationCommand<ConjugateGradientFilterType> VerboseIterationCommandType;
+  if(args_info.verbose_flag)
+    conjugategradient->AddObserver(itk::IterationEvent(), VerboseIterationCommandType::New());
+
+  typedef itk::ImageFileWriter< OutputImageType > WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( args_info.output_arg );
+  writer->SetInput( conjugategradient->GetOutput() );
+  writer->Update();
+
+  if(args_info.time_flag)
+    rtk::ImageBufferPool::GetInstance()->Report(std::cout);
+}
+
+//--------------------------------------------------------------------
+// Client mode: submits a job and prints the answers of the service
+static int SubmitJob(const args_info_rtkreconstructiond &args_info)
+{
+  if(!args_info.inputs_num)
+    {
+    std::cerr << "No job given, e.g., rtkreconstructiond --submit -- rtkfdk -p . -r .*.his -g geometry.xml -o fdk.mha" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  sockaddr_un address;
+  if( !MakeSocketAddress(args_info.socket_arg, address) )
+    {
+    std::cerr << "Socket file name too long: " << args_info.socket_arg << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A service which has just been started may not listen yet, the
+  // connection is retried for 10 s
+  int fd = -1;
+  for(unsigned int attempt=0; fd<0; attempt++)
+    {
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd<0)
+      break;
+    if( connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0 )
+      break;
+    const int error = errno;
+    close(fd);
+    fd = -1;
+    errno = error;
+    if( attempt==100 || (error!=ENOENT && error!=ECONNREFUSED) )
+      break;
+    usleep(100000);
+    }
+  if(fd<0)
+    {
+    std::cerr << "Could not connect to " << args_info.socket_arg << ": " << strerror(errno) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string line = QuoteArgument( itksys::SystemTools::GetCurrentWorkingDirectory() );
+  for(unsigned int i=0; i<args_info.inputs_num; i++)
+    line += ' ' + QuoteArgument(args_info.inputs[i]);
+  WriteLine(fd, line);
+
+  bool done = false;
+  std::string reply;
+  while( ReadLine(fd, reply) )
+    {
+    std::cout << reply << std::endl;
+    done = (reply.compare(0, 4, "DONE") == 0);
+    }
+  close(fd);
+  return (done)?EXIT_SUCCESS:EXIT_FAILURE;
+}
+
+//--------------------------------------------------------------------
+// Service mode
+
+/** Connection of a client which has not sent its complete job line yet */
+struct ConnectionType
+{
+  int         Socket;
+  std::string Buffer;
+  time_t      Start;
+};
+
+/** Longest accepted job line */
+static const std::string::size_type maximumRequestSize = 1<<20;
+
+/** Answers the status and shutdown requests or queues the job of a line */
+static void HandleRequest(ReconstructionService &service, int fd, std::string line)
+{
+  if( !line.empty() && line[line.size()-1]=='\r' )
+    line.erase(line.size()-1);
+
+  ReconstructionService::JobType job;
+  job.Socket = fd;
+  if( !SplitArguments(line, job.Arguments) || job.Arguments.empty() )
+    {
+    WriteLine(fd, "FAILED invalid job");
+    close(fd);
+    return;
+    }
+
+  // Optional working directory of the client
+  std::string workingDirectory = itksys::SystemTools::GetCurrentWorkingDirectory();
+  if(job.Arguments[0][0] == '/')
+    {
+    workingDirectory = job.Arguments[0];
+    job.Arguments.erase( job.Arguments.begin() );
+    }
+
+  if( job.Arguments.empty() )
+    {
+    WriteLine(fd, "FAILED invalid job");
+    close(fd);
+    }
+  else if(job.Arguments[0] == "status")
+    {
+    WriteLine(fd, "DONE " + service.GetStatus());
+    close(fd);
+    }
+  else if(job.Arguments[0] == "shutdown")
+    {
+    WriteLine(fd, "DONE shutting down after the queued jobs");
+    close(fd);
+    stopRequested = 1;
+    }
+  else
+    {
+    // The socket belongs to the worker once the job is queued
+    MakeAbsolutePaths(job.Arguments, workingDirectory);
+    WriteLine(fd, "QUEUED");
+    service.Push(job);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+  GGO(rtkreconstructiond, args_info);
+
+  if(args_info.submit_flag)
+    return SubmitJob(args_info);
+
+  // Threads: each job runs on its own thread which executes tasks of
+  // rtk::ThreadPool, the other processors are the workers of the pool shared
+  // by all jobs
+  const unsigned int numberOfJobs = std::max(1, args_info.jobs_arg);
+  unsigned int threadsPerJob = std::max(1U, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() / numberOfJobs);
+  if(args_info.threads_given)
+    threadsPerJob = std::max(1, args_info.threads_arg);
+  itk::MultiThreader::SetGlobalDefaultNumberOfThreads(threadsPerJob);
+  rtk::ThreadPool::GetInstance()->SetNumberOfWorkers( numberOfJobs * (threadsPerJob-1) );
+
+  // Image buffers are kept between jobs unless RTK_BUFFER_POOL is 0
+  std::string bufferPool;
+  if( !itksys::SystemTools::GetEnv("RTK_BUFFER_POOL", bufferPool) || bufferPool != "0" )
+    rtk::ImageBufferPool::GetInstance()->SetEnabled(true);
+
+  // Local socket, only accessible to the user of the service. A socket left
+  // by a previous service is removed but no other file.
+  sockaddr_un address;
+  if( !MakeSocketAddress(args_info.socket_arg, address) )
+    {
+    std::cerr << "Socket file name too long: " << args_info.socket_arg << std::endl;
+    return EXIT_FAILURE;
+    }
+  struct stat socketStat;
+  if( stat(args_info.socket_arg, &socketStat) == 0 )
+    {
+    if( !S_ISSOCK(socketStat.st_mode) )
+      {
+      std::cerr << args_info.socket_arg << " exists and is not a socket" << std::endl;
+      return EXIT_FAILURE;
+      }
+    unlink(args_info.socket_arg);
+    }
+  // The socket file is created by bind with the permissions of the umask,
+  // restricted to the user before bind so that no other user can connect
+  // between bind and chmod
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  const mode_t previousMask = umask(077);
+  const bool bound = listener>=0 && bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+  umask(previousMask);
+  if( !bound ||
+      chmod(args_info.socket_arg, S_IRUSR | S_IWUSR) < 0 ||
+      listen(listener, 64) < 0 )
+    {
+    std::cerr << "Could not listen on " << args_info.socket_arg << ": " << strerror(errno) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Stop on SIGINT and SIGTERM after the completion of the queued jobs.
+  // Clients which disconnect must not kill the service.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = StopHandler;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  ReconstructionService service(numberOfJobs, args_info.verbose_flag);
+  if(args_info.verbose_flag)
+    std::cout << "Listening on " << args_info.socket_arg << " with "
+              << numberOfJobs << " concurrent job(s) of "
+              << threadsPerJob << " thread(s)..." << std::endl;
+
+  // The listener and the connections which have not sent their job line yet
+  // are polled so that a slow client does not block the others
+  std::vector<ConnectionType> connections;
+  while(!stopRequested)
+    {
+    std::vector<pollfd> fds(connections.size()+1);
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+    for(size_t i=0; i<connections.size(); i++)
+      {
+      fds[i+1].fd = connections[i].Socket;
+      fds[i+1].events = POLLIN;
+      }
+    if( poll(&fds[0], fds.size(), 1000) < 0 )
+      {
+      if(errno == EINTR)
+        continue;
+      std::cerr << "Could not poll the connections: " << strerror(errno) << std::endl;
+      break;
+      }
+
+    // Read what is available on each connection, the job is handled once its
+    // line is complete. A client which does not send its job within 10 s is
+    // disconnected.
+    const time_t now = time(NULL);
+    std::vector<ConnectionType> pendingConnections;
+    for(size_t i=0; i<connections.size(); i++)
+      {
+      ConnectionType &connection = connections[i];
+      bool closed = false;
+      if(fds[i+1].revents)
+        {
+        char buffer[4096];
+        const ssize_t n = read(connection.Socket, buffer, sizeof(buffer));
+        if(n>0)
+          connection.Buffer.append(buffer, n);
+        else if(n==0 || errno!=EINTR)
+          closed = true;
+        }
+      const std::string::size_type endOfLine = connection.Buffer.find('\n');
+      if(endOfLine != std::string::npos)
+        HandleRequest(service, connection.Socket, connection.Buffer.substr(0, endOfLine));
+      else if(closed && !connection.Buffer.empty())
+        HandleRequest(service, connection.Socket, connection.Buffer);
+      else if(closed || now-connection.Start > 10 || connection.Buffer.size() > maximumRequestSize)
+        {
+        WriteLine(connection.Socket, "FAILED invalid job");
+        close(connection.Socket);
+        }
+      else
+        pendingConnections.push_back(connection);
+      }
+    connections.swap(pendingConnections);
+
+    if(fds[0].revents & POLLIN)
+      {
+      ConnectionType connection;
+      connection.Socket = accept(listener, NULL, NULL);
+      connection.Start = now;
+      if(connection.Socket>=0)
+        connections.push_back(connection);
+      else if(errno != EINTR)
+        {
+        std::cerr << "Could not accept a connection: " << strerror(errno) << std::endl;
+        break;
+        }
+      }
+    }
+
+  for(size_t i=0; i<connections.size(); i++)
+    close(connections[i].Socket);
+  close(listener);
+  unlink(args_info.socket_arg);
+  service.Stop();
+
+  return EXIT_SUCCESS;
+}
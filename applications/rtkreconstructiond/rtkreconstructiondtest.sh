@@ -0,0 +1,13 @@
+#!/bin/sh
+# Starts rtkreconstructiond in the background, submits an rtkfdk job of the
+# projections of rtkappprojectshepploganphantomtest and shuts the service
+# down. The only argument is the directory of the RTK executables.
+service="$1/rtkreconstructiond"
+socket=rtkappreconstructiondtest.sock
+
+"$service" -s $socket &
+"$service" --submit -s $socket -- rtkfdk -g geo -p . -r sheppy.mha -o fdk_service.mha
+status=$?
+"$service" --submit -s $socket -- shutdown
+wait
+exit $status
@@ -18,11 +18,14 @@
 
 #include "rtksart_ggo.h"
 #include "rtkGgoFunctions.h"
+#include "rtkImageBufferPool.h"
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkProjectionsCacheImageFilter.h"
 #include "rtkSARTConeBeamReconstructionFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
 #include "rtkPhaseGatingImageFilter.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "itkCudaImage.h"
@@ -34,6 +37,10 @@ int main(int argc, char * argv[])
 {
   GGO(rtksart, args_info);
 
+  // Reuse the image buffers between iterations
+  if(args_info.bufferpool_flag)
+    rtk::ImageBufferPool::GetInstance()->SetEnabled(true);
+
   typedef float OutputPixelType;
   const unsigned int Dimension = 3;
 
@@ -48,6 +55,15 @@ int main(int argc, char * argv[])
   ReaderType::Pointer reader = ReaderType::New();
   rtk::SetProjectionsReaderFromGgo<ReaderType, args_info_rtksart>(reader, args_info);
 
+  // Optional cache, projections are then read on demand
+  typedef rtk::ProjectionsCacheImageFilter< OutputImageType > CacheType;
+  CacheType::Pointer cache = CacheType::New();
+  cache->SetInput( reader->GetOutput() );
+  cache->SetCacheSize( args_info.cache_arg );
+  itk::ImageSource< OutputImageType >::Pointer projectionsSource = reader.GetPointer();
+  if(args_info.cache_arg>0)
+    projectionsSource = cache.GetPointer();
+
   // Geometry
   if(args_info.verbose_flag)
     std::cout << "Reading geometry information from "
@@ -68,7 +84,7 @@ int main(int argc, char * argv[])
     phaseGating->SetGatingWindowWidth(args_info.windowwidth_arg);
     phaseGating->SetGatingWindowCenter(args_info.windowcenter_arg);
     phaseGating->SetGatingWindowShape(args_info.windowshape_arg);
-    phaseGating->SetInputProjectionStack(reader->GetOutput());
+    phaseGating->SetInputProjectionStack(projectionsSource->GetOutput());
     phaseGating->SetInputGeometry(geometryReader->GetOutputObject());
     phaseGating->Update();
     }
@@ -92,28 +108,54 @@ int main(int argc, char * argv[])
     inputFilter = constantImageSource;
     }
 
-  // SART reconstruction filter
-  rtk::SARTConeBeamReconstructionFilter< OutputImageType >::Pointer sart =
-      rtk::SARTConeBeamReconstructionFilter< OutputImageType >::New();
-
-  // Set the forward and back projection filters
-  sart->SetForwardProjectionFilter(args_info.fp_arg);
-  sart->SetBackProjectionFilter(args_info.bp_arg);
-  sart->SetInput( inputFilter->GetOutput() );
-  if (args_info.signal_given)
+  // Shrink factors of the multi-resolution levels, the last one being the
+  // full resolution
+  std::vector<unsigned int> shrinkFactors;
+  for(unsigned int i=0; i<args_info.multires_given; i++)
+    shrinkFactors.push_back(args_info.multires_arg[i]);
+  shrinkFactors.push_back(1);
+
+  // SART reconstruction filter of each level
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  SARTType::Pointer sart;
+  for(unsigned int level=0; level<shrinkFactors.size(); level++)
     {
-    sart->SetInput(1, phaseGating->GetOutput());
-    sart->SetGeometry( phaseGating->GetOutputGeometry() );
-    sart->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+    sart = SARTType::New();
+
+    // Set the forward and back projection filters
+    sart->SetForwardProjectionFilter(args_info.fp_arg);
+    sart->SetBackProjectionFilter(args_info.bp_arg);
+    if (args_info.signal_given)
+      {
+      sart->SetGeometry( phaseGating->GetOutputGeometry() );
+      sart->SetGatingWeights( phaseGating->GetGatingWeightsOnSelectedProjections() );
+      }
+    else
+      sart->SetGeometry( geometryReader->GetOutputObject() );
+    if(level+1<shrinkFactors.size())
+      sart->SetNumberOfIterations( args_info.multiresniter_arg );
+    else
+      sart->SetNumberOfIterations( args_info.niterations_arg );
+    sart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
+    sart->SetLambda( args_info.lambda_arg );
+    if(args_info.positivity_flag)
+      {
+      sart->SetEnforcePositivity(true);
+      }
+    multires->AddLevel(shrinkFactors[level], sart);
     }
+
+  // Without coarse level, the full resolution filter is used directly
+  itk::ImageToImageFilter< OutputImageType, OutputImageType >::Pointer reconstruction = sart.GetPointer();
+  if(args_info.multires_given)
+    reconstruction = multires.GetPointer();
+  reconstruction->SetInput( inputFilter->GetOutput() );
+  if (args_info.signal_given)
+    reconstruction->SetInput(1, phaseGating->GetOutput());
   else
-    {
-    sart->SetInput(1, reader->GetOutput());
-    sart->SetGeometry( geometryReader->GetOutputObject() );
-    }
-  sart->SetNumberOfIterations( args_info.niterations_arg );
-  sart->SetNumberOfProjectionsPerSubset( args_info.nprojpersubset_arg );
-  sart->SetLambda( args_info.lambda_arg );
+    reconstruction->SetInput(1, projectionsSource->GetOutput());
 
   itk::TimeProbe totalTimeProbe;
   if(args_info.time_flag)
@@ -121,16 +163,15 @@ int main(int argc, char * argv[])
     std::cout << "Recording elapsed time... " << std::endl << std::flush;
     totalTimeProbe.Start();
     }
-  if(args_info.positivity_flag)
-    {
-    sart->SetEnforcePositivity(true);
-    }
 
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() )
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( reconstruction->Update() )
 
   if(args_info.time_flag)
     {
     sart->PrintTiming(std::cout);
+    if(args_info.cache_arg>0)
+      std::cout << "Projections cache hit rate: " << 100.*cache->GetHitRate() << '%' << std::endl;
+    rtk::ImageBufferPool::GetInstance()->Report(std::cout);
     totalTimeProbe.Stop();
     std::cout << "It took...  " << totalTimeProbe.GetMean() << ' ' << totalTimeProbe.GetUnit() << std::endl;
     }
@@ -139,7 +180,7 @@ int main(int argc, char * argv[])
   typedef itk::ImageFileWriter< OutputImageType > WriterType;
   WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( args_info.output_arg );
-  writer->SetInput( sart->GetOutput() );
+  writer->SetInput( reconstruction->GetOutput() );
   TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
 
   return EXIT_SUCCESS;
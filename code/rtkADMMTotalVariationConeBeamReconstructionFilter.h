@@ -32,6 +32,8 @@
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
 #include "rtkMultiplyByVectorImageFilter.h"
+#include "rtkFusedArithmeticImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -78,8 +80,7 @@ namespace rtk
    * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
    * AddGradient [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
    * Divergence [ label="rtk::BackwardDifferenceDivergenceImageFilter" URL="\ref rtk::BackwardDifferenceDivergenceImageFilter"];
-   * Multiply [ label="itk::MultiplyImageFilter (by beta)" URL="\ref itk::MultiplyImageFilter"];
-   * SubtractVolume [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
+   * RightHandSide [ label="rtk::FusedArithmeticImageFilter" URL="\ref rtk::FusedArithmeticImageFilter"];
    * ConjugateGradient[ label="rtk::ConjugateGradientImageFilter" URL="\ref rtk::ConjugateGradientImageFilter"];
    * AfterConjugateGradient [label="", fixedsize="false", width=0, height=0, shape=none];
    * GradientTwo [ label="rtk::ForwardDifferenceGradientImageFilter" URL="\ref rtk::ForwardDifferenceGradientImageFilter"];
@@ -103,10 +104,9 @@ namespace rtk
    * AfterZeroMultiplyGradient -> AddGradient;
    * AfterZeroMultiplyGradient -> Subtract;
    * AddGradient -> Divergence [label="g_0 + d_0"];
-   * Divergence -> Multiply [label="-nabla_t(g_0 + d_0)"];
-   * Multiply -> SubtractVolume [label="-beta *nabla_t(g_0 + d_0)"];
-   * BackProjection -> SubtractVolume [label="R_t p"];
-   * SubtractVolume -> ConjugateGradient [label="b"];
+   * Divergence -> RightHandSide [label="-nabla_t(g_0 + d_0)"];
+   * BackProjection -> RightHandSide [label="R_t p"];
+   * RightHandSide -> ConjugateGradient [label="b = R_t p - beta * nabla_t(g_0 + d_0)"];
    * ConjugateGradient -> AfterConjugateGradient [label="f_k+1"];
    * AfterConjugateGradient -> GradientTwo;
    * GradientTwo -> Subtract [label="nabla(f_k+1)"];
@@ -159,7 +159,7 @@ public:
         <TGradientOutputImage, TOutputImage>                                    ImageDivergenceFilterType;
     typedef rtk::SoftThresholdTVImageFilter
         <TGradientOutputImage>                                                  SoftThresholdTVFilterType;
-    typedef itk::SubtractImageFilter<TOutputImage>                              SubtractVolumeFilterType;
+    typedef rtk::FusedArithmeticImageFilter<TOutputImage>                       RightHandSideFilterType;
     typedef itk::AddImageFilter<TGradientOutputImage>                           AddGradientsFilterType;
     typedef itk::MultiplyImageFilter<TOutputImage>                              MultiplyVolumeFilterType;
     typedef itk::MultiplyImageFilter<TGradientOutputImage>                      MultiplyGradientFilterType;
@@ -195,6 +195,16 @@ public:
     itkSetMacro(CG_iterations, float)
     itkGetMacro(CG_iterations, float)
 
+    /** Relative residual norm at which each conjugate gradient stops, see
+     * rtk::ConjugateGradientImageFilter. Default is 0 (disabled). */
+    itkSetMacro(CG_Tolerance, double)
+    itkGetMacro(CG_Tolerance, double)
+
+    /** Convergence of the current conjugate gradient, updated before each
+     * itk::IterationEvent invoked by this filter. */
+    const std::vector<double> & GetResidualNorms() const {return m_ConjugateGradientFilter->GetResidualNorms();}
+    const std::vector<double> & GetElapsedTimes() const {return m_ConjugateGradientFilter->GetElapsedTimes();}
+
     void PrintTiming(std::ostream& os) const;
 
 protected:
@@ -207,12 +217,11 @@ protected:
     /** Member pointers to the filters used internally (for convenience)*/
     typename SubtractGradientsFilterType::Pointer                               m_SubtractFilter1;
     typename SubtractGradientsFilterType::Pointer                               m_SubtractFilter2;
-    typename MultiplyVolumeFilterType::Pointer                                  m_MultiplyFilter;
     typename MultiplyVolumeFilterType::Pointer                                  m_ZeroMultiplyVolumeFilter;
     typename MultiplyGradientFilterType::Pointer                                m_ZeroMultiplyGradientFilter;
     typename ImageGradientFilterType::Pointer                                   m_GradientFilter1; 
     typename ImageGradientFilterType::Pointer                                   m_GradientFilter2;
-    typename SubtractVolumeFilterType::Pointer                                  m_SubtractVolumeFilter;
+    typename RightHandSideFilterType::Pointer                                   m_RightHandSideFilter;
     typename AddGradientsFilterType::Pointer                                    m_AddGradientsFilter;
     typename ImageDivergenceFilterType::Pointer                                 m_DivergenceFilter;
     typename ConjugateGradientFilterType::Pointer                               m_ConjugateGradientFilter;
@@ -229,6 +238,10 @@ protected:
     * must be removed */
     void VerifyInputInformation(){}
 
+    /** Invokes the itk::IterationEvent of the conjugate gradient filter */
+    void ForwardIterationEvent() {this->InvokeEvent( itk::IterationEvent() );}
+    typename itk::SimpleMemberCommand<Self>::Pointer m_IterationCommand;
+
     /** The volume and the projections must have different requested regions
     */
     void GenerateInputRequestedRegion();
@@ -247,6 +260,7 @@ private:
     float           m_Beta;
     unsigned int    m_AL_iterations;
     unsigned int    m_CG_iterations;
+    double          m_CG_Tolerance;
 
     ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 
@@ -35,6 +35,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_Beta=1;
   m_AL_iterations=10;
   m_CG_iterations=3;
+  m_CG_Tolerance=0.;
   m_IsGated=false;
 
   // Create the filters
@@ -42,16 +43,18 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_ZeroMultiplyGradientFilter = MultiplyGradientFilterType::New();
   m_SubtractFilter1 = SubtractGradientsFilterType::New();
   m_SubtractFilter2 = SubtractGradientsFilterType::New();
-  m_MultiplyFilter = MultiplyVolumeFilterType::New();
   m_GradientFilter1 = ImageGradientFilterType::New();
   m_GradientFilter2 = ImageGradientFilterType::New();
-  m_SubtractVolumeFilter = SubtractVolumeFilterType::New();
+  m_RightHandSideFilter = RightHandSideFilterType::New();
   m_AddGradientsFilter = AddGradientsFilterType::New();
   m_DivergenceFilter = ImageDivergenceFilterType::New();
   m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
   m_SoftThresholdFilter = SoftThresholdTVFilterType::New();
   m_CGOperator = CGOperatorFilterType::New();
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
+  m_IterationCommand = itk::SimpleMemberCommand<Self>::New();
+  m_IterationCommand->SetCallbackFunction(this, &Self::ForwardIterationEvent);
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), m_IterationCommand);
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
   m_GatingWeightsFilter = GatingWeightsFilterType::New();
 
@@ -60,9 +63,8 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_AddGradientsFilter->SetInput1(m_ZeroMultiplyGradientFilter->GetOutput());
   m_AddGradientsFilter->SetInput2(m_GradientFilter1->GetOutput());
   m_DivergenceFilter->SetInput(m_AddGradientsFilter->GetOutput());
-  m_MultiplyFilter->SetInput1( m_DivergenceFilter->GetOutput() );
-  m_SubtractVolumeFilter->SetInput2(m_MultiplyFilter->GetOutput());
-  m_ConjugateGradientFilter->SetB(m_SubtractVolumeFilter->GetOutput());
+  m_RightHandSideFilter->SetInput(1, m_DivergenceFilter->GetOutput() );
+  m_ConjugateGradientFilter->SetB(m_RightHandSideFilter->GetOutput());
   m_ConjugateGradientFilter->SetNumberOfIterations(m_CG_iterations);
   m_GradientFilter2->SetInput(m_ConjugateGradientFilter->GetOutput());
   m_SubtractFilter1->SetInput1(m_GradientFilter2->GetOutput());
@@ -82,8 +84,8 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_GradientFilter1->ReleaseDataFlagOn();
   m_AddGradientsFilter->ReleaseDataFlagOn();
   m_DivergenceFilter->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
-  m_SubtractVolumeFilter->ReleaseDataFlagOn();
+  m_RightHandSideFilter->ReleaseDataFlagOn();
+  m_RightHandSideFilter->InPlaceOff(); // The back projection is computed once
   m_ConjugateGradientFilter->ReleaseDataFlagOff(); // Output is f_k+1
   m_GradientFilter2->ReleaseDataFlagOn();
   m_SubtractFilter1->ReleaseDataFlagOff(); // Output used in two filters
@@ -128,7 +130,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
 
   m_CGOperator->SetBeta(currentBeta);
   m_SoftThresholdFilter->SetThreshold(m_Alpha/(2 * currentBeta));
-  m_MultiplyFilter->SetConstant2( (const float) currentBeta);
+  m_RightHandSideFilter->SetADMMTotalVariationRightHandSide(currentBeta);
 }
 
 template< typename TOutputImage, typename TGradientOutputImage>
@@ -172,7 +174,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   m_ZeroMultiplyVolumeFilter->SetInput1(this->GetInput(0));
   m_CGOperator->SetInput(1, this->GetInput(1));
   m_ConjugateGradientFilter->SetX(this->GetInput(0));
-  m_MultiplyFilter->SetConstant2( m_Beta );
+  m_RightHandSideFilter->SetADMMTotalVariationRightHandSide(m_Beta);
   if (m_IsGated)
     {
     // Insert the gating filter into the pipeline
@@ -192,7 +194,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
   // in the constructor, as m_BackProjectionFilter is set at runtime
   m_BackProjectionFilter->SetInput(0, m_ZeroMultiplyVolumeFilter->GetOutput());
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput());
-  m_SubtractVolumeFilter->SetInput1(m_BackProjectionFilter->GetOutput());
+  m_RightHandSideFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
 
   // For the same reason, set geometry now
   m_CGOperator->SetGeometry(this->m_Geometry);
@@ -201,6 +203,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
 
   // Set runtime parameters
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_CG_iterations);
+  m_ConjugateGradientFilter->SetTolerance(this->m_CG_Tolerance);
 
   // Have the last filter calculate its output information
   m_SubtractFilter2->UpdateOutputInformation();
@@ -216,6 +219,8 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
 {
   for(unsigned int iter=0; iter < m_AL_iterations; iter++)
     {
+    TraceSpan iterationSpan("ADMM TV iteration", this, iter);
+
     SetBetaForCurrentIteration(iter);
 
     // After the first update, we need to use some outputs as inputs
@@ -240,7 +245,7 @@ ADMMTotalVariationConeBeamReconstructionFilter<TOutputImage, TGradientOutputImag
       }
 
     m_BeforeConjugateGradientProbe.Start();
-    m_SubtractVolumeFilter->Update();
+    m_RightHandSideFilter->Update();
     m_BeforeConjugateGradientProbe.Stop();
 
     m_ConjugateGradientProbe.Start();
@@ -20,7 +20,6 @@
 #define __rtkADMMWaveletsConeBeamReconstructionFilter_h
 
 #include <itkImageToImageFilter.h>
-#include <itkAddImageFilter.h>
 #include <itkSubtractImageFilter.h>
 #include <itkMultiplyImageFilter.h>
 #include <itkTimeProbe.h>
@@ -31,6 +30,8 @@
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkFusedArithmeticImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -90,9 +91,7 @@ namespace rtk
    * D [label="", fixedsize="false", width=0, height=0, shape=none];
    * G [label="", fixedsize="false", width=0, height=0, shape=none];
    * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
-   * Add [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
-   * Multiply [ label="itk::MultiplyImageFilter (by beta)" URL="\ref itk::MultiplyImageFilter"];
-   * AddTwo [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
+   * RightHandSide [ label="rtk::FusedArithmeticImageFilter" URL="\ref rtk::FusedArithmeticImageFilter"];
    * ConjugateGradient[ label="rtk::ConjugateGradientImageFilter" URL="\ref rtk::ConjugateGradientImageFilter"];
    * AfterConjugateGradient [label="", fixedsize="false", width=0, height=0, shape=none];
    * Subtract [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
@@ -111,13 +110,11 @@ namespace rtk
    * Displaced -> BackProjection;
    * AfterZeroMultiply -> D [label="d'_0"];
    * AfterZeroMultiply -> BackProjection;
-   * D -> Add;
-   * G -> Add;
+   * D -> RightHandSide;
+   * G -> RightHandSide;
    * D -> Subtract;
-   * Add -> Multiply [label="d'_k + g'_k"];
-   * Multiply -> AddTwo [label="beta (d'_k + g'_k)"];
-   * BackProjection -> AddTwo;
-   * AddTwo -> ConjugateGradient [label="b"];
+   * BackProjection -> RightHandSide;
+   * RightHandSide -> ConjugateGradient [label="b = R_t p + beta (d'_k + g'_k)"];
    * ConjugateGradient -> AfterConjugateGradient [label="f_k+1"];
    * AfterConjugateGradient -> Subtract;
    * Subtract -> BeforeSoftThreshold [arrowhead=none, label="f_k+1 - d'k"];
@@ -164,7 +161,7 @@ public:
     typedef rtk::BackProjectionImageFilter< TOutputImage, TOutputImage >                  BackProjectionFilterType;
     typedef rtk::ConjugateGradientImageFilter<TOutputImage>                               ConjugateGradientFilterType;
     typedef itk::SubtractImageFilter<TOutputImage>                                        SubtractFilterType;
-    typedef itk::AddImageFilter<TOutputImage>                                             AddFilterType;
+    typedef rtk::FusedArithmeticImageFilter<TOutputImage>                                 RightHandSideFilterType;
     typedef itk::MultiplyImageFilter<TOutputImage>                                        MultiplyFilterType;
     typedef rtk::ADMMWaveletsConjugateGradientOperator<TOutputImage>                      CGOperatorFilterType;
     typedef rtk::DeconstructSoftThresholdReconstructImageFilter<TOutputImage>             SoftThresholdFilterType;
@@ -191,6 +188,16 @@ public:
     itkSetMacro(CG_iterations, float)
     itkGetMacro(CG_iterations, float)
 
+    /** Relative residual norm at which each conjugate gradient stops, see
+     * rtk::ConjugateGradientImageFilter. Default is 0 (disabled). */
+    itkSetMacro(CG_Tolerance, double)
+    itkGetMacro(CG_Tolerance, double)
+
+    /** Convergence of the current conjugate gradient, updated before each
+     * itk::IterationEvent invoked by this filter. */
+    const std::vector<double> & GetResidualNorms() const {return m_ConjugateGradientFilter->GetResidualNorms();}
+    const std::vector<double> & GetElapsedTimes() const {return m_ConjugateGradientFilter->GetElapsedTimes();}
+
     itkSetMacro(Order, unsigned int)
     itkGetMacro(Order, unsigned int)
 
@@ -209,10 +216,8 @@ protected:
     /** Member pointers to the filters used internally (for convenience)*/
     typename SubtractFilterType::Pointer                                        m_SubtractFilter1;
     typename SubtractFilterType::Pointer                                        m_SubtractFilter2;
-    typename MultiplyFilterType::Pointer                                        m_MultiplyFilter;
     typename MultiplyFilterType::Pointer                                        m_ZeroMultiplyFilter;
-    typename AddFilterType::Pointer                                             m_AddFilter1;
-    typename AddFilterType::Pointer                                             m_AddFilter2;
+    typename RightHandSideFilterType::Pointer                                   m_RightHandSideFilter;
     typename ConjugateGradientFilterType::Pointer                               m_ConjugateGradientFilter;
     typename SoftThresholdFilterType::Pointer                                   m_SoftThresholdFilter;
     typename CGOperatorFilterType::Pointer                                      m_CGOperator;
@@ -226,6 +231,10 @@ protected:
     * must be removed */
     void VerifyInputInformation(){}
 
+    /** Invokes the itk::IterationEvent of the conjugate gradient filter */
+    void ForwardIterationEvent() {this->InvokeEvent( itk::IterationEvent() );}
+    typename itk::SimpleMemberCommand<Self>::Pointer m_IterationCommand;
+
     /** The volume and the projections must have different requested regions
     */
     void GenerateInputRequestedRegion();
@@ -239,6 +248,7 @@ private:
     float           m_Beta;
     unsigned int    m_AL_iterations;
     unsigned int    m_CG_iterations;
+    double          m_CG_Tolerance;
     unsigned int    m_Order;
     unsigned int    m_NumberOfLevels;
 
@@ -31,6 +31,7 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
   m_Beta(1),
   m_AL_iterations(10),
   m_CG_iterations(3),
+  m_CG_Tolerance(0.),
   m_Order(3),
   m_NumberOfLevels(5)
 {
@@ -40,20 +41,19 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
   m_ZeroMultiplyFilter = MultiplyFilterType::New();
   m_SubtractFilter1 = SubtractFilterType::New();
   m_SubtractFilter2 = SubtractFilterType::New();
-  m_MultiplyFilter = MultiplyFilterType::New();
-  m_AddFilter1 = AddFilterType::New();
-  m_AddFilter2 = AddFilterType::New();
+  m_RightHandSideFilter = RightHandSideFilterType::New();
   m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
   m_SoftThresholdFilter = SoftThresholdFilterType::New();
   m_CGOperator = CGOperatorFilterType::New();
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
+  m_IterationCommand = itk::SimpleMemberCommand<Self>::New();
+  m_IterationCommand->SetCallbackFunction(this, &Self::ForwardIterationEvent);
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), m_IterationCommand);
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
 
   // Set permanent connections
-  m_AddFilter1->SetInput2(m_ZeroMultiplyFilter->GetOutput());
-  m_MultiplyFilter->SetInput1( m_AddFilter1->GetOutput() );
-  m_AddFilter2->SetInput1(m_MultiplyFilter->GetOutput());
-  m_ConjugateGradientFilter->SetB(m_AddFilter2->GetOutput());
+  m_RightHandSideFilter->SetInput(2, m_ZeroMultiplyFilter->GetOutput());
+  m_ConjugateGradientFilter->SetB(m_RightHandSideFilter->GetOutput());
   m_SubtractFilter1->SetInput1(m_ConjugateGradientFilter->GetOutput());
   m_SubtractFilter1->SetInput2(m_ZeroMultiplyFilter->GetOutput());
   m_SoftThresholdFilter->SetInput(m_SubtractFilter1->GetOutput());
@@ -66,9 +66,8 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
 
   // Set memory management parameters
   m_ZeroMultiplyFilter->ReleaseDataFlagOn();
-  m_AddFilter1->ReleaseDataFlagOn();
-  m_AddFilter2->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
+  m_RightHandSideFilter->ReleaseDataFlagOn();
+  m_RightHandSideFilter->InPlaceOff(); // The back projection is computed once
   m_ConjugateGradientFilter->ReleaseDataFlagOff(); // Output is f_k+1
   m_SubtractFilter1->ReleaseDataFlagOff(); // Output used in two filters
   m_SoftThresholdFilter->ReleaseDataFlagOff(); // Output is g_k+1
@@ -135,15 +134,15 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
   m_CGOperator->SetInput(1, this->GetInput(1)); // The projections (the conjugate gradient operator needs them)
   m_CGOperator->SetBeta(m_Beta);
   m_ConjugateGradientFilter->SetX(this->GetInput(0));
-  m_MultiplyFilter->SetConstant2( m_Beta );
+  m_RightHandSideFilter->SetADMMWaveletsRightHandSide( m_Beta );
   m_DisplacedDetectorFilter->SetInput(this->GetInput(1));
 
   // Links with the m_BackProjectionFilter should be set here and not
   // in the constructor, as m_BackProjectionFilter is set at runtime
   m_BackProjectionFilter->SetInput(0, m_ZeroMultiplyFilter->GetOutput());
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput());
-  m_AddFilter1->SetInput1(this->GetInput(0));
-  m_AddFilter2->SetInput2(m_BackProjectionFilter->GetOutput());
+  m_RightHandSideFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+  m_RightHandSideFilter->SetInput(1, this->GetInput(0));
 
   // For the same reason, set geometry now
   m_CGOperator->SetGeometry(this->m_Geometry);
@@ -152,6 +151,7 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
 
   // Set runtime parameters
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_CG_iterations);
+  m_ConjugateGradientFilter->SetTolerance(this->m_CG_Tolerance);
   m_SoftThresholdFilter->SetNumberOfLevels(this->GetNumberOfLevels());
   m_SoftThresholdFilter->SetOrder(this->GetOrder());
   m_SoftThresholdFilter->SetThreshold(m_Alpha/(2 * m_Beta));
@@ -174,6 +174,8 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
 
   for(unsigned int iter=0; iter < m_AL_iterations; iter++)
     {
+    TraceSpan iterationSpan("ADMM wavelets iteration", this, iter);
+
     // After the first update, we need to use some outputs as inputs
     if(iter>0)
       {
@@ -183,11 +185,11 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
 
       W_t_G_k_plus_one = m_SoftThresholdFilter->GetOutput();
       W_t_G_k_plus_one->DisconnectPipeline();
-      m_AddFilter1->SetInput1(W_t_G_k_plus_one);
+      m_RightHandSideFilter->SetInput(1, W_t_G_k_plus_one);
 
       W_t_D_k_plus_one = m_SubtractFilter2->GetOutput();
       W_t_D_k_plus_one->DisconnectPipeline();
-      m_AddFilter1->SetInput2(W_t_D_k_plus_one);
+      m_RightHandSideFilter->SetInput(2, W_t_D_k_plus_one);
       m_SubtractFilter1->SetInput2(W_t_D_k_plus_one);
 
       // Recreate the links destroyed by DisconnectPipeline
@@ -196,7 +198,7 @@ ADMMWaveletsConeBeamReconstructionFilter<TOutputImage>
       }
 
     m_BeforeConjugateGradientProbe.Start();
-    m_AddFilter2->Update();
+    m_RightHandSideFilter->Update();
     m_BeforeConjugateGradientProbe.Stop();
 
     m_ConjugateGradientProbe.Start();
@@ -24,6 +24,8 @@
 #include <itkInPlaceImageFilter.h>
 #include <itkConceptChecking.h>
 #include "rtkProjectionGeometry.h"
+#include "rtkTraceCollector.h"
+#include "rtkConstantImageSource.h"
 
 namespace rtk
 {
@@ -36,7 +38,15 @@ namespace rtk
  * is voxel-based, meaning that the center of each voxel is projected in the
  * projection images to determine the interpolation location.
  *
- * \test rtkfovtest.cxx
+ * If SkipOutsideFieldOfView is on, the voxels outside the field of view of a
+ * rtk::ThreeDCircularProjectionGeometry, as computed by
+ * rtk::FieldOfViewImageFilter, are not backprojected and keep the value of
+ * input 0. The range of voxels inside the field of view of each line of the
+ * volume is computed once in BeforeThreadedGenerateData and the innermost
+ * loops only go over this range. The ranges are conservative, i.e., a few
+ * voxels outside the field of view may still be backprojected.
+ *
+ * \test rtkfovtest.cxx, rtkfdktest.cxx
  *
  * \author Simon Rit
  *
@@ -75,8 +85,15 @@ public:
   itkGetMacro(Transpose, bool);
   itkSetMacro(Transpose, bool);
 
+  /** Get / Set whether the voxels outside the field of view are skipped.
+   * Default is off. The geometry must then be a
+   * rtk::ThreeDCircularProjectionGeometry. */
+  itkGetMacro(SkipOutsideFieldOfView, bool);
+  itkSetMacro(SkipOutsideFieldOfView, bool);
+  itkBooleanMacro(SkipOutsideFieldOfView);
+
 protected:
-  BackProjectionImageFilter() : m_Geometry(NULL), m_Transpose(false) {
+  BackProjectionImageFilter() : m_Geometry(NULL), m_Transpose(false), m_SkipOutsideFieldOfView(false) {
     this->SetNumberOfRequiredInputs(2); this->SetInPlace( true );
   };
   virtual ~BackProjectionImageFilter() {
@@ -103,6 +120,20 @@ protected:
    * to verify. */
   virtual void VerifyInputInformation() {}
 
+  /** Returns true if input 0 is the output of a rtk::ConstantImageSource, see
+   * ConstantImageSource::IsConstantImage. A single pixel of input 0 is then
+   * requested and the output is initialized with the constant instead of
+   * being computed in place. Filters which read input 0 otherwise than with
+   * InitializeOutputRegion, e.g., on the GPU, must return false. */
+  virtual bool IsInputConstant(InputPixelType &constant) const;
+
+  /** The filter cannot run in place if input 0 is a constant image */
+  virtual bool CanRunInPlace() const;
+
+  /** Initialize the region of the output with input 0 if the filter does not
+   * run in place, or with the constant of input 0 if it is a constant image. */
+  void InitializeOutputRegion(const OutputImageRegionType& region);
+
   /** The input is a stack of projections, we need to interpolate in one projection
       for efficiency during interpolation. Use of itk::ExtractImageFilter is
       not threadsafe in ThreadedGenerateData, this one is. The output can be multiplied by a constant.
@@ -114,6 +145,34 @@ protected:
       instead of the physical point to physical point projection matrix provided by Geometry */
   ProjectionMatrixType GetIndexToIndexProjectionMatrix(const unsigned int iProj);
 
+  /** Range [pixMin,pixMax] of the indices of the buffered pixels of
+   * projection iProj whose ray may cross the box [boxMin,boxMax] in volume
+   * indices, i.e., the bounding box of the shadow of the box enlarged by one
+   * pixel. The range is empty (pixMin>pixMax) if the box is not seen.
+   * Transpose must be off. */
+  void GetSlabShadow(const int iProj,
+                     const double boxMin[3],
+                     const double boxMax[3],
+                     int pixMin[2],
+                     int pixMax[2]);
+
+  /** Computes the range of voxels inside the field of view of each line of
+   * the output requested region along x and along y, if
+   * SkipOutsideFieldOfView is on. */
+  void ComputeFieldOfViewRanges();
+
+  /** Crops [first, last) to the voxels inside the field of view of the line
+   * (j,k) along x, resp. of the line (i,k) along y. Nothing is done if
+   * SkipOutsideFieldOfView is off. */
+  void CropToFieldOfViewX(const int j, const int k, int &first, int &last) const;
+  void CropToFieldOfViewY(const int i, const int k, int &first, int &last) const;
+
+  /** Crops [first, last) to the indices n for which u0+du*(n-start) is in
+   * [0, uSup). The innermost loops compute the interpolation position with
+   * the same expression so that they do not need any bounds test. */
+  static void CropToDetector(const int start, const double u0, const double du, const double uSup,
+                             int &first, int &last);
+
 private:
   BackProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);            //purposely not implemented
@@ -124,6 +183,19 @@ private:
   /** Flip projection flag: infludences GetProjection and
     GetIndexToIndexProjectionMatrix for optimization */
   bool m_Transpose;
+
+  /** Field of view skipping. The ranges are stored in pairs [first, last)
+   * for each line of m_FieldOfViewRegion. The disks of the field of view
+   * only depend on the geometry and on the detector, they are not
+   * recomputed if these have not changed, e.g., for each subset of
+   * projections of rtk::FDKConeBeamReconstructionFilter. */
+  bool                  m_SkipOutsideFieldOfView;
+  OutputImageRegionType m_FieldOfViewRegion;
+  std::vector<int>      m_FieldOfViewRangesX;
+  std::vector<int>      m_FieldOfViewRangesY;
+  std::vector<double>   m_FieldOfViewDisks;
+  std::vector<double>   m_FieldOfViewDetector;
+  itk::TimeStamp        m_FieldOfViewTime;
 };
 
 } // end namespace rtk
@@ -20,11 +20,16 @@
 #define __rtkBackProjectionImageFilter_hxx
 
 #include "rtkHomogeneousMatrix.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkFieldOfViewImageFilter.h"
 
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkLinearInterpolateImageFunction.h>
 
+#include <algorithm>
+
 namespace rtk
 {
 
@@ -33,12 +38,21 @@ void
 BackProjectionImageFilter<TInputImage,TOutputImage>
 ::GenerateInputRequestedRegion()
 {
-  // Input 0 is the volume in which we backproject
+  // Input 0 is the volume in which we backproject, only one pixel is
+  // required if it is constant
   typename Superclass::InputImagePointer inputPtr0 =
     const_cast< TInputImage * >( this->GetInput(0) );
   if ( !inputPtr0 )
     return;
-  inputPtr0->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  typename TInputImage::RegionType reqRegion0 = this->GetOutput()->GetRequestedRegion();
+  InputPixelType constant;
+  if( this->IsInputConstant(constant) )
+    {
+    typename TInputImage::SizeType onePixel;
+    onePixel.Fill(1);
+    reqRegion0.SetSize(onePixel);
+    }
+  inputPtr0->SetRequestedRegion( reqRegion0 );
 
   // Input 1 is the stack of projections to backproject
   typename Superclass::InputImagePointer  inputPtr1 =
@@ -90,10 +104,10 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
         for(int cx=0; cx<2; cx++)
           {
           // Compute projection index
-          typename TInputImage::IndexType index = this->GetInput()->GetRequestedRegion().GetIndex();
-          index[0] += cx*this->GetInput()->GetRequestedRegion().GetSize(0);
-          index[1] += cy*this->GetInput()->GetRequestedRegion().GetSize(1);
-          index[2] += cz*this->GetInput()->GetRequestedRegion().GetSize(2);
+          typename TInputImage::IndexType index = this->GetOutput()->GetRequestedRegion().GetIndex();
+          index[0] += cx*this->GetOutput()->GetRequestedRegion().GetSize(0);
+          index[1] += cy*this->GetOutput()->GetRequestedRegion().GetSize(1);
+          index[2] += cz*this->GetOutput()->GetRequestedRegion().GetSize(2);
 
           itk::ContinuousIndex<double, Dimension-1> point;
           for(unsigned int i=0; i<Dimension-1; i++)
@@ -149,6 +163,284 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
 ::BeforeThreadedGenerateData()
 {
   this->SetTranspose(true);
+  this->ComputeFieldOfViewRanges();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::ComputeFieldOfViewRanges()
+{
+  m_FieldOfViewRangesX.clear();
+  m_FieldOfViewRangesY.clear();
+  if(!m_SkipOutsideFieldOfView)
+    return;
+
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  ThreeDCircularProjectionGeometry *circularGeometry;
+  circularGeometry = dynamic_cast<ThreeDCircularProjectionGeometry *>( m_Geometry.GetPointer() );
+  if(Dimension!=3 || circularGeometry==NULL)
+    itkExceptionMacro(<< "Skipping the voxels outside the field of view requires a 3D circular geometry.");
+
+  // The field of view is computed in physical coordinates, the ranges along
+  // the axes of the volume
+  typename TOutputImage::DirectionType identity;
+  identity.SetIdentity();
+  if(this->GetOutput()->GetDirection() != identity)
+    itkExceptionMacro(<< "Skipping the voxels outside the field of view requires an identity direction.");
+
+  typedef FieldOfViewImageFilter<TInputImage, TOutputImage> FOVFilterType;
+  typename FOVFilterType::Pointer fov = FOVFilterType::New();
+  fov->SetGeometry( circularGeometry );
+  fov->SetProjectionsStack( const_cast< TInputImage * >( this->GetInput(1) ) );
+
+  // Recompute the disks of the field of view only if the geometry or the
+  // detector have been modified
+  const TInputImage *stack = this->GetInput(1);
+  std::vector<double> detector;
+  for(unsigned int i=0; i<2; i++)
+    {
+    detector.push_back( stack->GetLargestPossibleRegion().GetIndex(i) );
+    detector.push_back( stack->GetLargestPossibleRegion().GetSize(i) );
+    detector.push_back( stack->GetOrigin()[i] );
+    detector.push_back( stack->GetSpacing()[i] );
+    for(unsigned int j=0; j<2; j++)
+      detector.push_back( stack->GetDirection()[i][j] );
+    }
+  if( detector != m_FieldOfViewDetector ||
+      m_FieldOfViewTime.GetMTime() < circularGeometry->GetMTime() ||
+      m_FieldOfViewTime.GetMTime() < this->GetMTime() )
+    {
+    // Union of the fields of view with and without a displaced detector, see
+    // FieldOfViewImageFilter::SetDisplacedDetector. Each disk is stored as
+    // (x, z, r).
+    m_FieldOfViewDisks.clear();
+    const typename FOVFilterType::FOVRadiusType types[3] = { FOVFilterType::RADIUSBOTH,
+                                                             FOVFilterType::RADIUSINF,
+                                                             FOVFilterType::RADIUSSUP };
+    for(unsigned int t=0; t<3; t++)
+      {
+      double x, z, r;
+      if( fov->ComputeFOVRadius(types[t], x, z, r) )
+        {
+        m_FieldOfViewDisks.push_back(x);
+        m_FieldOfViewDisks.push_back(z);
+        m_FieldOfViewDisks.push_back(r);
+        }
+      }
+    m_FieldOfViewDetector = detector;
+    m_FieldOfViewTime.Modified();
+    }
+  if( m_FieldOfViewDisks.empty() )
+    {
+    itkWarningMacro(<< "Could not compute the field of view, all voxels are backprojected.");
+    return;
+    }
+
+  double tangentInf, heightInf, tangentSup, heightSup;
+  fov->ComputeFOVHat(tangentInf, heightInf, tangentSup, heightSup);
+
+  // Ranges of the lines of the requested region. They are enlarged by one
+  // voxel in each direction to be conservative.
+  m_FieldOfViewRegion = this->GetOutput()->GetRequestedRegion();
+  const typename TOutputImage::PointType   origin  = this->GetOutput()->GetOrigin();
+  const typename TOutputImage::SpacingType spacing = this->GetOutput()->GetSpacing();
+  const double diagonalXZ = vcl_sqrt(spacing[0]*spacing[0] + spacing[2]*spacing[2]);
+  const int    firstIndex[3] = { (int)m_FieldOfViewRegion.GetIndex(0),
+                                 (int)m_FieldOfViewRegion.GetIndex(1),
+                                 (int)m_FieldOfViewRegion.GetIndex(2) };
+  const int    lastIndex[3]  = { firstIndex[0] + (int)m_FieldOfViewRegion.GetSize(0),
+                                 firstIndex[1] + (int)m_FieldOfViewRegion.GetSize(1),
+                                 firstIndex[2] + (int)m_FieldOfViewRegion.GetSize(2) };
+
+  m_FieldOfViewRangesX.reserve(2 * m_FieldOfViewRegion.GetSize(1) * m_FieldOfViewRegion.GetSize(2));
+  m_FieldOfViewRangesY.reserve(2 * m_FieldOfViewRegion.GetSize(0) * m_FieldOfViewRegion.GetSize(2));
+  for(int k=firstIndex[2]; k<lastIndex[2]; k++)
+    {
+    const double z = origin[2] + k * spacing[2];
+
+    // Lines along x
+    for(int j=firstIndex[1]; j<lastIndex[1]; j++)
+      {
+      // Maximum radius in the hat for y +/- one voxel
+      const double yInf = origin[1] + (j-1) * spacing[1];
+      const double ySup = origin[1] + (j+1) * spacing[1];
+      double radiusHat = itk::NumericTraits<double>::max();
+      if(tangentInf<0.)
+        radiusHat = vnl_math_min(radiusHat, (heightInf-ySup)/tangentInf);
+      else if(tangentInf==0. && ySup<heightInf)
+        radiusHat = -1.;
+      if(tangentSup>0.)
+        radiusHat = vnl_math_min(radiusHat, (heightSup-yInf)/tangentSup);
+      else if(tangentSup==0. && yInf>heightSup)
+        radiusHat = -1.;
+
+      double xFirst = itk::NumericTraits<double>::max();
+      double xLast  = itk::NumericTraits<double>::NonpositiveMin();
+      for(unsigned int d=0; d<m_FieldOfViewDisks.size(); d+=3)
+        {
+        const double radius = vnl_math_min(radiusHat, m_FieldOfViewDisks[d+2]);
+        const double dz = vnl_math_max(0., vnl_math_abs(z-m_FieldOfViewDisks[d+1])-spacing[2]);
+        if(radius<dz)
+          continue;
+        const double halfChord = vcl_sqrt(radius*radius - dz*dz);
+        xFirst = vnl_math_min(xFirst, m_FieldOfViewDisks[d] - halfChord);
+        xLast  = vnl_math_max(xLast,  m_FieldOfViewDisks[d] + halfChord);
+        }
+      int first = lastIndex[0];
+      int last = lastIndex[0];
+      if(xFirst<=xLast)
+        {
+        first = (int) vnl_math_max( (double)firstIndex[0],
+                                    vnl_math_min( (double)lastIndex[0], vcl_floor((xFirst-origin[0])/spacing[0]) ) );
+        last  = (int) vnl_math_max( (double)first,
+                                    vnl_math_min( (double)lastIndex[0], vcl_ceil((xLast-origin[0])/spacing[0])+1. ) );
+        }
+      m_FieldOfViewRangesX.push_back(first);
+      m_FieldOfViewRangesX.push_back(last);
+      }
+
+    // Lines along y
+    for(int i=firstIndex[0]; i<lastIndex[0]; i++)
+      {
+      const double x = origin[0] + i * spacing[0];
+      double yFirst = itk::NumericTraits<double>::max();
+      double yLast  = itk::NumericTraits<double>::NonpositiveMin();
+      for(unsigned int d=0; d<m_FieldOfViewDisks.size(); d+=3)
+        {
+        const double dx = x - m_FieldOfViewDisks[d];
+        const double dz = z - m_FieldOfViewDisks[d+1];
+        const double radius = vcl_sqrt(dx*dx + dz*dz);
+        const double radiusInf = vnl_math_max(0., radius-diagonalXZ);
+        if(radiusInf>m_FieldOfViewDisks[d+2])
+          continue;
+        const double radiusSup = vnl_math_min(radius+diagonalXZ, m_FieldOfViewDisks[d+2]);
+
+        // The limits of the hat are linear in the radius
+        yFirst = vnl_math_min(yFirst, vnl_math_min(heightInf - radiusInf * tangentInf,
+                                                   heightInf - radiusSup * tangentInf) );
+        yLast  = vnl_math_max(yLast,  vnl_math_max(heightSup - radiusInf * tangentSup,
+                                                   heightSup - radiusSup * tangentSup) );
+        }
+      int first = lastIndex[1];
+      int last = lastIndex[1];
+      if(yFirst<=yLast)
+        {
+        first = (int) vnl_math_max( (double)firstIndex[1],
+                                    vnl_math_min( (double)lastIndex[1], vcl_floor((yFirst-origin[1])/spacing[1])-1. ) );
+        last  = (int) vnl_math_max( (double)first,
+                                    vnl_math_min( (double)lastIndex[1], vcl_ceil((yLast-origin[1])/spacing[1])+2. ) );
+        }
+      m_FieldOfViewRangesY.push_back(first);
+      m_FieldOfViewRangesY.push_back(last);
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::CropToFieldOfViewX(const int j, const int k, int &first, int &last) const
+{
+  if( m_FieldOfViewRangesX.empty() )
+    return;
+  const unsigned int line = (j-m_FieldOfViewRegion.GetIndex(1)) +
+                            (k-m_FieldOfViewRegion.GetIndex(2)) * m_FieldOfViewRegion.GetSize(1);
+  first = vnl_math_max(first, m_FieldOfViewRangesX[2*line]);
+  last  = vnl_math_max(first, vnl_math_min(last, m_FieldOfViewRangesX[2*line+1]) );
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::CropToFieldOfViewY(const int i, const int k, int &first, int &last) const
+{
+  if( m_FieldOfViewRangesY.empty() )
+    return;
+  const unsigned int line = (i-m_FieldOfViewRegion.GetIndex(0)) +
+                            (k-m_FieldOfViewRegion.GetIndex(2)) * m_FieldOfViewRegion.GetSize(0);
+  first = vnl_math_max(first, m_FieldOfViewRangesY[2*line]);
+  last  = vnl_math_max(first, vnl_math_min(last, m_FieldOfViewRangesY[2*line+1]) );
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::CropToDetector(const int start, const double u0, const double du, const double uSup,
+                 int &first, int &last)
+{
+  // A small tolerance guards against a different rounding of u0+du*(n-start)
+  // in the innermost loops, e.g., with fused multiply-adds
+  const double tolerance = 1e-9 * (1.+uSup);
+  const double uInf = tolerance;
+  const double uMax = uSup - tolerance;
+  if(first>=last)
+    return;
+  if(du==0.)
+    {
+    if(u0<uInf || u0>=uMax)
+      last = first;
+    return;
+    }
+
+  // Analytical solution enlarged by one index in each direction...
+  double nInf = start + (uInf-u0)/du;
+  double nSup = start + (uMax-u0)/du;
+  if(du<0.)
+    std::swap(nInf, nSup);
+  first = (int) vnl_math_max( (double)first, vnl_math_min( (double)last, vcl_floor(nInf)-1. ) );
+  last  = (int) vnl_math_max( (double)first, vnl_math_min( (double)last, vcl_ceil(nSup)+2. ) );
+
+  // ... and refined with the same expression as the innermost loops. u is
+  // monotonic in n so that the whole range is inside the detector.
+  while(first<last && (u0+du*(first-start)<uInf || u0+du*(first-start)>=uMax) )
+    first++;
+  while(last>first && (u0+du*(last-1-start)<uInf || u0+du*(last-1-start)>=uMax) )
+    last--;
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::IsInputConstant(InputPixelType &constant) const
+{
+  return ConstantImageSource<TInputImage>::IsConstantImage(this->GetInput(0), constant);
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::CanRunInPlace() const
+{
+  InputPixelType constant;
+  return Superclass::CanRunInPlace() && !this->IsInputConstant(constant);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::InitializeOutputRegion(const OutputImageRegionType& region)
+{
+  typedef itk::ImageRegionIterator<TOutputImage> OutputRegionIterator;
+  OutputRegionIterator itOut(this->GetOutput(), region);
+
+  // Constant input, nothing to read
+  InputPixelType constant;
+  if( this->IsInputConstant(constant) )
+    {
+    for(itOut.GoToBegin(); !itOut.IsAtEnd(); ++itOut)
+      itOut.Set(constant);
+    return;
+    }
+
+  // Copy of the input if the filter is not in place
+  if(this->GetInput() != this->GetOutput() )
+    {
+    typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
+    InputRegionIterator itIn(this->GetInput(), region);
+    for(itOut.GoToBegin(); !itOut.IsAtEnd(); ++itIn, ++itOut)
+      itOut.Set(itIn.Get() );
+    }
 }
 
 /**
@@ -160,6 +452,8 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType itkNotUsed(threadId) )
 {
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
@@ -168,24 +462,13 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
   typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
   typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
 
-  // Iterators on volume input and output
-  typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  // Iterator on volume output
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    itIn.GoToBegin();
-    while(!itIn.IsAtEnd() )
-      {
-      itOut.Set(itIn.Get() );
-      ++itIn;
-      ++itOut;
-      }
-    }
+  this->InitializeOutputRegion(outputRegionForThread);
 
   // Continuous index at which we interpolate
   itk::ContinuousIndex<double, Dimension-1> pointProj;
@@ -211,32 +494,49 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       continue;
       }
 
-    // Go over each voxel
+    // Go over each line of voxels along x, cropped to the field of view
     itOut.GoToBegin();
     while(!itOut.IsAtEnd() )
       {
-      // Compute projection index
-      for(unsigned int i=0; i<Dimension-1; i++)
+      typename TOutputImage::IndexType lineIndex = itOut.GetIndex();
+      int first = lineIndex[0];
+      int last = first + (int)outputRegionForThread.GetSize(0);
+      if(Dimension==3)
+        this->CropToFieldOfViewX(lineIndex[1], lineIndex[2], first, last);
+      lineIndex[0] = first;
+      itOut.SetIndex(lineIndex);
+
+      // Go over each voxel of the line
+      for(int n=first; n<last; n++)
         {
-        pointProj[i] = matrix[i][Dimension];
+        // Compute projection index
+        for(unsigned int i=0; i<Dimension-1; i++)
+          {
+          pointProj[i] = matrix[i][Dimension];
+          for(unsigned int j=0; j<Dimension; j++)
+            pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
+          }
+
+        // Apply perspective
+        double perspFactor = matrix[Dimension-1][Dimension];
         for(unsigned int j=0; j<Dimension; j++)
-          pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
-        }
+          perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
+        perspFactor = 1/perspFactor;
+        for(unsigned int i=0; i<Dimension-1; i++)
+          pointProj[i] = pointProj[i]*perspFactor;
 
-      // Apply perspective
-      double perspFactor = matrix[Dimension-1][Dimension];
-      for(unsigned int j=0; j<Dimension; j++)
-        perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
-      perspFactor = 1/perspFactor;
-      for(unsigned int i=0; i<Dimension-1; i++)
-        pointProj[i] = pointProj[i]*perspFactor;
+        // Interpolate if in projection
+        if( interpolator->IsInsideBuffer(pointProj) )
+          {
+          itOut.Set( itOut.Get() + interpolator->EvaluateAtContinuousIndex(pointProj) );
+          }
 
-      // Interpolate if in projection
-      if( interpolator->IsInsideBuffer(pointProj) )
-        {
-        itOut.Set( itOut.Get() + interpolator->EvaluateAtContinuousIndex(pointProj) );
+        ++itOut;
         }
 
+      // Go to the next line
+      lineIndex[0] = outputRegionForThread.GetIndex(0) + outputRegionForThread.GetSize(0) - 1;
+      itOut.SetIndex(lineIndex);
       ++itOut;
       }
     }
@@ -286,20 +586,24 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
         v1 = v-vi;
         v2 = 1.0-v1;
 
+        // Voxels of the line in the field of view which project on the detector
+        int first = i;
+        int last = i + (int)region.GetSize(0);
+        this->CropToFieldOfViewX(j, k, first, last);
+        this->CropToDetector(i, u, du, pSize[0]-1, first, last);
+
         pProj = projection->GetBufferPointer() + vi * pSize[0];
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+        pVol = pVolZeroPointer + first + vBufferSize[0] * (j + k * vBufferSize[1] );
 
         // Innermost loop
-        for(; i<(region.GetIndex(0) + (int)region.GetSize(0)); i++, u += du, pVol++)
+        for(int n=first; n<last; n++, pVol++)
           {
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
-                     v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) );
-            }
+          const double un = u + du * (n-i);
+          ui = vnl_math_floor(un);
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
+                   v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) );
           } //i
         }
       } //j
@@ -346,21 +650,25 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
       vi = vnl_math_floor(v);
       if(vi>=0 && vi<(int)pSize[1]-1)
         {
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
-        for(; j<(region.GetIndex(1) + (int)region.GetSize(1)); j++, pVol += vBufferSize[0], u += du)
+        // Voxels of the line in the field of view which project on the detector
+        int first = j;
+        int last = j + (int)region.GetSize(1);
+        this->CropToFieldOfViewY(i, k, first, last);
+        this->CropToDetector(j, u, du, pSize[0]-1, first, last);
+
+        const double v1 = v-vi;
+        const double v2 = 1.0-v1;
+        pVol = pVolZeroPointer + i + vBufferSize[0] * (first + k * vBufferSize[1] );
+        for(int n=first; n<last; n++, pVol += vBufferSize[0])
           {
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            double u1, u2, v1, v2;
-            pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
-            v1 = v-vi;
-            v2 = 1.0-v1;
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
-                     v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
-            }
+          double u1, u2;
+          const double un = u + du * (n-j);
+          ui = vnl_math_floor(un);
+          pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
+                   v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) );
           } //j
         }
       } //i
@@ -461,6 +769,62 @@ BackProjectionImageFilter<TInputImage,TOutputImage>
                               matrixVol.GetVnlMatrix() );
 }
 
+template <class TInputImage, class TOutputImage>
+void
+BackProjectionImageFilter<TInputImage,TOutputImage>
+::GetSlabShadow(const int iProj,
+                const double boxMin[3],
+                const double boxMax[3],
+                int pixMin[2],
+                int pixMax[2])
+{
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  for(unsigned int k=0; k<2; k++)
+    {
+    pixMin[k] = buffReg.GetIndex(k);
+    pixMax[k] = buffReg.GetIndex(k) + (int)buffReg.GetSize(k) - 1;
+    }
+
+  // Project the 8 corners of the box. The shadow of the box is the convex
+  // hull of the projected corners if they are all on the same side of the
+  // source, otherwise all pixels are kept.
+  const ProjectionMatrixType matrix = this->GetIndexToIndexProjectionMatrix(iProj);
+  double uMin = itk::NumericTraits<double>::max();
+  double vMin = itk::NumericTraits<double>::max();
+  double uMax = itk::NumericTraits<double>::NonpositiveMin();
+  double vMax = itk::NumericTraits<double>::NonpositiveMin();
+  int sign = 0;
+  for(unsigned int c=0; c<8; c++)
+    {
+    double corner[3], p[3];
+    corner[0] = (c&1)?boxMax[0]:boxMin[0];
+    corner[1] = (c&2)?boxMax[1]:boxMin[1];
+    corner[2] = (c&4)?boxMax[2]:boxMin[2];
+    for(unsigned int i=0; i<3; i++)
+      p[i] = matrix[i][0] * corner[0] + matrix[i][1] * corner[1] + matrix[i][2] * corner[2] + matrix[i][3];
+    const int cornerSign = (p[2]>0.)?1:((p[2]<0.)?-1:0);
+    if(cornerSign == 0 || (sign != 0 && cornerSign != sign) )
+      return;
+    sign = cornerSign;
+    uMin = std::min(uMin, p[0] / p[2]);
+    uMax = std::max(uMax, p[0] / p[2]);
+    vMin = std::min(vMin, p[1] / p[2]);
+    vMax = std::max(vMax, p[1] / p[2]);
+    }
+
+  // The shadow is enlarged by one pixel for rounding errors and for the
+  // projectors which account for the width of the pixels. The callers
+  // discard the remaining pixels which do not see the box.
+  const double bounds[2][2] = { { uMin, uMax }, { vMin, vMax } };
+  for(unsigned int k=0; k<2; k++)
+    {
+    const double lower = std::max(bounds[k][0], pixMin[k] - 1.);
+    const double upper = std::min(bounds[k][1], pixMax[k] + 1.);
+    pixMin[k] = std::max(pixMin[k], (int)vnl_math_floor(lower) - 1);
+    pixMax[k] = std::min(pixMax[k], (int)vnl_math_ceil(upper) + 1);
+    }
+}
+
 } // end namespace rtk
 
 #endif
@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkBoundedQueue_h
+#define __rtkBoundedQueue_h
+
+#include <itkSimpleMutexLock.h>
+#include <itkConditionVariable.h>
+
+#include <deque>
+
+namespace rtk
+{
+
+/** \class BoundedQueue
+ * \brief First in, first out queue of bounded capacity shared between
+ * producer and consumer threads.
+ *
+ * Push waits while the queue is full and Pop waits while it is empty so that
+ * fast producers are slowed down to the pace of the consumers. Close wakes up
+ * all waiting threads: pushes then fail and pops fail as soon as the queue
+ * is empty, which is the signal for consumer threads to exit.
+ *
+ * \test rtkinlinefdktest.cxx
+ *
+ * \ingroup OSSystemObjects
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+  BoundedQueue(unsigned int capacity = 16):
+    m_Capacity(capacity),
+    m_Closed(false),
+    m_NotEmpty(itk::ConditionVariable::New()),
+    m_NotFull(itk::ConditionVariable::New())
+    {}
+
+  /** Get / Set the maximum number of elements in the queue. */
+  unsigned int GetCapacity() const { return m_Capacity; }
+  void SetCapacity(unsigned int capacity)
+    {
+    m_Mutex.Lock();
+    m_Capacity = (capacity)?capacity:1;
+    m_NotFull->Broadcast();
+    m_Mutex.Unlock();
+    }
+
+  /** Add an element at the end of the queue, waiting while the queue is full.
+   * Returns false if the queue has been closed. */
+  bool Push(const T &value)
+    {
+    m_Mutex.Lock();
+    while(!m_Closed && m_Queue.size() >= m_Capacity)
+      m_NotFull->Wait(&m_Mutex);
+    const bool closed = m_Closed;
+    if(!closed)
+      {
+      m_Queue.push_back(value);
+      m_NotEmpty->Signal();
+      }
+    m_Mutex.Unlock();
+    return !closed;
+    }
+
+  /** Remove the first element of the queue, waiting while the queue is
+   * empty. Returns false if the queue is empty and has been closed. */
+  bool Pop(T &value)
+    {
+    m_Mutex.Lock();
+    while(!m_Closed && m_Queue.empty())
+      m_NotEmpty->Wait(&m_Mutex);
+    const bool empty = m_Queue.empty();
+    if(!empty)
+      {
+      value = m_Queue.front();
+      m_Queue.pop_front();
+      m_NotFull->Signal();
+      }
+    m_Mutex.Unlock();
+    return !empty;
+    }
+
+  /** Close the queue and wake up all waiting threads. */
+  void Close()
+    {
+    m_Mutex.Lock();
+    m_Closed = true;
+    m_NotEmpty->Broadcast();
+    m_NotFull->Broadcast();
+    m_Mutex.Unlock();
+    }
+
+  /** Empty and reopen the queue. */
+  void Reset()
+    {
+    m_Mutex.Lock();
+    m_Queue.clear();
+    m_Closed = false;
+    m_Mutex.Unlock();
+    }
+
+  /** Number of elements currently in the queue. */
+  unsigned int GetSize() const
+    {
+    m_Mutex.Lock();
+    const unsigned int size = m_Queue.size();
+    m_Mutex.Unlock();
+    return size;
+    }
+
+private:
+  BoundedQueue(const BoundedQueue&); //purposely not implemented
+  void operator=(const BoundedQueue&); //purposely not implemented
+
+  std::deque<T>                   m_Queue;
+  unsigned int                    m_Capacity;
+  bool                            m_Closed;
+  mutable itk::SimpleMutexLock    m_Mutex;
+  itk::ConditionVariable::Pointer m_NotEmpty;
+  itk::ConditionVariable::Pointer m_NotFull;
+};
+
+} // end namespace rtk
+
+#endif
@@ -30,6 +30,7 @@
 #include "rtkDisplacedDetectorImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkLaplacianImageFilter.h"
+#include "rtkFFTRampPreconditionerImageFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "rtkCudaConjugateGradientImageFilter_3f.h"
@@ -57,6 +58,11 @@ namespace rtk
    *
    * With gamma > 0, a regularization is applied.
    *
+   * If RampPreconditioned, preconditioned conjugate gradient is performed with
+   * a 3D ramp filter of the volume, rtk::FFTRampPreconditionerImageFilter,
+   * which approximates the inverse of R^T R. The solution is the same but
+   * fewer forward and back projection pairs are required to reach it.
+   *
    * \dot
    * digraph ConjugateGradientConeBeamReconstructionFilter {
    *
@@ -147,6 +153,7 @@ public:
     typedef rtk::DisplacedDetectorImageFilter<TOutputImage>                  DisplacedDetectorFilterType;
     typedef rtk::ConstantImageSource<TOutputImage>                           ConstantImageSourceType;
     typedef itk::DivideOrZeroOutImageFilter<TOutputImage>                    DivideFilterType;
+    typedef rtk::FFTRampPreconditionerImageFilter<TOutputImage>              RampPreconditionerType;
 
     /** Pass the ForwardProjection filter to the conjugate gradient operator */
     void SetForwardProjectionFilter (int _arg);
@@ -160,6 +167,16 @@ public:
     itkSetMacro(NumberOfIterations, int)
     itkGetMacro(NumberOfIterations, int)
 
+    /** Relative residual norm at which the conjugate gradient stops, see
+     * rtk::ConjugateGradientImageFilter. Default is 0 (disabled). */
+    itkSetMacro(Tolerance, double)
+    itkGetMacro(Tolerance, double)
+
+    /** Convergence of the last conjugate gradient, updated before each
+     * itk::IterationEvent invoked by this filter. */
+    const std::vector<double> & GetResidualNorms() const {return m_ConjugateGradientFilter->GetResidualNorms();}
+    const std::vector<double> & GetElapsedTimes() const {return m_ConjugateGradientFilter->GetElapsedTimes();}
+
     itkSetMacro(MeasureExecutionTimes, bool)
     itkGetMacro(MeasureExecutionTimes, bool)
 
@@ -174,6 +191,12 @@ public:
     itkSetMacro(Gamma, float)
     itkGetMacro(Gamma, float)
 
+    /** If RampPreconditioned, performs preconditioned conjugate gradient with
+     * a 3D ramp filter of the volume. It cannot be combined with
+     * Preconditioned and disables the CUDA conjugate gradient. */
+    itkSetMacro(RampPreconditioned, bool)
+    itkGetMacro(RampPreconditioned, bool)
+
     /** Get / Set whether conjugate gradient should be performed on GPU */
     itkGetMacro(CudaConjugateGradient, bool)
     itkSetMacro(CudaConjugateGradient, bool)
@@ -185,6 +208,10 @@ protected:
     /** Does the real work. */
     virtual void GenerateData();
 
+    /** Invokes the itk::IterationEvent of the conjugate gradient filter */
+    void ForwardIterationEvent() {this->InvokeEvent( itk::IterationEvent() );}
+    typename itk::SimpleMemberCommand<Self>::Pointer m_IterationCommand;
+
     /** Member pointers to the filters used internally (for convenience)*/
     typename MultiplyFilterType::Pointer                                        m_MultiplyProjectionsFilter;
     typename MultiplyFilterType::Pointer                                        m_MultiplyVolumeFilter;
@@ -200,6 +227,7 @@ protected:
     typename ConstantImageSourceType::Pointer                                   m_ConstantVolumeSource;
     typename ConstantImageSourceType::Pointer                                   m_ConstantProjectionsSource;
     typename DivideFilterType::Pointer                                          m_DivideFilter;
+    typename RampPreconditionerType::Pointer                                    m_RampPreconditioner;
 
     /** The inputs of this filter have the same type (float, 3) but not the same meaning
     * It is normal that they do not occupy the same physical space. Therefore this check
@@ -217,11 +245,13 @@ private:
 
     ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 
-    int   m_NumberOfIterations;
+    int    m_NumberOfIterations;
+    double m_Tolerance;
     float m_Gamma;
     bool  m_MeasureExecutionTimes;
     bool  m_Preconditioned;
     bool  m_Regularized;
+    bool  m_RampPreconditioned;
     bool  m_CudaConjugateGradient;
 };
 } //namespace ITK
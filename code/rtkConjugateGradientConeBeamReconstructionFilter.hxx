@@ -31,10 +31,12 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>::ConjugateGradientCo
 
   // Set the default values of member parameters
   m_NumberOfIterations=3;
+  m_Tolerance=0.;
   m_MeasureExecutionTimes=false;
   m_Preconditioned=false;
   m_Gamma = 0;
   m_Regularized = false;
+  m_RampPreconditioned = false;
   m_CudaConjugateGradient = true;
 
   // Create the filters
@@ -46,6 +48,9 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>::ConjugateGradientCo
   m_ConstantVolumeSource     = ConstantImageSourceType::New();
 #endif
   m_CGOperator = CGOperatorFilterType::New();
+  m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
+  m_IterationCommand = itk::SimpleMemberCommand<Self>::New();
+  m_IterationCommand->SetCallbackFunction(this, &Self::ForwardIterationEvent);
 
   m_DivideFilter = DivideFilterType::New();
   m_ConstantProjectionsSource = ConstantImageSourceType::New();
@@ -53,6 +58,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>::ConjugateGradientCo
   m_MultiplyVolumeFilter = MultiplyFilterType::New();
   m_MultiplyProjectionsFilter = MultiplyFilterType::New();
   m_MultiplyOutputFilter = MultiplyFilterType::New();
+  m_RampPreconditioner = RampPreconditionerType::New();
 
   // Set permanent parameters
   m_ConstantVolumeSource->SetConstant(itk::NumericTraits<typename TOutputImage::PixelType>::ZeroValue());
@@ -122,13 +128,20 @@ void
 ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
 ::GenerateOutputInformation()
 {
-  // Choose between cuda or non-cuda conjugate gradient filter
+  if (m_RampPreconditioned && m_Preconditioned)
+    itkExceptionMacro(<< "RampPreconditioned and Preconditioned cannot be combined");
+
+  // Choose between cuda or non-cuda conjugate gradient filter. The CUDA
+  // conjugate gradient ignores the preconditioner.
   m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
 #ifdef RTK_USE_CUDA
-  if (m_CudaConjugateGradient)
+  if (m_CudaConjugateGradient && !m_RampPreconditioned)
     m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_3f::New();
 #endif
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
+  if (m_RampPreconditioned)
+    m_ConjugateGradientFilter->SetPreconditioner(m_RampPreconditioner.GetPointer());
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), m_IterationCommand);
 
   // Set runtime connections
   m_ConstantVolumeSource->SetInformationFromImage(this->GetInput(0));
@@ -181,6 +194,7 @@ ConjugateGradientConeBeamReconstructionFilter<TOutputImage>
   
   // Set runtime parameters
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_NumberOfIterations);
+  m_ConjugateGradientFilter->SetTolerance(this->m_Tolerance);
   m_CGOperator->SetPreconditioned(m_Preconditioned);
   m_CGOperator->SetRegularized(m_Regularized);
   m_CGOperator->SetGamma(m_Gamma);
@@ -46,9 +46,14 @@ public:
     void SetPk(const TInputImage* Pk);
     void SetAPk(const TInputImage* APk);
 
+    /** Optional preconditioned residual Z_k = M^-1 R_k. If set, Alphak is
+     * R_k^T Z_k / P_k^T A P_k instead of R_k^T R_k / P_k^T A P_k. */
+    void SetZk(const TInputImage* Zk);
+
     itkGetMacro(Alphak, float)
     itkGetMacro(SquaredNormR_k, float)
     itkGetMacro(SquaredNormR_kPlusOne, float)
+    itkGetMacro(RktZk, float)
 
 protected:
     ConjugateGradientGetR_kPlusOneImageFilter();
@@ -57,6 +62,7 @@ protected:
     typename TInputImage::Pointer GetRk();
     typename TInputImage::Pointer GetPk();
     typename TInputImage::Pointer GetAPk();
+    typename TInputImage::Pointer GetZk();
 
     /** Initialize the thread synchronization barrier before the threads run,
         and create a few vectors in which each thread will store temporary
@@ -77,6 +83,7 @@ private:
     float m_Alphak;
     float m_SquaredNormR_k;
     float m_SquaredNormR_kPlusOne;
+    float m_RktZk;
 
     // Thread synchronization tool
     itk::Barrier::Pointer m_Barrier;
@@ -86,6 +93,7 @@ private:
     std::vector<float> m_SquaredNormR_kVector;
     std::vector<float> m_SquaredNormR_kPlusOneVector;
     std::vector<float> m_PktApkVector;
+    std::vector<float> m_RktZkVector;
 
 };
 } //namespace ITK
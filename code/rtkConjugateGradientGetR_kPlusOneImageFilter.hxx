@@ -32,7 +32,8 @@ template< typename TInputType>
 ConjugateGradientGetR_kPlusOneImageFilter<TInputType>::ConjugateGradientGetR_kPlusOneImageFilter():
     m_Alphak(0.),
     m_SquaredNormR_k(0.),
-    m_SquaredNormR_kPlusOne(0.)
+    m_SquaredNormR_kPlusOne(0.),
+    m_RktZk(0.)
 {
     this->SetNumberOfRequiredInputs(3);
 }
@@ -55,6 +56,12 @@ void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>::SetAPk(const TInputT
     this->SetNthInput(2, const_cast<TInputType*>(APk));
 }
 
+template< typename TInputType>
+void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>::SetZk(const TInputType* Zk)
+{
+    this->SetNthInput(3, const_cast<TInputType*>(Zk));
+}
+
 template< typename TInputType>
 typename TInputType::Pointer ConjugateGradientGetR_kPlusOneImageFilter<TInputType>::GetRk()
 {
@@ -76,6 +83,13 @@ typename TInputType::Pointer ConjugateGradientGetR_kPlusOneImageFilter<TInputTyp
             ( this->itk::ProcessObject::GetInput(2) );
 }
 
+template< typename TInputType>
+typename TInputType::Pointer ConjugateGradientGetR_kPlusOneImageFilter<TInputType>::GetZk()
+{
+    return static_cast< TInputType * >
+            ( this->itk::ProcessObject::GetInput(3) );
+}
+
 template< typename TInputType>
 void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>
 ::BeforeThreadedGenerateData()
@@ -94,12 +108,14 @@ void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>
   m_SquaredNormR_kVector.clear();
   m_SquaredNormR_kPlusOneVector.clear();
   m_PktApkVector.clear();
+  m_RktZkVector.clear();
 
   for (unsigned int i=0; i<this->GetNumberOfThreads(); i++)
     {
     m_SquaredNormR_kVector.push_back(0);
     m_SquaredNormR_kPlusOneVector.push_back(0);
     m_PktApkVector.push_back(0);
+    m_RktZkVector.push_back(0);
     }
 }
 
@@ -121,6 +137,19 @@ void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>
     ++r_k_It;
     }
 
+  // Compute r_k_t_z_k if preconditioned
+  if(this->GetZk())
+    {
+    RegionIterator z_k_It(this->GetZk(), outputRegionForThread);
+    r_k_It.GoToBegin();
+    while(!r_k_It.IsAtEnd())
+      {
+      m_RktZkVector[threadId] += r_k_It.Get() * z_k_It.Get();
+      ++r_k_It;
+      ++z_k_It;
+      }
+    }
+
   // Compute p_k_t_A_p_k
   RegionIterator p_k_It(this->GetPk(), outputRegionForThread);
   p_k_It.GoToBegin();
@@ -136,12 +165,16 @@ void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>
 
   // Each thread computes alpha_k
   float squaredNormR_k = 0;
+  float r_k_t_z_k = 0;
   float p_k_t_A_p_k = 0;
   for (unsigned int i=0; i<this->GetNumberOfThreads(); i++)
     {
     squaredNormR_k += m_SquaredNormR_kVector[i];
+    r_k_t_z_k += m_RktZkVector[i];
     p_k_t_A_p_k += m_PktApkVector[i];
     }
+  if(this->GetZk())
+    squaredNormR_k = r_k_t_z_k;
   float alphak = squaredNormR_k / (p_k_t_A_p_k + eps);
 
   // Compute Rk+1 and write it on the output
@@ -169,14 +202,19 @@ void ConjugateGradientGetR_kPlusOneImageFilter<TInputType>
   // m_SquaredNormR_kPlusOne, as they will be passed to other filters
   m_SquaredNormR_k = 0;
   m_SquaredNormR_kPlusOne = 0;
+  m_RktZk = 0;
   float p_k_t_A_p_k = 0;
   for (unsigned int i=0; i<this->GetNumberOfThreads(); i++)
     {
     m_SquaredNormR_k += m_SquaredNormR_kVector[i];
     m_SquaredNormR_kPlusOne += m_SquaredNormR_kPlusOneVector[i];
+    m_RktZk += m_RktZkVector[i];
     p_k_t_A_p_k += m_PktApkVector[i];
     }
-  m_Alphak = m_SquaredNormR_k / (p_k_t_A_p_k + eps);
+  if(this->GetZk())
+    m_Alphak = m_RktZk / (p_k_t_A_p_k + eps);
+  else
+    m_Alphak = m_SquaredNormR_k / (p_k_t_A_p_k + eps);
 }
 
 }// end namespace
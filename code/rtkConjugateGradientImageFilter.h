@@ -27,6 +27,7 @@
 #include "rtkConjugateGradientGetP_kPlusOneImageFilter.h"
 
 #include "rtkConjugateGradientOperator.h"
+#include "rtkTraceCollector.h"
 #include "itkTimeProbe.h"
 
 namespace rtk
@@ -38,6 +39,25 @@ namespace rtk
  * ConjugateGradientImageFilter implements the algorithm described
  * in http://en.wikipedia.org/wiki/Conjugate_gradient_method
  *
+ * The filter stops after NumberOfIterations iterations or, if Tolerance is
+ * strictly positive, as soon as the norm of the residual B-AX relative to that
+ * of the initial residual is below Tolerance. An itk::IterationEvent is invoked
+ * after each iteration. The relative residual norms and the time elapsed since
+ * the beginning of the iterations are available with GetResidualNorms and
+ * GetElapsedTimes during these events and after the update. The tolerance is
+ * ignored by the CUDA implementations, which perform all the iterations.
+ *
+ * If a preconditioner is set with SetPreconditioner, the filter performs
+ * preconditioned conjugate gradient (PCG), see
+ * http://en.wikipedia.org/wiki/Conjugate_gradient_method#The_preconditioned_conjugate_gradient_method
+ * The preconditioner is any image to image filter which computes
+ * Z = M^-1 R from its first input R, M being symmetric positive definite and
+ * close to A, e.g., an itk::MultiplyImageFilter by the inverse of the
+ * diagonal of A. It is updated once per iteration and must not run in place.
+ * The solution is that of AX = B but fewer iterations are required when
+ * M^-1 A is better conditioned than A. The residual norms remain those of
+ * B-AX. The preconditioner is ignored by the CUDA implementations.
+ *
 */
 
 template< typename OutputImageType>
@@ -56,6 +76,8 @@ public:
   typedef typename rtk::ConjugateGradientGetP_kPlusOneImageFilter<OutputImageType>  GetP_kPlusOne_FilterType;
   typedef typename rtk::ConjugateGradientGetR_kPlusOneImageFilter<OutputImageType>  GetR_kPlusOne_FilterType;
   typedef typename rtk::ConjugateGradientGetX_kPlusOneImageFilter<OutputImageType>  GetX_kPlusOne_FilterType;
+  typedef itk::ImageToImageFilter<OutputImageType, OutputImageType>                 PreconditionerType;
+  typedef typename PreconditionerType::Pointer                                      PreconditionerPointerType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self)
@@ -66,12 +88,27 @@ public:
   /** Get and Set macro*/
   itkGetMacro(NumberOfIterations, int)
   itkSetMacro(NumberOfIterations, int)
+
+  /** Get / Set the relative residual norm below which the iterations stop.
+   * Default is 0, i.e., NumberOfIterations iterations are performed. */
+  itkGetMacro(Tolerance, double)
+  itkSetMacro(Tolerance, double)
+
+  /** Relative residual norm ||B-AX_k|| / ||B-AX_0|| and time in seconds since
+   * the beginning of the iterations after each iteration k>0. */
+  const std::vector<double> & GetResidualNorms() const {return m_ResidualNorms;}
+  const std::vector<double> & GetElapsedTimes() const {return m_ElapsedTimes;}
   
 //  itkSetMacro(MeasureExecutionTimes, bool)
 //  itkGetMacro(MeasureExecutionTimes, bool)
 
   void SetA(ConjugateGradientOperatorPointerType _arg );
 
+  /** Get / Set the filter computing M^-1 R. Default is none, i.e., M is
+   * the identity. */
+  void SetPreconditioner(PreconditionerPointerType _arg );
+  itkGetObjectMacro(Preconditioner, PreconditionerType)
+
   /** The input image to be updated.*/
   void SetX(const OutputImageType* OutputImage);
 
@@ -91,9 +128,20 @@ protected:
   /** Conjugate gradient requires the whole image */
   void GenerateInputRequestedRegion();
 
+  /** Returns M^-1 R, disconnected from the preconditioner */
+  OutputImagePointer ApplyPreconditioner(OutputImageType *R);
+
+  /** Returns A^T B */
+  double InnerProduct(OutputImageType *A, OutputImageType *B);
+
   ConjugateGradientOperatorPointerType m_A;
+  PreconditionerPointerType            m_Preconditioner;
+
+  int    m_NumberOfIterations;
+  double m_Tolerance;
 
-  int  m_NumberOfIterations;
+  std::vector<double> m_ResidualNorms;
+  std::vector<double> m_ElapsedTimes;
 
 private:
   ConjugateGradientImageFilter(const Self &); //purposely not implemented
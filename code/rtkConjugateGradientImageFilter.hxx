@@ -21,6 +21,8 @@
 
 #include "rtkConjugateGradientImageFilter.h"
 
+#include <itkImageRegionConstIterator.h>
+
 namespace rtk
 {
 
@@ -30,6 +32,7 @@ ConjugateGradientImageFilter<OutputImageType>::ConjugateGradientImageFilter()
   this->SetNumberOfRequiredInputs(2);
   
   m_NumberOfIterations = 1;
+  m_Tolerance = 0.;
 //  m_MeasureExecutionTimes = false;
 
   m_A = ConjugateGradientOperatorType::New();
@@ -71,6 +74,40 @@ void ConjugateGradientImageFilter<OutputImageType>
   this->Modified();
 }
 
+template<typename OutputImageType>
+void ConjugateGradientImageFilter<OutputImageType>
+::SetPreconditioner(PreconditionerPointerType _arg )
+{
+  this->m_Preconditioner = _arg;
+  this->Modified();
+}
+
+template<typename OutputImageType>
+typename ConjugateGradientImageFilter<OutputImageType>::OutputImagePointer
+ConjugateGradientImageFilter<OutputImageType>
+::ApplyPreconditioner(OutputImageType *R)
+{
+  m_Preconditioner->SetInput(R);
+  m_Preconditioner->UpdateLargestPossibleRegion();
+  OutputImagePointer Z = m_Preconditioner->GetOutput();
+  Z->DisconnectPipeline();
+  return Z;
+}
+
+template<typename OutputImageType>
+double
+ConjugateGradientImageFilter<OutputImageType>
+::InnerProduct(OutputImageType *A, OutputImageType *B)
+{
+  typedef itk::ImageRegionConstIterator<OutputImageType> IteratorType;
+  IteratorType itA(A, A->GetBufferedRegion());
+  IteratorType itB(B, A->GetBufferedRegion());
+  double result = 0.;
+  for(; !itA.IsAtEnd(); ++itA, ++itB)
+    result += itA.Get() * itB.Get();
+  return result;
+}
+
 template<typename OutputImageType>
 void ConjugateGradientImageFilter<OutputImageType>
 ::GenerateInputRequestedRegion()
@@ -93,6 +130,9 @@ void ConjugateGradientImageFilter<OutputImageType>
 ::GenerateData()
 {
   itk::TimeProbe CGTimeProbe;
+  CGTimeProbe.Start();
+  m_ResidualNorms.clear();
+  m_ElapsedTimes.clear();
 
 //  if(m_MeasureExecutionTimes)
 //    {
@@ -113,19 +153,25 @@ void ConjugateGradientImageFilter<OutputImageType>
   typename GetR_kPlusOne_FilterType::Pointer GetR_kPlusOne_Filter = GetR_kPlusOne_FilterType::New();
   typename GetX_kPlusOne_FilterType::Pointer GetX_kPlusOne_Filter = GetX_kPlusOne_FilterType::New();
 
-  // Compute P_zero = R_zero
-  typename OutputImageType::Pointer P_zero = SubtractFilter->GetOutput();
-  P_zero->DisconnectPipeline();
+  // Compute R_zero and P_zero = Z_zero = M^-1 R_zero
+  typename OutputImageType::Pointer R_zero = SubtractFilter->GetOutput();
+  R_zero->DisconnectPipeline();
+  typename OutputImageType::Pointer P_zero = R_zero;
+  if(m_Preconditioner.IsNotNull())
+    {
+    P_zero = this->ApplyPreconditioner(R_zero);
+    GetR_kPlusOne_Filter->SetZk(P_zero);
+    }
 
   // Compute AP_zero
   m_A->SetX(P_zero);
 
-  GetR_kPlusOne_Filter->SetRk(P_zero);
+  GetR_kPlusOne_Filter->SetRk(R_zero);
   GetR_kPlusOne_Filter->SetPk(P_zero);
   GetR_kPlusOne_Filter->SetAPk(m_A->GetOutput());
 
   GetP_kPlusOne_Filter->SetR_kPlusOne(GetR_kPlusOne_Filter->GetOutput());
-  GetP_kPlusOne_Filter->SetRk(P_zero);
+  GetP_kPlusOne_Filter->SetRk(R_zero);
   GetP_kPlusOne_Filter->SetPk(P_zero);
 
   GetX_kPlusOne_Filter->SetXk(this->GetX());
@@ -135,10 +181,15 @@ void ConjugateGradientImageFilter<OutputImageType>
   typename OutputImageType::Pointer R_kPlusOne;
   typename OutputImageType::Pointer P_kPlusOne;
   typename OutputImageType::Pointer X_kPlusOne;
+  typename OutputImageType::Pointer Z_kPlusOne;
 
   // Start the iterative procedure
-  for (int iter=0; iter<m_NumberOfIterations; iter++)
+  double squaredNormR_zero = 0.;
+  int iter;
+  for (iter=0; iter<m_NumberOfIterations; iter++)
     {
+    TraceSpan iterationSpan("Conjugate gradient iteration", this, iter);
+
     if(iter>0)
       {
       R_kPlusOne = GetR_kPlusOne_Filter->GetOutput();
@@ -155,6 +206,8 @@ void ConjugateGradientImageFilter<OutputImageType>
       GetR_kPlusOne_Filter->SetRk(R_kPlusOne);
       GetR_kPlusOne_Filter->SetPk(P_kPlusOne);
       GetR_kPlusOne_Filter->SetAPk(m_A->GetOutput());
+      if(m_Preconditioner.IsNotNull())
+        GetR_kPlusOne_Filter->SetZk(Z_kPlusOne);
 
       GetP_kPlusOne_Filter->SetRk(R_kPlusOne);
       GetP_kPlusOne_Filter->SetPk(P_kPlusOne);
@@ -163,6 +216,7 @@ void ConjugateGradientImageFilter<OutputImageType>
       GetX_kPlusOne_Filter->SetPk(P_kPlusOne);
       GetX_kPlusOne_Filter->SetXk(X_kPlusOne);
 
+      R_zero->ReleaseData();
       P_zero->ReleaseData();
       }
 
@@ -170,15 +224,42 @@ void ConjugateGradientImageFilter<OutputImageType>
     GetR_kPlusOne_Filter->Update();
     GetX_kPlusOne_Filter->SetAlphak(GetR_kPlusOne_Filter->GetAlphak());
     GetX_kPlusOne_Filter->Update();
-    GetP_kPlusOne_Filter->SetSquaredNormR_k(GetR_kPlusOne_Filter->GetSquaredNormR_k());
-    GetP_kPlusOne_Filter->SetSquaredNormR_kPlusOne(GetR_kPlusOne_Filter->GetSquaredNormR_kPlusOne());
+    if(m_Preconditioner.IsNotNull())
+      {
+      // P_k+1 = Z_k+1 + beta_k P_k with beta_k = R_k+1^T Z_k+1 / R_k^T Z_k
+      Z_kPlusOne = this->ApplyPreconditioner(GetR_kPlusOne_Filter->GetOutput());
+      GetP_kPlusOne_Filter->SetR_kPlusOne(Z_kPlusOne);
+      GetP_kPlusOne_Filter->SetSquaredNormR_k(GetR_kPlusOne_Filter->GetRktZk());
+      GetP_kPlusOne_Filter->SetSquaredNormR_kPlusOne(this->InnerProduct(GetR_kPlusOne_Filter->GetOutput(), Z_kPlusOne));
+      }
+    else
+      {
+      GetP_kPlusOne_Filter->SetSquaredNormR_k(GetR_kPlusOne_Filter->GetSquaredNormR_k());
+      GetP_kPlusOne_Filter->SetSquaredNormR_kPlusOne(GetR_kPlusOne_Filter->GetSquaredNormR_kPlusOne());
+      }
     GetP_kPlusOne_Filter->Update();
+
+    // Monitor the convergence. At the first iteration, R_k is R_zero.
+    if(iter==0)
+      squaredNormR_zero = GetR_kPlusOne_Filter->GetSquaredNormR_k();
+    CGTimeProbe.Stop();
+    m_ResidualNorms.push_back( (squaredNormR_zero>0.)?
+                               sqrt(GetR_kPlusOne_Filter->GetSquaredNormR_kPlusOne()/squaredNormR_zero):0. );
+    m_ElapsedTimes.push_back( CGTimeProbe.GetTotal() );
+    CGTimeProbe.Start();
+    this->InvokeEvent( itk::IterationEvent() );
+
+    if(m_ResidualNorms.back() <= m_Tolerance)
+      {
+      iter++;
+      break;
+      }
     }
 
   this->GraftOutput(GetX_kPlusOne_Filter->GetOutput());
 
   // Release the data from internal filters
-  if (m_NumberOfIterations > 1)
+  if (iter > 1)
     {
     R_kPlusOne->ReleaseData();
     P_kPlusOne->ReleaseData();
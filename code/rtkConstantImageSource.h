@@ -40,7 +40,7 @@ namespace rtk
  * rtkrampfiltertest.cxx, rtkamsterdamshroudtest.cxx,
  * rtkdrawgeometricphantomtest.cxx, rtkmotioncompensatedfdktest.cxx,
  * rtkfovtest.cxx, rtkforwardprojectiontest.cxx, rtkdisplaceddetectortest.cxx,
- * rtkshortscantest.cxx
+ * rtkshortscantest.cxx, rtkconstantinputtest.cxx
  *
  * \author Simon Rit
  *
@@ -110,8 +110,15 @@ public:
   itkSetMacro(Constant, OutputImagePixelType);
   itkGetConstMacro(Constant, OutputImagePixelType);
 
-  /** Set output image information from an existing image */
-  void SetInformationFromImage(const typename TOutputImage::Superclass* image);
+  /** Set output image information from an existing image, possibly with a
+   * different pixel type */
+  void SetInformationFromImage(const itk::ImageBase<TOutputImage::ImageDimension>* image);
+
+  /** Returns true if image is the output of a ConstantImageSource, in which
+   * case constant is set to the value of its pixels. Filters which only need
+   * this value, e.g., projectors accumulating in a constant image, can then
+   * request a single pixel of the image instead of the whole constant image. */
+  static bool IsConstantImage(const TOutputImage *image, OutputImagePixelType &constant);
 
 protected:
   ConstantImageSource();
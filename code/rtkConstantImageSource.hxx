@@ -49,6 +49,20 @@ ConstantImageSource<TOutputImage>
 {
 }
 
+template <class TOutputImage>
+bool
+ConstantImageSource<TOutputImage>
+::IsConstantImage(const TOutputImage *image, OutputImagePixelType &constant)
+{
+  if(!image)
+    return false;
+  Self *source = dynamic_cast<Self *>( image->GetSource().GetPointer() );
+  if(!source || source->GetOutput() != image)
+    return false;
+  constant = source->GetConstant();
+  return true;
+}
+
 template <class TOutputImage>
 void
 ConstantImageSource<TOutputImage>
@@ -116,7 +130,7 @@ ConstantImageSource<TOutputImage>
 template <class TOutputImage>
 void
 ConstantImageSource<TOutputImage>
-::SetInformationFromImage(const typename TOutputImage::Superclass* image)
+::SetInformationFromImage(const itk::ImageBase<TOutputImage::ImageDimension>* image)
 {
   this->SetSize( image->GetLargestPossibleRegion().GetSize() );
   this->SetIndex( image->GetLargestPossibleRegion().GetIndex() );
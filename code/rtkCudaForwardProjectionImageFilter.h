@@ -79,6 +79,9 @@ protected:
 
   virtual void GPUGenerateData();
 
+  /** The kernel reads the whole input 0 on the GPU */
+  virtual bool IsInputConstant(typename TInputImage::PixelType &) const { return false; }
+
 private:
   //purposely not implemented
   CudaForwardProjectionImageFilter(const Self&);
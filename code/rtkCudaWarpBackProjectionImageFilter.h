@@ -85,6 +85,9 @@ protected:
 
   virtual void GPUGenerateData();
 
+  /** The kernel reads the whole input 0 on the GPU */
+  virtual bool IsInputConstant(float &) const { return false; }
+
 private:
   CudaWarpBackProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);                   //purposely not implemented
@@ -85,6 +85,9 @@ protected:
   
   virtual void GPUGenerateData();
 
+  /** The kernel reads the whole input 0 on the GPU */
+  virtual bool IsInputConstant(float &) const { return false; }
+
 private:
   //purposely not implemented
   CudaWarpForwardProjectionImageFilter(const Self&);
@@ -38,22 +38,26 @@ namespace rtk
  * This cyclic deformation model has been described in [Rit et al, TMI, 2009] and
  * [Rit et al, Med Phys, 2009].
  *
+ * The 4D DVF can be stored with a lower precision than the output 3D DVF, e.g.
+ * with rtk::Half components, by setting TInputImage. The interpolation is
+ * computed in the precision of the output.
+ *
  * \test rtkmotioncompensatedfdktest.cxx
  *
  * \author Simon Rit
  *
  * \ingroup ImageToImageFilter
  */
-template <class TOutputImage>
+template <class TOutputImage,
+          class TInputImage=itk::Image<typename TOutputImage::PixelType,
+                                       TOutputImage::ImageDimension+1> >
 class ITK_EXPORT CyclicDeformationImageFilter:
-  public itk::ImageToImageFilter<itk::Image<typename TOutputImage::PixelType,
-                                            TOutputImage::ImageDimension+1>,
-                                 TOutputImage >
+  public itk::ImageToImageFilter<TInputImage, TOutputImage>
 {
 public:
   /** Standard class typedefs. */
   typedef CyclicDeformationImageFilter                                                 Self;
-  typedef itk::Image<typename TOutputImage::PixelType, TOutputImage::ImageDimension+1> InputImageType;
+  typedef TInputImage                                                                  InputImageType;
   typedef TOutputImage                                                                 OutputImageType;
   typedef itk::ImageToImageFilter<InputImageType, OutputImageType>                     Superclass;
   typedef itk::SmartPointer<Self>                                                      Pointer;
@@ -27,9 +27,9 @@
 namespace rtk
 {
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::GenerateOutputInformation()
 {
   typename OutputImageType::PointType   origin;
@@ -47,9 +47,9 @@ CyclicDeformationImageFilter<TOutputImage>
   this->GetOutput()->SetLargestPossibleRegion( region );
 }
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::GenerateInputRequestedRegion()
 {
   typename InputImageType::Pointer inputPtr = const_cast< InputImageType * >( this->GetInput() );
@@ -58,9 +58,9 @@ CyclicDeformationImageFilter<TOutputImage>
   inputPtr->SetRequestedRegion( inputPtr->GetLargestPossibleRegion() );
 }
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::BeforeThreadedGenerateData()
 {
   unsigned int nframe = this->GetInput()->GetLargestPossibleRegion().GetSize(OutputImageType::ImageDimension);
@@ -86,9 +86,9 @@ CyclicDeformationImageFilter<TOutputImage>
   m_FrameSup = m_FrameSup % nframe;
 }
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType itkNotUsed(threadId) )
 {
@@ -109,20 +109,23 @@ CyclicDeformationImageFilter<TOutputImage>
   inputRegionForThreadSup.SetIndex(OutputImageType::ImageDimension, m_FrameSup);
   typename itk::ImageRegionConstIterator<InputImageType> itSup(this->GetInput(), inputRegionForThreadSup);
 
-  // Output iterator
+  // Output iterator, the input pixels are converted to the output pixel type
+  // before the interpolation
+  typedef typename OutputImageType::PixelType OutputPixelType;
   itk::ImageRegionIterator<OutputImageType> itOut(this->GetOutput(), outputRegionForThread);
   while( !itOut.IsAtEnd() )
     {
-    itOut.Set(itInf.Get()*m_WeightInf + itSup.Get()*m_WeightSup);
+    itOut.Set(static_cast<OutputPixelType>(itInf.Get())*m_WeightInf +
+              static_cast<OutputPixelType>(itSup.Get())*m_WeightSup);
     ++itOut;
     ++itInf;
     ++itSup;
     }
 }
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::SetSignalFilename (const std::string _arg)
 {
   itkDebugMacro("setting SignalFilename to " << _arg);
@@ -146,9 +149,9 @@ CyclicDeformationImageFilter<TOutputImage>
     }
 }
 
-template <class TOutputImage>
+template <class TOutputImage, class TInputImage>
 void
-CyclicDeformationImageFilter<TOutputImage>
+CyclicDeformationImageFilter<TOutputImage, TInputImage>
 ::SetSignalVector (std::vector<double> _arg)
 {
   if ( m_Signal != _arg )
@@ -0,0 +1,94 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkDistanceDrivenBackProjectionImageFilter_h
+#define __rtkDistanceDrivenBackProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkTraceCollector.h"
+
+namespace rtk
+{
+
+/** \class DistanceDrivenBackProjectionImageFilter
+ * \brief Distance-driven back projection.
+ *
+ * Performs a back projection, i.e. smearing of ray value along its path,
+ * with the footprints of the detector pixels of
+ * rtk::DistanceDrivenForwardProjectionImageFilter. The weights are exactly
+ * those of the forward projector so the back projector is its adjoint.
+ *
+ * The computation is multithreaded over slabs of the volume. Each thread
+ * only accumulates in the voxels of its slab, which avoids concurrent writes
+ * in the same voxel, and only processes the pixels in the shadow of its slab,
+ * see BackProjectionImageFilter::GetSlabShadow.
+ *
+ * \test rtkdistancedrivenprojectorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT DistanceDrivenBackProjectionImageFilter :
+  public BackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef DistanceDrivenBackProjectionImageFilter                Self;
+  typedef BackProjectionImageFilter<TInputImage,TOutputImage>    Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef rtk::ThreeDCircularProjectionGeometry                  GeometryType;
+  typedef typename GeometryType::Pointer                         GeometryPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DistanceDrivenBackProjectionImageFilter, BackProjectionImageFilter);
+
+protected:
+  DistanceDrivenBackProjectionImageFilter() {}
+  virtual ~DistanceDrivenBackProjectionImageFilter() {}
+
+  /** Checks the geometry. */
+  virtual void BeforeThreadedGenerateData();
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId );
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  virtual void VerifyInputInformation() {}
+
+private:
+  DistanceDrivenBackProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                          //purposely not implemented
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkDistanceDrivenBackProjectionImageFilter.hxx"
+#endif
+
+#endif
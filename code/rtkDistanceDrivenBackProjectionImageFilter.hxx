@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkDistanceDrivenBackProjectionImageFilter_hxx
+#define __rtkDistanceDrivenBackProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkDistanceDrivenFootprint.h"
+#include "rtkSiddonRayTracing.h"
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+DistanceDrivenBackProjectionImageFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if( !dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer()) )
+    {
+    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+DistanceDrivenBackProjectionImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  const OutputImageRegionType outRegion = this->GetOutput()->GetBufferedRegion();
+  GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
+  int offsets[3];
+  offsets[0] = 1;
+  offsets[1] = outRegion.GetSize()[0];
+  offsets[2] = outRegion.GetSize()[0] * outRegion.GetSize()[1];
+
+  // Initialize output region with input region in case the filter is not in
+  // place
+  this->InitializeOutputRegion(outputRegionForThread);
+
+  // beginBuffer is pointing at point with index (0,0,0) in memory, even if
+  // it is not in the allocated memory
+  OutputPixelType *beginBuffer =
+      this->GetOutput()->GetBufferPointer() -
+      offsets[0] * outRegion.GetIndex()[0] -
+      offsets[1] * outRegion.GetIndex()[1] -
+      offsets[2] * outRegion.GetIndex()[2];
+
+  // Only the voxels of the slab of the thread are updated
+  int regionMin[3], regionMax[3];
+  double boxMin[3], boxMax[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    regionMin[i] = outputRegionForThread.GetIndex()[i];
+    regionMax[i] = outputRegionForThread.GetIndex()[i] + outputRegionForThread.GetSize()[i] - 1;
+    boxMin[i] = regionMin[i] - 0.5;
+    boxMax[i] = regionMax[i] + 0.5;
+    }
+
+  // Layout of the projections buffer
+  const InputPixelType *projBuffer = this->GetInput(1)->GetBufferPointer();
+  const int projOffset1 = buffReg.GetSize(0);
+  const int projOffset2 = buffReg.GetSize(0) * buffReg.GetSize(1);
+
+  // Go over each projection
+  for(int iProj=buffReg.GetIndex(2);
+          iProj<buffReg.GetIndex(2)+(int)buffReg.GetSize(2);
+          iProj++)
+    {
+    // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+    // corresponding 3D volume index
+    typename GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+    volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetOutput() );
+
+    // Source position in mm and in volume indices
+    typename GeometryType::HomogeneousVectorType sourceMM, sourcePosition;
+    sourceMM = geometry->GetSourcePosition(iProj);
+    sourcePosition = volPPToIndex * sourceMM;
+
+    // Matrices from the projection index to the physical coordinates in mm
+    // and to the volume index
+    typename GeometryType::ThreeDHomogeneousMatrixType matrixMM, matrix;
+    matrixMM = geometry->GetProjectionCoordinatesToFixedSystemMatrix(iProj).GetVnlMatrix() *
+               GetIndexToPhysicalPointMatrix( this->GetInput(1) ).GetVnlMatrix();
+    matrix = volPPToIndex.GetVnlMatrix() * matrixMM.GetVnlMatrix();
+
+    double source[3], dirVox[3], edgeU[3], edgeV[3];
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      source[i] = sourcePosition[i];
+      edgeU[i] = matrix[i][0];
+      edgeV[i] = matrix[i][1];
+      }
+
+    // Only the pixels in the shadow of the slab of the thread overlap voxels
+    // of the slab
+    int pixMin[2], pixMax[2];
+    this->GetSlabShadow(iProj, boxMin, boxMax, pixMin, pixMax);
+
+    // Go over each pixel of the shadow
+    typename TInputImage::IndexType index;
+    index[2] = iProj;
+    for(index[1]=pixMin[1]; index[1]<=pixMax[1]; index[1]++)
+      for(index[0]=pixMin[0]; index[0]<=pixMax[0]; index[0]++)
+      {
+      const InputPixelType value = projBuffer[ (index[0]-buffReg.GetIndex(0)) +
+                                               (index[1]-buffReg.GetIndex(1)) * projOffset1 +
+                                               (index[2]-buffReg.GetIndex(2)) * projOffset2 ];
+      if(value == 0)
+        continue;
+
+      // Ray direction in volume indices and length in mm
+      double rayLength = 0.;
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        dirVox[i] = matrix[i][Dimension];
+        double pixelMM = matrixMM[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          {
+          dirVox[i] += matrix[i][j] * index[j];
+          pixelMM += matrixMM[i][j] * index[j];
+          }
+        dirVox[i] -= source[i];
+        rayLength += (pixelMM - sourceMM[i]) * (pixelMM - sourceMM[i]);
+        }
+      rayLength = sqrt(rayLength);
+
+      Functor::SiddonRaySplat<OutputPixelType> splat(beginBuffer, value);
+      DistanceDrivenRayTraversal(source, dirVox, edgeU, edgeV,
+                                 regionMin, regionMax, offsets, rayLength, splat);
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
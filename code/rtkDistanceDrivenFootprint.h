@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkDistanceDrivenFootprint_h
+#define __rtkDistanceDrivenFootprint_h
+
+#include <algorithm>
+#include <cmath>
+
+namespace rtk
+{
+
+//--------------------------------------------------------------------
+/** \brief Overlap of the interval [lower,upper] with the voxel [i-0.5,i+0.5]
+ * normalized by the width of the interval.
+ *
+ * \ingroup Functions
+ */
+inline double
+DistanceDrivenOverlap(const double lower, const double upper, const int i)
+{
+  const double overlap = std::min(upper, i + 0.5) - std::max(lower, i - 0.5);
+  return (overlap>0.)?overlap/(upper-lower):0.;
+}
+
+//--------------------------------------------------------------------
+/** \brief Traversal of the voxels overlapped by a detector pixel with the
+ * distance-driven method.
+ *
+ * Implements the distance-driven projection [De Man and Basu, Phys Med Biol,
+ * 2004] of the pixel of a cone-beam projection. The volume is processed slice
+ * by slice along the main direction of the ray. The boundaries of the pixel,
+ * i.e., the rays from the source through the middles of its four edges, are
+ * mapped onto each slice where they are compared with the boundaries of the
+ * voxels. As in the original method, the kernel is separable: the two
+ * boundaries along the u axis of the detector are mapped along the axis of
+ * the slice where they are the furthest apart, the two boundaries along v
+ * along the other axis. The weight of a voxel is the product of the overlaps
+ * of the mapped pixel with the voxel along the two axes of the slice,
+ * normalized by the widths of the mapped pixel, times the length of the ray
+ * between two slices in mm.
+ *
+ * The original method sweeps the sorted boundaries of a row of pixels and of
+ * a row of voxels. The overlaps are computed here pixel by pixel, which gives
+ * the same weights and lets the forward projector be multithreaded over the
+ * pixels. The main direction is chosen for each ray instead of each
+ * projection.
+ *
+ * The source, the direction of the ray to the pixel center, the directions
+ * of the pixel edges (i.e., the increments of the ray direction per pixel
+ * along the two axes of the detector) and the region are in voxel indices.
+ * The volume is traversed for the alpha parameters of the ray in [0,1], i.e.,
+ * between the source and the pixel, and only the voxels of
+ * [regionMin,regionMax] are visited. visitor(offset, weight) is called for
+ * each voxel where offset is the memory offset of the voxel from index (0,0,0)
+ * given the offsets of the three dimensions, see SiddonRayTraversal.
+ *
+ * \ingroup Functions
+ */
+template <class TVisitor>
+inline void
+DistanceDrivenRayTraversal(const double source[3],
+                           const double direction[3],
+                           const double edgeU[3],
+                           const double edgeV[3],
+                           const int regionMin[3],
+                           const int regionMax[3],
+                           const int offsets[3],
+                           const double rayLength,
+                           TVisitor &visitor)
+{
+  // Main direction and the two others
+  unsigned int mainDir = 0;
+  for(unsigned int i=1; i<3; i++)
+    if(std::abs(direction[i]) > std::abs(direction[mainDir]))
+      mainDir = i;
+  if(direction[mainDir] == 0.)
+    return;
+  const unsigned int dirX = (mainDir+1)%3;
+  const unsigned int dirY = (mainDir+2)%3;
+
+  // Slopes of the boundaries of the pixel: boundary b crosses slice k at
+  // source[d] + (k-source[mainDir]) * slope[b][d] along direction d. The
+  // boundaries 0 and 1 are along u, 2 and 3 along v.
+  double slope[4][3];
+  for(unsigned int b=0; b<4; b++)
+    {
+    const double *edge = (b<2)?edgeU:edgeV;
+    const double sign = (b%2)?0.5:-0.5;
+    double boundary[3];
+    for(unsigned int i=0; i<3; i++)
+      boundary[i] = direction[i] + sign * edge[i];
+
+    // A boundary parallel to the slices or on the other side of the source
+    // only occurs for pixels seen at grazing incidence which are ignored
+    if(boundary[mainDir] * direction[mainDir] <= 0.)
+      return;
+    for(unsigned int i=0; i<3; i++)
+      slope[b][i] = boundary[i] / boundary[mainDir];
+    }
+
+  // Pairing of the axes of the detector with the axes of the slices
+  const double spreadUX = std::abs(slope[1][dirX] - slope[0][dirX]);
+  const double spreadUY = std::abs(slope[1][dirY] - slope[0][dirY]);
+  const double spreadVX = std::abs(slope[3][dirX] - slope[2][dirX]);
+  const double spreadVY = std::abs(slope[3][dirY] - slope[2][dirY]);
+  const unsigned int bx = (spreadUX + spreadVY >= spreadUY + spreadVX)?0:2;
+  const unsigned int by = 2 - bx;
+
+  // Slices of the main direction between the source and the pixel
+  const double invMain = 1. / direction[mainDir];
+  const double end = source[mainDir] + direction[mainDir];
+  int firstSlice = (int)std::ceil( std::min(source[mainDir], end) );
+  int lastSlice = (int)std::floor( std::max(source[mainDir], end) );
+  firstSlice = std::max(firstSlice, regionMin[mainDir]);
+  lastSlice = std::min(lastSlice, regionMax[mainDir]);
+
+  // Length of the ray between two slices in mm
+  const double step = rayLength * std::abs(invMain);
+
+  for(int k=firstSlice; k<=lastSlice; k++)
+    {
+    // Boundaries of the pixel mapped onto the slice. The mapped pixel has at
+    // least a tiny width near the source.
+    const double t = k - source[mainDir];
+    const double x0 = source[dirX] + t * slope[bx][dirX];
+    const double x1 = source[dirX] + t * slope[bx+1][dirX];
+    const double y0 = source[dirY] + t * slope[by][dirY];
+    const double y1 = source[dirY] + t * slope[by+1][dirY];
+    const double cx = 0.5 * (x0 + x1);
+    const double cy = 0.5 * (y0 + y1);
+    const double hx = std::max(0.5 * std::abs(x1 - x0), 1e-6);
+    const double hy = std::max(0.5 * std::abs(y1 - y0), 1e-6);
+
+    const int ixMin = std::max( regionMin[dirX], (int)std::floor(cx - hx + 0.5) );
+    const int ixMax = std::min( regionMax[dirX], (int)std::floor(cx + hx + 0.5) );
+    const int iyMin = std::max( regionMin[dirY], (int)std::floor(cy - hy + 0.5) );
+    const int iyMax = std::min( regionMax[dirY], (int)std::floor(cy + hy + 0.5) );
+    if(ixMin>ixMax || iyMin>iyMax)
+      continue;
+
+    const int offsetSlice = k * offsets[mainDir];
+    for(int iy=iyMin; iy<=iyMax; iy++)
+      {
+      const double wy = step * DistanceDrivenOverlap(cy - hy, cy + hy, iy);
+      if(wy == 0.)
+        continue;
+      const int offsetRow = offsetSlice + iy * offsets[dirY];
+      for(int ix=ixMin; ix<=ixMax; ix++)
+        {
+        const double w = wy * DistanceDrivenOverlap(cx - hx, cx + hx, ix);
+        if(w != 0.)
+          visitor(offsetRow + ix * offsets[dirX], w);
+        }
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif // __rtkDistanceDrivenFootprint_h
@@ -0,0 +1,90 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkDistanceDrivenForwardProjectionImageFilter_h
+#define __rtkDistanceDrivenForwardProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkForwardProjectionImageFilter.h"
+#include "rtkMacro.h"
+#include "rtkTraceCollector.h"
+
+namespace rtk
+{
+
+/** \class DistanceDrivenForwardProjectionImageFilter
+ * \brief Distance-driven forward projection.
+ *
+ * Performs a forward projection, i.e. accumulation along x-ray lines, where
+ * the boundaries of each detector pixel are mapped onto each slice of the
+ * volume along the main direction of the ray and compared with the
+ * boundaries of the voxels [De Man and Basu, Phys Med Biol, 2004], see
+ * DistanceDrivenRayTraversal. Contrary to the ray based projectors, the whole
+ * detector pixel is accounted for, which reduces aliasing when the voxels are
+ * small compared to the magnified pixels. The adjoint operator is
+ * rtk::DistanceDrivenBackProjectionImageFilter.
+ *
+ * The computation is multithreaded over the projections.
+ *
+ * \test rtkdistancedrivenprojectorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT DistanceDrivenForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef DistanceDrivenForwardProjectionImageFilter             Self;
+  typedef ForwardProjectionImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DistanceDrivenForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+protected:
+  DistanceDrivenForwardProjectionImageFilter() {}
+  virtual ~DistanceDrivenForwardProjectionImageFilter() {}
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  virtual void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  DistanceDrivenForwardProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                             //purposely not implemented
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkDistanceDrivenForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
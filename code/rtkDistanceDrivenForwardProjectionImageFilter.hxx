@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkDistanceDrivenForwardProjectionImageFilter_hxx
+#define __rtkDistanceDrivenForwardProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkDistanceDrivenFootprint.h"
+#include "rtkSiddonRayTracing.h"
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+void
+DistanceDrivenForwardProjectionImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const unsigned int nPixelPerProj = outputRegionForThread.GetSize(0)*outputRegionForThread.GetSize(1);
+  const typename TInputImage::RegionType volRegion = this->GetInput(1)->GetBufferedRegion();
+  const typename Superclass::GeometryType::Pointer geometry = this->GetGeometry();
+  int offsets[3];
+  offsets[0] = 1;
+  offsets[1] = volRegion.GetSize()[0];
+  offsets[2] = volRegion.GetSize()[0] * volRegion.GetSize()[1];
+
+  // beginBuffer is pointing at point with index (0,0,0) in memory, even if
+  // it is not in the allocated memory
+  const InputPixelType *beginBuffer =
+      this->GetInput(1)->GetBufferPointer() -
+      offsets[0] * volRegion.GetIndex()[0] -
+      offsets[1] * volRegion.GetIndex()[1] -
+      offsets[2] * volRegion.GetIndex()[2];
+
+  int regionMin[3], regionMax[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    regionMin[i] = volRegion.GetIndex()[i];
+    regionMax[i] = volRegion.GetIndex()[i] + volRegion.GetSize()[i] - 1;
+    }
+
+  // Iterators on input and output projections
+  typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
+  InputRegionIterator itIn(this->InitializeAccumulation(outputRegionForThread), outputRegionForThread);
+  typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
+  OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
+
+  // Go over each projection
+  for(int iProj=outputRegionForThread.GetIndex(2);
+          iProj<outputRegionForThread.GetIndex(2)+(int)outputRegionForThread.GetSize(2);
+          iProj++)
+    {
+    // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+    // corresponding 3D volume index
+    typename Superclass::GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+    volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetInput(1) );
+
+    // Source position in mm and in volume indices
+    typename Superclass::GeometryType::HomogeneousVectorType sourceMM, sourcePosition;
+    sourceMM = geometry->GetSourcePosition(iProj);
+    sourcePosition = volPPToIndex * sourceMM;
+
+    // Matrices from the projection index to the physical coordinates in mm
+    // and to the volume index
+    typename Superclass::GeometryType::ThreeDHomogeneousMatrixType matrixMM, matrix;
+    matrixMM = geometry->GetProjectionCoordinatesToFixedSystemMatrix(iProj).GetVnlMatrix() *
+               GetIndexToPhysicalPointMatrix( this->GetInput() ).GetVnlMatrix();
+    matrix = volPPToIndex.GetVnlMatrix() * matrixMM.GetVnlMatrix();
+
+    // The edges of the pixels are the same for all pixels of the projection
+    double source[3], dirVox[3], edgeU[3], edgeV[3];
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      source[i] = sourcePosition[i];
+      edgeU[i] = matrix[i][0];
+      edgeV[i] = matrix[i][1];
+      }
+
+    // Go over each pixel of the projection
+    for(unsigned int pix=0; pix<nPixelPerProj; pix++, ++itIn, ++itOut)
+      {
+      const typename TOutputImage::IndexType index = itOut.GetIndex();
+
+      // Ray direction in volume indices and length in mm
+      double rayLength = 0.;
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        dirVox[i] = matrix[i][Dimension];
+        double pixelMM = matrixMM[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          {
+          dirVox[i] += matrix[i][j] * index[j];
+          pixelMM += matrixMM[i][j] * index[j];
+          }
+        dirVox[i] -= source[i];
+        rayLength += (pixelMM - sourceMM[i]) * (pixelMM - sourceMM[i]);
+        }
+      rayLength = sqrt(rayLength);
+
+      Functor::SiddonRayAccumulation<InputPixelType> accumulation(beginBuffer);
+      DistanceDrivenRayTraversal(source, dirVox, edgeU, edgeV,
+                                 regionMin, regionMax, offsets, rayLength, accumulation);
+      itOut.Set( itIn.Get() + accumulation.GetSum() );
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
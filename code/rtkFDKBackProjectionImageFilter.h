@@ -20,6 +20,7 @@
 #define __rtkFDKBackProjectionImageFilter_h
 
 #include "rtkBackProjectionImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -36,6 +36,8 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType itkNotUsed(threadId) )
 {
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nProj = this->GetInput(1)->GetLargestPossibleRegion().GetSize(Dimension-1);
   const unsigned int iFirstProj = this->GetInput(1)->GetLargestPossibleRegion().GetIndex(Dimension-1);
@@ -44,24 +46,13 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
   typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
   typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
 
-  // Iterators on volume input and output
-  typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  // Iterator on volume output
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    itIn.GoToBegin();
-    while(!itIn.IsAtEnd() )
-      {
-      itOut.Set(itIn.Get() );
-      ++itIn;
-      ++itOut;
-      }
-    }
+  this->InitializeOutputRegion(outputRegionForThread);
 
   // Rotation center (assumed to be at 0 yet)
   typename TInputImage::PointType rotCenterPoint;
@@ -100,32 +91,48 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
       continue;
       }
 
-    // Go over each voxel
+    // Go over each line of voxels along x, cropped to the field of view
     itOut.GoToBegin();
     while(!itOut.IsAtEnd() )
       {
-      // Compute projection index
-      for(unsigned int i=0; i<Dimension-1; i++)
+      typename TOutputImage::IndexType lineIndex = itOut.GetIndex();
+      int first = lineIndex[0];
+      int last = first + (int)outputRegionForThread.GetSize(0);
+      this->CropToFieldOfViewX(lineIndex[1], lineIndex[2], first, last);
+      lineIndex[0] = first;
+      itOut.SetIndex(lineIndex);
+
+      // Go over each voxel of the line
+      for(int n=first; n<last; n++)
         {
-        pointProj[i] = matrix[i][Dimension];
+        // Compute projection index
+        for(unsigned int i=0; i<Dimension-1; i++)
+          {
+          pointProj[i] = matrix[i][Dimension];
+          for(unsigned int j=0; j<Dimension; j++)
+            pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
+          }
+
+        // Apply perspective
+        double perspFactor = matrix[Dimension-1][Dimension];
         for(unsigned int j=0; j<Dimension; j++)
-          pointProj[i] += matrix[i][j] * itOut.GetIndex()[j];
-        }
+          perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
+        perspFactor = 1/perspFactor;
+        for(unsigned int i=0; i<Dimension-1; i++)
+          pointProj[i] = pointProj[i]*perspFactor;
 
-      // Apply perspective
-      double perspFactor = matrix[Dimension-1][Dimension];
-      for(unsigned int j=0; j<Dimension; j++)
-        perspFactor += matrix[Dimension-1][j] * itOut.GetIndex()[j];
-      perspFactor = 1/perspFactor;
-      for(unsigned int i=0; i<Dimension-1; i++)
-        pointProj[i] = pointProj[i]*perspFactor;
+        // Interpolate if in projection
+        if( interpolator->IsInsideBuffer(pointProj) )
+          {
+          itOut.Set( itOut.Get() + perspFactor*perspFactor*interpolator->EvaluateAtContinuousIndex(pointProj) );
+          }
 
-      // Interpolate if in projection
-      if( interpolator->IsInsideBuffer(pointProj) )
-        {
-        itOut.Set( itOut.Get() + perspFactor*perspFactor*interpolator->EvaluateAtContinuousIndex(pointProj) );
+        ++itOut;
         }
 
+      // Go to the next line
+      lineIndex[0] = outputRegionForThread.GetIndex(0) + outputRegionForThread.GetSize(0) - 1;
+      itOut.SetIndex(lineIndex);
       ++itOut;
       }
     }
@@ -182,23 +189,29 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
         {
 #endif
 
+        // Voxels of the line in the field of view which project on the detector
+        int first = i;
+        int last = i + (int)region.GetSize(0);
+        this->CropToFieldOfViewX(j, k, first, last);
+#ifdef BILINEAR_BACKPROJECTION
+        this->CropToDetector(i, u, du, pSize[0]-1, first, last);
+#endif
+
         pProj = projection->GetBufferPointer() + vi * pSize[0];
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
+        pVol = pVolZeroPointer + first + vBufferSize[0] * (j + k * vBufferSize[1] );
 
         // Innermost loop
-        for(; i<(region.GetIndex(0) + (int)region.GetSize(0)); i++, u += du, pVol++)
+        for(int n=first; n<last; n++, pVol++)
           {
+          const double un = u + du * (n-i);
 #ifdef BILINEAR_BACKPROJECTION
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += w * (v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
-                          v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) ) );
-            }
+          ui = vnl_math_floor(un);
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += w * (v2 * (u2 * *(pProj+ui)          + u1 * *(pProj+ui+1) ) +
+                        v1 * (u2 * *(pProj+ui+pSize[0]) + u1 * *(pProj+ui+pSize[0]+1) ) );
 #else
-          ui = itk::Math::Round<double>(u);
+          ui = itk::Math::Round<double>(un);
           if(ui>=0 && ui<(int)pSize[0])
             {
             *pVol += w * *(pProj+ui);
@@ -257,24 +270,30 @@ FDKBackProjectionImageFilter<TInputImage,TOutputImage>
       if(vi>=0 && vi<(int)pSize[1])
         {
 #endif
-        pVol = pVolZeroPointer + i + vBufferSize[0] * (j + k * vBufferSize[1] );
-        for(; j<(region.GetIndex(1) + (int)region.GetSize(1)); j++, pVol += vBufferSize[0], u += du)
+        // Voxels of the line in the field of view which project on the detector
+        int first = j;
+        int last = j + (int)region.GetSize(1);
+        this->CropToFieldOfViewY(i, k, first, last);
+#ifdef BILINEAR_BACKPROJECTION
+        this->CropToDetector(j, u, du, pSize[0]-1, first, last);
+        const double v1 = v-vi;
+        const double v2 = 1.0-v1;
+#endif
+
+        pVol = pVolZeroPointer + i + vBufferSize[0] * (first + k * vBufferSize[1] );
+        for(int n=first; n<last; n++, pVol += vBufferSize[0])
           {
+          const double un = u + du * (n-j);
 #ifdef BILINEAR_BACKPROJECTION
-          ui = vnl_math_floor(u);
-          if(ui>=0 && ui<(int)pSize[0]-1)
-            {
-            double u1, u2, v1, v2;
-            pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
-            v1 = v-vi;
-            v2 = 1.0-v1;
-            u1 = u-ui;
-            u2 = 1.0-u1;
-            *pVol += w * (v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
-                          v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) ) );
-            }
+          double u1, u2;
+          ui = vnl_math_floor(un);
+          pProj = projection->GetBufferPointer() + vi * pSize[0] + ui;
+          u1 = un-ui;
+          u2 = 1.0-u1;
+          *pVol += w * (v2 * (u2 * *(pProj)          + u1 * *(pProj+1) ) +
+                        v1 * (u2 * *(pProj+pSize[0]) + u1 * *(pProj+pSize[0]+1) ) );
 #else
-          ui = itk::Math::Round<double>(u);
+          ui = itk::Math::Round<double>(un);
           if(ui>=0 && ui<(int)pSize[0])
             {
             pProj = projection->GetBufferPointer() + vi * pSize[0];
@@ -22,6 +22,8 @@
 #include "rtkFDKWeightProjectionFilter.h"
 #include "rtkFFTRampImageFilter.h"
 #include "rtkFDKBackProjectionImageFilter.h"
+#include "rtkThreadPoolImageFilter.h"
+#include "rtkTuningCache.h"
 #include "rtkConfiguration.h"
 
 #include <itkExtractImageFilter.h>
@@ -42,6 +44,13 @@ namespace rtk
  * controlled with ProjectionSubsetSize) via the use of itk::ExtractImageFilter
  * to extract sub-stacks.
  *
+ * The best ProjectionSubsetSize, multithreading strategy of the FFTs of the
+ * ramp filter (see FFTConvolutionImageFilter::SetFFTThreading) and
+ * BackProjectionBlockSize depend on the hardware and on the size of the
+ * problem. If AutoTuning is on, they are selected at the beginning of
+ * GenerateData with short calibration passes on the first projections and
+ * optionally stored in a rtk::TuningCache file for the next reconstructions.
+ *
  * \dot
  * digraph FDKConeBeamReconstructionFilter {
  * node [shape=box];
@@ -78,6 +87,7 @@ public:
   /** Typedefs of each subfilter of this composite filter */
   typedef itk::ExtractImageFilter<InputImageType, OutputImageType>                 ExtractFilterType;
   typedef rtk::FDKWeightProjectionFilter<InputImageType, OutputImageType>          WeightFilterType;
+  typedef typename WeightFilterType::Pointer                                       WeightFilterPointer;
   typedef rtk::FFTRampImageFilter<OutputImageType, OutputImageType, TFFTPrecision> RampFilterType;
   typedef rtk::FDKBackProjectionImageFilter<OutputImageType, OutputImageType>      BackProjectionFilterType;
   typedef typename BackProjectionFilterType::Pointer                               BackProjectionFilterPointer;
@@ -95,6 +105,11 @@ public:
   /** Get pointer to the weighting filter used by the feldkamp reconstruction */
   typename WeightFilterType::Pointer GetWeightFilter() { return m_WeightFilter; }
 
+  /** Set the weighting filter, e.g., an rtk::FusedFDKWeightProjectionFilter
+   * to apply the displaced detector and short scan weights with the FDK
+   * weights. The set function takes care of initializing the mini-pipeline. */
+  virtual void SetWeightFilter (const WeightFilterPointer _arg);
+
   /** Get pointer to the ramp filter used by the feldkamp reconstruction */
   typename RampFilterType::Pointer GetRampFilter() { return m_RampFilter; }
 
@@ -111,6 +126,29 @@ public:
   itkGetMacro(BackProjectionFilter, BackProjectionFilterPointer);
   virtual void SetBackProjectionFilter (const BackProjectionFilterPointer _arg);
 
+  /** Get / Set the number of slices of the volume in each piece of the
+   * backprojection, i.e., in each task of the rtk::ThreadPool. The default,
+   * 0, is one piece per thread. It is only used if the backprojection filter
+   * is a ThreadPoolImageFilter and the pool is enabled: other backprojection
+   * filters, e.g., rtk::FDKWarpBackProjectionImageFilter, run one piece per
+   * thread of the itk::MultiThreader. */
+  itkGetMacro(BackProjectionBlockSize, unsigned int);
+  itkSetMacro(BackProjectionBlockSize, unsigned int);
+
+  /** Get / Set whether ProjectionSubsetSize, the FFT threading of the ramp
+   * filter and BackProjectionBlockSize are tuned with calibration passes.
+   * Default is off. The calibration costs about the reconstruction of a few
+   * tens of projections, it is only run once per size of the problem. */
+  itkGetMacro(AutoTuning, bool);
+  itkSetMacro(AutoTuning, bool);
+  itkBooleanMacro(AutoTuning);
+
+  /** Get / Set the rtk::TuningCache file in which the tuned parameters are
+   * read and written. Default is empty, i.e., the parameters are not
+   * stored. */
+  itkGetStringMacro(TuningCacheFileName);
+  itkSetStringMacro(TuningCacheFileName);
+
 protected:
   FDKConeBeamReconstructionFilter();
   ~FDKConeBeamReconstructionFilter(){}
@@ -125,6 +163,20 @@ protected:
    * to verify. */
   virtual void VerifyInputInformation() {}
 
+  /** Reads the tuned parameters in the tuning cache or runs the calibration
+   * passes of AutoTuning. The time per projection is measured for the ramp
+   * filter for each subset size and FFT threading, and for the backprojection
+   * for each block size. */
+  virtual void AutoTune();
+
+  /** Runs the calibration passes and returns the tuned ProjectionSubsetSize,
+   * FFT threading and BackProjectionBlockSize. */
+  virtual TuningCache::ValuesType RunCalibrationPasses();
+
+  /** Returns true if the pieces of the backprojection are the tasks of the
+   * rtk::ThreadPool, i.e., if BackProjectionBlockSize is used. */
+  bool IsBackProjectionOnThreadPool() const;
+
   /** Pointers to each subfilter of this composite filter */
   typename ExtractFilterType::Pointer m_ExtractFilter;
   typename WeightFilterType::Pointer  m_WeightFilter;
@@ -139,7 +191,15 @@ private:
   /** Number of projections processed at a time. */
   unsigned int m_ProjectionSubsetSize;
 
+  /** Autotuning */
+  unsigned int             m_BackProjectionBlockSize;
+  bool                     m_AutoTuning;
+  std::string              m_TuningCacheFileName;
+  std::string              m_TunedKey;
+  TuningCache::ValuesType  m_TunedValues;
+
   /** Probes to time reconstruction */
+  itk::TimeProbe m_AutoTuningProbe;
   itk::TimeProbe m_PreFilterProbe;
   itk::TimeProbe m_FilterProbe;
   itk::TimeProbe m_BackProjectionProbe;
@@ -19,13 +19,21 @@
 #ifndef __rtkFDKConeBeamReconstructionFilter_hxx
 #define __rtkFDKConeBeamReconstructionFilter_hxx
 
+#include "rtkConstantImageSource.h"
+
+#include <itkMath.h>
+
+#include <sstream>
+
 namespace rtk
 {
 
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
 FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
 ::FDKConeBeamReconstructionFilter():
-  m_ProjectionSubsetSize(16)
+  m_ProjectionSubsetSize(16),
+  m_BackProjectionBlockSize(0),
+  m_AutoTuning(false)
 {
   this->SetNumberOfRequiredInputs(2);
 
@@ -33,7 +41,10 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
   m_ExtractFilter = ExtractFilterType::New();
   m_WeightFilter = WeightFilterType::New();
   m_RampFilter = RampFilterType::New();
-  this->SetBackProjectionFilter( BackProjectionFilterType::New() );
+
+  // The back projection runs on the thread pool so that, with pinned workers,
+  // each slab of the volume is always processed by the same processor
+  this->SetBackProjectionFilter( ThreadPoolImageFilter<BackProjectionFilterType>::New().GetPointer() );
 
   //Permanent internal connections
   m_WeightFilter->SetInput( m_ExtractFilter->GetOutput() );
@@ -112,6 +123,20 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
   subsetRegion = this->GetInput(1)->GetLargestPossibleRegion();
   unsigned int nProj = subsetRegion.GetSize( Dimension-1 );
 
+  if(m_AutoTuning)
+    {
+    m_AutoTuningProbe.Start();
+    this->AutoTune();
+    m_AutoTuningProbe.Stop();
+    }
+
+  // Pieces of the backprojection
+  if( m_BackProjectionBlockSize && this->IsBackProjectionOnThreadPool() )
+    {
+    const unsigned int nSlices = this->GetOutput()->GetRequestedRegion().GetSize(Dimension-1);
+    m_BackProjectionFilter->SetNumberOfThreads( (nSlices+m_BackProjectionBlockSize-1) / m_BackProjectionBlockSize );
+    }
+
   for(unsigned int i=0; i<nProj; i+=m_ProjectionSubsetSize)
     {
     // After the first bp update, we need to use its output as input.
@@ -148,6 +173,197 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
   this->GenerateOutputInformation();
 }
 
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::AutoTune()
+{
+  const unsigned int Dimension = this->InputImageDimension;
+  typename ExtractFilterType::InputImageRegionType projRegion;
+  projRegion = this->GetInput(1)->GetLargestPossibleRegion();
+  const typename OutputImageType::RegionType volRegion = this->GetOutput()->GetRequestedRegion();
+  const unsigned int nProj = projRegion.GetSize(Dimension-1);
+
+  // Key of the problem in the tuning cache
+  std::ostringstream problem;
+  problem << this->GetNameOfClass() << '_' << m_BackProjectionFilter->GetNameOfClass()
+          << "_fft" << 8*sizeof(TFFTPrecision)
+          << '_' << projRegion.GetSize(0) << 'x' << projRegion.GetSize(1)
+          << '_' << volRegion.GetSize(0) << 'x' << volRegion.GetSize(1) << 'x' << volRegion.GetSize(2);
+  const std::string key = TuningCache::MakeKey(problem.str(), m_RampFilter->GetNumberOfThreads() );
+  TuningCache::ValuesType values = m_TunedValues;
+  if(key != m_TunedKey)
+    {
+    if( m_TuningCacheFileName.empty() ||
+        !TuningCache::Read(m_TuningCacheFileName, key, values) ||
+        values.size() != 3 )
+      {
+      values = this->RunCalibrationPasses();
+      if( !m_TuningCacheFileName.empty() &&
+          !TuningCache::Write(m_TuningCacheFileName, key, values) )
+        {
+        itkWarningMacro(<< "Could not write the tuning cache " << m_TuningCacheFileName);
+        }
+      }
+    m_TunedKey = key;
+    m_TunedValues = values;
+    }
+
+  // The members are set directly to avoid modifying the filter during its update
+  m_ProjectionSubsetSize = vnl_math_max(1, itk::Math::Round<int>(values[0]) );
+  m_RampFilter->SetFFTThreading( static_cast<typename RampFilterType::FFTThreadingType>(
+                                   itk::Math::Round<int>(values[1]) ) );
+  m_BackProjectionBlockSize = vnl_math_max(0, itk::Math::Round<int>(values[2]) );
+
+  // First subset of projections with the tuned size
+  projRegion.SetSize(Dimension-1, std::min(m_ProjectionSubsetSize, nProj) );
+  m_ExtractFilter->SetExtractionRegion(projRegion);
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+TuningCache::ValuesType
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::RunCalibrationPasses()
+{
+  const unsigned int Dimension = this->InputImageDimension;
+  typename ExtractFilterType::InputImageRegionType subsetRegion;
+  subsetRegion = this->GetInput(1)->GetLargestPossibleRegion();
+  const unsigned int nProj = subsetRegion.GetSize(Dimension-1);
+  const unsigned int nSlices = this->GetOutput()->GetRequestedRegion().GetSize(Dimension-1);
+  const unsigned int nThreads = m_RampFilter->GetNumberOfThreads();
+
+  // Ramp filter: time per projection for each subset size and FFT threading.
+  // The first update computes the kernel and is not timed.
+  std::vector<unsigned int> subsetSizes;
+  const unsigned int maxSubsetSize = std::min(nProj, std::min(64U, std::max(16U, 2*nThreads) ) );
+  for(unsigned int size=1; size<=maxSubsetSize; size*=2)
+    subsetSizes.push_back(size);
+  const typename RampFilterType::FFTThreadingType fftThreadings[2] = { RampFilterType::ONEFFTPERTHREAD,
+                                                                       RampFilterType::MULTITHREADEDFFT };
+  std::vector<double> rampTimes(2*subsetSizes.size());
+  subsetRegion.SetSize(Dimension-1, 1);
+  m_ExtractFilter->SetExtractionRegion(subsetRegion);
+  m_RampFilter->UpdateLargestPossibleRegion();
+  for(unsigned int s=0; s<subsetSizes.size(); s++)
+    {
+    subsetRegion.SetSize(Dimension-1, subsetSizes[s]);
+    m_ExtractFilter->SetExtractionRegion(subsetRegion);
+    m_WeightFilter->UpdateLargestPossibleRegion();
+    for(unsigned int t=0; t<2; t++)
+      {
+      // The ramp filter is executed again without modifying it, which would
+      // recompute its kernel
+      m_RampFilter->SetFFTThreading(fftThreadings[t]);
+      m_WeightFilter->GetOutput()->Modified();
+      itk::TimeProbe probe;
+      probe.Start();
+      m_RampFilter->UpdateLargestPossibleRegion();
+      probe.Stop();
+      rampTimes[2*s+t] = probe.GetTotal() / subsetSizes[s];
+      }
+    }
+
+  // Backprojection of a few projections in a scratch volume: time per
+  // projection for each block size. The first update is not timed.
+  const unsigned int nCalibrationProjections = std::min(nProj, 4U);
+  subsetRegion.SetSize(Dimension-1, nCalibrationProjections);
+  m_ExtractFilter->SetExtractionRegion(subsetRegion);
+  m_RampFilter->UpdateLargestPossibleRegion();
+
+  typedef ConstantImageSource<OutputImageType> ScratchSourceType;
+  typename ScratchSourceType::Pointer scratch = ScratchSourceType::New();
+  scratch->SetInformationFromImage( this->GetInput(0) );
+  m_BackProjectionFilter->SetInput( 0, scratch->GetOutput() );
+  const unsigned int backupNumberOfThreads = m_BackProjectionFilter->GetNumberOfThreads();
+
+  // Block size 0 keeps the number of threads of the backprojection, the
+  // only possibility if its pieces are not tasks of the thread pool
+  std::vector<unsigned int> blockSizes;
+  if( this->IsBackProjectionOnThreadPool() )
+    {
+    for(unsigned int pieces=nThreads; pieces<=8*nThreads; pieces*=2)
+      {
+      const unsigned int blockSize = (nSlices+pieces-1) / pieces;
+      if( blockSizes.empty() || blockSize<blockSizes.back() )
+        blockSizes.push_back(blockSize);
+      }
+    }
+  else
+    blockSizes.push_back(0);
+  double bestBackProjectionTime = itk::NumericTraits<double>::max();
+  unsigned int bestBlockSize = blockSizes[0];
+  for(int b=-1; b<(int)blockSizes.size(); b++)
+    {
+    const unsigned int blockSize = blockSizes[vnl_math_max(b, 0)];
+    if(blockSize)
+      m_BackProjectionFilter->SetNumberOfThreads( (nSlices+blockSize-1) / blockSize );
+    m_BackProjectionFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+    m_BackProjectionFilter->Modified();
+    itk::TimeProbe probe;
+    probe.Start();
+    m_BackProjectionFilter->Update();
+    probe.Stop();
+    if(b>=0 && probe.GetTotal()<bestBackProjectionTime)
+      {
+      bestBackProjectionTime = probe.GetTotal();
+      bestBlockSize = blockSize;
+      }
+    }
+
+  // Backprojection of one projection with the best block size to estimate
+  // the overhead of each update, i.e., p(s)=c+o/s per projection
+  subsetRegion.SetSize(Dimension-1, 1);
+  m_ExtractFilter->SetExtractionRegion(subsetRegion);
+  m_RampFilter->UpdateLargestPossibleRegion();
+  if(bestBlockSize)
+    m_BackProjectionFilter->SetNumberOfThreads( (nSlices+bestBlockSize-1) / bestBlockSize );
+  m_BackProjectionFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  m_BackProjectionFilter->Modified();
+  itk::TimeProbe probe;
+  probe.Start();
+  m_BackProjectionFilter->Update();
+  probe.Stop();
+  double overhead = 0.;
+  if(nCalibrationProjections>1)
+    overhead = (probe.GetTotal() - bestBackProjectionTime / nCalibrationProjections) *
+               nCalibrationProjections / (nCalibrationProjections-1.);
+  overhead = vnl_math_max(0., overhead);
+
+  // Restore the backprojection filter
+  m_BackProjectionFilter->SetNumberOfThreads(backupNumberOfThreads);
+  m_BackProjectionFilter->SetInput( 0, this->GetInput(0) );
+  m_BackProjectionFilter->GetOutput()->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+
+  // Select the subset size and the FFT threading minimizing the time per
+  // projection, the time of the backprojection without overhead is the same
+  // for all
+  TuningCache::ValuesType values(3);
+  double bestTime = itk::NumericTraits<double>::max();
+  for(unsigned int s=0; s<subsetSizes.size(); s++)
+    for(unsigned int t=0; t<2; t++)
+      {
+      const double time = rampTimes[2*s+t] + overhead / subsetSizes[s];
+      if(time<bestTime)
+        {
+        bestTime = time;
+        values[0] = subsetSizes[s];
+        values[1] = fftThreadings[t];
+        }
+      }
+  values[2] = bestBlockSize;
+  return values;
+}
+
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+bool
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::IsBackProjectionOnThreadPool() const
+{
+  return ThreadPool::GetGlobalDefaultEnabled() &&
+         dynamic_cast< const ThreadPoolImageFilter<BackProjectionFilterType> * >(
+           m_BackProjectionFilter.GetPointer() ) != NULL;
+}
+
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
 ThreeDCircularProjectionGeometry::Pointer
 FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
@@ -176,6 +392,9 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
 ::PrintTiming(std::ostream& os) const
 {
   os << "FDKConeBeamReconstructionFilter timing:" << std::endl;
+  if(m_AutoTuning)
+    os << "  Auto tuning: " << m_AutoTuningProbe.GetTotal()
+       << ' ' << m_AutoTuningProbe.GetUnit() << std::endl;
   os << "  Prefilter operations: " << m_PreFilterProbe.GetTotal()
      << ' ' << m_PreFilterProbe.GetUnit() << std::endl;
   os << "  Ramp filter: " << m_FilterProbe.GetTotal()
@@ -184,6 +403,22 @@ FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
      << ' ' << m_BackProjectionProbe.GetUnit() << std::endl;
 }
 
+template<class TInputImage, class TOutputImage, class TFFTPrecision>
+void
+FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
+::SetWeightFilter (const WeightFilterPointer _arg)
+{
+  itkDebugMacro("setting WeightFilter to " << _arg);
+  if (this->m_WeightFilter != _arg)
+    {
+    _arg->SetGeometry( this->GetGeometry() );
+    this->m_WeightFilter = _arg;
+    m_WeightFilter->SetInput( m_ExtractFilter->GetOutput() );
+    m_RampFilter->SetInput( m_WeightFilter->GetOutput() );
+    this->Modified();
+    }
+}
+
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
 void
 FDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecision>
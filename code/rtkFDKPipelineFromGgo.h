@@ -0,0 +1,256 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFDKPipelineFromGgo_h
+#define __rtkFDKPipelineFromGgo_h
+
+#include "rtkGgoFunctions.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
+#include "rtkParkerShortScanImageFilter.h"
+#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkFusedFDKWeightProjectionFilter.h"
+#include "rtkFDKWarpBackProjectionImageFilter.h"
+#include "rtkCyclicDeformationImageFilter.h"
+
+#include <itkImageFileReader.h>
+#include <itkStreamingImageFilter.h>
+#include <itkImageFileWriter.h>
+#include <itkImageIOFactory.h>
+#include <itkTimeProbe.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+/** \class FDKPipelineFromGgo
+ * \brief FDK reconstruction pipeline from the gengetopt options of rtkfdk.
+ *
+ * The pipeline reads the projections, weights them for displaced detectors
+ * and short scans, reconstructs them with an FDK filter given by the caller
+ * and writes the volume, either with the streaming divisions or by slabs
+ * which fit in the memory budget. It keeps the filters alive as long as it
+ * exists. It is shared by rtkfdk and rtkreconstructiond.
+ *
+ * The FDK filter is not created by the pipeline so that the caller can pick
+ * the hardware and reuse a filter from one reconstruction to the next. The
+ * CPU options (motion compensation, fused weighting, field of view skipping
+ * and autotuning) are set with SetFDKFromGgo, the options shared with the GPU
+ * filters with SetFDKOptionsFromGgo.
+ *
+ * The required options in the ggo struct are those of rtkfdk.ggo.
+ *
+ * \ingroup Functions
+ */
+template< class TOutputImage >
+class FDKPipelineFromGgo
+{
+public:
+  typedef TOutputImage                                             OutputImageType;
+  typedef itk::Image< typename TOutputImage::PixelType,
+                      TOutputImage::ImageDimension >               CPUOutputImageType;
+  typedef ThreeDCircularProjectionGeometry                         GeometryType;
+  typedef ProjectionsReader< OutputImageType >                     ReaderType;
+  typedef DisplacedDetectorImageFilter< OutputImageType >          DDFType;
+  typedef ParkerShortScanImageFilter< OutputImageType >            PSSFType;
+  typedef ConstantImageSource< OutputImageType >                   ConstantImageSourceType;
+  typedef FDKConeBeamReconstructionFilter< OutputImageType >       FDKType;
+  typedef FusedFDKWeightProjectionFilter< OutputImageType >        FusedWeightType;
+  typedef itk::Vector<float,3>                                     DVFPixelType;
+  typedef itk::Image< DVFPixelType, 3 >                            DVFImageType;
+  typedef CyclicDeformationImageFilter< DVFImageType >             DeformationType;
+  typedef itk::ImageFileReader< typename DeformationType::InputImageType > DVFReaderType;
+  typedef FDKWarpBackProjectionImageFilter< OutputImageType,
+                                            OutputImageType,
+                                            DeformationType >      WarpBPType;
+  typedef itk::StreamingImageFilter<CPUOutputImageType, CPUOutputImageType> StreamerType;
+  typedef itk::ImageFileWriter<CPUOutputImageType>                 WriterType;
+
+  /** Creates the reader, the weighting filters and the source of the
+   * reconstructed volume. The weighting filters ddf and pssf can be given for
+   * other hardware than the CPU, they are created otherwise. */
+  template< class TArgsInfo >
+  FDKPipelineFromGgo(const TArgsInfo &args_info,
+                     GeometryType *geometry,
+                     DDFType *ddf = ITK_NULLPTR,
+                     PSSFType *pssf = ITK_NULLPTR):
+    m_Geometry(geometry),
+    m_DDF(ddf),
+    m_PSSF(pssf)
+    {
+    // Projections reader
+    m_Reader = ReaderType::New();
+    SetProjectionsReaderFromGgo<ReaderType, TArgsInfo>(m_Reader, args_info);
+
+    // Displaced detector weighting
+    if( m_DDF.IsNull() )
+      m_DDF = DisplacedDetectorForOffsetFieldOfViewImageFilter< OutputImageType >::New();
+    m_DDF->SetInput( m_Reader->GetOutput() );
+    m_DDF->SetGeometry( geometry );
+
+    // Short scan image filter
+    if( m_PSSF.IsNull() )
+      m_PSSF = PSSFType::New();
+    m_PSSF->SetInput( m_DDF->GetOutput() );
+    m_PSSF->SetGeometry( geometry );
+    m_PSSF->InPlaceOff();
+
+    // Create reconstructed image
+    m_ConstantImageSource = ConstantImageSourceType::New();
+    SetConstantImageSourceFromGgo<ConstantImageSourceType, TArgsInfo>(m_ConstantImageSource, args_info);
+    }
+
+  /** Reads the projections unless they are streamed, i.e., with --lowmem or
+   * --memory. In slab streaming mode, only the detector rows required by each
+   * slab are read when the slab is reconstructed. */
+  template< class TArgsInfo >
+  void ReadProjectionsFromGgo(const TArgsInfo &args_info)
+    {
+    if(args_info.lowmem_flag || args_info.memory_given)
+      return;
+    if(args_info.verbose_flag)
+      std::cout << "Reading... " << std::flush;
+    itk::TimeProbe readerProbe;
+    readerProbe.Start();
+    m_Reader->Update();
+    readerProbe.Stop();
+    if(args_info.verbose_flag)
+      std::cout << "It took " << readerProbe.GetMean() << ' ' << readerProbe.GetUnit() << std::endl;
+    }
+
+  /** Sets the inputs, the geometry and the ramp filter and subset options of
+   * an FDK filter. The FDK filters of all hardware are accepted. */
+  template< class TFDKType, class TArgsInfo >
+  void SetFDKOptionsFromGgo(TFDKType *feldkamp, const TArgsInfo &args_info)
+    {
+    feldkamp->SetInput( 0, m_ConstantImageSource->GetOutput() );
+    feldkamp->SetInput( 1, m_PSSF->GetOutput() );
+    feldkamp->SetGeometry( m_Geometry );
+    feldkamp->GetRampFilter()->SetTruncationCorrection(args_info.pad_arg);
+    feldkamp->GetRampFilter()->SetHannCutFrequency(args_info.hann_arg);
+    feldkamp->GetRampFilter()->SetHannCutFrequencyY(args_info.hannY_arg);
+    feldkamp->SetProjectionSubsetSize(args_info.subsetsize_arg);
+    }
+
+  /** Sets all the options of a CPU FDK filter. The displaced detector and
+   * short scan weights are applied with the FDK weights with --fused. With
+   * --signal and --dvf, the back projection of the filter is replaced by a
+   * motion-compensated one. All options are set since the filter may have
+   * been used for a previous reconstruction. */
+  template< class TArgsInfo >
+  void SetFDKFromGgo(FDKType *feldkamp, const TArgsInfo &args_info)
+    {
+    this->SetFDKOptionsFromGgo(feldkamp, args_info);
+
+    if(args_info.fused_flag)
+      {
+      if( !dynamic_cast<FusedWeightType *>( feldkamp->GetWeightFilter().GetPointer() ) )
+        feldkamp->SetWeightFilter( FusedWeightType::New().GetPointer() );
+      feldkamp->SetInput( 1, m_Reader->GetOutput() );
+      }
+
+    // Motion compensated CBCT settings
+    if(args_info.signal_given && args_info.dvf_given)
+      {
+      m_DVFReader = DVFReaderType::New();
+      m_DVFReader->SetFileName(args_info.dvf_arg);
+      m_Deformation = DeformationType::New();
+      m_Deformation->SetInput(m_DVFReader->GetOutput());
+      m_Deformation->SetSignalFilename(args_info.signal_arg);
+      m_WarpBackProjection = WarpBPType::New();
+      m_WarpBackProjection->SetDeformation(m_Deformation);
+      m_WarpBackProjection->SetGeometry( m_Geometry );
+      feldkamp->SetBackProjectionFilter( m_WarpBackProjection.GetPointer() );
+      }
+    feldkamp->GetBackProjectionFilter()->SetSkipOutsideFieldOfView( args_info.skipfov_flag );
+    feldkamp->SetAutoTuning( args_info.autotune_flag );
+    feldkamp->SetTuningCacheFileName( (args_info.tuningcache_given)?args_info.tuningcache_arg:"" );
+    }
+
+  /** Creates the writer of the reconstructed volume. With --memory, the
+   * writer requests z-slabs which fit in the memory budget and writes each
+   * of them to disk before requesting the next one. Otherwise, the volume is
+   * reconstructed in --divisions streaming divisions. */
+  template< class TArgsInfo >
+  WriterType *CreateWriterFromGgo(CPUOutputImageType *volume, const TArgsInfo &args_info)
+    {
+    m_Writer = WriterType::New();
+    m_Writer->SetFileName( args_info.output_arg );
+    if(args_info.memory_given)
+      {
+      m_ConstantImageSource->UpdateOutputInformation();
+      const typename CPUOutputImageType::SizeType size = m_ConstantImageSource->GetOutput()->GetLargestPossibleRegion().GetSize();
+      const double sliceMB = size[0] * size[1] * sizeof(typename CPUOutputImageType::PixelType) / (1024.*1024.);
+      unsigned int slabSize = std::max(1, (int)(args_info.memory_arg / sliceMB));
+      unsigned int nSlabs = (size[2] + slabSize - 1) / slabSize;
+
+      // Honor --divisions if it requires more slabs than the memory budget
+      if(args_info.divisions_arg > (int)nSlabs)
+        {
+        nSlabs = std::min(args_info.divisions_arg, (int)size[2]);
+        slabSize = (size[2] + nSlabs - 1) / nSlabs;
+        }
+      if(args_info.verbose_flag)
+        std::cout << "Reconstructing " << nSlabs << " slabs of "
+                  << slabSize << " slices, the projections are read and filtered "
+                  << nSlabs << " times..." << std::endl;
+      itk::ImageIOBase::Pointer io = itk::ImageIOFactory::CreateImageIO( args_info.output_arg,
+                                                                         itk::ImageIOFactory::WriteMode );
+      if( io.IsNotNull() && !io->CanStreamWrite() )
+        std::cerr << "Warning: the format of " << args_info.output_arg
+                  << " cannot be written by slabs, the whole volume will be"
+                  << " reconstructed in memory." << std::endl;
+      m_Writer->SetInput( volume );
+      m_Writer->SetNumberOfStreamDivisions( nSlabs );
+      }
+    else
+      {
+      // Streaming depending on streaming capability of writer
+      m_Streamer = StreamerType::New();
+      m_Streamer->SetInput( volume );
+      m_Streamer->SetNumberOfStreamDivisions( args_info.divisions_arg );
+      m_Writer->SetInput( m_Streamer->GetOutput() );
+      }
+    return m_Writer.GetPointer();
+    }
+
+  ReaderType *GetReader() { return m_Reader.GetPointer(); }
+  DDFType *GetDDF() { return m_DDF.GetPointer(); }
+  PSSFType *GetPSSF() { return m_PSSF.GetPointer(); }
+  ConstantImageSourceType *GetConstantImageSource() { return m_ConstantImageSource.GetPointer(); }
+
+private:
+  FDKPipelineFromGgo(const FDKPipelineFromGgo &); //purposely not implemented
+  void operator=(const FDKPipelineFromGgo &);     //purposely not implemented
+
+  GeometryType::Pointer                     m_Geometry;
+  typename ReaderType::Pointer              m_Reader;
+  typename DDFType::Pointer                 m_DDF;
+  typename PSSFType::Pointer                m_PSSF;
+  typename ConstantImageSourceType::Pointer m_ConstantImageSource;
+  typename DVFReaderType::Pointer           m_DVFReader;
+  typename DeformationType::Pointer         m_Deformation;
+  typename WarpBPType::Pointer              m_WarpBackProjection;
+  typename StreamerType::Pointer            m_Streamer;
+  typename WriterType::Pointer              m_Writer;
+};
+
+} // end namespace rtk
+
+#endif // __rtkFDKPipelineFromGgo_h
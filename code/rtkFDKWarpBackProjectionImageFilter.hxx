@@ -55,24 +55,13 @@ FDKWarpBackProjectionImageFilter<TInputImage,TOutputImage,TDeformation>
   typedef itk::LinearInterpolateImageFunction< ProjectionImageType, double > InterpolatorType;
   typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
 
-  // Iterators on volume input and output
-  typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  // Iterator on volume output
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    itIn.GoToBegin();
-    while(!itIn.IsAtEnd() )
-      {
-      itOut.Set(itIn.Get() );
-      ++itIn;
-      ++itOut;
-      }
-    }
+  this->InitializeOutputRegion(outputRegionForThread);
 
   // Rotation center (assumed to be at 0 yet)
   typename TInputImage::PointType rotCenterPoint;
@@ -81,16 +81,16 @@ protected:
 
   virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
 
-private:
-  FDKWeightProjectionFilter(const Self&); //purposely not implemented
-  void operator=(const Self&);            //purposely not implemented
-
   /** Angular weights for each projection */
   std::vector<double> m_ConstantProjectionFactor;
 
   /** Tilt angles with respect to the conventional situation */
   std::vector<double> m_TiltAngles;
 
+private:
+  FDKWeightProjectionFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);            //purposely not implemented
+
   /** Geometrical description of the system */
   ThreeDCircularProjectionGeometry::Pointer m_Geometry;
 }; // end of class
@@ -57,6 +57,15 @@ public:
   typedef typename InputImageType::IndexType                IndexType;
   typedef typename InputImageType::SizeType                 SizeType;
 
+  /** Multithreading strategy of the FFTs:
+   * - ONEFFTPERTHREAD: the requested region is split and each thread
+   *   computes the FFTs of its piece,
+   * - MULTITHREADEDFFT: a single FFT of the requested region is computed
+   *   with the internal multithreading of the FFT filters,
+   * - AUTOMATIC: MULTITHREADEDFFT for a single projection with a 2D kernel,
+   *   ONEFFTPERTHREAD otherwise. */
+  typedef enum {AUTOMATIC, ONEFFTPERTHREAD, MULTITHREADEDFFT} FFTThreadingType;
+
   typedef typename itk::Image<TFFTPrecision,
                               TInputImage::ImageDimension > FFTInputImageType;
   typedef typename FFTInputImageType::Pointer               FFTInputImagePointer;
@@ -93,6 +102,12 @@ public:
   itkGetConstMacro(TruncationCorrection, double);
   itkSetMacro(TruncationCorrection, double);
 
+  /** Set/Get the multithreading strategy of the FFTs. Default is AUTOMATIC.
+   * The best strategy depends on the number of threads and on the size of
+   * the projections, see FDKConeBeamReconstructionFilter::SetAutoTuning. */
+  itkGetConstMacro(FFTThreading, FFTThreadingType);
+  itkSetMacro(FFTThreading, FFTThreadingType);
+
 
 protected:
   FFTConvolutionImageFilter();
@@ -155,6 +170,10 @@ private:
    */
   int m_GreatestPrimeFactor;
   int m_BackupNumberOfThreads;
+
+  /** Multithreading strategy and the one selected for the current update */
+  FFTThreadingType m_FFTThreading;
+  bool             m_MultithreadedFFT;
 }; // end of class
 
 } // end namespace rtk
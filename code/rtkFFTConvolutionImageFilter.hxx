@@ -36,7 +36,9 @@ FFTConvolutionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
   m_KernelDimension(1),
   m_TruncationCorrection(0.),
   m_GreatestPrimeFactor(2),
-  m_BackupNumberOfThreads(1)
+  m_BackupNumberOfThreads(1),
+  m_FFTThreading(AUTOMATIC),
+  m_MultithreadedFFT(false)
 {
 #if defined(USE_FFTWD)
   if(typeid(TFFTPrecision).name() == typeid(double).name() )
@@ -93,8 +95,12 @@ FFTConvolutionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
   // If the following condition is met, multi-threading is left to the (i)fft
   // filter. Otherwise, one splits the image and a separate fft is performed
   // per thread.
-  if(this->GetOutput()->GetRequestedRegion().GetSize()[2] == 1 &&
-     m_KernelDimension == 2)
+  if(m_FFTThreading == AUTOMATIC)
+    m_MultithreadedFFT = this->GetOutput()->GetRequestedRegion().GetSize()[2] == 1 &&
+                         m_KernelDimension == 2;
+  else
+    m_MultithreadedFFT = (m_FFTThreading == MULTITHREADEDFFT);
+  if(m_MultithreadedFFT)
     {
     m_BackupNumberOfThreads = this->GetNumberOfThreads();
     this->SetNumberOfThreads(1);
@@ -121,8 +127,7 @@ void
 FFTConvolutionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
 ::AfterThreadedGenerateData()
 {
-  if(this->GetOutput()->GetRequestedRegion().GetSize()[2] == 1 &&
-     m_KernelDimension == 2)
+  if(m_MultithreadedFFT)
     this->SetNumberOfThreads(m_BackupNumberOfThreads);
 }
 
@@ -301,6 +306,7 @@ FFTConvolutionImageFilter<TInputImage, TOutputImage, TFFTPrecision>
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "GreatestPrimeFactor: "  << m_GreatestPrimeFactor << std::endl;
+  os << indent << "FFTThreading: "  << m_FFTThreading << std::endl;
 }
 
 template<class TInputImage, class TOutputImage, class TFFTPrecision>
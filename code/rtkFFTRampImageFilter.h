@@ -120,7 +120,10 @@ protected:
   ~FFTRampImageFilter(){}
 
   /** Creates and return a pointer to one line of the ramp kernel in Fourier space.
-   *  Used in generate data functions.  */
+   *  Used in generate data functions. The kernel is kept between updates, e.g.,
+   *  between the subsets of projections of FDK, as long as the width, the
+   *  height and the spacing of the padded projections and the windows are
+   *  unchanged. */
   virtual void UpdateFFTConvolutionKernel(const SizeType size);
 
 private:
@@ -140,6 +143,10 @@ private:
     */
   double m_RamLakCutFrequency;
   double m_SheppLoganCutFrequency;
+
+  /** Width, height, spacing and window parameters of the last computation of
+   * the kernel, which is only recomputed if one of them changes. */
+  std::vector<double> m_KernelFFTParameters;
 }; // end of class
 
 } // end namespace rtk
@@ -49,6 +49,22 @@ FFTRampImageFilter<TInputImage, TOutputImage, TFFTPrecision>
 {
   const int width = s[0];
   const int height = s[1];
+  const double spacing = this->GetInput()->GetSpacing()[0];
+
+  // Nothing to do if the kernel has already been computed with the same
+  // parameters
+  std::vector<double> parameters;
+  parameters.push_back(width);
+  parameters.push_back(height);
+  parameters.push_back(spacing);
+  parameters.push_back(m_HannCutFrequency);
+  parameters.push_back(m_CosineCutFrequency);
+  parameters.push_back(m_HammingFrequency);
+  parameters.push_back(m_HannCutFrequencyY);
+  parameters.push_back(m_RamLakCutFrequency);
+  parameters.push_back(m_SheppLoganCutFrequency);
+  if( this->m_KernelFFT.IsNotNull() && parameters == m_KernelFFTParameters )
+    return;
 
   // Allocate kernel
   SizeType size;
@@ -61,7 +77,6 @@ FFTRampImageFilter<TInputImage, TOutputImage, TFFTPrecision>
 
   // Compute kernel in space domain (see Kak & Slaney, chapter 3 equation 61
   // page 72) although spacing is not squared according to equation 69 page 75
-  double spacing = this->GetInput()->GetSpacing()[0];
   IndexType ix,jx;
   ix.Fill(0);
   jx.Fill(0);
@@ -170,6 +185,7 @@ FFTRampImageFilter<TInputImage, TOutputImage, TFFTPrecision>
       }
     }
   this->m_KernelFFT->DisconnectPipeline();
+  m_KernelFFTParameters = parameters;
 }
 
 } // end namespace rtk
@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFFTRampPreconditionerImageFilter_h
+#define __rtkFFTRampPreconditionerImageFilter_h
+
+#include <itkImageToImageFilter.h>
+#include "rtkConfiguration.h"
+
+namespace rtk
+{
+
+/** \class FFTRampPreconditionerImageFilter
+ * \brief 3D ramp filter of a volume used as preconditioner of conjugate
+ * gradient reconstructions.
+ *
+ * The normal operator R^T R of cone-beam tomography is close to a 3D blur with
+ * a 1/|f| transfer function. This filter multiplies the 3D Fourier transform
+ * of its input by |f|+epsilon, which approximates its inverse, epsilon being
+ * the first non-zero frequency of the padded volume to make the filter
+ * positive definite. The filter is symmetric whatever the padding since the
+ * kernel is real and even. The volume is zero padded by PaddingSize voxels
+ * (8 by default), up to the next size supported by the FFT, so that the
+ * kernel, which decays as the fourth power of the distance, wraps around
+ * negligibly between opposite faces. Dimensions of size 1 are not padded. It
+ * is meant to be plugged in rtk::ConjugateGradientImageFilter with
+ * SetPreconditioner: the amplitude of the kernel does not matter.
+ *
+ * \test rtkconjugategradientreconstructiontest.cxx
+ *
+ * \ingroup ImageToImageFilter
+ */
+
+template<class TImage, class TFFTPrecision=typename TImage::PixelType>
+class ITK_EXPORT FFTRampPreconditionerImageFilter :
+  public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef FFTRampPreconditionerImageFilter           Self;
+  typedef itk::ImageToImageFilter<TImage, TImage>    Superclass;
+  typedef itk::SmartPointer<Self>                    Pointer;
+  typedef itk::SmartPointer<const Self>              ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                                             ImageType;
+  typedef typename ImageType::RegionType                     RegionType;
+  typedef typename ImageType::SizeType                       SizeType;
+  typedef itk::Image<TFFTPrecision, TImage::ImageDimension>  FFTInputImageType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(FFTRampPreconditionerImageFilter, ImageToImageFilter);
+
+  /** Get / Set the number of zero voxels added along each dimension before
+   * the FFT. Default is 8. */
+  itkGetMacro(PaddingSize, unsigned int);
+  itkSetMacro(PaddingSize, unsigned int);
+
+protected:
+  FFTRampPreconditionerImageFilter();
+  ~FFTRampPreconditionerImageFilter() {}
+
+  /** The whole volume is filtered */
+  void GenerateInputRequestedRegion();
+  void EnlargeOutputRequestedRegion(itk::DataObject *output);
+
+  void GenerateData();
+
+  /** Smallest size greater or equal to n with prime factors up to 5, which
+   * is supported by all FFT implementations of ITK. */
+  static typename SizeType::SizeValueType GetFFTSize(typename SizeType::SizeValueType n);
+
+private:
+  FFTRampPreconditionerImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                   //purposely not implemented
+
+  unsigned int m_PaddingSize;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkFFTRampPreconditionerImageFilter.hxx"
+#endif
+
+#endif
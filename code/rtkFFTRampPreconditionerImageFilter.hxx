@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFFTRampPreconditionerImageFilter_hxx
+#define __rtkFFTRampPreconditionerImageFilter_hxx
+
+#include <itkRealToHalfHermitianForwardFFTImageFilter.h>
+#include <itkHalfHermitianToRealInverseFFTImageFilter.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template <class TImage, class TFFTPrecision>
+FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>
+::FFTRampPreconditionerImageFilter():
+  m_PaddingSize(8)
+{
+}
+
+template <class TImage, class TFFTPrecision>
+void
+FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>
+::GenerateInputRequestedRegion()
+{
+  typename ImageType::Pointer input = const_cast<ImageType *>(this->GetInput());
+  if(input.IsNull())
+    return;
+  input->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <class TImage, class TFFTPrecision>
+void
+FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>
+::EnlargeOutputRequestedRegion(itk::DataObject *output)
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <class TImage, class TFFTPrecision>
+typename FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>::SizeType::SizeValueType
+FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>
+::GetFFTSize(typename SizeType::SizeValueType n)
+{
+  for(;; n++)
+    {
+    typename SizeType::SizeValueType m = n;
+    while(m%2 == 0) m /= 2;
+    while(m%3 == 0) m /= 3;
+    while(m%5 == 0) m /= 5;
+    if(m <= 1)
+      return n;
+    }
+}
+
+template <class TImage, class TFFTPrecision>
+void
+FFTRampPreconditionerImageFilter<TImage, TFFTPrecision>
+::GenerateData()
+{
+  this->AllocateOutputs();
+  const ImageType *input = this->GetInput();
+  const RegionType region = input->GetLargestPossibleRegion();
+  const unsigned int Dimension = ImageType::ImageDimension;
+
+  // Zero pad to limit the wrap around of the kernel between opposite faces
+  typename FFTInputImageType::RegionType paddedRegion;
+  paddedRegion.SetIndex(region.GetIndex());
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    if(region.GetSize(i) > 1)
+      paddedRegion.SetSize(i, GetFFTSize(region.GetSize(i) + m_PaddingSize));
+    else
+      paddedRegion.SetSize(i, region.GetSize(i));
+    }
+  typename FFTInputImageType::Pointer paddedImage = FFTInputImageType::New();
+  paddedImage->SetRegions(paddedRegion);
+  paddedImage->Allocate();
+  paddedImage->FillBuffer(0);
+  itk::ImageRegionConstIterator<ImageType>    itS(input, region);
+  itk::ImageRegionIterator<FFTInputImageType> itP(paddedImage, region);
+  for(; !itS.IsAtEnd(); ++itS, ++itP)
+    itP.Set( itS.Get() );
+
+  // FFT padded image
+  typedef itk::RealToHalfHermitianForwardFFTImageFilter< FFTInputImageType > FFTType;
+  typename FFTType::Pointer fft = FFTType::New();
+  fft->SetInput( paddedImage );
+  fft->SetNumberOfThreads( this->GetNumberOfThreads() );
+  fft->Update();
+  paddedImage = NULL;
+
+  // Multiply by |f|+epsilon. The half Hermitian image only contains the
+  // non-negative frequencies along the first dimension.
+  double frequencyStep[Dimension];
+  double epsilon = itk::NumericTraits<double>::max();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    frequencyStep[i] = 1. / (paddedRegion.GetSize(i) * input->GetSpacing()[i]);
+    epsilon = std::min(epsilon, frequencyStep[i]);
+    }
+  typedef typename FFTType::OutputImageType FFTOutputImageType;
+  const typename FFTOutputImageType::RegionType fftRegion = fft->GetOutput()->GetLargestPossibleRegion();
+  itk::ImageRegionIteratorWithIndex<FFTOutputImageType> itF(fft->GetOutput(), fftRegion);
+  for(; !itF.IsAtEnd(); ++itF)
+    {
+    double squaredFrequency = 0.;
+    for(unsigned int i=0; i<Dimension; i++)
+      {
+      long k = itF.GetIndex()[i] - fftRegion.GetIndex(i);
+      if(k > (long)paddedRegion.GetSize(i)/2)
+        k -= paddedRegion.GetSize(i);
+      squaredFrequency += vnl_math_sqr(k * frequencyStep[i]);
+      }
+    itF.Set( itF.Get() * static_cast<TFFTPrecision>(sqrt(squaredFrequency) + epsilon) );
+    }
+
+  // Inverse FFT image
+  typedef itk::HalfHermitianToRealInverseFFTImageFilter< FFTOutputImageType > IFFTType;
+  typename IFFTType::Pointer ifft = IFFTType::New();
+  ifft->SetInput( fft->GetOutput() );
+  ifft->SetNumberOfThreads( this->GetNumberOfThreads() );
+  ifft->SetActualXDimensionIsOdd( paddedRegion.GetSize(0) % 2 );
+  ifft->Update();
+  fft = NULL;
+
+  // Crop the volume
+  RegionType ifftRegion = region;
+  ifftRegion.SetIndex( ifft->GetOutput()->GetLargestPossibleRegion().GetIndex() );
+  itk::ImageRegionConstIterator<FFTInputImageType> itI(ifft->GetOutput(), ifftRegion);
+  itk::ImageRegionIterator<ImageType>              itO(this->GetOutput(), region);
+  for(; !itI.IsAtEnd(); ++itI, ++itO)
+    itO.Set( itI.Get() );
+}
+
+} // end namespace rtk
+#endif
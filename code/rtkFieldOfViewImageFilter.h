@@ -99,6 +99,13 @@ public:
    * m_Geometry and ProjectionsStack must be set.*/
   virtual bool ComputeFOVRadius(const FOVRadiusType type, double &x, double &z, double &r);
 
+  /** Computes the hat which limits the field of view along the y-axis. A
+   * point (x,y,z) at a distance radius of the center of the disk is in the
+   * hat if radius*tangentInf >= heightInf-y and radius*tangentSup <=
+   * heightSup-y. As for ComputeFOVRadius, m_Geometry and ProjectionsStack
+   * must be set. */
+  virtual void ComputeFOVHat(double &tangentInf, double &heightInf, double &tangentSup, double &heightSup);
+
 protected:
   FieldOfViewImageFilter();
   virtual ~FieldOfViewImageFilter() {};
@@ -221,6 +221,13 @@ void FieldOfViewImageFilter<TInputImage, TOutputImage>
       m_Radius = -1.;
     }
 
+  ComputeFOVHat(m_HatTangentInf, m_HatHeightInf, m_HatTangentSup, m_HatHeightSup);
+}
+
+template <class TInputImage, class TOutputImage>
+void FieldOfViewImageFilter<TInputImage, TOutputImage>
+::ComputeFOVHat(double &tangentInf, double &heightInf, double &tangentSup, double &heightSup)
+{
   // Compute projection stack indices of corners
   m_ProjectionsStack->UpdateOutputInformation();
   typename TInputImage::IndexType indexCorner1;
@@ -240,8 +247,8 @@ void FieldOfViewImageFilter<TInputImage, TOutputImage>
       std::swap(corner1[i], corner2[i]);
 
   // Go over projection stack, compute minimum radius and minimum tangent
-  m_HatHeightSup = itk::NumericTraits<double>::max();
-  m_HatHeightInf = itk::NumericTraits<double>::NonpositiveMin();
+  heightSup = itk::NumericTraits<double>::max();
+  heightInf = itk::NumericTraits<double>::NonpositiveMin();
   for(unsigned int k=0; k<m_ProjectionsStack->GetLargestPossibleRegion().GetSize(2); k++)
     {
     const double sid = m_Geometry->GetSourceToIsocenterDistances()[k];
@@ -252,21 +259,21 @@ void FieldOfViewImageFilter<TInputImage, TOutputImage>
 
     const double projOffsetY = m_Geometry->GetProjectionOffsetsY()[k];
     const double sourceOffsetY = m_Geometry->GetSourceOffsetsY()[k];
-    const double heightInf = sourceOffsetY+mag*(corner1[1]+projOffsetY-sourceOffsetY);
-    if(heightInf>m_HatHeightInf)
+    const double hInf = sourceOffsetY+mag*(corner1[1]+projOffsetY-sourceOffsetY);
+    if(hInf>heightInf)
       {
-      m_HatHeightInf = heightInf;
-      m_HatTangentInf = m_HatHeightInf/sid;
+      heightInf = hInf;
+      tangentInf = heightInf/sid;
       if(sdd==0.) // Parallel
-        m_HatTangentInf = 0.;
+        tangentInf = 0.;
       }
-    const double heightSup = sourceOffsetY+mag*(corner2[1]+projOffsetY-sourceOffsetY);
-    if(heightSup<m_HatHeightSup)
+    const double hSup = sourceOffsetY+mag*(corner2[1]+projOffsetY-sourceOffsetY);
+    if(hSup<heightSup)
       {
-      m_HatHeightSup = heightSup;
-      m_HatTangentSup = m_HatHeightSup/sid;
+      heightSup = hSup;
+      tangentSup = heightSup/sid;
       if(sdd==0.) // Parallel
-        m_HatTangentSup = 0.;
+        tangentSup = 0.;
       }
     }
 }
@@ -22,6 +22,7 @@
 #include <itkInPlaceImageFilter.h>
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
 
 namespace rtk
 {
@@ -44,6 +45,9 @@ public:
   typedef itk::SmartPointer<Self>                           Pointer;
   typedef itk::SmartPointer<const Self>                     ConstPointer;
 
+  typedef typename TInputImage::PixelType                   InputPixelType;
+  typedef typename TOutputImage::RegionType                 OutputImageRegionType;
+
   typedef rtk::ThreeDCircularProjectionGeometry             GeometryType;
   typedef typename GeometryType::Pointer                    GeometryPointer;
 
@@ -69,6 +73,21 @@ protected:
    * to verify. */
   virtual void VerifyInputInformation() ITK_OVERRIDE {}
 
+  /** Returns true if input 0 is the output of a rtk::ConstantImageSource, see
+   * ConstantImageSource::IsConstantImage. A single pixel of input 0 is then
+   * requested and the output, initialized with the constant, is used instead
+   * of input 0 by InitializeAccumulation. Filters which read input 0
+   * otherwise, e.g., on the GPU, must return false. */
+  virtual bool IsInputConstant(InputPixelType &constant) const;
+
+  /** The filter cannot run in place if input 0 is a constant image */
+  virtual bool CanRunInPlace() const ITK_OVERRIDE;
+
+  /** Returns the image whose pixels in region are accumulated with the
+   * forward projection of the volume: input 0 or, if input 0 is a constant
+   * image, the output filled with the constant in region. */
+  const TInputImage * InitializeAccumulation(const OutputImageRegionType& region);
+
 private:
   ForwardProjectionImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&);            //purposely not implemented
@@ -23,9 +23,12 @@
 #include "rtkRayCastInterpolateImageFunction.h"
 
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkIdentityTransform.h>
 
+#include <typeinfo>
+
 namespace rtk
 {
 
@@ -34,12 +37,21 @@ void
 ForwardProjectionImageFilter<TInputImage,TOutputImage>
 ::GenerateInputRequestedRegion()
 {
-  // Input 0 is the stack of projections in which we project
+  // Input 0 is the stack of projections in which we project, only one pixel
+  // is required if it is constant
   typename Superclass::InputImagePointer inputPtr0 =
     const_cast< TInputImage * >( this->GetInput(0) );
   if ( !inputPtr0 )
     return;
-  inputPtr0->SetRequestedRegion( this->GetOutput()->GetRequestedRegion() );
+  typename TInputImage::RegionType reqRegion0 = this->GetOutput()->GetRequestedRegion();
+  InputPixelType constant;
+  if( this->IsInputConstant(constant) )
+    {
+    typename TInputImage::SizeType onePixel;
+    onePixel.Fill(1);
+    reqRegion0.SetSize(onePixel);
+    }
+  inputPtr0->SetRequestedRegion( reqRegion0 );
 
   // Input 1 is the volume to forward project
   typename Superclass::InputImagePointer  inputPtr1 =
@@ -51,6 +63,41 @@ ForwardProjectionImageFilter<TInputImage,TOutputImage>
   inputPtr1->SetRequestedRegion( reqRegion );
 }
 
+template <class TInputImage, class  TOutputImage>
+bool
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::IsInputConstant(InputPixelType &constant) const
+{
+  // The output replaces input 0 which requires the same image type
+  if( typeid(TInputImage) != typeid(TOutputImage) )
+    return false;
+  return ConstantImageSource<TInputImage>::IsConstantImage(this->GetInput(0), constant);
+}
+
+template <class TInputImage, class  TOutputImage>
+bool
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::CanRunInPlace() const
+{
+  InputPixelType constant;
+  return Superclass::CanRunInPlace() && !this->IsInputConstant(constant);
+}
+
+template <class TInputImage, class  TOutputImage>
+const TInputImage *
+ForwardProjectionImageFilter<TInputImage,TOutputImage>
+::InitializeAccumulation(const OutputImageRegionType& region)
+{
+  InputPixelType constant;
+  if( !this->IsInputConstant(constant) )
+    return this->GetInput(0);
+
+  itk::ImageRegionIterator<TOutputImage> itOut(this->GetOutput(), region);
+  for(itOut.GoToBegin(); !itOut.IsAtEnd(); ++itOut)
+    itOut.Set(constant);
+  return dynamic_cast<const TInputImage *>( this->GetOutput() );
+}
+
 } // end namespace rtk
 
 #endif
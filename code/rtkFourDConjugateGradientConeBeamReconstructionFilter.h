@@ -81,6 +81,13 @@ namespace rtk
    * }
    * \enddot
    *
+   * The projection stack can be stored with a lower precision than the
+   * projections processed by the projectors, e.g. with rtk::Half pixels, by
+   * setting StoredProjectionStackType. Each projection is converted when it
+   * is extracted from the stack so the memory footprint of the stack is
+   * halved while the projectors compute in the precision of
+   * ProjectionStackType.
+   *
    * \test rtkfourdconjugategradienttest.cxx
    *
    * \author Cyril Mory
@@ -88,7 +95,9 @@ namespace rtk
    * \ingroup ReconstructionAlgorithm
    */
 
-template<typename VolumeSeriesType, typename ProjectionStackType>
+template<typename VolumeSeriesType,
+         typename ProjectionStackType,
+         typename StoredProjectionStackType=ProjectionStackType>
 class ITK_EXPORT FourDConjugateGradientConeBeamReconstructionFilter :
   public rtk::IterativeConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
 {
@@ -108,8 +117,12 @@ public:
   typedef rtk::ForwardProjectionImageFilter< VolumeType, ProjectionStackType >                      ForwardProjectionFilterType;
   typedef rtk::BackProjectionImageFilter< ProjectionStackType, VolumeType >                         BackProjectionFilterType;
   typedef rtk::ConjugateGradientImageFilter<VolumeSeriesType>                                       ConjugateGradientFilterType;
-  typedef rtk::FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>  CGOperatorFilterType;
-  typedef rtk::ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>             ProjStackToFourDFilterType;
+  typedef rtk::FourDReconstructionConjugateGradientOperator<VolumeSeriesType,
+                                                            ProjectionStackType,
+                                                            StoredProjectionStackType>              CGOperatorFilterType;
+  typedef rtk::ProjectionStackToFourDImageFilter<VolumeSeriesType,
+                                                 ProjectionStackType,
+                                                 StoredProjectionStackType>                         ProjStackToFourDFilterType;
 
   /** Standard New method. */
   itkNewMacro(Self)
@@ -127,6 +140,16 @@ public:
   itkGetMacro(NumberOfIterations, unsigned int)
   itkSetMacro(NumberOfIterations, unsigned int)
 
+  /** Relative residual norm at which the conjugate gradient stops, see
+   * rtk::ConjugateGradientImageFilter. Default is 0 (disabled). */
+  itkGetMacro(Tolerance, double)
+  itkSetMacro(Tolerance, double)
+
+  /** Convergence of the conjugate gradient, updated before each
+   * itk::IterationEvent invoked by this filter. */
+  const std::vector<double> & GetResidualNorms() const {return m_ConjugateGradientFilter->GetResidualNorms();}
+  const std::vector<double> & GetElapsedTimes() const {return m_ConjugateGradientFilter->GetElapsedTimes();}
+
   /** Get / Set whether conjugate gradient should be performed on GPU */
   itkGetMacro(CudaConjugateGradient, bool)
   itkSetMacro(CudaConjugateGradient, bool)
@@ -136,8 +159,8 @@ public:
   typename VolumeSeriesType::ConstPointer GetInputVolumeSeries();
 
   /** Set/Get the stack of projections  */
-  void SetInputProjectionStack(const VolumeType* Projection);
-  typename VolumeType::ConstPointer GetInputProjectionStack();
+  void SetInputProjectionStack(const StoredProjectionStackType* Projection);
+  typename StoredProjectionStackType::ConstPointer GetInputProjectionStack();
 
   /** Pass the ForwardProjection filter to the conjugate gradient operator */
   void SetForwardProjectionFilter (int _arg);
@@ -162,6 +185,10 @@ protected:
    * to verify. */
   virtual void VerifyInputInformation() {}
 
+  /** Invokes the itk::IterationEvent of the conjugate gradient filter */
+  void ForwardIterationEvent() {this->InvokeEvent( itk::IterationEvent() );}
+  typename itk::SimpleMemberCommand<Self>::Pointer m_IterationCommand;
+
   /** Pointers to each subfilter of this composite filter */
   typename ForwardProjectionFilterType::Pointer     m_ForwardProjectionFilter;
   typename BackProjectionFilterType::Pointer        m_BackProjectionFilter;
@@ -183,6 +210,9 @@ private:
   /** Number of conjugate gradient descent iterations */
   unsigned int m_NumberOfIterations;
 
+  /** Relative residual norm at which the conjugate gradient stops */
+  double m_Tolerance;
+
 }; // end of class
 
 } // end namespace rtk
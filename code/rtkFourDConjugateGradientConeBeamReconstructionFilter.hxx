@@ -30,58 +30,62 @@
 namespace rtk
 {
 
-template<class VolumeSeriesType, class ProjectionStackType>
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::FourDConjugateGradientConeBeamReconstructionFilter()
 {
   this->SetNumberOfRequiredInputs(2);
 
   // Set the default values of member parameters
   m_NumberOfIterations=3;
+  m_Tolerance=0.;
   m_CudaConjugateGradient = false; // 4D volumes of usual size only fit on the largest GPUs
 
   // Create the filters
   m_CGOperator = CGOperatorFilterType::New();
   m_ConjugateGradientFilter = ConjugateGradientFilterType::New();
   m_ProjStackToFourDFilter = ProjStackToFourDFilterType::New();
+  m_IterationCommand = itk::SimpleMemberCommand<Self>::New();
+  m_IterationCommand->SetCallbackFunction(this, &Self::ForwardIterationEvent);
+  m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), m_IterationCommand);
 
   // Memory management options
   m_ProjStackToFourDFilter->ReleaseDataFlagOn();
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
 {
   this->SetNthInput(0, const_cast<VolumeSeriesType*>(VolumeSeries));
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::SetInputProjectionStack(const VolumeType* Projection)
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputProjectionStack(const StoredProjectionStackType* Projection)
 {
-  this->SetNthInput(1, const_cast<VolumeType*>(Projection));
+  this->SetNthInput(1, const_cast<StoredProjectionStackType*>(Projection));
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 typename VolumeSeriesType::ConstPointer
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::GetInputVolumeSeries()
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputVolumeSeries()
 {
   return static_cast< const VolumeSeriesType * >
           ( this->itk::ProcessObject::GetInput(0) );
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
-typename ProjectionStackType::ConstPointer
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::GetInputProjectionStack()
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
+typename StoredProjectionStackType::ConstPointer
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputProjectionStack()
 {
-  return static_cast< const VolumeType * >
+  return static_cast< const StoredProjectionStackType * >
           ( this->itk::ProcessObject::GetInput(1) );
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetForwardProjectionFilter (int _arg)
 {
   if( _arg != this->GetForwardProjectionFilter() )
@@ -98,9 +102,9 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 }
 
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetBackProjectionFilter (int _arg)
 {
   if( _arg != this->GetBackProjectionFilter() )
@@ -121,9 +125,9 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
     }
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetWeights(const itk::Array2D<float> _arg)
 {
   m_ProjStackToFourDFilter->SetWeights(_arg);
@@ -131,15 +135,18 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
   this->Modified();
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateOutputInformation()
 {
   // Set the Conjugate Gradient filter (either on CPU or GPU depending on user's choice)
 #ifdef RTK_USE_CUDA
   if (m_CudaConjugateGradient)
+    {
     m_ConjugateGradientFilter = rtk::CudaConjugateGradientImageFilter_4f::New();
+    m_ConjugateGradientFilter->AddObserver(itk::IterationEvent(), m_IterationCommand);
+    }
 #endif
   m_ConjugateGradientFilter->SetA(m_CGOperator.GetPointer());
 
@@ -159,6 +166,7 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 
   // Set runtime parameters
   m_ConjugateGradientFilter->SetNumberOfIterations(this->m_NumberOfIterations);
+  m_ConjugateGradientFilter->SetTolerance(this->m_Tolerance);
 
   // Have the last filter calculate its output information
   m_ConjugateGradientFilter->UpdateOutputInformation();
@@ -168,9 +176,9 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
 }
 
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateInputRequestedRegion()
 {
   //Call the superclass' implementation of this method
@@ -179,9 +187,9 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
   this->m_ProjStackToFourDFilter->PropagateRequestedRegion(this->m_ProjStackToFourDFilter->GetOutput());
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateData()
 {
   m_ProjStackToFourDFilter->Update();
@@ -201,9 +209,9 @@ FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionS
   this->GraftOutput( pimg);
 }
 
-template<class VolumeSeriesType, class ProjectionStackType>
+template<class VolumeSeriesType, class ProjectionStackType, class StoredProjectionStackType>
 void
-FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::PrintTiming(std::ostream& os) const
 {
 }
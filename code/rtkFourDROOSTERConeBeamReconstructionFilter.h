@@ -31,6 +31,7 @@
 #include "rtkWarpSequenceImageFilter.h"
 #include "rtkUnwarpSequenceImageFilter.h"
 #include "rtkLastDimensionL0GradientDenoisingImageFilter.h"
+#include "rtkTraceCollector.h"
 
 #include <itkThresholdImageFilter.h>
 #include <itkSubtractImageFilter.h>
@@ -177,6 +178,10 @@ namespace rtk
    * }
    * \enddot
    *
+   * As in rtk::FourDConjugateGradientConeBeamReconstructionFilter, the
+   * projection stack can be stored with a lower precision, e.g. with rtk::Half
+   * pixels, by setting StoredProjectionStackType.
+   *
    * \test rtkfourdroostertest.cxx
    *
    * \author Cyril Mory
@@ -184,7 +189,9 @@ namespace rtk
    * \ingroup ReconstructionAlgorithm
    */
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType,
+          typename ProjectionStackType,
+          typename StoredProjectionStackType=ProjectionStackType>
 class FourDROOSTERConeBeamReconstructionFilter : public rtk::IterativeConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
 {
 public:
@@ -220,8 +227,8 @@ public:
   typename VolumeSeriesType::ConstPointer GetInputVolumeSeries();
 
   /** The stack of measured projections */
-  void SetInputProjectionStack(const ProjectionStackType* Projection);
-  typename ProjectionStackType::Pointer   GetInputProjectionStack();
+  void SetInputProjectionStack(const StoredProjectionStackType* Projection);
+  typename StoredProjectionStackType::Pointer   GetInputProjectionStack();
 
   /** The region of interest outside of which all movement is removed */
   void SetMotionMask(const VolumeType* mask);
@@ -233,7 +240,9 @@ public:
   typename MVFSequenceImageType::Pointer            GetDisplacementField();
   typename MVFSequenceImageType::Pointer            GetInverseDisplacementField();
 
-  typedef rtk::FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>    FourDCGFilterType;
+  typedef rtk::FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType,
+                                                                 ProjectionStackType,
+                                                                 StoredProjectionStackType>                FourDCGFilterType;
   typedef itk::ThresholdImageFilter<VolumeSeriesType>                                                       ThresholdFilterType;
   typedef itk::ResampleImageFilter<VolumeType, VolumeType>                                                  ResampleFilterType;
   typedef rtk::AverageOutOfROIImageFilter <VolumeSeriesType, VolumeType>                                    AverageOutOfROIFilterType;
@@ -24,8 +24,8 @@
 namespace rtk
 {
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::FourDROOSTERConeBeamReconstructionFilter()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::FourDROOSTERConeBeamReconstructionFilter()
 {
 //   this->SetNumberOfRequiredInputs(2);
 
@@ -77,95 +77,95 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>:
   m_L0DenoisingTime = TemporalL0DenoisingFilterType::New();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
 {
   this->SetPrimaryInput(const_cast<VolumeSeriesType*>(VolumeSeries));
 //   this->SetPrimaryInputName("VolumeSeries");
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
-::SetInputProjectionStack(const ProjectionStackType* Projection)
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
+::SetInputProjectionStack(const StoredProjectionStackType* Projection)
 {
-  this->SetInput("ProjectionStack", const_cast<ProjectionStackType*>(Projection));
+  this->SetInput("ProjectionStack", const_cast<StoredProjectionStackType*>(Projection));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetMotionMask(const VolumeType* mask)
 {
   this->SetInput("MotionMask", const_cast<VolumeType*>(mask));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetDisplacementField(const MVFSequenceImageType* MVFs)
 {
   this->SetInput("DisplacementField", const_cast<MVFSequenceImageType*>(MVFs));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetInverseDisplacementField(const MVFSequenceImageType* MVFs)
 {
   this->SetInput("InverseDisplacementField", const_cast<MVFSequenceImageType*>(MVFs));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 typename VolumeSeriesType::ConstPointer
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetInputVolumeSeries()
 {
   return static_cast< const VolumeSeriesType * >
           ( this->itk::ProcessObject::GetInput("Primary") );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename ProjectionStackType::Pointer
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename StoredProjectionStackType::Pointer
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetInputProjectionStack()
 {
-  return static_cast< ProjectionStackType * >
+  return static_cast< StoredProjectionStackType * >
           ( this->itk::ProcessObject::GetInput("ProjectionStack") );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::VolumeType::Pointer
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::VolumeType::Pointer
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetMotionMask()
 {
   return static_cast< VolumeType * >
           ( this->itk::ProcessObject::GetInput("MotionMask") );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::MVFSequenceImageType::Pointer
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::MVFSequenceImageType::Pointer
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetDisplacementField()
 {
   return static_cast< MVFSequenceImageType * >
           ( this->itk::ProcessObject::GetInput("DisplacementField") );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>::MVFSequenceImageType::Pointer
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::MVFSequenceImageType::Pointer
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetInverseDisplacementField()
 {
   return static_cast< MVFSequenceImageType * >
           ( this->itk::ProcessObject::GetInput("InverseDisplacementField") );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetForwardProjectionFilter(int _arg)
 {
   if( _arg != this->GetForwardProjectionFilter() )
@@ -175,9 +175,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     }
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetBackProjectionFilter(int _arg)
 {
   if( _arg != this->GetBackProjectionFilter() )
@@ -187,17 +187,17 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     }
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetWeights(const itk::Array2D<float> _arg)
 {
   m_FourDCGFilter->SetWeights(_arg);
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateInputRequestedRegion()
 {
   //Call the superclass' implementation of this method
@@ -246,9 +246,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     }
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateOutputInformation()
 {
   const int Dimension = VolumeType::ImageDimension;
@@ -448,9 +448,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   this->GetOutput()->CopyInformation( currentDownstreamFilter->GetOutput() );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateData()
 {
   // Declare the pointer that will be used to plug the output back as input
@@ -459,6 +459,8 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
 
   for (int i=0; i<m_MainLoop_iterations; i++)
     {
+    TraceSpan iterationSpan("4D ROOSTER iteration", this, i);
+
     // After the first iteration, we need to use the output as input
     if (i>0)
       {
@@ -472,14 +474,18 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
       }
 
     m_CGProbe.Start();
+    TraceCollector::GetInstance()->Begin("CG", this, i);
     m_FourDCGFilter->Update();
+    TraceCollector::GetInstance()->End("CG", this);
     m_CGProbe.Stop();
     currentDownstreamFilter = m_FourDCGFilter;
 
     if (m_PerformPositivity)
       {
       m_PositivityProbe.Start();
+      TraceCollector::GetInstance()->Begin("Positivity", this, i);
       m_PositivityFilter->Update();
+      TraceCollector::GetInstance()->End("Positivity", this);
       m_PositivityProbe.Stop();
     
       currentDownstreamFilter = m_PositivityFilter;
@@ -488,7 +494,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformMotionMask)
       {
       m_MotionMaskProbe.Start();
+      TraceCollector::GetInstance()->Begin("MotionMask", this, i);
       m_AverageOutOfROIFilter->Update();
+      TraceCollector::GetInstance()->End("MotionMask", this);
       m_MotionMaskProbe.Stop();
     
       currentDownstreamFilter = m_AverageOutOfROIFilter;
@@ -497,7 +505,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformTVSpatialDenoising)
       {
       m_TVSpatialDenoisingProbe.Start();
+      TraceCollector::GetInstance()->Begin("TVSpatialDenoising", this, i);
       m_TVDenoisingSpace->Update();
+      TraceCollector::GetInstance()->End("TVSpatialDenoising", this);
       m_TVSpatialDenoisingProbe.Stop();
     
       currentDownstreamFilter = m_TVDenoisingSpace;
@@ -506,7 +516,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformWaveletsSpatialDenoising)
       {
       m_WaveletsSpatialDenoisingProbe.Start();
+      TraceCollector::GetInstance()->Begin("WaveletsSpatialDenoising", this, i);
       m_WaveletsDenoisingSpace->Update();
+      TraceCollector::GetInstance()->End("WaveletsSpatialDenoising", this);
       m_WaveletsSpatialDenoisingProbe.Stop();
     
       currentDownstreamFilter = m_WaveletsDenoisingSpace;
@@ -515,7 +527,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformWarping)
       {
       m_WarpingProbe.Start();
+      TraceCollector::GetInstance()->Begin("Warping", this, i);
       m_Warp->Update();
+      TraceCollector::GetInstance()->End("Warping", this);
       m_WarpingProbe.Stop();
     
       currentDownstreamFilter = m_Warp;
@@ -524,7 +538,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformTVTemporalDenoising)
       {
       m_TVTemporalDenoisingProbe.Start();
+      TraceCollector::GetInstance()->Begin("TVTemporalDenoising", this, i);
       m_TVDenoisingTime->Update();
+      TraceCollector::GetInstance()->End("TVTemporalDenoising", this);
       m_TVTemporalDenoisingProbe.Stop();
     
       currentDownstreamFilter = m_TVDenoisingTime;
@@ -533,7 +549,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformL0TemporalDenoising)
       {
       m_L0TemporalDenoisingProbe.Start();
+      TraceCollector::GetInstance()->Begin("L0TemporalDenoising", this, i);
       m_L0DenoisingTime->Update();
+      TraceCollector::GetInstance()->End("L0TemporalDenoising", this);
       m_L0TemporalDenoisingProbe.Stop();
     
       currentDownstreamFilter = m_L0DenoisingTime;
@@ -542,6 +560,7 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
     if (m_PerformWarping)
       {
       m_UnwarpingProbe.Start();
+      TraceCollector::GetInstance()->Begin("Unwarping", this, i);
 
       if (m_ComputeInverseWarpingByConjugateGradient)
         {
@@ -558,6 +577,7 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
         currentDownstreamFilter = m_AddFilter;
         }
 
+      TraceCollector::GetInstance()->End("Unwarping", this);
       m_UnwarpingProbe.Stop();
       }
     }
@@ -565,9 +585,9 @@ FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   this->GraftOutput( currentDownstreamFilter->GetOutput() );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
+FourDROOSTERConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::PrintTiming(std::ostream& os) const
 {
   os << "FourDROOSTERConeBeamReconstructionFilter timing:" << std::endl;
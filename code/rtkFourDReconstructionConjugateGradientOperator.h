@@ -29,6 +29,7 @@
 #include "rtkBackProjectionImageFilter.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkThreadPoolImageFilter.h"
 
 #ifdef RTK_USE_CUDA
 #  include "rtkCudaInterpolateImageFilter.h"
@@ -75,6 +76,10 @@ namespace rtk
    * results in performance gain and easier GPU memory management.
    * The current implementation is the optimized one.
    *
+   * The projection stack is only used for its information. Its pixel type,
+   * StoredProjectionStackType, may therefore differ from that of the
+   * projections processed internally, e.g. to store it with rtk::Half pixels.
+   *
    * \dot
    * digraph FourDReconstructionConjugateGradientOperator {
    *
@@ -122,7 +127,9 @@ namespace rtk
    * \ingroup ReconstructionAlgorithm
    */
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType,
+          typename ProjectionStackType,
+          typename StoredProjectionStackType=ProjectionStackType>
 class FourDReconstructionConjugateGradientOperator : public ConjugateGradientOperator< VolumeSeriesType>
 {
 public:
@@ -145,7 +152,7 @@ public:
 
     /** The image that will be backprojected, then added, with coefficients, to each 3D volume of the 4D image.
     * It is 3D because the backprojection filters need it, but the third dimension, which is the number of projections, is 1  */
-    void SetInputProjectionStack(const ProjectionStackType* Projection);
+    void SetInputProjectionStack(const StoredProjectionStackType* Projection);
 
     typedef rtk::BackProjectionImageFilter< ProjectionStackType, ProjectionStackType >          BackProjectionFilterType;
     typedef rtk::ForwardProjectionImageFilter< ProjectionStackType, ProjectionStackType >       ForwardProjectionFilterType;
@@ -182,7 +189,7 @@ protected:
     ~FourDReconstructionConjugateGradientOperator(){}
 
     typename VolumeSeriesType::ConstPointer GetInputVolumeSeries();
-    typename ProjectionStackType::ConstPointer GetInputProjectionStack();
+    typename StoredProjectionStackType::ConstPointer GetInputProjectionStack();
 
     /** Builds the pipeline and computes output information */
     virtual void GenerateOutputInformation();
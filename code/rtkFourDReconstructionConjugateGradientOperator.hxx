@@ -23,8 +23,8 @@
 namespace rtk
 {
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>::FourDReconstructionConjugateGradientOperator()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::FourDReconstructionConjugateGradientOperator()
 {
   this->SetNumberOfRequiredInputs(2);
 
@@ -38,53 +38,53 @@ FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackTy
   m_DisplacedDetectorFilter->SetPadOnTruncatedSide(false);
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-void FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+void FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
 {
   this->SetNthInput(0, const_cast<VolumeSeriesType*>(VolumeSeries));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-void FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>::SetInputProjectionStack(const ProjectionStackType* Projection)
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+void FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputProjectionStack(const StoredProjectionStackType* Projection)
 {
-  this->SetNthInput(1, const_cast<ProjectionStackType*>(Projection));
+  this->SetNthInput(1, const_cast<StoredProjectionStackType*>(Projection));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename VolumeSeriesType::ConstPointer FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>::GetInputVolumeSeries()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename VolumeSeriesType::ConstPointer FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputVolumeSeries()
 {
   return static_cast< const VolumeSeriesType * >
           ( this->itk::ProcessObject::GetInput(0) );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename ProjectionStackType::ConstPointer FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>::GetInputProjectionStack()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename StoredProjectionStackType::ConstPointer FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputProjectionStack()
 {
-  return static_cast< const ProjectionStackType * >
+  return static_cast< const StoredProjectionStackType * >
           ( this->itk::ProcessObject::GetInput(1) );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetBackProjectionFilter (const typename BackProjectionFilterType::Pointer _arg)
 {
   m_BackProjectionFilter = _arg;
   this->Modified();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetForwardProjectionFilter (const typename ForwardProjectionFilterType::Pointer _arg)
 {
   m_ForwardProjectionFilter = _arg;
   this->Modified();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::InitializeConstantSources()
 {
   unsigned int Dimension = 3;
@@ -136,20 +136,20 @@ FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackTy
   m_ConstantVolumeSeriesSource->ReleaseDataFlagOn();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateOutputInformation()
 {
   // Create the interpolation filter (first on CPU, and overwrite with the GPU version if CUDA requested)
-  m_InterpolationFilter = InterpolationFilterType::New();
+  m_InterpolationFilter = ThreadPoolImageFilter<InterpolationFilterType>::New();
 #ifdef RTK_USE_CUDA
   if (m_UseCudaInterpolation)
     m_InterpolationFilter = rtk::CudaInterpolateImageFilter::New();
 #endif
 
   // Create the splat filter (first on CPU, and overwrite with the GPU version if CUDA requested)
-  m_SplatFilter = SplatFilterType::New();
+  m_SplatFilter = ThreadPoolImageFilter<SplatFilterType>::New();
 #ifdef RTK_USE_CUDA
   if (m_UseCudaSplat)
     m_SplatFilter = rtk::CudaSplatImageFilter::New();
@@ -214,9 +214,9 @@ FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackTy
 }
 
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateInputRequestedRegion()
 {
   // Let the internal filters compute the input requested region
@@ -227,9 +227,9 @@ FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackTy
   // Leave its requested region unchanged (set by the other filters that need it)
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType>
+FourDReconstructionConjugateGradientOperator<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateData()
 {
   int Dimension = ProjectionStackType::ImageDimension;
@@ -24,17 +24,21 @@
 
 #include <itkExtractImageFilter.h>
 #include <itkMultiplyImageFilter.h>
-#include <itkSubtractImageFilter.h>
-#include <itkAddImageAdaptor.h>
-#include <itkDivideOrZeroOutImageFilter.h>
+#include <itkAddImageFilter.h>
 #include <itkTimeProbe.h>
-#include <itkThresholdImageFilter.h>
+#if !defined(ITK_LEGACY_REMOVE)
+# include <itkSubtractImageFilter.h>
+# include <itkDivideOrZeroOutImageFilter.h>
+# include <itkThresholdImageFilter.h>
+#endif
 
 #include "rtkRayBoxIntersectionImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkProjectionStackToFourDImageFilter.h"
 #include "rtkFourDToProjectionStackImageFilter.h"
+#include "rtkFusedArithmeticImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -46,6 +50,9 @@ namespace rtk
  * is essentially the same as in SARTConeBeamReconstructionFilter, with
  * the ForwardProjectionImageFilter replaced by 4DToProjectionStackImageFilter
  * and the BackProjectionImageFilter replaced by ProjectionStackTo4DImageFilter.
+ * As in SARTConeBeamReconstructionFilter, the correction of the projections
+ * and the update of the volume are each computed in a single pass by an
+ * rtk::FusedArithmeticImageFilter.
  *
  * \dot
  * digraph FourDSARTConeBeamReconstructionFilter {
@@ -62,48 +69,42 @@ namespace rtk
  * Extract [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * MultiplyByZero [ label="itk::MultiplyImageFilter (by zero)" URL="\ref itk::MultiplyImageFilter"];
  * AfterExtract [label="", fixedsize="false", width=0, height=0, shape=none];
- * Subtract [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
- * MultiplyByLambda [ label="itk::MultiplyImageFilter (by lambda)" URL="\ref itk::MultiplyImageFilter"];
- * Divide [ label="itk::DivideOrZeroOutImageFilter" URL="\ref itk::DivideOrZeroOutImageFilter"];
+ * Correction [ label="rtk::FusedArithmeticImageFilter (SART correction)" URL="\ref rtk::FusedArithmeticImageFilter"];
  * ConstantProjectionStack [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * ExtractConstantProjection [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * RayBox [ label="rtk::RayBoxIntersectionImageFilter" URL="\ref rtk::RayBoxIntersectionImageFilter"];
  * ConstantVolume [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * ProjectionStackToFourD [ label="rtk::ProjectionStackToFourDImageFilter" URL="\ref rtk::ProjectionStackToFourDImageFilter"];
  * Add [ label="itk::AddImageFilter (accumulates corrections)" URL="\ref itk::AddImageFilter"];
- * Add2 [ label="itk::AddImageFilter (adds correction to current 4D volume)" URL="\ref itk::AddImageFilter"];
+ * Update [ label="rtk::FusedArithmeticImageFilter (sum and positivity)" URL="\ref rtk::FusedArithmeticImageFilter"];
  * OutofInput0 [label="", fixedsize="false", width=0, height=0, shape=none];
- * Threshold [ label="itk::ThresholdImageFilter" URL="\ref itk::ThresholdImageFilter"];
- * OutofThreshold [label="", fixedsize="false", width=0, height=0, shape=none];
+ * OutofUpdate [label="", fixedsize="false", width=0, height=0, shape=none];
  * OutofBP [label="", fixedsize="false", width=0, height=0, shape=none];
  * BeforeAdd [label="", fixedsize="false", width=0, height=0, shape=none];
- * BeforeAdd2 [label="", fixedsize="false", width=0, height=0, shape=none];
+ * BeforeUpdate [label="", fixedsize="false", width=0, height=0, shape=none];
  * Input0 -> OutofInput0 [arrowhead=none];
  * OutofInput0 -> FourDToProjectionStack;
- * OutofInput0 -> Add2;
+ * OutofInput0 -> Update;
  * BeforeAdd -> Add;
  * ConstantVolume -> BeforeAdd [arrowhead=none];
  * OutofInput0 -> ProjectionStackToFourD;
  * Extract -> AfterExtract[arrowhead=none];
  * AfterExtract -> MultiplyByZero;
- * AfterExtract -> Subtract;
+ * AfterExtract -> Correction;
  * MultiplyByZero -> FourDToProjectionStack;
  * Input1 -> Extract;
- * FourDToProjectionStack -> Subtract;
- * Subtract -> MultiplyByLambda;
- * MultiplyByLambda -> Divide;
+ * FourDToProjectionStack -> Correction;
  * ConstantProjectionStack -> ExtractConstantProjection;
  * ExtractConstantProjection -> RayBox;
- * RayBox -> Divide;
- * Divide -> ProjectionStackToFourD;
+ * RayBox -> Correction;
+ * Correction -> ProjectionStackToFourD;
  * ProjectionStackToFourD -> Add;
- * Add -> BeforeAdd2 [arrowhead=none];
- * BeforeAdd2 -> Add2;
- * BeforeAdd2 -> BeforeAdd [style=dashed, constraint=false];
- * Add2 -> Threshold;
- * Threshold -> OutofThreshold [arrowhead=none];
- * OutofThreshold -> OutofInput0 [headport="se", style=dashed];
- * OutofThreshold -> Output;
+ * Add -> BeforeUpdate [arrowhead=none];
+ * BeforeUpdate -> Update;
+ * BeforeUpdate -> BeforeAdd [style=dashed, constraint=false];
+ * Update -> OutofUpdate [arrowhead=none];
+ * OutofUpdate -> OutofInput0 [headport="se", style=dashed];
+ * OutofUpdate -> Output;
  * }
  * \enddot
  *
@@ -133,16 +134,24 @@ public:
   typedef itk::ExtractImageFilter< ProjectionStackType, ProjectionStackType >                             ExtractFilterType;
   typedef rtk::ForwardProjectionImageFilter< ProjectionStackType, ProjectionStackType >                   ForwardProjectionFilterType;
   typedef rtk::FourDToProjectionStackImageFilter < ProjectionStackType, VolumeSeriesType >                FourDToProjectionStackFilterType;
-  typedef itk::SubtractImageFilter< ProjectionStackType, ProjectionStackType >                            SubtractFilterType;
   typedef itk::MultiplyImageFilter< ProjectionStackType, ProjectionStackType, ProjectionStackType >       MultiplyFilterType;
   typedef itk::AddImageFilter< VolumeSeriesType, VolumeSeriesType >                                       AddFilterType;
   typedef rtk::BackProjectionImageFilter< VolumeType, VolumeType >                                        BackProjectionFilterType;
   typedef rtk::ProjectionStackToFourDImageFilter < VolumeSeriesType, ProjectionStackType >                ProjectionStackToFourDFilterType;
   typedef rtk::RayBoxIntersectionImageFilter<ProjectionStackType, ProjectionStackType>                    RayBoxIntersectionFilterType;
-  typedef itk::DivideOrZeroOutImageFilter<ProjectionStackType, ProjectionStackType, ProjectionStackType>  DivideFilterType;
   typedef rtk::ConstantImageSource<VolumeSeriesType>                                                      ConstantVolumeSeriesSourceType;
   typedef rtk::ConstantImageSource<ProjectionStackType>                                                   ConstantProjectionStackSourceType;
+  typedef rtk::FusedArithmeticImageFilter<ProjectionStackType>                                            CorrectionFilterType;
+  typedef rtk::FusedArithmeticImageFilter<VolumeSeriesType>                                               UpdateFilterType;
+
+#if !defined(ITK_LEGACY_REMOVE)
+  /** \deprecated The subtraction, the multiplication by lambda and the
+   * division are fused in CorrectionFilterType and the threshold in
+   * UpdateFilterType. These types are not used anymore. */
+  typedef itk::SubtractImageFilter< ProjectionStackType, ProjectionStackType >                            SubtractFilterType;
+  typedef itk::DivideOrZeroOutImageFilter<ProjectionStackType, ProjectionStackType, ProjectionStackType>  DivideFilterType;
   typedef itk::ThresholdImageFilter<VolumeSeriesType>                                                     ThresholdFilterType;
+#endif
 
 /** Standard New method. */
   itkNewMacro(Self);
@@ -208,17 +217,14 @@ protected:
   typename MultiplyFilterType::Pointer                    m_ZeroMultiplyFilter;
   typename ForwardProjectionFilterType::Pointer           m_ForwardProjectionFilter;
   typename FourDToProjectionStackFilterType::Pointer      m_FourDToProjectionStackFilter;
-  typename SubtractFilterType::Pointer                    m_SubtractFilter;
+  typename CorrectionFilterType::Pointer                  m_CorrectionFilter;
   typename AddFilterType::Pointer                         m_AddFilter;
-  typename AddFilterType::Pointer                         m_AddFilter2;
-  typename MultiplyFilterType::Pointer                    m_MultiplyFilter;
+  typename UpdateFilterType::Pointer                      m_UpdateFilter;
   typename BackProjectionFilterType::Pointer              m_BackProjectionFilter;
   typename ProjectionStackToFourDFilterType::Pointer      m_ProjectionStackToFourDFilter;
   typename RayBoxIntersectionFilterType::Pointer          m_RayBoxFilter;
-  typename DivideFilterType::Pointer                      m_DivideFilter;
   typename ConstantProjectionStackSourceType::Pointer     m_ConstantProjectionStackSource;
   typename ConstantVolumeSeriesSourceType::Pointer        m_ConstantVolumeSeriesSource;
-  typename ThresholdFilterType::Pointer                   m_ThresholdFilter;
 
   /** Miscellaneous member variables */
   std::vector< unsigned int >                    m_ProjectionsOrder;
@@ -248,13 +254,11 @@ private:
   itk::TimeProbe m_ExtractProbe;
   itk::TimeProbe m_ZeroMultiplyProbe;
   itk::TimeProbe m_ForwardProjectionProbe;
-  itk::TimeProbe m_SubtractProbe;
-  itk::TimeProbe m_MultiplyProbe;
+  itk::TimeProbe m_CorrectionProbe;
   itk::TimeProbe m_RayBoxProbe;
-  itk::TimeProbe m_DivideProbe;
   itk::TimeProbe m_BackProjectionProbe;
-  itk::TimeProbe m_ThresholdProbe;
   itk::TimeProbe m_AddProbe;
+  itk::TimeProbe m_UpdateProbe;
 
 }; // end of class
 
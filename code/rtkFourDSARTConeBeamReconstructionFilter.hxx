@@ -41,10 +41,9 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   // Create each filter of the composite filter
   m_ExtractFilter = ExtractFilterType::New();
   m_ZeroMultiplyFilter = MultiplyFilterType::New();
-  m_SubtractFilter = SubtractFilterType::New();
+  m_CorrectionFilter = CorrectionFilterType::New();
   m_AddFilter = AddFilterType::New();
-  m_AddFilter2 = AddFilterType::New();
-  m_MultiplyFilter = MultiplyFilterType::New();
+  m_UpdateFilter = UpdateFilterType::New();
   m_ConstantVolumeSeriesSource = ConstantVolumeSeriesSourceType::New();
   m_FourDToProjectionStackFilter = FourDToProjectionStackFilterType::New();
   m_ProjectionStackToFourDFilter = ProjectionStackToFourDFilterType::New();
@@ -53,23 +52,18 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   // projection
   m_ExtractFilterRayBox = ExtractFilterType::New();
   m_RayBoxFilter = RayBoxIntersectionFilterType::New();
-  m_DivideFilter = DivideFilterType::New();
   m_ConstantProjectionStackSource = ConstantProjectionStackSourceType::New();
 
-  // Create the filter that enforces positivity
-  m_ThresholdFilter = ThresholdFilterType::New();
-  
   //Permanent internal connections
   m_ZeroMultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
   m_ZeroMultiplyFilter->SetInput2( m_ExtractFilter->GetOutput() );
 
-  m_MultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
-  m_MultiplyFilter->SetInput2( m_SubtractFilter->GetOutput() );
+  m_CorrectionFilter->SetInput(1, m_ExtractFilter->GetOutput() );
+  m_CorrectionFilter->SetSARTCorrection(0.);
 
   m_ExtractFilterRayBox->SetInput(m_ConstantProjectionStackSource->GetOutput());
   m_RayBoxFilter->SetInput(m_ExtractFilterRayBox->GetOutput());
-  m_DivideFilter->SetInput1(m_MultiplyFilter->GetOutput());
-  m_DivideFilter->SetInput2(m_RayBoxFilter->GetOutput());
+  m_CorrectionFilter->SetInput(2, m_RayBoxFilter->GetOutput());
 
   // Default parameters
   m_ExtractFilter->SetDirectionCollapseToSubmatrix();
@@ -158,16 +152,8 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   if ( !inputPtr )
     return;
 
-  if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_ThresholdFilter->GetOutput()->PropagateRequestedRegion();
-    }
-  else
-    {
-    m_AddFilter2->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_AddFilter2->GetOutput()->PropagateRequestedRegion();
-    }
+  m_UpdateFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
+  m_UpdateFilter->GetOutput()->PropagateRequestedRegion();
 }
 
 template<class VolumeSeriesType, class ProjectionStackType>
@@ -208,21 +194,21 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   m_ConstantVolumeSeriesSource->UpdateOutputInformation();
 
   m_ProjectionStackToFourDFilter->SetInputVolumeSeries( this->GetInputVolumeSeries() );
-  m_ProjectionStackToFourDFilter->SetInputProjectionStack( m_DivideFilter->GetOutput() );
+  m_ProjectionStackToFourDFilter->SetInputProjectionStack( m_CorrectionFilter->GetOutput() );
 
   m_AddFilter->SetInput1(m_ProjectionStackToFourDFilter->GetOutput());
   m_AddFilter->SetInput2(m_ConstantVolumeSeriesSource->GetOutput());
 
-  m_AddFilter2->SetInput1(m_AddFilter->GetOutput());
-  m_AddFilter2->SetInput2(this->GetInputVolumeSeries());
+  m_UpdateFilter->SetInput(0, m_AddFilter->GetOutput());
+  m_UpdateFilter->SetInput(1, this->GetInputVolumeSeries());
+  m_UpdateFilter->SetSum(m_EnforcePositivity);
 
   m_ExtractFilter->SetInput( this->GetInputProjectionStack() );
 
   m_FourDToProjectionStackFilter->SetInputProjectionStack( m_ZeroMultiplyFilter->GetOutput() );
   m_FourDToProjectionStackFilter->SetInputVolumeSeries( this->GetInputVolumeSeries() );
 
-  m_SubtractFilter->SetInput2(m_FourDToProjectionStackFilter->GetOutput() );
-  m_SubtractFilter->SetInput1(m_ExtractFilter->GetOutput() );
+  m_CorrectionFilter->SetInput(0, m_FourDToProjectionStackFilter->GetOutput() );
 
   // For the same reason, set geometry now
   // Check and set geometry
@@ -256,39 +242,20 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   m_ZeroMultiplyFilter->UpdateOutputInformation();
   m_FourDToProjectionStackFilter->UpdateOutputInformation();
 
-  m_DivideFilter->UpdateOutputInformation();
+  m_CorrectionFilter->UpdateOutputInformation();
 
-  
-  if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->SetOutsideValue(0);
-    m_ThresholdFilter->ThresholdBelow(0);
-    m_ThresholdFilter->SetInput(m_AddFilter2->GetOutput() );
-
-    // Update output information
-    m_ThresholdFilter->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_ThresholdFilter->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_ThresholdFilter->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_ThresholdFilter->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_ThresholdFilter->GetOutput()->GetLargestPossibleRegion() );
-    }
-  else
-    {
-    // Update output information
-    m_AddFilter2->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_AddFilter2->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_AddFilter2->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_AddFilter2->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_AddFilter2->GetOutput()->GetLargestPossibleRegion() );
-    }
+  // Update output information
+  m_UpdateFilter->UpdateOutputInformation();
+  this->GetOutput()->SetOrigin( m_UpdateFilter->GetOutput()->GetOrigin() );
+  this->GetOutput()->SetSpacing( m_UpdateFilter->GetOutput()->GetSpacing() );
+  this->GetOutput()->SetDirection( m_UpdateFilter->GetOutput()->GetDirection() );
+  this->GetOutput()->SetLargestPossibleRegion( m_UpdateFilter->GetOutput()->GetLargestPossibleRegion() );
 
   // Set memory management flags
   m_ZeroMultiplyFilter->ReleaseDataFlagOn();
   m_FourDToProjectionStackFilter->ReleaseDataFlagOn();
-  m_SubtractFilter->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
   m_RayBoxFilter->ReleaseDataFlagOn();
-  m_DivideFilter->ReleaseDataFlagOn();
+  m_CorrectionFilter->ReleaseDataFlagOn();
 }
 
 template<class VolumeSeriesType, class ProjectionStackType>
@@ -303,8 +270,8 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   unsigned int nProj = subsetRegion.GetSize(Dimension-1);
   subsetRegion.SetSize(Dimension-1, 1);
 
-  m_MultiplyFilter->SetInput1( (const float) m_Lambda/(double)m_NumberOfProjectionsPerSubset  );
-  
+  m_CorrectionFilter->SetSARTCorrection( m_Lambda/(double)m_NumberOfProjectionsPerSubset );
+
   // Create the zero projection stack used as input by RayBoxIntersectionFilter
   m_ConstantProjectionStackSource->Update();
 
@@ -315,6 +282,8 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
   // For each iteration, go over each projection
   for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
     {
+    TraceSpan iterationSpan("4D SART iteration", this, iter);
+
     unsigned int projectionsProcessedInSubset = 0;
 
     for(unsigned int i = 0; i < nProj; i++)
@@ -325,15 +294,11 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
       // - reset the projectionsProcessedInSubset to zero
       if (projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset)
         {
-        if (m_EnforcePositivity)
-          pimg2 = m_ThresholdFilter->GetOutput();
-        else
-          pimg2 = m_AddFilter2->GetOutput();
-
+        pimg2 = m_UpdateFilter->GetOutput();
         pimg2->DisconnectPipeline();
 
         m_FourDToProjectionStackFilter->SetInputVolumeSeries( pimg2 );
-        m_AddFilter2->SetInput2( pimg2 );
+        m_UpdateFilter->SetInput(1, pimg2 );
         m_AddFilter->SetInput2(m_ConstantVolumeSeriesSource->GetOutput());
 
         projectionsProcessedInSubset = 0;
@@ -377,21 +342,13 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
       m_FourDToProjectionStackFilter->Update();
       m_ForwardProjectionProbe.Stop();
 
-      m_SubtractProbe.Start();
-      m_SubtractFilter->Update();
-      m_SubtractProbe.Stop();
-
-      m_MultiplyProbe.Start();
-      m_MultiplyFilter->Update();
-      m_MultiplyProbe.Stop();
-
       m_RayBoxProbe.Start();
       m_RayBoxFilter->Update();
       m_RayBoxProbe.Stop();
 
-      m_DivideProbe.Start();
-      m_DivideFilter->Update();
-      m_DivideProbe.Stop();
+      m_CorrectionProbe.Start();
+      m_CorrectionFilter->Update();
+      m_CorrectionProbe.Stop();
 
       m_BackProjectionProbe.Start();
       m_ProjectionStackToFourDFilter->Update();
@@ -404,29 +361,15 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
       projectionsProcessedInSubset++;
       if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i == nProj - 1))
         {
-        m_AddProbe.Start();
-        m_AddFilter2->SetInput1(m_AddFilter->GetOutput());
-        m_AddFilter2->Update();
-        m_AddProbe.Stop();
-
-        if (m_EnforcePositivity)
-          {
-          m_ThresholdProbe.Start();
-          m_ThresholdFilter->Update();
-          m_ThresholdProbe.Stop();
-          }
+        m_UpdateProbe.Start();
+        m_UpdateFilter->SetInput(0, m_AddFilter->GetOutput());
+        m_UpdateFilter->Update();
+        m_UpdateProbe.Stop();
         }
 
       }
     }
-  if (m_EnforcePositivity)
-    {
-    this->GraftOutput( m_ThresholdFilter->GetOutput() );
-    }
-  else
-    {
-    this->GraftOutput( m_AddFilter2->GetOutput() );
-    }
+  this->GraftOutput( m_UpdateFilter->GetOutput() );
 }
 
 template<class VolumeSeriesType, class ProjectionStackType>
@@ -441,23 +384,16 @@ FourDSARTConeBeamReconstructionFilter<VolumeSeriesType, ProjectionStackType>
      << ' ' << m_ZeroMultiplyProbe.GetUnit() << std::endl;
   os << "  Forward projection: " << m_ForwardProjectionProbe.GetTotal()
      << ' ' << m_ForwardProjectionProbe.GetUnit() << std::endl;
-  os << "  Subtraction: " << m_SubtractProbe.GetTotal()
-     << ' ' << m_SubtractProbe.GetUnit() << std::endl;
-  os << "  Multiplication by lambda: " << m_MultiplyProbe.GetTotal()
-     << ' ' << m_MultiplyProbe.GetUnit() << std::endl;
   os << "  Ray box intersection: " << m_RayBoxProbe.GetTotal()
      << ' ' << m_RayBoxProbe.GetUnit() << std::endl;
-  os << "  Division: " << m_DivideProbe.GetTotal()
-     << ' ' << m_DivideProbe.GetUnit() << std::endl;
+  os << "  Correction (subtraction, multiplication by lambda and division): " << m_CorrectionProbe.GetTotal()
+     << ' ' << m_CorrectionProbe.GetUnit() << std::endl;
   os << "  Back projection: " << m_BackProjectionProbe.GetTotal()
      << ' ' << m_BackProjectionProbe.GetUnit() << std::endl;
-  os << "  Volume update: " << m_AddProbe.GetTotal()
+  os << "  Accumulation of the corrections: " << m_AddProbe.GetTotal()
      << ' ' << m_AddProbe.GetUnit() << std::endl;
-  if (m_EnforcePositivity)
-    {
-    os << "  Positivity enforcement: " << m_ThresholdProbe.GetTotal()
-    << ' ' << m_ThresholdProbe.GetUnit() << std::endl;
-    }
+  os << "  Volume update (sum and positivity): " << m_UpdateProbe.GetTotal()
+     << ' ' << m_UpdateProbe.GetUnit() << std::endl;
 }
 
 } // end namespace rtk
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFusedArithmeticImageFilter_h
+#define __rtkFusedArithmeticImageFilter_h
+
+#include <itkInPlaceImageFilter.h>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class FusedArithmeticImageFilter
+ * \brief Evaluates a chain of element-wise operations in a single pass.
+ *
+ * Composite filters often chain itk::AddImageFilter,
+ * itk::SubtractImageFilter, itk::MultiplyImageFilter,
+ * itk::DivideOrZeroOutImageFilter and itk::ThresholdImageFilter, each of them
+ * reading and writing a full image. This filter replaces such a chain by a
+ * small program in reverse Polish notation which is evaluated once per pixel:
+ * Push(INPUT, i) pushes input i on a stack, Push(CONSTANT, c) pushes a
+ * constant, and each operation pops its operands and pushes its result. The
+ * output is the single value left on the stack.
+ *
+ * The program is interpreted on blocks of a few hundred values of each line of
+ * the output region so that the cost of the interpretation is amortized and
+ * that each operation is a simple loop that the compiler can vectorize. The
+ * intermediate results stay in the cache and the images are read and written
+ * once only.
+ *
+ * All inputs have the type of the output. If the pixel is a fixed length
+ * vector, e.g., a gradient, the operations are applied to each component.
+ *
+ * Helpers program the updates of SART and of the ADMM right-hand sides.
+ *
+ * \test rtkfusedarithmetictest.cxx
+ *
+ * \ingroup InPlaceImageFilter
+ */
+template<class TImage>
+class ITK_EXPORT FusedArithmeticImageFilter :
+  public itk::InPlaceImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef FusedArithmeticImageFilter                Self;
+  typedef itk::InPlaceImageFilter<TImage, TImage>   Superclass;
+  typedef itk::SmartPointer<Self>                   Pointer;
+  typedef itk::SmartPointer<const Self>             ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                                         ImageType;
+  typedef typename ImageType::PixelType                  PixelType;
+  typedef typename itk::NumericTraits<PixelType>::ValueType ValueType;
+  typedef typename ImageType::RegionType                 OutputImageRegionType;
+
+  /** Instructions of the program. INPUT and CONSTANT push a value on the
+   * stack, unary operations replace the top of the stack and binary
+   * operations replace the two values on top of the stack, the first operand
+   * being the deepest one. DIVIDE_OR_ZERO_OUT returns 0 when the denominator
+   * is below 1e-5, like itk::DivideOrZeroOutImageFilter. */
+  typedef enum {INPUT=0,
+                CONSTANT,
+                ADD,
+                SUBTRACT,
+                MULTIPLY,
+                DIVIDE,
+                DIVIDE_OR_ZERO_OUT,
+                MINIMUM,
+                MAXIMUM,
+                NEGATE,
+                ABSOLUTE} OperationType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(FusedArithmeticImageFilter, InPlaceImageFilter);
+
+  /** Removes all the instructions of the program. */
+  void ClearProgram();
+
+  /** Appends an operation to the program. */
+  void Push(OperationType operation);
+
+  /** Appends INPUT, with the index of the input, or CONSTANT, with its value,
+   * to the program. Returns the position of the instruction which can be used
+   * to change the constant with SetConstant. */
+  unsigned int Push(OperationType operation, double operand);
+
+  /** Changes the value of the constant pushed at position pos of the program. */
+  void SetConstant(unsigned int pos, double value);
+
+  /** Number of instructions of the program. */
+  unsigned int GetProgramSize() const { return m_Program.size(); }
+
+  /** Programs the correction of SART,
+   * weight * lambda * (input 1 - input 0) / input 2,
+   * where input 0 is the forward projection, input 1 the measured projection
+   * and input 2 the length of the rays in the volume. The division is zeroed
+   * out like in itk::DivideOrZeroOutImageFilter. */
+  void SetSARTCorrection(double lambda, double weight = 1.);
+
+  /** Programs input 0 + input 1, with negative values set to 0 if
+   * enforcePositivity is true. This is the update of the volume of SART. */
+  void SetSum(bool enforcePositivity = false);
+
+  /** Programs the right-hand side of the conjugate gradient of ADMM TV,
+   * input 0 - beta * input 1, where input 0 is the back projection of the
+   * projections and input 1 the divergence of the sum of the dual variable and
+   * of the auxiliary variable. */
+  void SetADMMTotalVariationRightHandSide(double beta);
+
+  /** Programs the right-hand side of the conjugate gradient of ADMM wavelets,
+   * input 0 + beta * (input 1 + input 2), where input 0 is the back projection
+   * of the projections and inputs 1 and 2 the dual and the auxiliary variables. */
+  void SetADMMWaveletsRightHandSide(double beta);
+
+protected:
+  FusedArithmeticImageFilter();
+  ~FusedArithmeticImageFilter() {}
+
+  /** Checks that the program is valid for the inputs of the filter. */
+  virtual void BeforeThreadedGenerateData();
+
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
+
+  /** Evaluates the program on n values. The inputs are pointed by inputs and
+   * stack is a buffer of m_MaximumStackDepth*BlockSize values. */
+  void EvaluateBlock(const ValueType * const *inputs, ValueType *stack, ValueType *output, unsigned int n) const;
+
+  /** Number of values of the blocks evaluated by the program. */
+  itkStaticConstMacro(BlockSize, unsigned int, 512);
+
+private:
+  FusedArithmeticImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);             //purposely not implemented
+
+  struct Instruction
+    {
+    OperationType operation;
+    unsigned int  input;
+    ValueType     constant;
+    };
+
+  std::vector<Instruction> m_Program;
+  unsigned int             m_MaximumStackDepth;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkFusedArithmeticImageFilter.hxx"
+#endif
+
+#endif
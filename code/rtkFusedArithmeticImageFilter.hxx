@@ -0,0 +1,322 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFusedArithmeticImageFilter_hxx
+#define __rtkFusedArithmeticImageFilter_hxx
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template <class TImage>
+FusedArithmeticImageFilter<TImage>
+::FusedArithmeticImageFilter():
+  m_MaximumStackDepth(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::ClearProgram()
+{
+  m_Program.clear();
+  this->Modified();
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::Push(OperationType operation)
+{
+  if(operation == INPUT || operation == CONSTANT)
+    itkExceptionMacro(<< "INPUT and CONSTANT require an operand");
+  Instruction instruction;
+  instruction.operation = operation;
+  instruction.input = 0;
+  instruction.constant = 0;
+  m_Program.push_back(instruction);
+  this->Modified();
+}
+
+template <class TImage>
+unsigned int
+FusedArithmeticImageFilter<TImage>
+::Push(OperationType operation, double operand)
+{
+  Instruction instruction;
+  instruction.operation = operation;
+  instruction.input = 0;
+  instruction.constant = 0;
+  if(operation == INPUT)
+    instruction.input = (unsigned int) operand;
+  else if(operation == CONSTANT)
+    instruction.constant = operand;
+  else
+    itkExceptionMacro(<< "Only INPUT and CONSTANT have an operand");
+  m_Program.push_back(instruction);
+  this->Modified();
+  return m_Program.size()-1;
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::SetConstant(unsigned int pos, double value)
+{
+  if(pos >= m_Program.size() || m_Program[pos].operation != CONSTANT)
+    itkExceptionMacro(<< "Instruction " << pos << " of the program is not a CONSTANT");
+  if(m_Program[pos].constant != (ValueType) value)
+    {
+    m_Program[pos].constant = value;
+    this->Modified();
+    }
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::SetSARTCorrection(double lambda, double weight)
+{
+  ClearProgram();
+  Push(INPUT, 1);
+  Push(INPUT, 0);
+  Push(SUBTRACT);
+  Push(CONSTANT, lambda);
+  Push(MULTIPLY);
+  Push(INPUT, 2);
+  Push(DIVIDE_OR_ZERO_OUT);
+  if(weight != 1.)
+    {
+    Push(CONSTANT, weight);
+    Push(MULTIPLY);
+    }
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::SetSum(bool enforcePositivity)
+{
+  ClearProgram();
+  Push(INPUT, 0);
+  Push(INPUT, 1);
+  Push(ADD);
+  if(enforcePositivity)
+    {
+    Push(CONSTANT, 0.);
+    Push(MAXIMUM);
+    }
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::SetADMMTotalVariationRightHandSide(double beta)
+{
+  ClearProgram();
+  Push(INPUT, 0);
+  Push(INPUT, 1);
+  Push(CONSTANT, beta);
+  Push(MULTIPLY);
+  Push(SUBTRACT);
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::SetADMMWaveletsRightHandSide(double beta)
+{
+  ClearProgram();
+  Push(INPUT, 1);
+  Push(INPUT, 2);
+  Push(ADD);
+  Push(CONSTANT, beta);
+  Push(MULTIPLY);
+  Push(INPUT, 0);
+  Push(ADD);
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::BeforeThreadedGenerateData()
+{
+  unsigned int depth = 0;
+  m_MaximumStackDepth = 0;
+  for(unsigned int i=0; i<m_Program.size(); i++)
+    {
+    switch(m_Program[i].operation)
+      {
+      case INPUT:
+        if(m_Program[i].input >= this->GetNumberOfInputs() || !this->GetInput(m_Program[i].input))
+          itkExceptionMacro(<< "Instruction " << i << " pushes input " << m_Program[i].input << " which is not set");
+        depth++;
+        break;
+      case CONSTANT:
+        depth++;
+        break;
+      case NEGATE:
+      case ABSOLUTE:
+        if(depth < 1)
+          itkExceptionMacro(<< "Instruction " << i << " requires one operand on the stack");
+        break;
+      default:
+        if(depth < 2)
+          itkExceptionMacro(<< "Instruction " << i << " requires two operands on the stack");
+        depth--;
+      }
+    m_MaximumStackDepth = std::max(m_MaximumStackDepth, depth);
+    }
+  if(depth != 1)
+    itkExceptionMacro(<< "The program leaves " << depth << " values on the stack instead of 1");
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId))
+{
+  const unsigned int blockSize = BlockSize;
+  const unsigned int nInputs = this->GetNumberOfInputs();
+  const unsigned int nComponents = sizeof(PixelType) / sizeof(ValueType);
+  const unsigned int lineLength = outputRegionForThread.GetSize(0) * nComponents;
+
+  std::vector<ValueType> stack(m_MaximumStackDepth * blockSize);
+  std::vector<const ValueType *> inputs(nInputs, (const ValueType *)NULL);
+  std::vector<const ValueType *> lineInputs(nInputs, (const ValueType *)NULL);
+  ImageType *output = this->GetOutput();
+
+  // Go over the lines of the region, the lines are contiguous in memory
+  OutputImageRegionType lineRegion = outputRegionForThread;
+  lineRegion.SetSize(0, 1);
+  itk::ImageRegionConstIteratorWithIndex<ImageType> itLine(output, lineRegion);
+  for(; !itLine.IsAtEnd(); ++itLine)
+    {
+    const typename ImageType::IndexType index = itLine.GetIndex();
+    for(unsigned int i=0; i<nInputs; i++)
+      {
+      const ImageType *input = this->GetInput(i);
+      if(input)
+        lineInputs[i] = reinterpret_cast<const ValueType *>(input->GetBufferPointer() + input->ComputeOffset(index));
+      }
+    ValueType *out = reinterpret_cast<ValueType *>(output->GetBufferPointer() + output->ComputeOffset(index));
+
+    for(unsigned int pos=0; pos<lineLength; pos+=blockSize)
+      {
+      for(unsigned int i=0; i<nInputs; i++)
+        if(lineInputs[i])
+          inputs[i] = lineInputs[i] + pos;
+      EvaluateBlock(&(inputs[0]), &(stack[0]), out + pos, std::min(blockSize, lineLength-pos));
+      }
+    }
+}
+
+template <class TImage>
+void
+FusedArithmeticImageFilter<TImage>
+::EvaluateBlock(const ValueType * const *inputs, ValueType *stack, ValueType *output, unsigned int n) const
+{
+  const unsigned int blockSize = BlockSize;
+  const ValueType zero = itk::NumericTraits<ValueType>::ZeroValue();
+  const ValueType threshold = 1e-5;
+  unsigned int top = 0; // Number of values on the stack
+  for(unsigned int k=0; k<m_Program.size(); k++)
+    {
+    const Instruction &instruction = m_Program[k];
+    if(instruction.operation == INPUT)
+      {
+      ValueType *a = stack + top * blockSize;
+      const ValueType *in = inputs[instruction.input];
+      for(unsigned int j=0; j<n; j++)
+        a[j] = in[j];
+      top++;
+      continue;
+      }
+    if(instruction.operation == CONSTANT)
+      {
+      ValueType *a = stack + top * blockSize;
+      for(unsigned int j=0; j<n; j++)
+        a[j] = instruction.constant;
+      top++;
+      continue;
+      }
+
+    ValueType *a = stack + (top-1) * blockSize;
+    if(instruction.operation == NEGATE)
+      {
+      for(unsigned int j=0; j<n; j++)
+        a[j] = -a[j];
+      continue;
+      }
+    if(instruction.operation == ABSOLUTE)
+      {
+      for(unsigned int j=0; j<n; j++)
+        a[j] = (a[j]<zero)?-a[j]:a[j];
+      continue;
+      }
+
+    // Binary operations
+    const ValueType *b = a;
+    a -= blockSize;
+    top--;
+    switch(instruction.operation)
+      {
+      case ADD:
+        for(unsigned int j=0; j<n; j++)
+          a[j] += b[j];
+        break;
+      case SUBTRACT:
+        for(unsigned int j=0; j<n; j++)
+          a[j] -= b[j];
+        break;
+      case MULTIPLY:
+        for(unsigned int j=0; j<n; j++)
+          a[j] *= b[j];
+        break;
+      case DIVIDE:
+        for(unsigned int j=0; j<n; j++)
+          a[j] /= b[j];
+        break;
+      case DIVIDE_OR_ZERO_OUT:
+        for(unsigned int j=0; j<n; j++)
+          a[j] = (b[j]<threshold)?zero:a[j]/b[j];
+        break;
+      case MINIMUM:
+        for(unsigned int j=0; j<n; j++)
+          a[j] = (b[j]<a[j])?b[j]:a[j];
+        break;
+      case MAXIMUM:
+        for(unsigned int j=0; j<n; j++)
+          a[j] = (a[j]<b[j])?b[j]:a[j];
+        break;
+      default:
+        break;
+      }
+    }
+
+  for(unsigned int j=0; j<n; j++)
+    output[j] = stack[j];
+}
+
+} // end namespace rtk
+#endif
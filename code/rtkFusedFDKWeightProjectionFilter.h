@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFusedFDKWeightProjectionFilter_h
+#define __rtkFusedFDKWeightProjectionFilter_h
+
+#include "rtkFDKWeightProjectionFilter.h"
+#include "rtkDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
+#include "rtkParkerShortScanImageFilter.h"
+#include "rtkConstantImageSource.h"
+
+namespace rtk
+{
+
+/** \class FusedFDKWeightProjectionFilter
+ * \brief Applies in a single pass the displaced detector, the short scan and
+ * the FDK weights.
+ *
+ * The weights of rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter and
+ * rtk::ParkerShortScanImageFilter only depend on the column of the projection
+ * and on the projection index. They are therefore precomputed once per
+ * geometry in a table of one row per projection, which also contains the
+ * angular factor of rtk::FDKWeightProjectionFilter. The table is computed by
+ * running the two weighting filters on a stack of ones so that the weights are
+ * exactly those of the original filters. The cosine weight of FDK, which
+ * depends on both detector coordinates, is computed on the fly.
+ *
+ * The three 2D weighting passes before ramp filtering are then replaced by a
+ * single multiplication of each projection pixel. Like
+ * rtk::DisplacedDetectorImageFilter, the output is zero padded on the
+ * truncated side of a displaced detector. The InPlace setting is then
+ * ignored because the output buffer is larger than the input buffer.
+ *
+ * The filter is meant to replace the weighting filter of
+ * rtk::FDKConeBeamReconstructionFilter, see
+ * FDKConeBeamReconstructionFilter::SetWeightFilter.
+ *
+ * \test rtkfusedfdkweighttest.cxx
+ *
+ * \ingroup InPlaceImageFilter
+ */
+template<class TInputImage, class TOutputImage=TInputImage>
+class ITK_EXPORT FusedFDKWeightProjectionFilter :
+  public FDKWeightProjectionFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef FusedFDKWeightProjectionFilter                        Self;
+  typedef FDKWeightProjectionFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                               Pointer;
+  typedef itk::SmartPointer<const Self>                         ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                                  InputImageType;
+  typedef TOutputImage                                 OutputImageType;
+  typedef typename OutputImageType::RegionType         OutputImageRegionType;
+  typedef typename OutputImageType::PixelType          PixelType;
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Stack of weights computed with the original weighting filters and
+   * compact table of one weight row per projection. */
+  typedef itk::Image<PixelType, ImageDimension>                                  WeightsStackType;
+  typedef itk::Image<PixelType, 2>                                               WeightsTableType;
+  typedef rtk::ConstantImageSource<WeightsStackType>                             OnesSourceType;
+  typedef rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter<WeightsStackType> DisplacedDetectorFilterType;
+  typedef rtk::ParkerShortScanImageFilter<WeightsStackType>                      ParkerFilterType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(FusedFDKWeightProjectionFilter, FDKWeightProjectionFilter);
+
+  /** Get / Set whether the displaced detector weighting is applied. Default is on. */
+  itkGetMacro(DisplacedDetectorWeighting, bool);
+  itkSetMacro(DisplacedDetectorWeighting, bool);
+  itkBooleanMacro(DisplacedDetectorWeighting);
+
+  /** Get / Set whether the short scan weighting is applied. Default is on. */
+  itkGetMacro(ShortScanWeighting, bool);
+  itkSetMacro(ShortScanWeighting, bool);
+  itkBooleanMacro(ShortScanWeighting);
+
+  /** Get the table of weights, one row per projection, including the angular
+   * factor of FDK. It is available after UpdateOutputInformation(). */
+  itkGetConstObjectMacro(WeightsTable, WeightsTableType);
+
+protected:
+  FusedFDKWeightProjectionFilter();
+  ~FusedFDKWeightProjectionFilter() {}
+
+  /** Computes the table of weights if required and pads the output like
+   * rtk::DisplacedDetectorImageFilter. */
+  virtual void GenerateOutputInformation();
+
+  virtual void GenerateInputRequestedRegion();
+
+  /** The filter runs in place only if the output is not padded. */
+  virtual bool CanRunInPlace() const;
+
+  /** Allocate a new output buffer and keep the input if the output is padded,
+   * even if InPlace is on. */
+  virtual void AllocateOutputs();
+  virtual void ReleaseInputs();
+
+  /** Nothing to do, the weights have been computed with the table. */
+  virtual void BeforeThreadedGenerateData() {}
+
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
+
+  /** Recompute the table of weights if the geometry, the input information or
+   * the parameters of the filter have been modified since the last computation. */
+  void UpdateWeightsTable();
+
+private:
+  FusedFDKWeightProjectionFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                 //purposely not implemented
+
+  bool m_DisplacedDetectorWeighting;
+  bool m_ShortScanWeighting;
+
+  /** Mini-pipeline computing the displaced detector and short scan weights */
+  typename OnesSourceType::Pointer              m_OnesSource;
+  typename DisplacedDetectorFilterType::Pointer m_DisplacedDetectorFilter;
+  typename ParkerFilterType::Pointer            m_ParkerFilter;
+
+  /** Weights table and time of its last computation */
+  typename WeightsTableType::Pointer m_WeightsTable;
+  itk::TimeStamp                     m_WeightsTableTime;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkFusedFDKWeightProjectionFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,317 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkFusedFDKWeightProjectionFilter_hxx
+#define __rtkFusedFDKWeightProjectionFilter_hxx
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::FusedFDKWeightProjectionFilter():
+  m_DisplacedDetectorWeighting(true),
+  m_ShortScanWeighting(true)
+{
+  m_OnesSource = OnesSourceType::New();
+  m_OnesSource->SetConstant(1.);
+  m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
+  m_ParkerFilter = ParkerFilterType::New();
+  m_ParkerFilter->InPlaceOff();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::UpdateWeightsTable()
+{
+  const InputImageType *input = this->GetInput();
+  const typename InputImageType::RegionType inputRegion = input->GetLargestPossibleRegion();
+  const unsigned int nProj = this->GetGeometry()->GetGantryAngles().size();
+
+  // The stack of ones has the columns of the input and the full set of
+  // projections of the geometry. Its two rows are the first and the last rows
+  // of the input so that the field of view computed by the displaced detector
+  // filter is unchanged.
+  typename OnesSourceType::IndexType index;
+  index.Fill(0);
+  index[0] = inputRegion.GetIndex(0);
+  typename OnesSourceType::SizeType size;
+  size.Fill(1);
+  size[0] = inputRegion.GetSize(0);
+  size[ImageDimension-1] = nProj;
+  typename OnesSourceType::SpacingType spacing = input->GetSpacing();
+  if(inputRegion.GetSize(1)>1)
+    {
+    size[1] = 2;
+    spacing[1] *= inputRegion.GetSize(1)-1;
+    }
+  typename InputImageType::IndexType firstRowIndex;
+  firstRowIndex.Fill(0);
+  firstRowIndex[1] = inputRegion.GetIndex(1);
+  typename InputImageType::PointType origin;
+  input->TransformIndexToPhysicalPoint(firstRowIndex, origin);
+
+  m_OnesSource->SetOrigin(origin);
+  m_OnesSource->SetSpacing(spacing);
+  m_OnesSource->SetDirection(input->GetDirection());
+  m_OnesSource->SetIndex(index);
+  m_OnesSource->SetSize(size);
+
+  if( m_WeightsTable.IsNotNull() &&
+      m_WeightsTableTime.GetMTime() > this->GetGeometry()->GetMTime() &&
+      m_WeightsTableTime.GetMTime() > m_OnesSource->GetMTime() &&
+      m_WeightsTableTime.GetMTime() > this->GetMTime() )
+    return;
+
+  // Mini-pipeline computing the displaced detector and short scan weights
+  typename WeightsStackType::Pointer weights;
+  if(m_DisplacedDetectorWeighting)
+    {
+    m_DisplacedDetectorFilter->SetInput( m_OnesSource->GetOutput() );
+    m_DisplacedDetectorFilter->SetGeometry( this->GetGeometry() );
+    m_DisplacedDetectorFilter->Modified();
+    }
+  if(m_ShortScanWeighting)
+    {
+    if(m_DisplacedDetectorWeighting)
+      m_ParkerFilter->SetInput( m_DisplacedDetectorFilter->GetOutput() );
+    else
+      m_ParkerFilter->SetInput( m_OnesSource->GetOutput() );
+    m_ParkerFilter->SetGeometry( this->GetGeometry() );
+    m_ParkerFilter->Modified();
+    m_ParkerFilter->Update();
+    weights = m_ParkerFilter->GetOutput();
+    }
+  else if(m_DisplacedDetectorWeighting)
+    {
+    m_DisplacedDetectorFilter->Update();
+    weights = m_DisplacedDetectorFilter->GetOutput();
+    }
+  else
+    {
+    m_OnesSource->Update();
+    weights = m_OnesSource->GetOutput();
+    }
+
+  // Angular factor and tilt angles of FDK
+  Superclass::BeforeThreadedGenerateData();
+
+  // Keep the first row of each projection, multiplied by the angular factor
+  const typename WeightsStackType::RegionType weightsRegion = weights->GetLargestPossibleRegion();
+  typename WeightsTableType::IndexType tableIndex;
+  tableIndex[0] = weightsRegion.GetIndex(0);
+  tableIndex[1] = 0;
+  typename WeightsTableType::SizeType tableSize;
+  tableSize[0] = weightsRegion.GetSize(0);
+  tableSize[1] = nProj;
+  typename WeightsTableType::RegionType tableRegion(tableIndex, tableSize);
+  m_WeightsTable = WeightsTableType::New();
+  m_WeightsTable->SetRegions(tableRegion);
+  m_WeightsTable->Allocate();
+
+  const PixelType *pIn = weights->GetBufferPointer();
+  PixelType *pOut = m_WeightsTable->GetBufferPointer();
+  const unsigned int weightsSliceSize = weightsRegion.GetSize(0) * weightsRegion.GetSize(1);
+  for(unsigned int k=0; k<nProj; k++)
+    {
+    const PixelType *pRow = pIn + k * weightsSliceSize;
+    for(unsigned int i=0; i<tableSize[0]; i++)
+      *pOut++ = pRow[i] * this->m_ConstantProjectionFactor[k];
+    }
+
+  // The weights stack is not needed anymore
+  weights->ReleaseData();
+
+  m_WeightsTableTime.Modified();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if( !this->GetInput() )
+    return;
+
+  UpdateWeightsTable();
+
+  // Zero padding of the output along x is that of the weights table
+  typename TOutputImage::RegionType outputRegion = this->GetInput()->GetLargestPossibleRegion();
+  outputRegion.SetIndex(0, m_WeightsTable->GetLargestPossibleRegion().GetIndex(0) );
+  outputRegion.SetSize(0, m_WeightsTable->GetLargestPossibleRegion().GetSize(0) );
+  this->GetOutput()->SetLargestPossibleRegion( outputRegion );
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::CanRunInPlace() const
+{
+  return this->GetInput() &&
+         this->GetOutput()->GetLargestPossibleRegion() == this->GetInput()->GetLargestPossibleRegion();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::AllocateOutputs()
+{
+  if( this->GetInPlace() && !this->CanRunInPlace() )
+    itk::ImageSource<TOutputImage>::AllocateOutputs();
+  else
+    Superclass::AllocateOutputs();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::ReleaseInputs()
+{
+  if( this->GetInPlace() && !this->CanRunInPlace() )
+    itk::ProcessObject::ReleaseInputs();
+  else
+    Superclass::ReleaseInputs();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  typename Superclass::InputImagePointer  inputPtr = const_cast< TInputImage * >( this->GetInput() );
+  typename Superclass::OutputImagePointer outputPtr = this->GetOutput();
+
+  if ( !inputPtr || !outputPtr )
+    return;
+
+  typename TInputImage::RegionType inputRequestedRegion = outputPtr->GetRequestedRegion();
+  inputRequestedRegion.Crop( inputPtr->GetLargestPossibleRegion() );
+
+  inputPtr->SetRequestedRegion( inputRequestedRegion );
+}
+
+template <class TInputImage, class TOutputImage>
+void
+FusedFDKWeightProjectionFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId))
+{
+  // Compute overlap between input and output
+  OutputImageRegionType overlapRegion = outputRegionForThread;
+  const bool hasOverlap = overlapRegion.Crop(this->GetInput()->GetLargestPossibleRegion() );
+  const int inputFirstX = overlapRegion.GetIndex(0);
+  const int inputLastX  = (hasOverlap)?inputFirstX+(int)overlapRegion.GetSize(0):inputFirstX;
+
+  // Prepare point increment (TransformIndexToPhysicalPoint too slow)
+  typename OutputImageType::PointType pointBase, pointIncrement;
+  typename OutputImageType::IndexType index = outputRegionForThread.GetIndex();
+  this->GetOutput()->TransformIndexToPhysicalPoint( index, pointBase );
+  for(int i=0; i<3; i++)
+    index[i]++;
+  this->GetOutput()->TransformIndexToPhysicalPoint( index, pointIncrement );
+  for(int i=0; i<3; i++)
+    pointIncrement[i] -= pointBase[i];
+
+  // Iterators
+  typedef itk::ImageRegionConstIterator<InputImageType> InputConstIterator;
+  InputConstIterator itI;
+  if(hasOverlap)
+    {
+    itI = InputConstIterator(this->GetInput(), overlapRegion);
+    itI.GoToBegin();
+    }
+  typedef itk::ImageRegionIterator<OutputImageType> OutputIterator;
+  OutputIterator itO(this->GetOutput(), outputRegionForThread);
+  itO.GoToBegin();
+
+  // Weights table
+  const int tableFirstX = m_WeightsTable->GetLargestPossibleRegion().GetIndex(0);
+  const unsigned int tableSizeX = m_WeightsTable->GetLargestPossibleRegion().GetSize(0);
+  const int firstX = outputRegionForThread.GetIndex(0);
+  const int lastX = firstX + (int)outputRegionForThread.GetSize(0);
+
+  for(int k=outputRegionForThread.GetIndex(2);
+          k<outputRegionForThread.GetIndex(2)+(int)outputRegionForThread.GetSize(2);
+          k++)
+    {
+    const PixelType *weights = m_WeightsTable->GetBufferPointer() + k * tableSizeX;
+    const double sdd  = this->GetGeometry()->GetSourceToDetectorDistances()[k];
+    if(sdd != 0.) // Divergent
+      {
+      typename InputImageType::PointType point = pointBase;
+      point[1] = pointBase[1]
+                 + this->GetGeometry()->GetProjectionOffsetsY()[k]
+                 - this->GetGeometry()->GetSourceOffsetsY()[k];
+      const double cosa = cos(this->m_TiltAngles[k]);
+      const double sina = sin(this->m_TiltAngles[k]);
+      const double tana = tan(this->m_TiltAngles[k]);
+      const double sid  = this->GetGeometry()->GetSourceToIsocenterDistances()[k];
+      const double sdd2 = sdd * sdd;
+      const double RD   = sdd - sid;
+
+      const double numpart1 = sdd*(cosa+tana*sina);
+      const double sddtana = sdd * tana;
+
+      for(unsigned int j=0;
+                       j<outputRegionForThread.GetSize(1);
+                       j++, point[1] += pointIncrement[1])
+        {
+        point[0] = pointBase[0]
+                   + this->GetGeometry()->GetProjectionOffsetsX()[k]
+                   + tana * RD;
+        const double sdd2y2 = sdd2 + point[1]*point[1];
+        for(int i=firstX; i<lastX; i++, ++itO, point[0] += pointIncrement[0])
+          {
+          if(i<inputFirstX || i>=inputLastX)
+            {
+            itO.Set( 0 );
+            continue;
+            }
+          const double denom = sqrt( sdd2y2 + pow(point[0]-sddtana,2.) );
+          const double cosGamma = (numpart1 - point[0] * sina) / denom;
+          itO.Set( itI.Get() * weights[i-tableFirstX] * cosGamma );
+          ++itI;
+          }
+        }
+      }
+    else // Parallel
+      {
+      for(unsigned int j=0; j<outputRegionForThread.GetSize(1); j++)
+        {
+        for(int i=firstX; i<lastX; i++, ++itO)
+          {
+          if(i<inputFirstX || i>=inputLastX)
+            {
+            itO.Set( 0 );
+            continue;
+            }
+          itO.Set( itI.Get() * weights[i-tableFirstX] );
+          ++itI;
+          }
+        }
+      }
+    }
+}
+
+} // end namespace rtk
+#endif
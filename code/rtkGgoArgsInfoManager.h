@@ -19,6 +19,7 @@
 #define __rtkGgoArgsInfoManager_h
 
 #include "rtkConfiguration.h"
+#include "rtkTraceCollector.h"
 #ifdef RTK_TIME_EACH_FILTER
 # include "rtkGlobalTimer.h"
 #endif
@@ -40,6 +41,16 @@ class args_info_manager
     ~args_info_manager()
       {
       this->cleanup_function( this->args_info_pointer );
+
+      // Write the trace if it has been requested with RTK_TRACE
+      try
+        {
+        rtk::TraceCollector::GetInstance()->Flush();
+        }
+      catch( itk::ExceptionObject & err )
+        {
+        std::cerr << err << std::endl;
+        }
       }
   private:
     TArgsInfo * args_info_pointer;
@@ -18,6 +18,8 @@
 #include "rtkGlobalTimer.h"
 #include "itkObjectFactory.h"
 
+#include <iomanip>
+
 namespace rtk
 {
 GlobalTimer::Pointer GlobalTimer::m_Instance = ITK_NULLPTR;
@@ -112,8 +114,18 @@ void
 GlobalTimer
 ::Start(const char *id)
 {
+  this->Start(id, ITK_NULLPTR);
+}
+
+void
+GlobalTimer
+::Start(const char *id, const itk::ProcessObject *process)
+{
+  // The memory of the process is sampled outside of the lock
+  const MemoryProbesCollector::SizeValueType peak = MemoryProbesCollector::GetPeakResidentSetSize();
   m_Mutex.Lock();
   m_TimeProbesCollectorBase.Start(id);
+  m_MemoryProbesCollector.Start(id, process, peak);
   m_Mutex.Unlock();
 }
 
@@ -121,8 +133,30 @@ void
 GlobalTimer
 ::Stop(const char *id)
 {
+  this->Stop(id, ITK_NULLPTR);
+}
+
+void
+GlobalTimer
+::Stop(const char *id, const itk::ProcessObject *process)
+{
+  const MemoryProbesCollector::MemorySampleType sample = MemoryProbesCollector::Sample(process);
   m_Mutex.Lock();
   m_TimeProbesCollectorBase.Stop(id);
+  m_MemoryProbesCollector.Stop(id, process, sample);
+  m_Mutex.Unlock();
+}
+
+void
+GlobalTimer
+::CountCacheAccess(const char *id, bool hit)
+{
+  m_Mutex.Lock();
+  std::pair<itk::SizeValueType, itk::SizeValueType> &accesses = m_CacheAccesses[id];
+  if(hit)
+    accesses.first++;
+  else
+    accesses.second++;
   m_Mutex.Unlock();
 }
 
@@ -132,6 +166,29 @@ GlobalTimer
 {
   m_Mutex.Lock();
   m_TimeProbesCollectorBase.Report(os);
+  m_MemoryProbesCollector.Report(os);
+  if( !m_CacheAccesses.empty() )
+    {
+    // The format of the stream of the caller is restored after the report
+    const std::ios_base::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::endl
+       << std::setw(50) << std::left << "Cache"
+       << std::setw(15) << std::right << "Hits"
+       << std::setw(15) << "Misses"
+       << std::setw(15) << "Hit rate (%)" << std::endl;
+    for(CacheAccessesType::const_iterator it = m_CacheAccesses.begin(); it != m_CacheAccesses.end(); ++it)
+      {
+      const itk::SizeValueType total = it->second.first + it->second.second;
+      os << std::setw(50) << std::left << it->first
+         << std::setw(15) << std::right << it->second.first
+         << std::setw(15) << it->second.second
+         << std::setw(15) << std::fixed << std::setprecision(1)
+         << ((total)?100.*it->second.first/total:0.) << std::endl;
+      }
+    os.flags(flags);
+    os.precision(precision);
+    }
   m_Mutex.Unlock();
 }
 
@@ -141,6 +198,8 @@ GlobalTimer
 {
   m_Mutex.Lock();
   m_TimeProbesCollectorBase.Clear();
+  m_MemoryProbesCollector.Clear();
+  m_CacheAccesses.clear();
   m_Watchers.clear();
   m_Mutex.Unlock();
 }
@@ -21,9 +21,12 @@
 #include <itkProcessObject.h>
 #include "rtkGlobalTimerProbesCollector.h"
 #include "rtkTimeProbesCollectorBase.h"
+#include "rtkMemoryProbesCollector.h"
 #include "rtkWatcherForTimer.h"
 #include <itkSimpleFastMutexLock.h>
 
+#include <map>
+
 namespace rtk
 {
 /** \class GlobalTimer
@@ -63,10 +66,23 @@ public:
    * exist, it will be created */
   virtual void Start(const char *name);
 
+  /** Start a time probe identified with a name and a memory probe of process,
+   * which is paired with the stop of the same process */
+  virtual void Start(const char *name, const itk::ProcessObject *process);
+
   /** Stop a time probe identified with a name */
   virtual void Stop(const char *name);
 
-  /** Report the summary of results from the probes */
+  /** Stop a time probe identified with a name and account for the memory
+   * allocated by the outputs of process */
+  virtual void Stop(const char *name, const itk::ProcessObject *process);
+
+  /** Count a hit or a miss of a cache identified with a name. The number of
+   * hits and misses and the hit rate of each cache are reported with the
+   * probes. */
+  virtual void CountCacheAccess(const char *name, bool hit);
+
+  /** Report the summary of results from the time and memory probes */
   virtual void Report(std::ostream & os = std::cout) const;
 
   /** Destroy the set of probes. New probes can be created after invoking this
@@ -87,8 +103,13 @@ protected:
 
 //  rtk::GlobalTimerProbesCollector m_GlobalTimerProbesCollector;
   rtk::TimeProbesCollectorBase       m_TimeProbesCollectorBase;
+  rtk::MemoryProbesCollector         m_MemoryProbesCollector;
   std::vector<rtk::WatcherForTimer*> m_Watchers;
 
+  /** Number of hits and misses of each cache */
+  typedef std::map< std::string, std::pair<itk::SizeValueType, itk::SizeValueType> > CacheAccessesType;
+  CacheAccessesType                  m_CacheAccesses;
+
 private:
   GlobalTimer(const Self &);   //purposely not implemented
   void operator=(const Self &); //purposely not implemented
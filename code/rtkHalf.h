@@ -0,0 +1,271 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkHalf_h
+#define __rtkHalf_h
+
+#include <itkIntTypes.h>
+#include <itkMacro.h>
+#include <itkFixedArray.h>
+#include <itkNumericTraits.h>
+
+#include <cstring>
+
+namespace rtk
+{
+
+/** \class Half
+ * \brief IEEE 754 half precision (binary16) floating point storage type.
+ *
+ * Half has a sign bit, 5 exponent bits and 10 mantissa bits, i.e., a relative
+ * precision of 2^-11 and a range of +/-65504. It is meant to store large
+ * images, e.g. projection stacks or deformation vector fields, with half the
+ * memory footprint and bandwidth of float. It is not meant for computation:
+ * a Half is implicitly converted to and from float so that kernels reading or
+ * writing Half images compute in float. Accumulators should remain float.
+ *
+ * The conversion from float rounds to the nearest representable value, ties
+ * to even, with overflow to infinity and gradual underflow to subnormals.
+ *
+ * \see BFloat16
+ *
+ * \test rtkhalfprecisiontest.cxx
+ *
+ * \ingroup Functions
+ */
+class Half
+{
+public:
+  /** Uninitialized, like a float. */
+  Half() {}
+  Half(float value) : m_Bits( FloatToBits(value) ) {}
+
+  operator float() const { return BitsToFloat(m_Bits); }
+
+  Half & operator+=(float value) { return *this = float(*this) + value; }
+  Half & operator-=(float value) { return *this = float(*this) - value; }
+  Half & operator*=(float value) { return *this = float(*this) * value; }
+  Half & operator/=(float value) { return *this = float(*this) / value; }
+
+  /** Raw binary16 representation. */
+  itk::uint16_t GetBits() const { return m_Bits; }
+  static Half FromBits(itk::uint16_t bits) { Half h; h.m_Bits = bits; return h; }
+
+  static itk::uint16_t FloatToBits(float value)
+    {
+    itk::uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    const itk::uint32_t sign = (x >> 16) & 0x8000;
+    x &= 0x7fffffff;
+
+    // Infinity and NaN, NaN remains quiet
+    if(x >= 0x7f800000)
+      return sign | 0x7c00 | ((x > 0x7f800000) ? 0x200 : 0);
+
+    // Rounds above the largest half, 65504
+    if(x >= 0x477ff000)
+      return sign | 0x7c00;
+
+    // Subnormal half or zero
+    if(x < 0x38800000)
+      {
+      if(x <= 0x33000000)
+        return sign;
+      const itk::uint32_t shift = 126 - (x >> 23);
+      const itk::uint32_t mantissa = (x & 0x7fffff) | 0x800000;
+      const itk::uint32_t halfway = 1u << (shift - 1);
+      const itk::uint32_t remainder = mantissa & ( (1u << shift) - 1 );
+      itk::uint32_t h = mantissa >> shift;
+      if( remainder > halfway || (remainder == halfway && (h & 1)) )
+        h++;
+      return sign | h;
+      }
+
+    // Normal half, rebias the exponent from 127 to 15 and round the mantissa.
+    // A carry of the rounding correctly increments the exponent.
+    itk::uint32_t h = (x - 0x38000000) >> 13;
+    const itk::uint32_t remainder = x & 0x1fff;
+    if( remainder > 0x1000 || (remainder == 0x1000 && (h & 1)) )
+      h++;
+    return sign | h;
+    }
+
+  static float BitsToFloat(itk::uint16_t h)
+    {
+    const itk::uint32_t sign = itk::uint32_t(h & 0x8000) << 16;
+    const itk::uint32_t exponent = (h >> 10) & 0x1f;
+    itk::uint32_t mantissa = h & 0x3ff;
+    itk::uint32_t x;
+    if(exponent == 0x1f)
+      x = sign | 0x7f800000 | (mantissa << 13);
+    else if(exponent != 0)
+      x = sign | ( (exponent + 112) << 23 ) | (mantissa << 13);
+    else if(mantissa == 0)
+      x = sign;
+    else
+      {
+      // Subnormal half, normalized in float
+      itk::uint32_t e = 113;
+      while( !(mantissa & 0x400) )
+        {
+        mantissa <<= 1;
+        e--;
+        }
+      x = sign | (e << 23) | ( (mantissa & 0x3ff) << 13 );
+      }
+    float value;
+    std::memcpy(&value, &x, sizeof(value));
+    return value;
+    }
+
+private:
+  itk::uint16_t m_Bits;
+};
+
+/** \class BFloat16
+ * \brief Brain floating point (bfloat16) storage type.
+ *
+ * BFloat16 is the upper half of a float: a sign bit, 8 exponent bits and 7
+ * mantissa bits. It has the range of float with a relative precision of 2^-8
+ * only, which suits data with a large dynamic range and a limited accuracy,
+ * e.g. intermediate volumes of a regularized reconstruction. As Half, it is
+ * a storage type implicitly converted to and from float.
+ *
+ * \see Half
+ *
+ * \test rtkhalfprecisiontest.cxx
+ *
+ * \ingroup Functions
+ */
+class BFloat16
+{
+public:
+  /** Uninitialized, like a float. */
+  BFloat16() {}
+  BFloat16(float value) : m_Bits( FloatToBits(value) ) {}
+
+  operator float() const { return BitsToFloat(m_Bits); }
+
+  BFloat16 & operator+=(float value) { return *this = float(*this) + value; }
+  BFloat16 & operator-=(float value) { return *this = float(*this) - value; }
+  BFloat16 & operator*=(float value) { return *this = float(*this) * value; }
+  BFloat16 & operator/=(float value) { return *this = float(*this) / value; }
+
+  /** Raw bfloat16 representation. */
+  itk::uint16_t GetBits() const { return m_Bits; }
+  static BFloat16 FromBits(itk::uint16_t bits) { BFloat16 b; b.m_Bits = bits; return b; }
+
+  static itk::uint16_t FloatToBits(float value)
+    {
+    itk::uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+    // NaN remains quiet, the rounding below could turn it into infinity
+    if( (x & 0x7fffffff) > 0x7f800000 )
+      return (x >> 16) | 0x40;
+    // Round to nearest, ties to even
+    x += 0x7fff + ( (x >> 16) & 1 );
+    return x >> 16;
+    }
+
+  static float BitsToFloat(itk::uint16_t b)
+    {
+    const itk::uint32_t x = itk::uint32_t(b) << 16;
+    float value;
+    std::memcpy(&value, &x, sizeof(value));
+    return value;
+    }
+
+private:
+  itk::uint16_t m_Bits;
+};
+
+/** \class LowPrecisionNumericTraits
+ * \brief itk::NumericTraits shared by Half and BFloat16.
+ *
+ * All real types are float so that filters using NumericTraits to choose
+ * their accumulation type compute in float.
+ */
+template <class T>
+class LowPrecisionNumericTraits
+{
+public:
+  typedef T                           ValueType;
+  typedef float                       PrintType;
+  typedef T                           AbsType;
+  typedef float                       AccumulateType;
+  typedef float                       FloatType;
+  typedef float                       RealType;
+  typedef float                       ScalarRealType;
+  typedef itk::FixedArray<ValueType, 1> MeasurementVectorType;
+
+  itkStaticConstMacro(IsSigned, bool, true);
+  itkStaticConstMacro(IsInteger, bool, false);
+  itkStaticConstMacro(IsComplex, bool, false);
+
+  static const T Zero;
+  static const T One;
+
+  static T min() { return SmallestNormalValue(); }
+  static T max() { return LargestValue(); }
+  static T min(T) { return min(); }
+  static T max(T) { return max(); }
+  static T NonpositiveMin() { return T::FromBits(LargestValue().GetBits() | 0x8000); }
+  static T epsilon() { return Epsilon(); }
+  static bool IsPositive(T val) { return float(val) > 0.f; }
+  static bool IsNonpositive(T val) { return float(val) <= 0.f; }
+  static bool IsNegative(T val) { return float(val) < 0.f; }
+  static bool IsNonnegative(T val) { return float(val) >= 0.f; }
+  static T ZeroValue() { return T(0.f); }
+  static T OneValue() { return T(1.f); }
+  static T ZeroValue(const T &) { return T(0.f); }
+  static T OneValue(const T &) { return T(1.f); }
+  static unsigned int GetLength(const T &) { return 1; }
+  static unsigned int GetLength() { return 1; }
+  static void SetLength(T &, const unsigned int s)
+    {
+    if ( s != 1 )
+      itkGenericExceptionMacro(<< "Cannot set the size of a scalar to " << s);
+    }
+  template<class TArray>
+  static void AssignToArray(const T & v, TArray & mv) { mv[0] = v; }
+
+private:
+  static T SmallestNormalValue();
+  static T LargestValue();
+  static T Epsilon();
+};
+
+template <class T> const T LowPrecisionNumericTraits<T>::Zero = T(0.f);
+template <class T> const T LowPrecisionNumericTraits<T>::One = T(1.f);
+
+template <> inline Half LowPrecisionNumericTraits<Half>::SmallestNormalValue() { return Half::FromBits(0x0400); }
+template <> inline Half LowPrecisionNumericTraits<Half>::LargestValue() { return Half::FromBits(0x7bff); }
+template <> inline Half LowPrecisionNumericTraits<Half>::Epsilon() { return Half::FromBits(0x1400); }
+template <> inline BFloat16 LowPrecisionNumericTraits<BFloat16>::SmallestNormalValue() { return BFloat16::FromBits(0x0080); }
+template <> inline BFloat16 LowPrecisionNumericTraits<BFloat16>::LargestValue() { return BFloat16::FromBits(0x7f7f); }
+template <> inline BFloat16 LowPrecisionNumericTraits<BFloat16>::Epsilon() { return BFloat16::FromBits(0x3c00); }
+
+} // end namespace rtk
+
+namespace itk
+{
+template <> class NumericTraits<rtk::Half> : public rtk::LowPrecisionNumericTraits<rtk::Half> {};
+template <> class NumericTraits<rtk::BFloat16> : public rtk::LowPrecisionNumericTraits<rtk::BFloat16> {};
+} // end namespace itk
+
+#endif
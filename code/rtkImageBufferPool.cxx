@@ -0,0 +1,432 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkImageBufferPool.h"
+#include "rtkPooledImportImageContainer.h"
+#include "rtkThreadPool.h"
+
+#include <itkObjectFactory.h>
+#include <itkVersion.h>
+#include <itkCovariantVector.h>
+#include <itkVector.h>
+#include <itksys/SystemTools.hxx>
+#include <itksys/SystemInformation.hxx>
+
+#include <cstring>
+#include <algorithm>
+#include <typeinfo>
+
+namespace rtk
+{
+
+namespace
+{
+/** Factory replacing the pixel containers of the images by pooled ones */
+class ImageBufferPoolFactory : public itk::ObjectFactoryBase
+{
+public:
+  typedef ImageBufferPoolFactory        Self;
+  typedef itk::ObjectFactoryBase        Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  const char* GetITKSourceVersion(void) const {
+    return ITK_SOURCE_VERSION;
+  }
+
+  const char* GetDescription(void) const {
+    return "Image buffer pool factory, allocates the pixels of images from rtk::ImageBufferPool";
+  }
+
+  itkFactorylessNewMacro(Self);
+  itkTypeMacro(ImageBufferPoolFactory, itk::ObjectFactoryBase);
+
+protected:
+  ImageBufferPoolFactory()
+    {
+    this->RegisterContainerOverride<float>();
+    this->RegisterContainerOverride<double>();
+    this->RegisterContainerOverride< itk::CovariantVector<float, 3> >();
+    this->RegisterContainerOverride< itk::CovariantVector<double, 3> >();
+    this->RegisterContainerOverride< itk::Vector<float, 3> >();
+    this->RegisterContainerOverride< itk::Vector<double, 3> >();
+    }
+
+  template<class TPixel>
+  void RegisterContainerOverride()
+    {
+    typedef itk::ImportImageContainer<itk::SizeValueType, TPixel>        ContainerType;
+    typedef rtk::PooledImportImageContainer<itk::SizeValueType, TPixel> PooledContainerType;
+    this->RegisterOverride(typeid(ContainerType).name(),
+                           typeid(PooledContainerType).name(),
+                           "Pooled image container",
+                           1,
+                           itk::CreateObjectFunction<PooledContainerType>::New() );
+    }
+
+private:
+  ImageBufferPoolFactory(const Self&); //purposely not implemented
+  void operator=(const Self&);         //purposely not implemented
+};
+
+/** Runtime activation without recompilation */
+bool GetEnabledFromEnvironment()
+{
+  std::string value;
+  if( itksys::SystemTools::GetEnv("RTK_BUFFER_POOL", value) )
+    return value == "1";
+  return false;
+}
+
+bool GetParallelFirstTouchFromEnvironment()
+{
+  std::string value;
+  if( itksys::SystemTools::GetEnv("RTK_FIRST_TOUCH", value) )
+    return value == "1";
+  return false;
+}
+
+/** Buffers zeroed by the calling thread in ImageBufferPool::Zero */
+const size_t minimumParallelZeroBytes = 1<<20;
+
+/** Buffer zeroed by the tasks of ImageBufferPool::Zero, each task zeroing
+ * SlicesPerPiece slices of SliceBytes bytes */
+struct ZeroType
+{
+  char * Buffer;
+  size_t Bytes;
+  size_t SliceBytes;
+  size_t SlicesPerPiece;
+};
+
+void ZeroTask(void *arg, unsigned int taskId, unsigned int itkNotUsed(numberOfTasks))
+{
+  const ZeroType *zero = static_cast<ZeroType *>(arg);
+  const size_t pieceBytes = zero->SlicesPerPiece * zero->SliceBytes;
+  const size_t begin = std::min(zero->Bytes, taskId * pieceBytes);
+  const size_t end = std::min(zero->Bytes, (taskId+1) * pieceBytes);
+  if(end > begin)
+    std::memset(zero->Buffer + begin, 0, end - begin);
+}
+
+/** Creation of the singleton */
+itk::SimpleFastMutexLock instanceMutex;
+}
+
+ImageBufferPool::Pointer ImageBufferPool::m_Instance = ITK_NULLPTR;
+
+ImageBufferPool
+::ImageBufferPool():
+  m_MinimumBufferSize(1<<20),
+  m_ParallelFirstTouch(GetParallelFirstTouchFromEnvironment()),
+  m_PooledBytes(0),
+  m_AllocatedBytes(0),
+  m_NumberOfAllocations(0),
+  m_NumberOfReuses(0)
+{
+  // A quarter of the physical memory, given in MiB
+  itksys::SystemInformation info;
+  info.RunMemoryCheck();
+  m_MaximumPooledBytes = info.GetTotalPhysicalMemory() * (1<<18);
+  if(!m_MaximumPooledBytes)
+    m_MaximumPooledBytes = size_t(1)<<30;
+}
+
+ImageBufferPool
+::~ImageBufferPool()
+{
+  this->Clear();
+  // The pooled pixel containers hold a reference to the pool, which is
+  // therefore only destroyed once all its buffers have been released.
+}
+
+void
+ImageBufferPool
+::PrintSelf(std::ostream & os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ImageBufferPool (single instance): "
+     << (void *)ImageBufferPool::m_Instance << std::endl;
+  os << indent << "Enabled: " << this->GetEnabled() << std::endl;
+  os << indent << "MinimumBufferSize: " << m_MinimumBufferSize << std::endl;
+  os << indent << "ParallelFirstTouch: " << m_ParallelFirstTouch << std::endl;
+  os << indent << "MaximumPooledBytes: " << this->GetMaximumPooledBytes() << std::endl;
+}
+
+/**
+ * Return the single instance of the ImageBufferPool
+ */
+ImageBufferPool::Pointer
+ImageBufferPool
+::GetInstance()
+{
+  instanceMutex.Lock();
+  if ( !ImageBufferPool::m_Instance )
+    {
+    // Try the factory first
+    ImageBufferPool::m_Instance  = itk::ObjectFactory< Self >::Create();
+    // if the factory did not provide one, then create it here
+    if ( !ImageBufferPool::m_Instance )
+      {
+      ImageBufferPool::m_Instance = new ImageBufferPool;
+      // Remove extra reference from construction.
+      ImageBufferPool::m_Instance->UnRegister();
+      }
+    ImageBufferPool::m_Instance->SetEnabled( GetEnabledFromEnvironment() );
+    }
+  Pointer instance = ImageBufferPool::m_Instance;
+  instanceMutex.Unlock();
+  /**
+   * return the instance
+   */
+  return instance;
+}
+
+/**
+ * This just calls GetInstance
+ */
+ImageBufferPool::Pointer
+ImageBufferPool
+::New()
+{
+  return GetInstance();
+}
+
+bool
+ImageBufferPool
+::GetEnabled() const
+{
+  return m_Factory.IsNotNull();
+}
+
+void
+ImageBufferPool
+::SetEnabled(bool enabled)
+{
+  if( enabled == this->GetEnabled() )
+    return;
+  if(enabled)
+    {
+    m_Factory = ImageBufferPoolFactory::New().GetPointer();
+    itk::ObjectFactoryBase::RegisterFactory(m_Factory);
+    }
+  else
+    {
+    // Buffers of existing pooled containers are still given back to the pool
+    itk::ObjectFactoryBase::UnRegisterFactory(m_Factory);
+    m_Factory = ITK_NULLPTR;
+    }
+  this->Modified();
+}
+
+size_t
+ImageBufferPool
+::GetMaximumPooledBytes() const
+{
+  m_Mutex.Lock();
+  const size_t bytes = m_MaximumPooledBytes;
+  m_Mutex.Unlock();
+  return bytes;
+}
+
+void
+ImageBufferPool
+::SetMaximumPooledBytes(size_t bytes)
+{
+  m_Mutex.Lock();
+  m_MaximumPooledBytes = bytes;
+  this->Evict(m_MaximumPooledBytes);
+  m_Mutex.Unlock();
+  this->Modified();
+}
+
+void *
+ImageBufferPool
+::Allocate(size_t bytes)
+{
+  m_Mutex.Lock();
+  m_NumberOfAllocations++;
+
+  // Most recently released buffer of the same size
+  void *buffer = ITK_NULLPTR;
+  for(FreeBuffersType::iterator it = m_FreeBuffers.begin(); it != m_FreeBuffers.end(); ++it)
+    {
+    if(it->first == bytes)
+      {
+      buffer = it->second;
+      m_FreeBuffers.erase(it);
+      m_PooledBytes -= bytes;
+      m_NumberOfReuses++;
+      break;
+      }
+    }
+
+  // Otherwise, make room in the pool for a new buffer
+  if(!buffer)
+    {
+    this->Evict( (m_MaximumPooledBytes>bytes)?m_MaximumPooledBytes-bytes:0 );
+    m_Mutex.Unlock();
+    buffer = ::operator new(bytes);
+    if(m_ParallelFirstTouch)
+      Zero(buffer, bytes);
+    m_Mutex.Lock();
+    }
+
+  m_AllocatedBuffers[buffer] = bytes;
+  m_AllocatedBytes += bytes;
+  m_Mutex.Unlock();
+  return buffer;
+}
+
+void
+ImageBufferPool
+::Zero(void *buffer, size_t bytes, size_t sliceBytes, unsigned int numberOfPieces)
+{
+  if(!numberOfPieces)
+    numberOfPieces = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if(bytes < minimumParallelZeroBytes || numberOfPieces < 2 || !ThreadPool::GetGlobalDefaultEnabled())
+    {
+    std::memset(buffer, 0, bytes);
+    return;
+    }
+
+  // Same pieces as itk::ImageSource::SplitRequestedRegion along the last
+  // dimension: ceil(range/numberOfPieces) slices per piece, the last piece
+  // taking the remaining slices
+  ZeroType zero;
+  zero.Buffer = static_cast<char *>(buffer);
+  zero.Bytes = bytes;
+  zero.SliceBytes = (sliceBytes)?sliceBytes:4096;
+  const size_t range = (bytes + zero.SliceBytes - 1) / zero.SliceBytes;
+  zero.SlicesPerPiece = (range + numberOfPieces - 1) / numberOfPieces;
+  const unsigned int numberOfTasks = (range + zero.SlicesPerPiece - 1) / zero.SlicesPerPiece;
+  ThreadPool::GetInstance()->ParallelFor(numberOfTasks, ZeroTask, &zero);
+}
+
+bool
+ImageBufferPool
+::Release(void *buffer)
+{
+  m_Mutex.Lock();
+  AllocatedBuffersType::iterator it = m_AllocatedBuffers.find(buffer);
+  if( it == m_AllocatedBuffers.end() )
+    {
+    m_Mutex.Unlock();
+    return false;
+    }
+  const size_t bytes = it->second;
+  m_AllocatedBuffers.erase(it);
+  m_AllocatedBytes -= bytes;
+  m_FreeBuffers.push_front( std::make_pair(bytes, buffer) );
+  m_PooledBytes += bytes;
+  this->Evict(m_MaximumPooledBytes);
+  m_Mutex.Unlock();
+  return true;
+}
+
+void
+ImageBufferPool
+::Evict(size_t maximumBytes)
+{
+  while( m_PooledBytes > maximumBytes && !m_FreeBuffers.empty() )
+    {
+    m_PooledBytes -= m_FreeBuffers.back().first;
+    ::operator delete( m_FreeBuffers.back().second );
+    m_FreeBuffers.pop_back();
+    }
+}
+
+void
+ImageBufferPool
+::Clear()
+{
+  m_Mutex.Lock();
+  for(FreeBuffersType::iterator it = m_FreeBuffers.begin(); it != m_FreeBuffers.end(); ++it)
+    ::operator delete( it->second );
+  m_FreeBuffers.clear();
+  m_PooledBytes = 0;
+  m_Mutex.Unlock();
+}
+
+itk::SizeValueType
+ImageBufferPool
+::GetNumberOfAllocations() const
+{
+  m_Mutex.Lock();
+  const itk::SizeValueType n = m_NumberOfAllocations;
+  m_Mutex.Unlock();
+  return n;
+}
+
+itk::SizeValueType
+ImageBufferPool
+::GetNumberOfReuses() const
+{
+  m_Mutex.Lock();
+  const itk::SizeValueType n = m_NumberOfReuses;
+  m_Mutex.Unlock();
+  return n;
+}
+
+double
+ImageBufferPool
+::GetReuseRate() const
+{
+  m_Mutex.Lock();
+  const double rate = (m_NumberOfAllocations)?double(m_NumberOfReuses)/m_NumberOfAllocations:0.;
+  m_Mutex.Unlock();
+  return rate;
+}
+
+size_t
+ImageBufferPool
+::GetPooledBytes() const
+{
+  m_Mutex.Lock();
+  const size_t bytes = m_PooledBytes;
+  m_Mutex.Unlock();
+  return bytes;
+}
+
+size_t
+ImageBufferPool
+::GetAllocatedBytes() const
+{
+  m_Mutex.Lock();
+  const size_t bytes = m_AllocatedBytes;
+  m_Mutex.Unlock();
+  return bytes;
+}
+
+void
+ImageBufferPool
+::Report(std::ostream & os) const
+{
+  m_Mutex.Lock();
+  os << "Image buffer pool: "
+     << m_NumberOfAllocations << " allocations, "
+     << m_NumberOfReuses << " reuses ("
+     << ((m_NumberOfAllocations)?100.*m_NumberOfReuses/m_NumberOfAllocations:0.) << "%), "
+     << m_AllocatedBytes/(1<<20) << " MiB in use, "
+     << m_PooledBytes/(1<<20) << " MiB pooled"
+     << std::endl;
+  m_Mutex.Unlock();
+}
+
+} // end namespace rtk
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkImageBufferPool_h
+#define __rtkImageBufferPool_h
+
+#include <itkObject.h>
+#include <itkObjectFactoryBase.h>
+#include <itkSimpleFastMutexLock.h>
+
+#include "rtkWin32Header.h"
+
+#include <list>
+#include <map>
+
+namespace rtk
+{
+
+/** \class ImageBufferPool
+ * \brief Pool of the large pixel buffers of images, reused instead of being
+ * freed and allocated again.
+ *
+ * Iterative reconstructions create the same images at each iteration:
+ * constant volumes, outputs of arithmetic filters, gradients, etc. Each of
+ * them is a large allocation and, when the image is released (e.g., with
+ * ReleaseDataFlag) or destroyed, a large deallocation, which for 4D volumes
+ * amounts to gigabytes of page faults per iteration.
+ *
+ * The ImageBufferPool is a singleton which keeps the released buffers and
+ * gives them back to the next allocation of the same size. Images allocate
+ * their buffers from the pool through rtk::PooledImportImageContainer, which
+ * replaces the pixel container of images of float, double and 3D vectors of
+ * float and double through an ITK object factory when the pool is enabled.
+ * Buffers smaller than MinimumBufferSize are not pooled. The least recently
+ * released buffers are freed when the pooled buffers exceed
+ * MaximumPooledBytes, by default a quarter of the physical memory.
+ *
+ * The pool is disabled by default: applications opt in with SetEnabled,
+ * e.g., with the --bufferpool option of rtksart, rtkconjugategradient and
+ * rtkfourdrooster, or by setting the environment variable RTK_BUFFER_POOL
+ * to 1 which enables the pool when the singleton is created. The statistics
+ * on the reuse of the buffers are printed with Report.
+ *
+ * On NUMA machines, the pages of a buffer are allocated on the node of the
+ * thread which first writes them. With ParallelFirstTouch, new buffers are
+ * zeroed by Zero, i.e., by the workers of rtk::ThreadPool which later
+ * process the same parts of the image, instead of being first touched by a
+ * single thread, e.g., in itk::Image::FillBuffer.
+ *
+ * \test rtkimagebufferpooltest.cxx
+ *
+ * \ingroup OSSystemObjects
+ */
+class RTK_EXPORT ImageBufferPool : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageBufferPool                 Self;
+  typedef itk::Object                     Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageBufferPool, itk::Object);
+
+  /** This is a singleton pattern New. There will only be ONE reference to an
+   * ImageBufferPool object per process. */
+  static Pointer New();
+
+  /** Return the singleton instance with no reference counting. The
+   * creation of the singleton is thread-safe. */
+  static Pointer GetInstance();
+
+  /** Get / Set whether the pixel containers of new images are pooled.
+   * Default is false unless the environment variable RTK_BUFFER_POOL is 1. */
+  bool GetEnabled() const;
+  void SetEnabled(bool enabled);
+  itkBooleanMacro(Enabled);
+
+  /** Get / Set the size in bytes under which buffers are not pooled. Default is 1 MiB. */
+  itkGetMacro(MinimumBufferSize, size_t);
+  itkSetMacro(MinimumBufferSize, size_t);
+
+  /** Get / Set whether new buffers are first touched in parallel with Zero.
+   * Default is false unless the environment variable RTK_FIRST_TOUCH is 1. */
+  itkGetMacro(ParallelFirstTouch, bool);
+  itkSetMacro(ParallelFirstTouch, bool);
+  itkBooleanMacro(ParallelFirstTouch);
+
+  /** Set bytes of buffer to zero with the tasks of rtk::ThreadPool. The
+   * buffer is split in the pieces of the split of the output region of a
+   * filter with numberOfPieces threads (by default, the global default number
+   * of threads of ITK) by itk::ImageSource::SplitRequestedRegion, i.e., along
+   * its last dimension, sliceBytes being the size of one slice of the image
+   * along this dimension (by default, a page). With pinned workers, each
+   * slice is therefore first touched by the processor which will process it.
+   * Buffers smaller than 1 MiB, or all buffers if the thread pool is disabled,
+   * are zeroed by the calling thread. */
+  static void Zero(void *buffer, size_t bytes, size_t sliceBytes = 0, unsigned int numberOfPieces = 0);
+
+  /** Get / Set the maximum number of bytes of the released buffers kept in
+   * the pool. */
+  size_t GetMaximumPooledBytes() const;
+  void SetMaximumPooledBytes(size_t bytes);
+
+  /** Return a buffer of bytes, reusing a released buffer of the same size if
+   * any. Throws std::bad_alloc if a new buffer cannot be allocated. */
+  void *Allocate(size_t bytes);
+
+  /** Give back a buffer obtained with Allocate. Returns false, without doing
+   * anything, if the buffer does not come from the pool. */
+  bool Release(void *buffer);
+
+  /** Free all the released buffers kept in the pool. */
+  void Clear();
+
+  /** Statistics of the pool */
+  itk::SizeValueType GetNumberOfAllocations() const;
+  itk::SizeValueType GetNumberOfReuses() const;
+  double GetReuseRate() const;
+  size_t GetPooledBytes() const;
+  size_t GetAllocatedBytes() const;
+
+  /** Report the statistics of the pool */
+  void Report(std::ostream & os = std::cout) const;
+
+protected:
+  ImageBufferPool();
+  virtual ~ImageBufferPool();
+  virtual void PrintSelf(std::ostream & os, itk::Indent indent) const;
+
+  /** Free the least recently released buffers until the pool fits in
+   * maximumBytes. Must be called with m_Mutex locked. */
+  void Evict(size_t maximumBytes);
+
+private:
+  ImageBufferPool(const Self &);   //purposely not implemented
+  void operator=(const Self &);    //purposely not implemented
+
+  static Pointer m_Instance;
+
+  /** Factory of the pooled pixel containers, registered when enabled */
+  itk::ObjectFactoryBase::Pointer m_Factory;
+  size_t                          m_MinimumBufferSize;
+  bool                            m_ParallelFirstTouch;
+
+  /** Released buffers, most recent first, and sizes of the buffers in use */
+  typedef std::list< std::pair<size_t, void*> > FreeBuffersType;
+  typedef std::map< void*, size_t >             AllocatedBuffersType;
+  mutable itk::SimpleFastMutexLock m_Mutex;
+  FreeBuffersType                  m_FreeBuffers;
+  AllocatedBuffersType             m_AllocatedBuffers;
+  size_t                           m_MaximumPooledBytes;
+  size_t                           m_PooledBytes;
+  size_t                           m_AllocatedBytes;
+  itk::SizeValueType               m_NumberOfAllocations;
+  itk::SizeValueType               m_NumberOfReuses;
+};
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,263 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkInlineFDKReconstructor_h
+#define __rtkInlineFDKReconstructor_h
+
+#include "rtkBoundedQueue.h"
+#include "rtkFusedFDKWeightProjectionFilter.h"
+#include "rtkFFTRampImageFilter.h"
+#include "rtkFDKBackProjectionImageFilter.h"
+#include "rtkProjectionsReader.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+
+#include <itkBinShrinkImageFilter.h>
+#include <itkMultiThreader.h>
+#include <itkSimpleFastMutexLock.h>
+
+namespace rtk
+{
+
+/** \class InlineFDKReconstructor
+ * \brief FDK reconstruction of projections processed as soon as they are
+ * acquired.
+ *
+ * The geometry of the whole acquisition must be known before the first
+ * projection arrives, e.g., the planned trajectory. The displaced detector,
+ * short scan and FDK weights of each projection can then be computed
+ * independently of the other projections with
+ * rtk::FusedFDKWeightProjectionFilter, which allows processing the
+ * projections in any order.
+ *
+ * Projections are pushed, from any thread, with PushProjection or
+ * PushProjectionFile in a bounded queue. A pool of filtering threads pops
+ * them, reads them if required with a rtk::ProjectionsReader, weights them
+ * and ramp filters them. The filtered projections are passed through a second
+ * bounded queue to the backprojection thread, which accumulates them in the
+ * volume with a multithreaded rtk::FDKBackProjectionImageFilter, or any
+ * subclass set with SetBackProjectionFilter, e.g., its CUDA or OpenCL
+ * implementation. The queues block the producers when they are full. Once
+ * the last projection has been pushed, Finalize waits for the end of the
+ * processing, which typically amounts to one filtering and one
+ * backprojection.
+ *
+ * An itk::IterationEvent is invoked by the backprojection thread after the
+ * backprojection of each projection.
+ *
+ * A coarse preview of the volume, e.g., for patient positioning, can be
+ * reconstructed alongside with SetPreviewShrinkFactor. Each filtered projection
+ * is then also binned with an itk::BinShrinkImageFilter and backprojected in a
+ * volume with voxels PreviewShrinkFactor times larger in each direction, which
+ * costs a small fraction of the full resolution backprojection. GetPreview
+ * returns a copy of the current preview at any time during the acquisition.
+ *
+ * \test rtkinlinefdktest.cxx
+ *
+ * \ingroup ReconstructionAlgorithm
+ */
+template<class TOutputImage, class TFFTPrecision=double>
+class ITK_EXPORT InlineFDKReconstructor : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef InlineFDKReconstructor        Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TOutputImage                                                             OutputImageType;
+  typedef TOutputImage                                                             ProjectionImageType;
+  typedef typename OutputImageType::Pointer                                        OutputImagePointer;
+  typedef typename ProjectionImageType::Pointer                                    ProjectionImagePointer;
+  typedef ThreeDCircularProjectionGeometry                                         GeometryType;
+  typedef rtk::FusedFDKWeightProjectionFilter<ProjectionImageType>                 WeightFilterType;
+  typedef rtk::FFTRampImageFilter<ProjectionImageType, ProjectionImageType, TFFTPrecision> RampFilterType;
+  typedef rtk::FDKBackProjectionImageFilter<OutputImageType, OutputImageType>      BackProjectionFilterType;
+  typedef typename BackProjectionFilterType::Pointer                               BackProjectionFilterPointer;
+  typedef rtk::ProjectionsReader<ProjectionImageType>                              ProjectionsReaderType;
+  typedef itk::BinShrinkImageFilter<ProjectionImageType, ProjectionImageType>      BinShrinkFilterType;
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(InlineFDKReconstructor, itk::Object);
+
+  /** Get / Set the geometry of the whole acquisition. */
+  itkGetMacro(Geometry, GeometryType::Pointer);
+  itkSetMacro(Geometry, GeometryType::Pointer);
+
+  /** Get / Set the volume in which the projections are backprojected. It is
+   * updated if it has a source and modified in place. */
+  itkGetMacro(Volume, OutputImagePointer);
+  itkSetMacro(Volume, OutputImagePointer);
+
+  /** Get / Set the number of threads which weight and ramp filter the
+   * projections. Default is half the default number of threads of ITK. */
+  itkGetMacro(NumberOfFilteringThreads, unsigned int);
+  itkSetMacro(NumberOfFilteringThreads, unsigned int);
+
+  /** Get / Set the maximum number of projections in each queue. Default is 16. */
+  itkGetMacro(QueueSize, unsigned int);
+  itkSetMacro(QueueSize, unsigned int);
+
+  /** Get / Set the parameters of the ramp filter, see rtk::FFTRampImageFilter. */
+  itkGetMacro(TruncationCorrection, double);
+  itkSetMacro(TruncationCorrection, double);
+  itkGetMacro(HannCutFrequency, double);
+  itkSetMacro(HannCutFrequency, double);
+  itkGetMacro(HannCutFrequencyY, double);
+  itkSetMacro(HannCutFrequencyY, double);
+
+  /** Get / Set the weights, see rtk::FusedFDKWeightProjectionFilter. Default is on. */
+  itkGetMacro(DisplacedDetectorWeighting, bool);
+  itkSetMacro(DisplacedDetectorWeighting, bool);
+  itkBooleanMacro(DisplacedDetectorWeighting);
+  itkGetMacro(ShortScanWeighting, bool);
+  itkSetMacro(ShortScanWeighting, bool);
+  itkBooleanMacro(ShortScanWeighting);
+
+  /** Get / Set the reader whose parameters (pre-processing, conversion to line
+   * integrals, etc.) are used to read the projections pushed with
+   * PushProjectionFile. Its file names are ignored. */
+  itkGetObjectMacro(ProjectionsReader, ProjectionsReaderType);
+  itkSetObjectMacro(ProjectionsReader, ProjectionsReaderType);
+
+  /** Get / Set the filters which backproject the filtered projections in the
+   * volume and in the preview, e.g., rtk::CudaFDKBackProjectionImageFilter to
+   * backproject on the GPU. They must be different objects. Default is
+   * rtk::FDKBackProjectionImageFilter. */
+  itkGetObjectMacro(BackProjectionFilter, BackProjectionFilterType);
+  itkSetObjectMacro(BackProjectionFilter, BackProjectionFilterType);
+  itkGetObjectMacro(PreviewBackProjectionFilter, BackProjectionFilterType);
+  itkSetObjectMacro(PreviewBackProjectionFilter, BackProjectionFilterType);
+
+  /** Get / Set the factor between the voxel size of the preview and that of
+   * the volume. Default is 0, i.e., no preview is reconstructed. */
+  itkGetMacro(PreviewShrinkFactor, unsigned int);
+  itkSetMacro(PreviewShrinkFactor, unsigned int);
+
+  /** Start the filtering and backprojection threads. */
+  void Start();
+
+  /** Push projection number index of the geometry, i.e., an image with one
+   * projection. The pixels are shared, not copied, and must not be modified
+   * until the end of the reconstruction. Waits if the queue is full. */
+  void PushProjection(unsigned int index, ProjectionImageType *projection);
+
+  /** Push projection number index of the geometry which will be read from
+   * fileName by a filtering thread. Waits if the queue is full. */
+  void PushProjectionFile(unsigned int index, const std::string &fileName);
+
+  /** Wait for the end of the processing of all pushed projections, stop the
+   * threads and return the reconstructed volume. Throws an exception if the
+   * processing of a projection has failed. */
+  OutputImageType *Finalize();
+
+  /** Copy of the preview with the projections backprojected so far. Can be
+   * called from any thread while the projections are being processed. */
+  OutputImagePointer GetPreview() const;
+
+  /** Number of projections pushed and backprojected. */
+  unsigned int GetNumberOfPushedProjections() const;
+  unsigned int GetNumberOfBackProjectedProjections() const;
+
+protected:
+  InlineFDKReconstructor();
+  ~InlineFDKReconstructor();
+
+  /** Element of the queues */
+  struct ProjectionItem
+    {
+    unsigned int           Index;
+    ProjectionImagePointer Image;
+    ProjectionImagePointer PreviewImage;
+    std::string            FileName;
+    };
+
+  /** Check the index and add the item to the input queue */
+  void PushItem(const ProjectionItem &item);
+
+  /** Thread functions and their callbacks for itk::MultiThreader */
+  void FilterProjections();
+  void BackProjectProjections();
+  static ITK_THREAD_RETURN_TYPE FilteringThreadCallback(void *arg);
+  static ITK_THREAD_RETURN_TYPE BackProjectionThreadCallback(void *arg);
+
+  /** Image sharing the pixels of projection with the projection index along
+   * the last dimension. */
+  ProjectionImagePointer GetProjectionWithIndex(ProjectionImageType *projection, unsigned int index);
+
+  /** Allocate the preview volume covering the same region as the volume. */
+  void AllocatePreview();
+
+  /** Store the message of an exception thrown by a processing thread. */
+  void SetError(const std::string &message);
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  InlineFDKReconstructor(const Self&); //purposely not implemented
+  void operator=(const Self&);         //purposely not implemented
+
+  GeometryType::Pointer                   m_Geometry;
+  OutputImagePointer                      m_Volume;
+  typename ProjectionsReaderType::Pointer m_ProjectionsReader;
+  BackProjectionFilterPointer             m_BackProjectionFilter;
+  BackProjectionFilterPointer             m_PreviewBackProjectionFilter;
+  unsigned int                            m_NumberOfFilteringThreads;
+  unsigned int                            m_QueueSize;
+  double                                  m_TruncationCorrection;
+  double                                  m_HannCutFrequency;
+  double                                  m_HannCutFrequencyY;
+  bool                                    m_DisplacedDetectorWeighting;
+  bool                                    m_ShortScanWeighting;
+  unsigned int                            m_PreviewShrinkFactor;
+
+  /** Queues between the producers and the filtering threads and between the
+   * filtering threads and the backprojection thread */
+  BoundedQueue<ProjectionItem> m_InputQueue;
+  BoundedQueue<ProjectionItem> m_FilteredQueue;
+
+  /** Threads */
+  itk::MultiThreader::Pointer m_Threader;
+  std::vector<ThreadIdType>   m_ThreadIds;
+  bool                        m_Started;
+
+  /** State shared by the threads, protected by m_Mutex */
+  mutable itk::SimpleFastMutexLock m_Mutex;
+  std::vector<bool>                m_Pushed;
+  unsigned int                     m_NumberOfPushedProjections;
+  unsigned int                     m_NumberOfBackProjectedProjections;
+  unsigned int                     m_NumberOfActiveFilteringThreads;
+  std::string                      m_ErrorMessage;
+
+  /** Preview volume, protected by m_PreviewMutex */
+  mutable itk::SimpleFastMutexLock m_PreviewMutex;
+  OutputImagePointer               m_PreviewVolume;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkInlineFDKReconstructor.hxx"
+#endif
+
+#endif
@@ -0,0 +1,443 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkInlineFDKReconstructor_hxx
+#define __rtkInlineFDKReconstructor_hxx
+
+#include <itkCommand.h>
+#include <itkImageDuplicator.h>
+#include <itkMutexLockHolder.h>
+
+namespace rtk
+{
+
+template <class TOutputImage, class TFFTPrecision>
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::InlineFDKReconstructor():
+  m_NumberOfFilteringThreads( vnl_math_max(1, (int)itk::MultiThreader::GetGlobalDefaultNumberOfThreads()/2) ),
+  m_QueueSize(16),
+  m_TruncationCorrection(0.),
+  m_HannCutFrequency(0.),
+  m_HannCutFrequencyY(0.),
+  m_DisplacedDetectorWeighting(true),
+  m_ShortScanWeighting(true),
+  m_PreviewShrinkFactor(0),
+  m_Started(false),
+  m_NumberOfPushedProjections(0),
+  m_NumberOfBackProjectedProjections(0),
+  m_NumberOfActiveFilteringThreads(0)
+{
+  m_ProjectionsReader = ProjectionsReaderType::New();
+  m_BackProjectionFilter = BackProjectionFilterType::New();
+  m_PreviewBackProjectionFilter = BackProjectionFilterType::New();
+  m_Threader = itk::MultiThreader::New();
+}
+
+template <class TOutputImage, class TFFTPrecision>
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::~InlineFDKReconstructor()
+{
+  // Do not leave threads running on a destroyed object
+  if(m_Started)
+    {
+    m_InputQueue.Close();
+    m_FilteredQueue.Close();
+    for(unsigned int i=0; i<m_ThreadIds.size(); i++)
+      m_Threader->TerminateThread(m_ThreadIds[i]);
+    }
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::Start()
+{
+  if(m_Started)
+    itkExceptionMacro(<< "The reconstruction has already been started");
+  if(m_Geometry.IsNull())
+    itkExceptionMacro(<< "The geometry of the acquisition has not been set");
+  if(m_Volume.IsNull())
+    itkExceptionMacro(<< "The volume has not been set");
+  if(m_BackProjectionFilter.IsNull() ||
+     (m_PreviewShrinkFactor>1 && m_PreviewBackProjectionFilter.IsNull()))
+    itkExceptionMacro(<< "The backprojection filters have not been set");
+  if(m_PreviewShrinkFactor>1 && m_BackProjectionFilter == m_PreviewBackProjectionFilter)
+    itkExceptionMacro(<< "The volume and the preview must be backprojected by different filters");
+
+  // The volume is modified in place
+  if(m_Volume->GetSource())
+    {
+    m_Volume->Update();
+    m_Volume->DisconnectPipeline();
+    }
+
+  this->AllocatePreview();
+
+  m_Pushed.assign(m_Geometry->GetGantryAngles().size(), false);
+  m_NumberOfPushedProjections = 0;
+  m_NumberOfBackProjectedProjections = 0;
+  m_ErrorMessage = "";
+  m_InputQueue.Reset();
+  m_InputQueue.SetCapacity(m_QueueSize);
+  m_FilteredQueue.Reset();
+  m_FilteredQueue.SetCapacity(m_QueueSize);
+
+  m_ThreadIds.clear();
+  m_NumberOfActiveFilteringThreads = vnl_math_max(1U, m_NumberOfFilteringThreads);
+  for(unsigned int i=0; i<m_NumberOfActiveFilteringThreads; i++)
+    m_ThreadIds.push_back( m_Threader->SpawnThread(FilteringThreadCallback, this) );
+  m_ThreadIds.push_back( m_Threader->SpawnThread(BackProjectionThreadCallback, this) );
+  m_Started = true;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::AllocatePreview()
+{
+  m_PreviewMutex.Lock();
+  m_PreviewVolume = NULL;
+  if(m_PreviewShrinkFactor>1)
+    {
+    // Same physical extent as the volume with larger voxels. The first preview
+    // voxel is centered on the first m_PreviewShrinkFactor voxels of the volume.
+    const typename OutputImageType::RegionType region = m_Volume->GetLargestPossibleRegion();
+    typename OutputImageType::IndexType firstIndex = region.GetIndex();
+    typename OutputImageType::SpacingType spacing = m_Volume->GetSpacing();
+    typename OutputImageType::SizeType size;
+    itk::ContinuousIndex<double, ImageDimension> centerIndex;
+    for(unsigned int i=0; i<ImageDimension; i++)
+      {
+      centerIndex[i] = firstIndex[i] + 0.5 * (m_PreviewShrinkFactor - 1);
+      spacing[i] *= m_PreviewShrinkFactor;
+      size[i] = (region.GetSize(i) + m_PreviewShrinkFactor - 1) / m_PreviewShrinkFactor;
+      }
+    typename OutputImageType::PointType origin;
+    m_Volume->TransformContinuousIndexToPhysicalPoint(centerIndex, origin);
+
+    m_PreviewVolume = OutputImageType::New();
+    m_PreviewVolume->SetRegions(size);
+    m_PreviewVolume->SetOrigin(origin);
+    m_PreviewVolume->SetSpacing(spacing);
+    m_PreviewVolume->SetDirection(m_Volume->GetDirection());
+    m_PreviewVolume->Allocate();
+    m_PreviewVolume->FillBuffer(0);
+    }
+  m_PreviewMutex.Unlock();
+}
+
+template <class TOutputImage, class TFFTPrecision>
+typename InlineFDKReconstructor<TOutputImage, TFFTPrecision>::OutputImagePointer
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::GetPreview() const
+{
+  OutputImagePointer preview;
+  m_PreviewMutex.Lock();
+  if(m_PreviewVolume.IsNotNull())
+    {
+    typedef itk::ImageDuplicator<OutputImageType> DuplicatorType;
+    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+    duplicator->SetInputImage(m_PreviewVolume);
+    duplicator->Update();
+    preview = duplicator->GetOutput();
+    }
+  m_PreviewMutex.Unlock();
+  return preview;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::PushItem(const ProjectionItem &item)
+{
+  if(!m_Started)
+    itkExceptionMacro(<< "Start must be called before pushing projections");
+
+  m_Mutex.Lock();
+  const bool invalid = (item.Index >= m_Pushed.size() || m_Pushed[item.Index]);
+  if(!invalid)
+    {
+    m_Pushed[item.Index] = true;
+    m_NumberOfPushedProjections++;
+    }
+  m_Mutex.Unlock();
+  if(invalid)
+    itkExceptionMacro(<< "Projection #" << item.Index << " is not in the geometry or has already been pushed");
+
+  m_InputQueue.Push(item);
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::PushProjection(unsigned int index, ProjectionImageType *projection)
+{
+  ProjectionItem item;
+  item.Index = index;
+  item.Image = projection;
+  this->PushItem(item);
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::PushProjectionFile(unsigned int index, const std::string &fileName)
+{
+  ProjectionItem item;
+  item.Index = index;
+  item.FileName = fileName;
+  this->PushItem(item);
+}
+
+template <class TOutputImage, class TFFTPrecision>
+typename InlineFDKReconstructor<TOutputImage, TFFTPrecision>::OutputImageType *
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::Finalize()
+{
+  if(!m_Started)
+    itkExceptionMacro(<< "The reconstruction has not been started");
+
+  // The filtering threads exit when the input queue is empty and the last one
+  // closes the queue of the backprojection thread
+  m_InputQueue.Close();
+  for(unsigned int i=0; i<m_ThreadIds.size(); i++)
+    m_Threader->TerminateThread(m_ThreadIds[i]);
+  m_ThreadIds.clear();
+  m_Started = false;
+
+  if(m_ErrorMessage != "")
+    itkExceptionMacro(<< "Inline reconstruction failed: " << m_ErrorMessage);
+  return m_Volume;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+unsigned int
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::GetNumberOfPushedProjections() const
+{
+  m_Mutex.Lock();
+  const unsigned int n = m_NumberOfPushedProjections;
+  m_Mutex.Unlock();
+  return n;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+unsigned int
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::GetNumberOfBackProjectedProjections() const
+{
+  m_Mutex.Lock();
+  const unsigned int n = m_NumberOfBackProjectedProjections;
+  m_Mutex.Unlock();
+  return n;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+typename InlineFDKReconstructor<TOutputImage, TFFTPrecision>::ProjectionImagePointer
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::GetProjectionWithIndex(ProjectionImageType *projection, unsigned int index)
+{
+  typename ProjectionImageType::RegionType region = projection->GetBufferedRegion();
+  if(region != projection->GetLargestPossibleRegion() || region.GetSize(ImageDimension-1) != 1)
+    itkExceptionMacro(<< "Projection #" << index << " must be a fully buffered image with one projection");
+  region.SetIndex(ImageDimension-1, index);
+
+  ProjectionImagePointer result = ProjectionImageType::New();
+  result->CopyInformation(projection);
+  result->SetRegions(region);
+  result->SetPixelContainer(projection->GetPixelContainer());
+  return result;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::SetError(const std::string &message)
+{
+  m_Mutex.Lock();
+  if(m_ErrorMessage == "")
+    m_ErrorMessage = message;
+  m_Mutex.Unlock();
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::FilterProjections()
+{
+  // Each thread has its own mini-pipeline, single threaded since several
+  // projections are filtered in parallel
+  typename ProjectionsReaderType::Pointer reader = ProjectionsReaderType::New();
+  reader->SetOrigin( m_ProjectionsReader->GetOrigin() );
+  reader->SetSpacing( m_ProjectionsReader->GetSpacing() );
+  reader->SetDirection( m_ProjectionsReader->GetDirection() );
+  reader->SetLowerBoundaryCropSize( m_ProjectionsReader->GetLowerBoundaryCropSize() );
+  reader->SetUpperBoundaryCropSize( m_ProjectionsReader->GetUpperBoundaryCropSize() );
+  reader->SetShrinkFactors( m_ProjectionsReader->GetShrinkFactors() );
+  reader->SetAirThreshold( m_ProjectionsReader->GetAirThreshold() );
+  reader->SetScatterToPrimaryRatio( m_ProjectionsReader->GetScatterToPrimaryRatio() );
+  reader->SetNonNegativityConstraintThreshold( m_ProjectionsReader->GetNonNegativityConstraintThreshold() );
+  reader->SetI0( m_ProjectionsReader->GetI0() );
+  reader->SetWaterPrecorrectionCoefficients( m_ProjectionsReader->GetWaterPrecorrectionCoefficients() );
+  reader->SetComputeLineIntegral( m_ProjectionsReader->GetComputeLineIntegral() );
+
+  typename WeightFilterType::Pointer weight = WeightFilterType::New();
+  weight->SetGeometry( m_Geometry );
+  weight->SetDisplacedDetectorWeighting( m_DisplacedDetectorWeighting );
+  weight->SetShortScanWeighting( m_ShortScanWeighting );
+  weight->SetNumberOfThreads(1);
+  weight->InPlaceOff();
+
+  typename RampFilterType::Pointer ramp = RampFilterType::New();
+  ramp->SetInput( weight->GetOutput() );
+  ramp->SetTruncationCorrection( m_TruncationCorrection );
+  ramp->SetHannCutFrequency( m_HannCutFrequency );
+  ramp->SetHannCutFrequencyY( m_HannCutFrequencyY );
+  ramp->SetNumberOfThreads(1);
+
+  typename BinShrinkFilterType::Pointer bin = BinShrinkFilterType::New();
+  typename BinShrinkFilterType::ShrinkFactorsType binFactors;
+  binFactors.Fill(m_PreviewShrinkFactor);
+  binFactors[ImageDimension-1] = 1;
+  bin->SetShrinkFactors( binFactors );
+  bin->SetNumberOfThreads(1);
+
+  ProjectionItem item;
+  while( m_InputQueue.Pop(item) )
+    {
+    try
+      {
+      if(item.Image.IsNull())
+        {
+        reader->SetFileNames( std::vector<std::string>(1, item.FileName) );
+        reader->UpdateLargestPossibleRegion();
+        item.Image = reader->GetOutput();
+        item.Image->DisconnectPipeline();
+        }
+      weight->SetInput( this->GetProjectionWithIndex(item.Image, item.Index) );
+      ramp->UpdateLargestPossibleRegion();
+      item.Image = ramp->GetOutput();
+      item.Image->DisconnectPipeline();
+      if(m_PreviewShrinkFactor>1)
+        {
+        bin->SetInput( item.Image );
+        bin->UpdateLargestPossibleRegion();
+        item.PreviewImage = bin->GetOutput();
+        item.PreviewImage->DisconnectPipeline();
+        }
+      m_FilteredQueue.Push(item);
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      this->SetError( err.GetDescription() );
+      }
+    }
+
+  // The last filtering thread signals the end to the backprojection thread
+  m_Mutex.Lock();
+  if(--m_NumberOfActiveFilteringThreads == 0)
+    m_FilteredQueue.Close();
+  m_Mutex.Unlock();
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::BackProjectProjections()
+{
+  BackProjectionFilterPointer bp = m_BackProjectionFilter;
+  bp->SetGeometry( m_Geometry.GetPointer() );
+  bp->InPlaceOn();
+
+  BackProjectionFilterPointer previewBP = m_PreviewBackProjectionFilter;
+  if(m_PreviewShrinkFactor>1)
+    {
+    previewBP->SetGeometry( m_Geometry.GetPointer() );
+    previewBP->InPlaceOn();
+    }
+
+  ProjectionItem item;
+  while( m_FilteredQueue.Pop(item) )
+    {
+    try
+      {
+      bp->SetInput(0, m_Volume);
+      bp->SetInput(1, item.Image);
+      bp->UpdateLargestPossibleRegion();
+      OutputImagePointer volume = bp->GetOutput();
+      volume->DisconnectPipeline();
+      m_Volume = volume;
+
+      if(item.PreviewImage.IsNotNull())
+        {
+        itk::MutexLockHolder<itk::SimpleFastMutexLock> previewLock(m_PreviewMutex);
+        previewBP->SetInput(0, m_PreviewVolume);
+        previewBP->SetInput(1, item.PreviewImage);
+        previewBP->UpdateLargestPossibleRegion();
+        m_PreviewVolume = previewBP->GetOutput();
+        m_PreviewVolume->DisconnectPipeline();
+        }
+
+      m_Mutex.Lock();
+      m_NumberOfBackProjectedProjections++;
+      m_Mutex.Unlock();
+      this->InvokeEvent( itk::IterationEvent() );
+      }
+    catch( itk::ExceptionObject & err )
+      {
+      this->SetError( err.GetDescription() );
+      }
+    }
+}
+
+template <class TOutputImage, class TFFTPrecision>
+ITK_THREAD_RETURN_TYPE
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::FilteringThreadCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  static_cast<Self *>(info->UserData)->FilterProjections();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+ITK_THREAD_RETURN_TYPE
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::BackProjectionThreadCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  static_cast<Self *>(info->UserData)->BackProjectProjections();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TOutputImage, class TFFTPrecision>
+void
+InlineFDKReconstructor<TOutputImage, TFFTPrecision>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfFilteringThreads: " << m_NumberOfFilteringThreads << std::endl
+     << indent << "QueueSize: " << m_QueueSize << std::endl
+     << indent << "PreviewShrinkFactor: " << m_PreviewShrinkFactor << std::endl
+     << indent << "NumberOfPushedProjections: " << this->GetNumberOfPushedProjections() << std::endl
+     << indent << "NumberOfBackProjectedProjections: " << this->GetNumberOfBackProjectedProjections() << std::endl;
+}
+
+} // end namespace rtk
+
+#endif
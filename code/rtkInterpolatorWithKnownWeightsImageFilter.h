@@ -52,6 +52,10 @@ namespace rtk
    *
    * InterpolatorWithKnownWeightsImageFilter implements S_theta.
    *
+   * The pixels of the 3D + t sequence are converted to the pixel type of the
+   * 3D volume before the interpolation. The sequence can therefore be stored
+   * with a lower precision, e.g. with rtk::Half pixels.
+   *
    *
    * \test rtkfourdconjugategradienttest.cxx
    *
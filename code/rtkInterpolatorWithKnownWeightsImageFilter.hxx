@@ -137,6 +137,7 @@ void InterpolatorWithKnownWeightsImageFilter<VolumeType, VolumeSeriesType>
   typedef itk::ImageRegionIterator<VolumeType>        VolumeRegionIterator;
   typedef itk::ImageRegionConstIterator<VolumeType>   VolumeRegionConstIterator;
   typedef itk::ImageRegionIterator<VolumeSeriesType>  VolumeSeriesRegionIterator;
+  typedef typename VolumeType::PixelType              VolumePixelType;
 
   float weight;
 
@@ -184,7 +185,7 @@ void InterpolatorWithKnownWeightsImageFilter<VolumeType, VolumeSeriesType>
 
       while(!itOut.IsAtEnd())
         {
-        itOut.Set(itOut.Get() + weight * itVolumeSeries.Get());
+        itOut.Set(itOut.Get() + weight * static_cast<VolumePixelType>(itVolumeSeries.Get()));
         ++itVolumeSeries;
         ++itOut;
         }
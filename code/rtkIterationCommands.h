@@ -0,0 +1,73 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkIterationCommands_h
+#define __rtkIterationCommands_h
+
+#include <itkCommand.h>
+
+namespace rtk
+{
+
+/** \class VerboseIterationCommand
+ * \brief Prints the convergence of a conjugate gradient based filter.
+ *
+ * Observer of the itk::IterationEvent of rtk::ConjugateGradientImageFilter or
+ * of a reconstruction filter forwarding its events. TCaller must provide
+ * GetResidualNorms() and GetElapsedTimes(), e.g.,
+ * rtk::ConjugateGradientConeBeamReconstructionFilter.
+ *
+ * \ingroup Functions
+ */
+template<class TCaller>
+class VerboseIterationCommand : public itk::Command
+{
+public:
+  /** Standard class typedefs. */
+  typedef VerboseIterationCommand       Self;
+  typedef itk::Command                  Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  void Execute(itk::Object *caller, const itk::EventObject & event)
+    {
+    this->Execute( (const itk::Object *)caller, event);
+    }
+
+  void Execute(const itk::Object *caller, const itk::EventObject & event)
+    {
+    if( !itk::IterationEvent().CheckEvent( &event ) )
+      return;
+    const TCaller *filter = dynamic_cast<const TCaller *>(caller);
+    if( !filter || filter->GetResidualNorms().empty() )
+      return;
+    std::cout << "Iteration #" << filter->GetResidualNorms().size()
+              << ", relative residual " << filter->GetResidualNorms().back()
+              << ", " << filter->GetElapsedTimes().back() << " s"
+              << std::endl;
+    }
+
+protected:
+  VerboseIterationCommand() {}
+};
+
+} // end namespace rtk
+
+#endif
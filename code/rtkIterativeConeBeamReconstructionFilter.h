@@ -23,9 +23,14 @@
 #include "rtkConfiguration.h"
 #include "rtkRayCastInterpolatorForwardProjectionImageFilter.h"
 #include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkDistanceDrivenForwardProjectionImageFilter.h"
 // Back projection filters
 #include "rtkJosephBackProjectionImageFilter.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+#include "rtkDistanceDrivenBackProjectionImageFilter.h"
+#include "rtkThreadPoolImageFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "rtkCudaForwardProjectionImageFilter.h"
@@ -80,6 +85,14 @@ public:
   virtual void SetBackProjectionFilter (int bptype);
   int GetBackProjectionFilter () { return m_CurrentBackProjectionConfiguration; }
 
+  /** Get / Set whether the Siddon projectors (--fp 3 and --bp 5) store the
+   * ray-volume intersections in a rtk::SiddonRayCache shared by all the
+   * projectors of the filter. The cache uses 16 bytes per projection pixel.
+   * Default is on. It must be set before the projectors. */
+  itkGetMacro(UseSiddonRayCache, bool);
+  itkSetMacro(UseSiddonRayCache, bool);
+  itkBooleanMacro(UseSiddonRayCache);
+
 protected:
   IterativeConeBeamReconstructionFilter();
   ~IterativeConeBeamReconstructionFilter(){}
@@ -97,6 +110,10 @@ protected:
   int m_CurrentForwardProjectionConfiguration;
   int m_CurrentBackProjectionConfiguration;
 
+  /** Cache shared by the Siddon projectors */
+  bool                    m_UseSiddonRayCache;
+  SiddonRayCache::Pointer m_SiddonRayCache;
+
 private:
   //purposely not implemented
   IterativeConeBeamReconstructionFilter(const Self&);
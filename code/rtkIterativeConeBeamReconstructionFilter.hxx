@@ -29,6 +29,10 @@ namespace rtk
   {
     m_CurrentForwardProjectionConfiguration = -1;
     m_CurrentBackProjectionConfiguration = -1;
+
+    // The Siddon projectors share the ray-volume intersections
+    m_UseSiddonRayCache = true;
+    m_SiddonRayCache = SiddonRayCache::New();
   }
 
   template<class TOutputImage, class ProjectionStackType>
@@ -40,10 +44,10 @@ namespace rtk
     switch(fwtype)
       {
       case(0):
-        fw = rtk::JosephForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
+        fw = rtk::ThreadPoolImageFilter< rtk::JosephForwardProjectionImageFilter<VolumeType, ProjectionStackType> >::New();
       break;
       case(1):
-        fw = rtk::RayCastInterpolatorForwardProjectionImageFilter<VolumeType, ProjectionStackType>::New();
+        fw = rtk::ThreadPoolImageFilter< rtk::RayCastInterpolatorForwardProjectionImageFilter<VolumeType, ProjectionStackType> >::New();
       break;
       case(2):
       #ifdef RTK_USE_CUDA
@@ -52,6 +56,18 @@ namespace rtk
         itkGenericExceptionMacro(<< "The program has not been compiled with cuda option");
       #endif
       break;
+      case(3):
+        {
+        typedef rtk::ThreadPoolImageFilter< rtk::SiddonForwardProjectionImageFilter<VolumeType, ProjectionStackType> > SiddonType;
+        typename SiddonType::Pointer siddon = SiddonType::New();
+        siddon->SetUseRayCache(m_UseSiddonRayCache);
+        siddon->SetRayCache(m_SiddonRayCache);
+        fw = siddon;
+        }
+      break;
+      case(4):
+        fw = rtk::ThreadPoolImageFilter< rtk::DistanceDrivenForwardProjectionImageFilter<VolumeType, ProjectionStackType> >::New();
+      break;
 
       default:
         itkGenericExceptionMacro(<< "Unhandled --fp value.");
@@ -67,9 +83,10 @@ namespace rtk
     switch(bptype)
       {
       case(0):
-        bp = rtk::BackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
+        bp = rtk::ThreadPoolImageFilter< rtk::BackProjectionImageFilter<ProjectionStackType, VolumeType> >::New();
         break;
       case(1):
+        // Sequential GenerateData, not dispatched onto the thread pool
         bp = rtk::JosephBackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
         break;
       case(2):
@@ -80,6 +97,7 @@ namespace rtk
       #endif
       break;
       case(3):
+        // Sequential GenerateData, not dispatched onto the thread pool
         bp = rtk::NormalizedJosephBackProjectionImageFilter<ProjectionStackType, VolumeType>::New();
         break;
       case(4):
@@ -89,6 +107,18 @@ namespace rtk
         itkGenericExceptionMacro(<< "The program has not been compiled with cuda option");
       #endif
         break;
+      case(5):
+        {
+        typedef rtk::ThreadPoolImageFilter< rtk::SiddonBackProjectionImageFilter<ProjectionStackType, VolumeType> > SiddonType;
+        typename SiddonType::Pointer siddon = SiddonType::New();
+        siddon->SetUseRayCache(m_UseSiddonRayCache);
+        siddon->SetRayCache(m_SiddonRayCache);
+        bp = siddon;
+        }
+        break;
+      case(6):
+        bp = rtk::ThreadPoolImageFilter< rtk::DistanceDrivenBackProjectionImageFilter<ProjectionStackType, VolumeType> >::New();
+        break;
       default:
         itkGenericExceptionMacro(<< "Unhandled --bp value.");
       }
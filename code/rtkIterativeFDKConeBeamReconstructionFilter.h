@@ -31,6 +31,7 @@
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkFDKConeBeamReconstructionFilter.h"
 #include "rtkRayBoxIntersectionImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
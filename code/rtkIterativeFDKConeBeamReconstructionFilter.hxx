@@ -182,6 +182,8 @@ IterativeFDKConeBeamReconstructionFilter<TInputImage, TOutputImage, TFFTPrecisio
   // For each iteration over 1, go over each projection
   for(unsigned int iter = 1; iter < m_NumberOfIterations; iter++)
     {
+    TraceSpan iterationSpan("Iterative FDK iteration", this, iter);
+
     m_DivideFilter->Update();
 
     // Use previous iteration's result as input volume in next iteration
@@ -41,11 +41,6 @@ JosephBackProjectionImageFilter<TInputImage,
   const unsigned int Dimension = TInputImage::ImageDimension;
   typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
   const unsigned int nPixelPerProj = buffReg.GetSize(0) * buffReg.GetSize(1);
-  int offsets[3];
-  offsets[0] = 1;
-  offsets[1] = this->GetInput(0)->GetBufferedRegion().GetSize()[0];
-  offsets[2] = this->GetInput(0)->GetBufferedRegion().GetSize()[0] * this->GetInput(0)->GetBufferedRegion().GetSize()[1];
-
   GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
   if( !geometry )
     {
@@ -54,25 +49,14 @@ JosephBackProjectionImageFilter<TInputImage,
 
   // Allocate the output image
   this->AllocateOutputs();
+  int offsets[3];
+  offsets[0] = 1;
+  offsets[1] = this->GetOutput()->GetBufferedRegion().GetSize()[0];
+  offsets[2] = this->GetOutput()->GetBufferedRegion().GetSize()[0] * this->GetOutput()->GetBufferedRegion().GetSize()[1];
 
   // Initialize output region with input region in case the filter is not in
   // place
-  if(this->GetInput() != this->GetOutput() )
-    {
-    // Iterators on volume input and output
-    typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-    InputRegionIterator itVolIn(this->GetInput(0), this->GetInput()->GetBufferedRegion());
-
-    typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
-    OutputRegionIterator itVolOut(this->GetOutput(), this->GetInput()->GetBufferedRegion());
-
-    while(!itVolIn.IsAtEnd() )
-      {
-      itVolOut.Set(itVolIn.Get() );
-      ++itVolIn;
-      ++itVolOut;
-      }
-    }
+  this->InitializeOutputRegion( this->GetOutput()->GetRequestedRegion() );
 
   // beginBuffer is pointing at point with index (0,0,0) in memory, even if
   // it is not in the allocated memory
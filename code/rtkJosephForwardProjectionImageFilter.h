@@ -22,6 +22,7 @@
 #include "rtkConfiguration.h"
 #include "rtkForwardProjectionImageFilter.h"
 #include "rtkMacro.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -41,6 +41,8 @@ JosephForwardProjectionImageFilter<TInputImage,
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType threadId )
 {
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nPixelPerProj = outputRegionForThread.GetSize(0)*outputRegionForThread.GetSize(1);
   int offsets[3];
@@ -59,7 +61,7 @@ JosephForwardProjectionImageFilter<TInputImage,
 
   // Iterators on input and output projections
   typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  InputRegionIterator itIn(this->InitializeAccumulation(outputRegionForThread), outputRegionForThread);
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
@@ -87,11 +87,15 @@
 
 //--------------------------------------------------------------------
 /** \brief Update a filter and catching/displaying exceptions
+ *
+ * The macro can be defined before including this file by programs which must
+ * not exit on exceptions, e.g., rtkreconstructiond.
  *
  * \author Simon Rit
  *
  * \ingroup Macro
  */
+#ifndef TRY_AND_EXIT_ON_ITK_EXCEPTION
 #define TRY_AND_EXIT_ON_ITK_EXCEPTION(execFunc)                         \
   try                                                                   \
     {                                                                   \
@@ -124,6 +128,7 @@
       }                                                                 \
       exit(EXIT_FAILURE);                                               \
     }
+#endif
 //--------------------------------------------------------------------
 
 //--------------------------------------------------------------------
@@ -157,12 +162,26 @@
 /** \brief Redefine ITK's New macros in order to add a watcher to
  * each new filter created
  *
+ * Each new process object is watched by rtk::TraceCollector if tracing is
+ * enabled when it is created, and by rtk::GlobalTimer if
+ * RTK_TIME_EACH_FILTER is on.
+ *
  * \author Cyril Mory
  *
  * \ingroup Macro
  */
 
 #ifdef RTK_TIME_EACH_FILTER
+# define rtkWatchProcessObjectMacro(processObjectPointer)             \
+    rtk::GlobalTimer::GetInstance()->Watch(processObjectPointer);     \
+    if( rtk::TraceCollector::IsEnabled() )                            \
+      rtk::TraceCollector::GetInstance()->Watch(processObjectPointer);
+#else
+# define rtkWatchProcessObjectMacro(processObjectPointer)             \
+    if( rtk::TraceCollector::IsEnabled() )                            \
+      rtk::TraceCollector::GetInstance()->Watch(processObjectPointer);
+#endif
+
 #undef itkSimpleNewMacro
 #define itkSimpleNewMacro(x)                                                         \
   static Pointer New(void)                                                           \
@@ -178,7 +197,7 @@
     processObjectPointer = dynamic_cast<itk::ProcessObject*>(smartPtr.GetPointer()); \
     if (processObjectPointer != NULL)                                                \
       {                                                                              \
-      rtk::GlobalTimer::GetInstance()->Watch(processObjectPointer);                  \
+      rtkWatchProcessObjectMacro(processObjectPointer)                               \
       }                                                                              \
     return smartPtr;                                                                 \
     }
@@ -205,7 +224,7 @@
     processObjectPointer = dynamic_cast<itk::ProcessObject*>(smartPtr.GetPointer()); \
     if (processObjectPointer != NULL)                                                \
       {                                                                              \
-      rtk::GlobalTimer::GetInstance()->Watch(processObjectPointer);                  \
+      rtkWatchProcessObjectMacro(processObjectPointer)                               \
       }                                                                              \
     return smartPtr;                                                                 \
     }                                                                                \
@@ -215,7 +234,6 @@
     smartPtr = x::New().GetPointer();                                                \
     return smartPtr;                                                                 \
     }
-#endif //RTK_TIME_EACH_FILTER
 
 
 #endif
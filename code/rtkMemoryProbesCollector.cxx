@@ -0,0 +1,316 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkMemoryProbesCollector.h"
+
+#include <itkImage.h>
+#include <itkVectorImage.h>
+#include <itkCovariantVector.h>
+#include <itkVector.h>
+#include <itkMemoryUsageObserver.h>
+
+#include "rtkHalf.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <set>
+
+#if defined(_WIN32)
+# include <windows.h>
+# include <psapi.h>
+# if defined(_MSC_VER)
+#  pragma comment(lib, "psapi.lib")
+# endif
+#else
+# include <sys/resource.h>
+#endif
+
+namespace rtk
+{
+
+namespace
+{
+/** Buffer and size of a data object if it is an image of type TImage */
+template< class TImage >
+bool GetImageBuffer(const itk::DataObject *o, const void * &buffer, itk::SizeValueType &bytes)
+{
+  const TImage *img = dynamic_cast<const TImage *>(o);
+  if( !img || !img->GetPixelContainer() )
+    return false;
+  buffer = img->GetBufferPointer();
+  bytes = img->GetPixelContainer()->Size() * sizeof(typename TImage::InternalPixelType);
+  return true;
+}
+
+/** Buffer and size of a data object if it is an image with components of
+ * type TComponent */
+template< class TComponent, unsigned int VDimension >
+bool GetImageBufferForComponent(const itk::DataObject *o, const void * &buffer, itk::SizeValueType &bytes)
+{
+  return GetImageBuffer< itk::Image<TComponent, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<itk::CovariantVector<TComponent, 3>, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<itk::Vector<TComponent, 3>, VDimension> >(o, buffer, bytes);
+}
+
+template< unsigned int VDimension >
+bool GetImageBufferForDimension(const itk::DataObject *o, const void * &buffer, itk::SizeValueType &bytes)
+{
+  return GetImageBufferForComponent<float, VDimension>(o, buffer, bytes) ||
+         GetImageBufferForComponent<double, VDimension>(o, buffer, bytes) ||
+         GetImageBufferForComponent<rtk::Half, VDimension>(o, buffer, bytes) ||
+         GetImageBufferForComponent<rtk::BFloat16, VDimension>(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<unsigned short, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<short, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<unsigned char, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::Image<unsigned int, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::VectorImage<float, VDimension> >(o, buffer, bytes) ||
+         GetImageBuffer< itk::VectorImage<double, VDimension> >(o, buffer, bytes);
+}
+
+bool GetDataObjectBuffer(const itk::DataObject *o, const void * &buffer, itk::SizeValueType &bytes)
+{
+  buffer = ITK_NULLPTR;
+  bytes = 0;
+  if( !o )
+    return false;
+  return GetImageBufferForDimension<2>(o, buffer, bytes) ||
+         GetImageBufferForDimension<3>(o, buffer, bytes) ||
+         GetImageBufferForDimension<4>(o, buffer, bytes);
+}
+}
+
+MemoryProbesCollector
+::MemoryProbesCollector()
+{
+}
+
+MemoryProbesCollector
+::~MemoryProbesCollector()
+{
+}
+
+MemoryProbesCollector::SizeValueType
+MemoryProbesCollector
+::GetOutputBytes(const itk::ProcessObject *process)
+{
+  // Buffers of the inputs
+  std::set<const void *> inputBuffers;
+  itk::ProcessObject::DataObjectPointerArray inputs = const_cast<itk::ProcessObject *>(process)->GetInputs();
+  for(unsigned int i=0; i<inputs.size(); i++)
+    {
+    const void *buffer;
+    SizeValueType bytes;
+    if( GetDataObjectBuffer(inputs[i], buffer, bytes) && buffer )
+      inputBuffers.insert(buffer);
+    }
+
+  // Buffers of the outputs which are not those of an input
+  SizeValueType total = 0;
+  itk::ProcessObject::DataObjectPointerArray outputs = const_cast<itk::ProcessObject *>(process)->GetOutputs();
+  for(unsigned int i=0; i<outputs.size(); i++)
+    {
+    const void *buffer;
+    SizeValueType bytes;
+    if( GetDataObjectBuffer(outputs[i], buffer, bytes) &&
+        ( !buffer || inputBuffers.find(buffer) == inputBuffers.end() ) )
+      total += bytes;
+    }
+  return total;
+}
+
+MemoryProbesCollector::SizeValueType
+MemoryProbesCollector
+::GetPeakResidentSetSize()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if( GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) )
+    return counters.PeakWorkingSetSize;
+  return 0;
+#else
+  struct rusage usage;
+  if( getrusage(RUSAGE_SELF, &usage) )
+    return 0;
+# if defined(__APPLE__)
+  return usage.ru_maxrss;        // bytes
+# else
+  return usage.ru_maxrss * 1024; // kilobytes
+# endif
+#endif
+}
+
+MemoryProbesCollector::SizeValueType
+MemoryProbesCollector
+::GetResidentSetSize()
+{
+  // itk::MemoryUsageObserver reports kilobytes
+  itk::MemoryUsageObserver observer;
+  return observer.GetMemoryUsage() * 1024;
+}
+
+MemoryProbesCollector::MemorySampleType
+MemoryProbesCollector
+::Sample(const itk::ProcessObject *process)
+{
+  MemorySampleType sample;
+  sample.OutputBytes = (process)?GetOutputBytes(process):0;
+  sample.ResidentSetSize = GetResidentSetSize();
+  sample.PeakResidentSetSize = GetPeakResidentSetSize();
+  return sample;
+}
+
+void
+MemoryProbesCollector
+::Start(const char *id, const itk::ProcessObject *process)
+{
+  this->Start(id, process, GetPeakResidentSetSize());
+}
+
+void
+MemoryProbesCollector
+::Start(const char *id, const itk::ProcessObject *process, SizeValueType peakResidentSetSize)
+{
+  if( m_Probes.find(id) == m_Probes.end() )
+    {
+    MemoryProbeType probe = {0, 0, 0, 0, 0, 0, 0};
+    m_Probes[id] = probe;
+    m_Order.push_back(id);
+    }
+  m_Probes[id].NumberOfStarts++;
+  m_StartPeaks[process].push_back(peakResidentSetSize);
+}
+
+void
+MemoryProbesCollector
+::Stop(const char *id, const itk::ProcessObject *process)
+{
+  this->Stop(id, process, Sample(process));
+}
+
+void
+MemoryProbesCollector
+::Stop(const char *id, const itk::ProcessObject *process, const MemorySampleType &sample)
+{
+  MapType::iterator it = m_Probes.find(id);
+  StartPeaksMapType::iterator itStart = m_StartPeaks.find(process);
+  // Ignore probes which have not been started, e.g., if the collector has
+  // been cleared in between
+  if( it == m_Probes.end() || itStart == m_StartPeaks.end() )
+    return;
+  const SizeValueType startPeak = itStart->second.back();
+  itStart->second.pop_back();
+  if( itStart->second.empty() )
+    m_StartPeaks.erase(itStart);
+
+  MemoryProbeType &probe = it->second;
+  probe.NumberOfStops++;
+
+  probe.TotalOutputBytes += sample.OutputBytes;
+  probe.MaxOutputBytes = std::max(probe.MaxOutputBytes, sample.OutputBytes);
+
+  probe.MaxResidentSetSize = std::max(probe.MaxResidentSetSize, sample.ResidentSetSize);
+
+  const SizeValueType peak = sample.PeakResidentSetSize;
+  probe.MaxPeakResidentSetSize = std::max(probe.MaxPeakResidentSetSize, peak);
+  if(peak > startPeak)
+    probe.MaxPeakIncrease = std::max(probe.MaxPeakIncrease, peak - startPeak);
+}
+
+void
+MemoryProbesCollector
+::Report(std::ostream & os) const
+{
+  if ( m_Order.empty() )
+    return;
+
+  unsigned int maxlength = sizeof("Probe Tag")/sizeof(char);
+  for(unsigned int i=0; i<m_Order.size(); i++)
+    maxlength = std::max(maxlength, (unsigned int) m_Order[i].size());
+  maxlength += 2;
+  const unsigned int width = maxlength+10+5*18;
+  const double MB = 1024.*1024.;
+
+  // The format of the stream of the caller is restored after the report
+  const std::ios_base::fmtflags flags = os.flags();
+  os << std::endl << std::endl;
+  os.width(width);
+  os << std::setfill('*') << "" << std::endl << std::setfill(' ');
+  os << std::left;
+  os.width(maxlength);
+  os << "Probe Tag";
+  os.width(10);
+  os << "Stops";
+  os.width(18);
+  os << "Output total (MB)";
+  os.width(18);
+  os << "Output max (MB)";
+  os.width(18);
+  os << "RSS max (MB)";
+  os.width(18);
+  os << "Peak RSS (MB)";
+  os.width(18);
+  os << "Peak incr. (MB)";
+  os << std::endl;
+  os.width(width);
+  os << std::setfill('*') << "" << std::endl << std::setfill(' ');
+
+  for(unsigned int i=0; i<m_Order.size(); i++)
+    {
+    const MemoryProbeType &probe = m_Probes.find(m_Order[i])->second;
+    os.width(maxlength);
+    os << m_Order[i];
+    os.width(10);
+    os << probe.NumberOfStops;
+    os.width(18);
+    os << probe.TotalOutputBytes / MB;
+    os.width(18);
+    os << probe.MaxOutputBytes / MB;
+    os.width(18);
+    os << probe.MaxResidentSetSize / MB;
+    os.width(18);
+    os << probe.MaxPeakResidentSetSize / MB;
+    os.width(18);
+    os << probe.MaxPeakIncrease / MB;
+    os << std::endl;
+    }
+  os.width(width);
+  os << std::setfill('*') << "" << std::endl << std::setfill(' ');
+  os.flags(flags);
+}
+
+void
+MemoryProbesCollector
+::Clear(void)
+{
+  m_Probes.clear();
+  m_Order.clear();
+  m_StartPeaks.clear();
+}
+
+const MemoryProbesCollector::MemoryProbeType *
+MemoryProbesCollector
+::GetProbe(const char *name) const
+{
+  MapType::const_iterator it = m_Probes.find(name);
+  if( it == m_Probes.end() )
+    return ITK_NULLPTR;
+  return &(it->second);
+}
+
+} // end namespace rtk
@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkMemoryProbesCollector_h
+#define __rtkMemoryProbesCollector_h
+
+#include <itkProcessObject.h>
+
+#include <map>
+#include <vector>
+#include <string>
+
+namespace rtk
+{
+/** \class MemoryProbesCollector
+ *  \brief Aggregates the memory used by filters.
+ *
+ *  For each filter name, the collector records the number of bytes of the
+ *  buffers allocated for the outputs of the filter, the resident set size
+ *  (RSS) of the process at the end of the filter and the increase of the peak
+ *  RSS of the process during the filter. The last quantity identifies the
+ *  filters which have raised the high-water mark of the process. Calls can be
+ *  nested, e.g., for the mini-pipelines of composite filters, or interleaved,
+ *  e.g., for filters running concurrently: the start of each call is paired
+ *  with its stop by the process object which is probed.
+ *
+ *  Output buffers which are shared with an input, e.g., for in-place
+ *  filters, are not counted. The size of the elements of the buffers is the
+ *  size of their component type times the number of components per pixel,
+ *  including rtk::Half and rtk::BFloat16 components. Images whose component
+ *  type is unknown to the collector are not counted.
+ *
+ *  The collector is not thread safe. The memory of the process can be
+ *  sampled beforehand with Sample, e.g., outside of the lock of the caller,
+ *  since reading it is slow on some systems.
+ *
+ * \ingroup ITKCommon
+ */
+class ITKCommon_EXPORT MemoryProbesCollector
+{
+public:
+  typedef itk::SizeValueType SizeValueType;
+
+  /** Memory of the process and bytes of the outputs of a filter */
+  struct MemorySampleType
+    {
+    SizeValueType OutputBytes;
+    SizeValueType ResidentSetSize;
+    SizeValueType PeakResidentSetSize;
+    };
+
+  /** Statistics of all calls of the filters with the same name */
+  struct MemoryProbeType
+    {
+    unsigned int  NumberOfStarts;
+    unsigned int  NumberOfStops;
+    SizeValueType TotalOutputBytes;
+    SizeValueType MaxOutputBytes;
+    SizeValueType MaxResidentSetSize;
+    SizeValueType MaxPeakResidentSetSize;
+    SizeValueType MaxPeakIncrease;
+    };
+
+  MemoryProbesCollector();
+  virtual ~MemoryProbesCollector();
+
+  /** Samples the memory of the process at the start of a filter */
+  virtual void Start(const char *name, const itk::ProcessObject *process);
+
+  /** Idem with the peak RSS already sampled with GetPeakResidentSetSize */
+  virtual void Start(const char *name, const itk::ProcessObject *process, SizeValueType peakResidentSetSize);
+
+  /** Samples the memory of the process at the end of a filter and counts the
+   * buffers of its outputs. */
+  virtual void Stop(const char *name, const itk::ProcessObject *process);
+
+  /** Idem with the memory already sampled with Sample */
+  virtual void Stop(const char *name, const itk::ProcessObject *process, const MemorySampleType &sample);
+
+  /** Memory of the process and output bytes of process (if not NULL) */
+  static MemorySampleType Sample(const itk::ProcessObject *process);
+
+  /** Report the summary of results from the probes */
+  virtual void Report(std::ostream & os = std::cout) const;
+
+  /** Destroy the set of probes. */
+  virtual void Clear(void);
+
+  /** Get the statistics of the filters with this name, NULL if there is no
+   * probe with this name. */
+  const MemoryProbeType *GetProbe(const char *name) const;
+
+  /** Number of bytes of the buffers of the outputs of process which are not
+   * shared with one of its inputs. */
+  static SizeValueType GetOutputBytes(const itk::ProcessObject *process);
+
+  /** Peak resident set size of the process in bytes, 0 if unavailable. */
+  static SizeValueType GetPeakResidentSetSize();
+
+  /** Resident set size of the process in bytes. */
+  static SizeValueType GetResidentSetSize();
+
+protected:
+  typedef std::map< std::string, MemoryProbeType > MapType;
+  MapType                    m_Probes;
+  std::vector<std::string>   m_Order;
+
+  /** Peak RSS at the start of the calls which have not been stopped yet, per
+   * process object */
+  typedef std::map< const itk::ProcessObject*, std::vector<SizeValueType> > StartPeaksMapType;
+  StartPeaksMapType          m_StartPeaks;
+};
+} // end namespace rtk
+
+#endif //__rtkMemoryProbesCollector_h
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkMultiResolutionConeBeamReconstructionFilter_h
+#define __rtkMultiResolutionConeBeamReconstructionFilter_h
+
+#include <itkImageToImageFilter.h>
+#include <itkBinShrinkImageFilter.h>
+#include <itkResampleImageFilter.h>
+
+namespace rtk
+{
+
+/** \class MultiResolutionConeBeamReconstructionFilter
+ * \brief Coarse-to-fine driver of an iterative reconstruction.
+ *
+ * The early iterations of iterative reconstructions mostly recover the low
+ * frequencies of the volume, which does not require the full resolution. This
+ * filter runs a reconstruction filter per level, from the coarsest to the
+ * finest, each level being added with AddLevel with its shrink factor. At
+ * each level, the projections (input 1) are binned along the detector axes
+ * and the volume (input 0) along all axes with itk::BinShrinkImageFilter.
+ * The volume of the first level is initialized with the binned input volume
+ * and the following ones with the result of the previous level, linearly
+ * resampled on the grid of the level after replicating its border voxels so
+ * that the edges of the finer grid are not interpolated with zeros. The
+ * output has the information of input 0, the result of the last level being
+ * resampled if its shrink factor is not 1.
+ *
+ * The reconstruction filter of each level can be any filter taking the
+ * volume as input 0 and the projections as input 1, e.g.,
+ * rtk::SARTConeBeamReconstructionFilter or
+ * rtk::ConjugateGradientConeBeamReconstructionFilter, configured beforehand
+ * (geometry, number of iterations, etc.). The geometry is unchanged by
+ * binning since it is defined in physical coordinates. Inputs 2 and above,
+ * e.g., the weights of rtk::ConjugateGradientConeBeamReconstructionFilter,
+ * are assumed to be projection-like: they are binned as the projections and
+ * passed to the level filters with the same index. Filters with named inputs
+ * such as rtk::RegularizedConjugateGradientConeBeamReconstructionFilter are
+ * not supported.
+ *
+ * \test rtkmultiresolutiontest.cxx
+ *
+ * \ingroup ReconstructionAlgorithm
+ */
+template<class TOutputImage>
+class ITK_EXPORT MultiResolutionConeBeamReconstructionFilter :
+  public itk::ImageToImageFilter<TOutputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiResolutionConeBeamReconstructionFilter         Self;
+  typedef itk::ImageToImageFilter<TOutputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                             Pointer;
+  typedef itk::SmartPointer<const Self>                       ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TOutputImage                                                 OutputImageType;
+  typedef typename OutputImageType::Pointer                            OutputImagePointer;
+  typedef itk::ImageToImageFilter<TOutputImage, TOutputImage>          ReconstructionFilterType;
+  typedef typename ReconstructionFilterType::Pointer                   ReconstructionFilterPointer;
+  typedef itk::BinShrinkImageFilter<TOutputImage, TOutputImage>        BinShrinkFilterType;
+  typedef itk::ResampleImageFilter<TOutputImage, TOutputImage, double> ResampleFilterType;
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MultiResolutionConeBeamReconstructionFilter, itk::ImageToImageFilter);
+
+  /** Add a level reconstructed with filter on a volume and projections binned
+   * by shrinkFactor. Levels are processed in the order in which they have
+   * been added, i.e., with decreasing shrink factors. */
+  void AddLevel(unsigned int shrinkFactor, ReconstructionFilterType *filter);
+
+  /** Remove all levels. */
+  void ClearLevels();
+
+  /** Number of levels and accessors to their parameters. */
+  unsigned int GetNumberOfLevels() const {return m_ShrinkFactors.size();}
+  unsigned int GetShrinkFactor(unsigned int level) const {return m_ShrinkFactors[level];}
+  ReconstructionFilterType *GetReconstructionFilter(unsigned int level) {return m_ReconstructionFilters[level];}
+
+protected:
+  MultiResolutionConeBeamReconstructionFilter();
+  ~MultiResolutionConeBeamReconstructionFilter() {}
+
+  /** The volume and the projections do not occupy the same physical space */
+  virtual void VerifyInputInformation() {}
+
+  /** Both inputs are entirely required */
+  virtual void GenerateInputRequestedRegion();
+
+  virtual void GenerateData();
+
+  /** Bin projections along the detector axes. */
+  OutputImagePointer BinProjections(OutputImageType *projections, unsigned int factor);
+
+  /** Linear resampling of volume on the grid of reference with replicated
+   * border voxels. */
+  OutputImagePointer ResampleVolume(OutputImageType *volume, OutputImageType *reference);
+
+private:
+  MultiResolutionConeBeamReconstructionFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                              //purposely not implemented
+
+  std::vector<unsigned int>                m_ShrinkFactors;
+  std::vector<ReconstructionFilterPointer> m_ReconstructionFilters;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkMultiResolutionConeBeamReconstructionFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkMultiResolutionConeBeamReconstructionFilter_hxx
+#define __rtkMultiResolutionConeBeamReconstructionFilter_hxx
+
+#include "rtkTraceCollector.h"
+
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template<class TOutputImage>
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::MultiResolutionConeBeamReconstructionFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+}
+
+template<class TOutputImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::AddLevel(unsigned int shrinkFactor, ReconstructionFilterType *filter)
+{
+  if(shrinkFactor<1)
+    itkExceptionMacro(<< "The shrink factor of a level must be at least 1");
+  if(!filter)
+    itkExceptionMacro(<< "The reconstruction filter of a level must be set");
+  m_ShrinkFactors.push_back(shrinkFactor);
+  m_ReconstructionFilters.push_back(filter);
+  this->Modified();
+}
+
+template<class TOutputImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::ClearLevels()
+{
+  m_ShrinkFactors.clear();
+  m_ReconstructionFilters.clear();
+  this->Modified();
+}
+
+template<class TOutputImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  for(unsigned int i=0; i<this->GetNumberOfInputs(); i++)
+    {
+    OutputImageType *input = const_cast<OutputImageType *>(this->GetInput(i));
+    if(input)
+      input->SetRequestedRegionToLargestPossibleRegion();
+    }
+}
+
+template<class TOutputImage>
+typename MultiResolutionConeBeamReconstructionFilter<TOutputImage>::OutputImagePointer
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::BinProjections(OutputImageType *projections, unsigned int factor)
+{
+  if(factor==1)
+    return projections;
+
+  typename BinShrinkFilterType::Pointer bin = BinShrinkFilterType::New();
+  typename BinShrinkFilterType::ShrinkFactorsType binFactors;
+  binFactors.Fill(factor);
+  binFactors[ImageDimension-1] = 1;
+  bin->SetInput(projections);
+  bin->SetShrinkFactors(binFactors);
+  bin->Update();
+  OutputImagePointer binned = bin->GetOutput();
+  binned->DisconnectPipeline();
+  return binned;
+}
+
+template<class TOutputImage>
+typename MultiResolutionConeBeamReconstructionFilter<TOutputImage>::OutputImagePointer
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::ResampleVolume(OutputImageType *volume, OutputImageType *reference)
+{
+  // Pad the volume by one voxel replicating its border so that the linear
+  // interpolation covers the grid of the reference, which extends beyond the
+  // outer voxel centers of the volume, in particular when binning has dropped
+  // the last voxels of a dimension.
+  typename OutputImageType::RegionType region = volume->GetLargestPossibleRegion();
+  typename OutputImageType::RegionType paddedRegion = region;
+  paddedRegion.PadByRadius(1);
+
+  OutputImagePointer padded = OutputImageType::New();
+  padded->CopyInformation(volume);
+  padded->SetRegions(paddedRegion);
+  padded->Allocate();
+
+  typename OutputImageType::IndexType first = region.GetIndex();
+  typename OutputImageType::IndexType last = region.GetUpperIndex();
+  itk::ImageRegionIteratorWithIndex<OutputImageType> it(padded, paddedRegion);
+  for(it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    typename OutputImageType::IndexType idx = it.GetIndex();
+    for(unsigned int i=0; i<ImageDimension; i++)
+      idx[i] = std::min(std::max(idx[i], first[i]), last[i]);
+    it.Set(volume->GetPixel(idx));
+    }
+
+  typedef itk::LinearInterpolateImageFunction<OutputImageType, double> InterpolatorType;
+  typename ResampleFilterType::Pointer resample = ResampleFilterType::New();
+  resample->SetInput(padded);
+  resample->SetInterpolator(InterpolatorType::New());
+  resample->SetUseReferenceImage(true);
+  resample->SetReferenceImage(reference);
+  resample->Update();
+  OutputImagePointer resampled = resample->GetOutput();
+  resampled->DisconnectPipeline();
+  return resampled;
+}
+
+template<class TOutputImage>
+void
+MultiResolutionConeBeamReconstructionFilter<TOutputImage>
+::GenerateData()
+{
+  if(m_ShrinkFactors.empty())
+    itkExceptionMacro(<< "At least one level must be added");
+
+  OutputImagePointer volume = const_cast<OutputImageType *>(this->GetInput(0));
+  OutputImagePointer projections = const_cast<OutputImageType *>(this->GetInput(1));
+
+  OutputImagePointer result;
+  for(unsigned int level=0; level<m_ShrinkFactors.size(); level++)
+    {
+    TraceSpan levelSpan("Multi-resolution level", this, level);
+    const unsigned int factor = m_ShrinkFactors[level];
+    ReconstructionFilterType *filter = m_ReconstructionFilters[level];
+
+    // Projections and projection-like inputs binned along the detector axes
+    filter->SetInput(1, BinProjections(projections, factor));
+    for(unsigned int i=2; i<this->GetNumberOfInputs(); i++)
+      {
+      OutputImageType *input = const_cast<OutputImageType *>(this->GetInput(i));
+      if(input)
+        filter->SetInput(i, BinProjections(input, factor));
+      }
+
+    // Volume of the level: the binned input for the first level, otherwise
+    // the result of the previous level resampled on the binned grid
+    OutputImagePointer levelVolume = volume;
+    typename BinShrinkFilterType::Pointer binVolume = BinShrinkFilterType::New();
+    binVolume->SetInput(volume);
+    binVolume->SetShrinkFactors(factor);
+    if(level==0 && factor>1)
+      {
+      binVolume->Update();
+      levelVolume = binVolume->GetOutput();
+      levelVolume->DisconnectPipeline();
+      }
+    else if(level>0)
+      {
+      binVolume->UpdateOutputInformation();
+      levelVolume = ResampleVolume(result, (factor>1)?binVolume->GetOutput():volume.GetPointer());
+      }
+
+    filter->SetInput(0, levelVolume);
+    filter->UpdateLargestPossibleRegion();
+    result = filter->GetOutput();
+    result->DisconnectPipeline();
+    }
+
+  // Back to the grid of the input volume if the last level is binned
+  if(m_ShrinkFactors.back()>1)
+    result = ResampleVolume(result, volume);
+
+  this->GraftOutput(result);
+}
+
+} // end namespace rtk
+
+#endif
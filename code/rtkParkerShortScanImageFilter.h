@@ -75,9 +75,12 @@ public:
   itkSetMacro(Geometry, GeometryPointer);
 
 protected:
-  ParkerShortScanImageFilter(){ this->SetInPlace(true); }
+  ParkerShortScanImageFilter();
   ~ParkerShortScanImageFilter(){}
 
+  /** Computes the short scan parameters which are shared by all threads. */
+  virtual void BeforeThreadedGenerateData();
+
   virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
 
 private:
@@ -93,6 +96,13 @@ private:
   double m_InferiorCorner;
   double m_SuperiorCorner;
 
+  /** Short scan parameters computed in BeforeThreadedGenerateData from the
+   * sorted gantry angles: true if the scan is a short scan, first angle of
+   * the scan and delta as defined in [Parker, Med Phys, 1982]. */
+  bool   m_IsShortScan;
+  double m_FirstAngle;
+  double m_Delta;
+
   itk::SimpleFastMutexLock m_WarningMutex;
 }; // end of class
 
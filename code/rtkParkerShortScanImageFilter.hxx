@@ -26,29 +26,68 @@
 namespace rtk
 {
 
+template <class TInputImage, class TOutputImage>
+ParkerShortScanImageFilter<TInputImage, TOutputImage>
+::ParkerShortScanImageFilter():
+  m_IsShortScan(false),
+  m_FirstAngle(0.),
+  m_Delta(0.)
+{
+  this->SetInPlace(true);
+}
+
 template <class TInputImage, class TOutputImage>
 void
 ParkerShortScanImageFilter<TInputImage, TOutputImage>
-::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId) )
+::BeforeThreadedGenerateData()
 {
   // Get angular gaps and max gap
-  std::vector<double> angularGaps = m_Geometry->GetAngularGapsWithNext( m_Geometry->GetGantryAngles() );
+  const std::vector<double> rotationAngles = m_Geometry->GetGantryAngles();
+  std::vector<double> angularGaps = m_Geometry->GetAngularGapsWithNext( rotationAngles );
   int                 nProj = angularGaps.size();
   int                 maxAngularGapPos = 0;
   for(int iProj=1; iProj<nProj; iProj++)
     if(angularGaps[iProj] > angularGaps[maxAngularGapPos])
       maxAngularGapPos = iProj;
 
+  // Not a short scan if less than 20 degrees max gap, => nothing to do
+  // FIXME: do nothing in parallel geometry, currently handled with a trick in the geometry object
+  m_IsShortScan = !( m_Geometry->GetSourceToDetectorDistances()[0] == 0. ||
+                     angularGaps[maxAngularGapPos] < itk::Math::pi / 9 );
+  if(!m_IsShortScan)
+    return;
+
+  const std::map<double,unsigned int> sortedAngles = m_Geometry->GetUniqueSortedAngles( rotationAngles );
+
+  // Compute delta between first and last angle where there is weighting required
+  std::map<double,unsigned int>::const_iterator itLastAngle;
+  itLastAngle = sortedAngles.find(rotationAngles[maxAngularGapPos]);
+  std::map<double,unsigned int>::const_iterator itFirstAngle = itLastAngle;
+  itFirstAngle = (++itFirstAngle==sortedAngles.end())?sortedAngles.begin():itFirstAngle;
+  m_FirstAngle = itFirstAngle->first;
+  double lastAngle = itLastAngle->first;
+  if(lastAngle<m_FirstAngle)
+    {
+    lastAngle += 2*vnl_math::pi;
+    }
+  //Delta
+  m_Delta = 0.5 * (lastAngle - m_FirstAngle - vnl_math::pi);
+  m_Delta = m_Delta - 2*vnl_math::pi*floor( m_Delta / (2*vnl_math::pi) ); // between -2*PI and 2*PI
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ParkerShortScanImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId) )
+{
   // Input / ouput iterators
   itk::ImageRegionConstIterator<InputImageType> itIn(this->GetInput(), outputRegionForThread);
   itk::ImageRegionIterator<OutputImageType>     itOut(this->GetOutput(), outputRegionForThread);
   itIn.GoToBegin();
   itOut.GoToBegin();
 
-  // Not a short scan if less than 20 degrees max gap, => nothing to do
-  // FIXME: do nothing in parallel geometry, currently handled with a trick in the geometry object
-  if( m_Geometry->GetSourceToDetectorDistances()[0] == 0. ||
-      angularGaps[maxAngularGapPos] < itk::Math::pi / 9 )
+  // Not a short scan, nothing to do
+  if( !m_IsShortScan )
     {
     if(this->GetInput() != this->GetOutput() ) // If not in place, copy is
                                                // required
@@ -80,23 +119,8 @@ ParkerShortScanImageFilter<TInputImage, TOutputImage>
   weights->Allocate();
   typename itk::ImageRegionIteratorWithIndex<WeightImageType> itWeights(weights, weights->GetLargestPossibleRegion() );
 
-  const std::vector<double> rotationAngles = m_Geometry->GetGantryAngles();
-  const std::map<double,unsigned int> sortedAngles = m_Geometry->GetUniqueSortedAngles( m_Geometry->GetGantryAngles() );
-
-  // Compute delta between first and last angle where there is weighting required
-  std::map<double,unsigned int>::const_iterator itLastAngle;
-  itLastAngle = sortedAngles.find(rotationAngles[maxAngularGapPos]);
-  std::map<double,unsigned int>::const_iterator itFirstAngle = itLastAngle;
-  itFirstAngle = (++itFirstAngle==sortedAngles.end())?sortedAngles.begin():itFirstAngle;
-  const double firstAngle = itFirstAngle->first;
-  double lastAngle = itLastAngle->first;
-  if(lastAngle<firstAngle)
-    {
-    lastAngle += 2*vnl_math::pi;
-    }
-  //Delta
-  double delta = 0.5 * (lastAngle - firstAngle - vnl_math::pi);
-  delta = delta - 2*vnl_math::pi*floor( delta / (2*vnl_math::pi) ); // between -2*PI and 2*PI
+  const std::vector<double> &rotationAngles = m_Geometry->GetGantryAngles();
+  const double delta = m_Delta;
 
   // Pre-compute the two corners of the projection images
   typename TInputImage::IndexType id = this->GetInput()->GetLargestPossibleRegion().GetIndex();
@@ -135,7 +159,7 @@ ParkerShortScanImageFilter<TInputImage, TOutputImage>
     // Parker's article assumes that the scan starts at 0, convert projection
     // angle accordingly
     double beta = rotationAngles[ itIn.GetIndex()[2] ];
-    beta = beta - firstAngle;
+    beta = beta - m_FirstAngle;
     if (beta<0)
       beta += 2*vnl_math::pi;
 
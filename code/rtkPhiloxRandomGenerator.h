@@ -0,0 +1,179 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkPhiloxRandomGenerator_h
+#define __rtkPhiloxRandomGenerator_h
+
+#include <itkIntTypes.h>
+#include <vnl/vnl_math.h>
+#include <vnl/vnl_gamma.h>
+
+namespace rtk
+{
+
+/** \class PhiloxRandomGenerator
+ * \brief Counter-based random number generator Philox4x32-10.
+ *
+ * The generator of [Salmon et al, SC'11] computes random numbers as a
+ * bijection of a counter, parametrized by a key, with 10 rounds of 32-bit
+ * multiplications and xors. It has no state besides its counter: the n-th
+ * number of stream s for key k is always the same, whatever has been drawn
+ * before. Image filters therefore construct a generator for each pixel with
+ * the seed as key and the linear index of the pixel as stream, so that the
+ * noise of a pixel does not depend on the thread or the streaming division
+ * which processes it, nor on the order of the pixels.
+ *
+ * Uniform, normal (Box-Muller) and Poisson variates are drawn from the
+ * stream. Poisson variates are computed by inversion for small means and
+ * with the transformed rejection method PTRS of [Hormann, 1993] otherwise.
+ *
+ * \test rtkprojectionnoisetest.cxx
+ *
+ * \ingroup Functions
+ */
+class PhiloxRandomGenerator
+{
+public:
+  PhiloxRandomGenerator(itk::uint64_t seed, itk::uint64_t stream):
+    m_Position(4),
+    m_HasNormalVariate(false)
+    {
+    m_Key[0] = static_cast<itk::uint32_t>(seed);
+    m_Key[1] = static_cast<itk::uint32_t>(seed >> 32);
+    m_Counter[0] = static_cast<itk::uint32_t>(stream);
+    m_Counter[1] = static_cast<itk::uint32_t>(stream >> 32);
+    m_Counter[2] = 0;
+    m_Counter[3] = 0;
+    }
+
+  /** Next 32 random bits of the stream */
+  itk::uint32_t GetIntegerVariate()
+    {
+    if(m_Position == 4)
+      {
+      Generate(m_Key, m_Counter, m_Output);
+      m_Counter[2]++;
+      m_Position = 0;
+      }
+    return m_Output[m_Position++];
+    }
+
+  /** Uniform variate in ]0,1[ */
+  double GetUniformVariate()
+    {
+    return ( GetIntegerVariate() + 0.5 ) * ( 1. / 4294967296. );
+    }
+
+  /** Standard normal variate, drawn in pairs with the Box-Muller transform */
+  double GetNormalVariate()
+    {
+    if(m_HasNormalVariate)
+      {
+      m_HasNormalVariate = false;
+      return m_NormalVariate;
+      }
+    const double r = vcl_sqrt( -2. * vcl_log( GetUniformVariate() ) );
+    const double theta = 2. * vnl_math::pi * GetUniformVariate();
+    m_NormalVariate = r * vcl_sin(theta);
+    m_HasNormalVariate = true;
+    return r * vcl_cos(theta);
+    }
+
+  /** Poisson variate of mean lambda */
+  double GetPoissonVariate(double lambda)
+    {
+    if( !(lambda > 0.) )
+      return 0.;
+
+    // Inversion: one uniform variate and about lambda iterations
+    if(lambda < 10.)
+      {
+      const double u = GetUniformVariate();
+      double p = vcl_exp(-lambda);
+      double cdf = p;
+      unsigned int k = 0;
+      while(u > cdf && p > 0.)
+        {
+        k++;
+        p *= lambda / k;
+        cdf += p;
+        }
+      return k;
+      }
+
+    // PTRS: 2 uniform variates per trial, 1.1 trials on average
+    const double slam = vcl_sqrt(lambda);
+    const double loglam = vcl_log(lambda);
+    const double b = 0.931 + 2.53 * slam;
+    const double a = -0.059 + 0.02483 * b;
+    const double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+    const double vr = 0.9277 - 3.6224 / (b - 2.);
+    for(;;)
+      {
+      const double u = GetUniformVariate() - 0.5;
+      const double v = GetUniformVariate();
+      const double us = 0.5 - vcl_fabs(u);
+      const double k = vcl_floor( (2. * a / us + b) * u + lambda + 0.43 );
+      if(us >= 0.07 && v <= vr)
+        return k;
+      if(k < 0. || (us < 0.013 && v > us) )
+        continue;
+      if( vcl_log(v) + vcl_log(invalpha) - vcl_log( a / (us * us) + b ) <=
+          -lambda + k * loglam - vnl_log_gamma(k + 1.) )
+        return k;
+      }
+    }
+
+  /** Philox4x32-10 bijection of counter for key */
+  static void Generate(const itk::uint32_t key[2], const itk::uint32_t counter[4], itk::uint32_t output[4])
+    {
+    itk::uint32_t k0 = key[0];
+    itk::uint32_t k1 = key[1];
+    itk::uint32_t c0 = counter[0];
+    itk::uint32_t c1 = counter[1];
+    itk::uint32_t c2 = counter[2];
+    itk::uint32_t c3 = counter[3];
+    for(unsigned int round=0; round<10; round++)
+      {
+      const itk::uint64_t p0 = static_cast<itk::uint64_t>(0xD2511F53) * c0;
+      const itk::uint64_t p1 = static_cast<itk::uint64_t>(0xCD9E8D57) * c2;
+      c0 = static_cast<itk::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+      c2 = static_cast<itk::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+      c1 = static_cast<itk::uint32_t>(p1);
+      c3 = static_cast<itk::uint32_t>(p0);
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+      }
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+    }
+
+private:
+  itk::uint32_t m_Key[2];
+  itk::uint32_t m_Counter[4];
+  itk::uint32_t m_Output[4];
+  unsigned int  m_Position;
+  double        m_NormalVariate;
+  bool          m_HasNormalVariate;
+};
+
+} // end namespace rtk
+
+#endif
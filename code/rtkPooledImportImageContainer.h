@@ -0,0 +1,99 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkPooledImportImageContainer_h
+#define __rtkPooledImportImageContainer_h
+
+#include <itkImportImageContainer.h>
+
+#include "rtkImageBufferPool.h"
+
+namespace rtk
+{
+
+/** \class PooledImportImageContainer
+ * \brief Pixel container of images whose buffer is allocated from the
+ * rtk::ImageBufferPool.
+ *
+ * The container is a drop-in replacement of itk::ImportImageContainer,
+ * created instead of the latter by the object factory registered by
+ * ImageBufferPool::SetEnabled. Buffers smaller than the minimum size of the
+ * pool and imported buffers are managed as in itk::ImportImageContainer.
+ * The container keeps a reference to the pool of its buffers so that they
+ * can be given back even during the destruction of static objects.
+ *
+ * \test rtkimagebufferpooltest.cxx
+ *
+ * \ingroup ImageObjects
+ */
+template< typename TElementIdentifier, typename TElement >
+class PooledImportImageContainer:
+  public itk::ImportImageContainer< TElementIdentifier, TElement >
+{
+public:
+  /** Standard class typedefs. */
+  typedef PooledImportImageContainer                                Self;
+  typedef itk::ImportImageContainer< TElementIdentifier, TElement > Superclass;
+  typedef itk::SmartPointer< Self >                                 Pointer;
+  typedef itk::SmartPointer< const Self >                           ConstPointer;
+
+  typedef TElementIdentifier ElementIdentifier;
+  typedef TElement           Element;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Standard part of every itk Object. */
+  itkTypeMacro(PooledImportImageContainer, ImportImageContainer);
+
+protected:
+  PooledImportImageContainer() {}
+
+  /** The destructor of the superclass would not call the overridden
+   * DeallocateManagedMemory */
+  ~PooledImportImageContainer()
+    {
+    this->DeallocateManagedMemory();
+    }
+
+#if ITK_VERSION_MAJOR > 4 || (ITK_VERSION_MAJOR == 4 && ITK_VERSION_MINOR >= 4)
+  virtual TElement * AllocateElements(ElementIdentifier size, bool UseDefaultConstructor = false) const ITK_OVERRIDE;
+#else
+  virtual TElement * AllocateElements(ElementIdentifier size) const ITK_OVERRIDE;
+#endif
+
+  virtual void DeallocateManagedMemory() ITK_OVERRIDE;
+
+  /** Allocate bytes from the pool, zeroed if zero is true */
+  TElement * AllocatePooledElements(ElementIdentifier size, bool zero) const;
+
+private:
+  PooledImportImageContainer(const Self &); //purposely not implemented
+  void operator=(const Self &);             //purposely not implemented
+
+  /** Pool of the buffers allocated by the container, if any */
+  mutable ImageBufferPool::Pointer m_Pool;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkPooledImportImageContainer.hxx"
+#endif
+
+#endif
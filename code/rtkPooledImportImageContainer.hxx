@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkPooledImportImageContainer_hxx
+#define __rtkPooledImportImageContainer_hxx
+
+#include "rtkPooledImportImageContainer.h"
+
+#include <new>
+#include <cstring>
+
+namespace rtk
+{
+
+#if ITK_VERSION_MAJOR > 4 || (ITK_VERSION_MAJOR == 4 && ITK_VERSION_MINOR >= 4)
+template< typename TElementIdentifier, typename TElement >
+TElement *
+PooledImportImageContainer< TElementIdentifier, TElement >
+::AllocateElements(ElementIdentifier size, bool UseDefaultConstructor) const
+{
+  if( size * sizeof(TElement) < ImageBufferPool::GetInstance()->GetMinimumBufferSize() )
+    return Superclass::AllocateElements(size, UseDefaultConstructor);
+  return this->AllocatePooledElements(size, UseDefaultConstructor);
+}
+#else
+template< typename TElementIdentifier, typename TElement >
+TElement *
+PooledImportImageContainer< TElementIdentifier, TElement >
+::AllocateElements(ElementIdentifier size) const
+{
+  if( size * sizeof(TElement) < ImageBufferPool::GetInstance()->GetMinimumBufferSize() )
+    return Superclass::AllocateElements(size);
+  return this->AllocatePooledElements(size, false);
+}
+#endif
+
+template< typename TElementIdentifier, typename TElement >
+TElement *
+PooledImportImageContainer< TElementIdentifier, TElement >
+::AllocatePooledElements(ElementIdentifier size, bool zero) const
+{
+  const size_t bytes = size * sizeof(TElement);
+  m_Pool = ImageBufferPool::GetInstance();
+
+  TElement *data;
+  try
+    {
+    data = static_cast<TElement *>( m_Pool->Allocate(bytes) );
+    }
+  catch ( std::bad_alloc & )
+    {
+    // Same exception as itk::ImportImageContainer
+    itk::MemoryAllocationError e(__FILE__, __LINE__, "Failed to allocate memory for image.", ITK_LOCATION);
+    throw e;
+    }
+
+  // Reused buffers contain the pixels of a previous image. They are zeroed
+  // in parallel only if the first touch is parallel, as new buffers are.
+  if(zero)
+    {
+    if( m_Pool->GetParallelFirstTouch() )
+      ImageBufferPool::Zero(data, bytes);
+    else
+      std::memset(data, 0, bytes);
+    }
+  return data;
+}
+
+template< typename TElementIdentifier, typename TElement >
+void
+PooledImportImageContainer< TElementIdentifier, TElement >
+::DeallocateManagedMemory()
+{
+  // The pool is not accessed with GetInstance which could create a new one
+  // during the destruction of static objects
+  if( this->GetContainerManageMemory() &&
+      this->GetImportPointer() &&
+      m_Pool.IsNotNull() &&
+      m_Pool->Release( this->GetImportPointer() ) )
+    {
+    // The buffer is back in the pool, only reset the pointer and the sizes
+    this->SetContainerManageMemory(false);
+    Superclass::DeallocateManagedMemory();
+    this->SetContainerManageMemory(true);
+    }
+  else
+    Superclass::DeallocateManagedMemory();
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,134 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkProjectionNoiseImageFilter_h
+#define __rtkProjectionNoiseImageFilter_h
+
+#include <itkInPlaceImageFilter.h>
+
+#include "rtkPhiloxRandomGenerator.h"
+
+namespace rtk
+{
+
+/** \class ProjectionNoiseImageFilter
+ * \brief Adds Gaussian, Poisson or Poisson-Gaussian noise to simulated
+ * projections.
+ *
+ * The noise of each pixel is drawn from a rtk::PhiloxRandomGenerator whose
+ * key is the Seed and whose stream is the linear index of the pixel in the
+ * largest possible region. Unlike rtk::AdditiveGaussianNoiseImageFilter, the
+ * filter is therefore multithreaded and its output only depends on the Seed,
+ * whatever the number of threads and of streaming divisions.
+ *
+ * The NoiseModel is one of:
+ * - GAUSSIAN: \f$v_{out} = v_{in} + \bar{x} + \sigma G\f$ with the Mean
+ *   \f$\bar{x}\f$ and the StandardDeviation \f$\sigma\f$,
+ * - POISSON: photon counts \f$N = P(I_0 e^{-v_{in}})\f$ with I0 photons per
+ *   pixel of the unattenuated beam,
+ * - POISSONGAUSSIAN: \f$N = P(I_0 e^{-v_{in}}) + \bar{x} + \sigma G\f$, i.e.,
+ *   quantum noise and Gaussian electronic noise whose Mean and
+ *   StandardDeviation are in photons.
+ *
+ * If LineIntegral is on (default), the input and the output are line
+ * integrals and the output is \f$\ln(I_0/N)\f$, counts below one photon being
+ * set to one photon. Otherwise, the input is the expected number of photons
+ * \f$I_0 e^{-v_{in}}\f$ and the output is N.
+ *
+ * \test rtkprojectionnoisetest.cxx
+ *
+ * \ingroup InPlaceImageFilter
+ */
+template<class TInputImage, class TOutputImage=TInputImage>
+class ITK_EXPORT ProjectionNoiseImageFilter :
+  public itk::InPlaceImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ProjectionNoiseImageFilter                         Self;
+  typedef itk::InPlaceImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                                  InputImageType;
+  typedef TOutputImage                                 OutputImageType;
+  typedef typename OutputImageType::RegionType         OutputImageRegionType;
+  typedef typename OutputImageType::PixelType          OutputPixelType;
+
+  typedef enum {GAUSSIAN=0, POISSON, POISSONGAUSSIAN} NoiseModelType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ProjectionNoiseImageFilter, itk::InPlaceImageFilter);
+
+  /** Get / Set the noise model. Default is GAUSSIAN. */
+  itkGetMacro(NoiseModel, NoiseModelType);
+  itkSetMacro(NoiseModel, NoiseModelType);
+
+  /** Get / Set the seed of the noise. Default is 0. */
+  itkGetMacro(Seed, itk::uint64_t);
+  itkSetMacro(Seed, itk::uint64_t);
+
+  /** Get / Set the mean and the standard deviation of the Gaussian noise,
+   * in photons for POISSONGAUSSIAN. Defaults are 0 and 1. */
+  itkGetMacro(Mean, double);
+  itkSetMacro(Mean, double);
+  itkGetMacro(StandardDeviation, double);
+  itkSetMacro(StandardDeviation, double);
+
+  /** Get / Set the number of photons per pixel of the unattenuated beam of
+   * the Poisson models. Default is 10000. */
+  itkGetMacro(I0, double);
+  itkSetMacro(I0, double);
+
+  /** Get / Set whether the input and the output of the Poisson models are
+   * line integrals or numbers of photons. Default is on. */
+  itkGetMacro(LineIntegral, bool);
+  itkSetMacro(LineIntegral, bool);
+  itkBooleanMacro(LineIntegral);
+
+protected:
+  ProjectionNoiseImageFilter();
+  ~ProjectionNoiseImageFilter() {}
+
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId);
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  ProjectionNoiseImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);             //purposely not implemented
+
+  NoiseModelType m_NoiseModel;
+  itk::uint64_t  m_Seed;
+  double         m_Mean;
+  double         m_StandardDeviation;
+  double         m_I0;
+  bool           m_LineIntegral;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkProjectionNoiseImageFilter.hxx"
+#endif
+
+#endif
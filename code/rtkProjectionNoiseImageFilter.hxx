@@ -0,0 +1,96 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkProjectionNoiseImageFilter_hxx
+#define __rtkProjectionNoiseImageFilter_hxx
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+ProjectionNoiseImageFilter<TInputImage, TOutputImage>
+::ProjectionNoiseImageFilter():
+  m_NoiseModel(GAUSSIAN),
+  m_Seed(0),
+  m_Mean(0.),
+  m_StandardDeviation(1.),
+  m_I0(1e4),
+  m_LineIntegral(true)
+{
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ProjectionNoiseImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId))
+{
+  const unsigned int Dimension = TOutputImage::ImageDimension;
+  const OutputImageRegionType largest = this->GetOutput()->GetLargestPossibleRegion();
+
+  typedef itk::ImageRegionConstIteratorWithIndex<InputImageType> InputIteratorType;
+  InputIteratorType itIn(this->GetInput(), outputRegionForThread);
+  typedef itk::ImageRegionIterator<OutputImageType> OutputIteratorType;
+  OutputIteratorType itOut(this->GetOutput(), outputRegionForThread);
+
+  const double logI0 = vcl_log(m_I0);
+  for(; !itOut.IsAtEnd(); ++itIn, ++itOut)
+    {
+    // The stream of the pixel is its linear index in the largest possible
+    // region, independent of the region of the thread
+    const typename InputImageType::IndexType index = itIn.GetIndex();
+    itk::uint64_t stream = 0;
+    for(int d=Dimension-1; d>=0; d--)
+      stream = stream * largest.GetSize(d) + ( index[d] - largest.GetIndex(d) );
+    PhiloxRandomGenerator generator(m_Seed, stream);
+
+    const double in = itIn.Get();
+    if(m_NoiseModel == GAUSSIAN)
+      {
+      itOut.Set( in + m_Mean + m_StandardDeviation * generator.GetNormalVariate() );
+      continue;
+      }
+
+    double counts = generator.GetPoissonVariate( (m_LineIntegral)?m_I0*vcl_exp(-in):in );
+    if(m_NoiseModel == POISSONGAUSSIAN)
+      counts += m_Mean + m_StandardDeviation * generator.GetNormalVariate();
+    if(m_LineIntegral)
+      itOut.Set( logI0 - vcl_log( vnl_math_max(counts, 1.) ) );
+    else
+      itOut.Set( counts );
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ProjectionNoiseImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NoiseModel: " << m_NoiseModel << std::endl
+     << indent << "Seed: " << m_Seed << std::endl
+     << indent << "Mean: " << m_Mean << std::endl
+     << indent << "StandardDeviation: " << m_StandardDeviation << std::endl
+     << indent << "I0: " << m_I0 << std::endl
+     << indent << "LineIntegral: " << m_LineIntegral << std::endl;
+}
+
+} // end namespace rtk
+#endif
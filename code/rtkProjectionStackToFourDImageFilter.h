@@ -26,6 +26,7 @@
 #include "rtkConstantImageSource.h"
 #include "rtkThreeDCircularProjectionGeometry.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkThreadPoolImageFilter.h"
 
 #ifdef RTK_USE_CUDA
   #include "rtkCudaSplatImageFilter.h"
@@ -64,6 +65,11 @@ namespace rtk
    *
    * ProjectionStackToFourDImageFilter implements S_theta^T R_theta^T.
    *
+   * The projection stack can be stored with a lower precision than the
+   * projections processed by the back projection filter, e.g. with rtk::Half
+   * pixels, by setting StoredProjectionStackType. Each projection is converted
+   * to ProjectionStackType when it is extracted from the stack.
+   *
    * \dot
    * digraph ProjectionStackToFourDImageFilter {
    *
@@ -105,7 +111,9 @@ namespace rtk
    * \ingroup ReconstructionAlgorithm
    */
 
-template< typename VolumeSeriesType, typename ProjectionStackType >
+template< typename VolumeSeriesType,
+          typename ProjectionStackType,
+          typename StoredProjectionStackType=ProjectionStackType >
 class ProjectionStackToFourDImageFilter : public itk::ImageToImageFilter< VolumeSeriesType, VolumeSeriesType >
 {
 public:
@@ -128,10 +136,10 @@ public:
 
     /** The image that will be backprojected, then added, with coefficients, to each 3D volume of the 4D image.
     * It is 3D because the backprojection filters need it, but the third dimension, which is the number of projections, is 1  */
-    void SetInputProjectionStack(const ProjectionStackType* Projection);
+    void SetInputProjectionStack(const StoredProjectionStackType* Projection);
 
     typedef rtk::BackProjectionImageFilter< VolumeType, VolumeType >              BackProjectionFilterType;
-    typedef itk::ExtractImageFilter< ProjectionStackType, ProjectionStackType >   ExtractFilterType;
+    typedef itk::ExtractImageFilter< StoredProjectionStackType, ProjectionStackType > ExtractFilterType;
     typedef rtk::ConstantImageSource< VolumeType >                                ConstantVolumeSourceType;
     typedef rtk::ConstantImageSource< VolumeSeriesType >                          ConstantVolumeSeriesSourceType;
     typedef rtk::SplatWithKnownWeightsImageFilter<VolumeSeriesType, VolumeType>   SplatFilterType;
@@ -161,7 +169,7 @@ protected:
     ~ProjectionStackToFourDImageFilter(){}
 
     typename VolumeSeriesType::ConstPointer GetInputVolumeSeries();
-    typename ProjectionStackType::ConstPointer GetInputProjectionStack();
+    typename StoredProjectionStackType::ConstPointer GetInputProjectionStack();
 
     /** Does the real work. */
     virtual void GenerateData();
@@ -27,8 +27,8 @@
 namespace rtk
 {
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::ProjectionStackToFourDImageFilter()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::ProjectionStackToFourDImageFilter()
 {
   this->SetNumberOfRequiredInputs(2);
 
@@ -40,62 +40,62 @@ ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::Projec
   m_ExtractFilter = ExtractFilterType::New();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-void ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+void ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputVolumeSeries(const VolumeSeriesType* VolumeSeries)
 {
   this->SetNthInput(0, const_cast<VolumeSeriesType*>(VolumeSeries));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-void ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::SetInputProjectionStack(const ProjectionStackType* Projection)
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+void ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::SetInputProjectionStack(const StoredProjectionStackType* Projection)
 {
-  this->SetNthInput(1, const_cast<ProjectionStackType*>(Projection));
+  this->SetNthInput(1, const_cast<StoredProjectionStackType*>(Projection));
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename VolumeSeriesType::ConstPointer ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::GetInputVolumeSeries()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename VolumeSeriesType::ConstPointer ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputVolumeSeries()
 {
   return static_cast< const VolumeSeriesType * >
           ( this->itk::ProcessObject::GetInput(0) );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename ProjectionStackType::ConstPointer ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::GetInputProjectionStack()
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename StoredProjectionStackType::ConstPointer ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::GetInputProjectionStack()
 {
-  return static_cast< const ProjectionStackType * >
+  return static_cast< const StoredProjectionStackType * >
           ( this->itk::ProcessObject::GetInput(1) );
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetBackProjectionFilter (const typename BackProjectionFilterType::Pointer _arg)
 {
   m_BackProjectionFilter = _arg;
   this->Modified();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
-typename ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>::BackProjectionFilterType*
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
+typename ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>::BackProjectionFilterType*
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GetBackProjectionFilter ()
 {
   return(m_BackProjectionFilter.GetPointer());
 }
 
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::SetGeometry(const ThreeDCircularProjectionGeometry::Pointer _arg)
 {
   m_Geometry = _arg;
   this->Modified();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::InitializeConstantSource()
 {
   unsigned int Dimension = 3;
@@ -130,13 +130,13 @@ ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
   m_ConstantVolumeSeriesSource->ReleaseDataFlagOn();
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateOutputInformation()
 {
   // Create and set the splat filter
-  m_SplatFilter = SplatFilterType::New();
+  m_SplatFilter = ThreadPoolImageFilter<SplatFilterType>::New();
 #ifdef RTK_USE_CUDA
   if (m_UseCudaSplat)
     m_SplatFilter = rtk::CudaSplatImageFilter::New();
@@ -196,9 +196,9 @@ ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
   this->GetOutput()->CopyInformation(m_SplatFilter->GetOutput());
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateInputRequestedRegion()
 {
   // The 4D input volume need not be loaded in memory, is it only used to configure the
@@ -211,15 +211,15 @@ ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
   this->GetBackProjectionFilter()->PropagateRequestedRegion(this->GetBackProjectionFilter()->GetOutput());
 }
 
-template< typename VolumeSeriesType, typename ProjectionStackType>
+template< typename VolumeSeriesType, typename ProjectionStackType, typename StoredProjectionStackType>
 void
-ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType>
+ProjectionStackToFourDImageFilter<VolumeSeriesType, ProjectionStackType, StoredProjectionStackType>
 ::GenerateData()
 {
   int Dimension = ProjectionStackType::ImageDimension;
 
   // Set the Extract filter
-  typename ProjectionStackType::RegionType extractRegion;
+  typename StoredProjectionStackType::RegionType extractRegion;
   extractRegion = this->GetInputProjectionStack()->GetLargestPossibleRegion();
   extractRegion.SetSize(Dimension-1, 1);
 
@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkProjectionsCacheImageFilter_h
+#define __rtkProjectionsCacheImageFilter_h
+
+#include <itkImageToImageFilter.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class ProjectionsCacheImageFilter
+ * \brief Serves projections of its input through a least recently used cache.
+ *
+ * The filter requests at most one projection from its input when the
+ * pipeline is updated. Instead, each projection of the requested region is
+ * taken from a cache of at most CacheSize projections. A missing projection
+ * is requested alone from the input, e.g., a rtk::ProjectionsReader which then
+ * only reads and preprocesses the corresponding file, and the least recently
+ * used projection is evicted if the cache is full. The input keeps the last
+ * projection it has produced.
+ *
+ * It is meant to be inserted between the projections reader and an iterative
+ * reconstruction filter which extracts one projection (or a subset) at a time,
+ * e.g., rtk::SARTConeBeamReconstructionFilter, so that the memory used by the
+ * projections is bounded even if the acquisition does not fit in RAM. The
+ * cache is emptied when the input pipeline is modified. Hits and misses are
+ * counted by the filter and also reported with rtk::GlobalTimer when RTK is
+ * compiled with RTK_TIME_EACH_FILTER.
+ *
+ * \test rtkprojectionscachetest.cxx
+ *
+ * \ingroup ImageToImageFilter
+ */
+template<class TImage>
+class ITK_EXPORT ProjectionsCacheImageFilter :
+  public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ProjectionsCacheImageFilter                   Self;
+  typedef itk::ImageToImageFilter<TImage, TImage>       Superclass;
+  typedef itk::SmartPointer<Self>                       Pointer;
+  typedef itk::SmartPointer<const Self>                 ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                                        ImageType;
+  typedef typename ImageType::RegionType                RegionType;
+  typedef typename ImageType::PixelType                 PixelType;
+  typedef std::vector<PixelType>                        ProjectionBufferType;
+
+  /** ImageDimension constant */
+  itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ProjectionsCacheImageFilter, itk::ImageToImageFilter);
+
+  /** Get / Set the maximum number of projections in the cache. Default is 32. */
+  itkGetMacro(CacheSize, unsigned int);
+  itkSetMacro(CacheSize, unsigned int);
+
+  /** Get the number of projections served from the cache and read from the
+   * input since the creation of the filter. */
+  itkGetConstMacro(NumberOfHits, itk::SizeValueType);
+  itkGetConstMacro(NumberOfMisses, itk::SizeValueType);
+
+  /** Get the ratio of projections served from the cache. */
+  double GetHitRate() const;
+
+  /** Get the number of projections currently in the cache. */
+  unsigned int GetNumberOfCachedProjections() const { return m_Cache.size(); }
+
+  /** Empty the cache. */
+  void ClearCache();
+
+protected:
+  ProjectionsCacheImageFilter();
+  ~ProjectionsCacheImageFilter() {}
+
+  /** Empty the cache if the input pipeline has been modified. */
+  virtual void GenerateOutputInformation();
+
+  /** Request the projections held by the input, or the first requested
+   * projection if the input holds none, so that the pipeline reads at most
+   * one projection. Projections are requested one by one in GenerateData. */
+  virtual void GenerateInputRequestedRegion();
+
+  virtual void GenerateData();
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+  /** Get the buffer of a projection, from the cache if it is there or from the
+   * input otherwise. */
+  const ProjectionBufferType &GetProjection(const int index);
+
+private:
+  ProjectionsCacheImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);              //purposely not implemented
+
+  /** Indices of the cached projections, most recently used first */
+  typedef std::list<int> UsageListType;
+  struct CacheEntry
+    {
+    ProjectionBufferType             Buffer;
+    typename UsageListType::iterator Usage;
+    };
+  typedef std::map<int, CacheEntry> CacheType;
+
+  unsigned int       m_CacheSize;
+  CacheType          m_Cache;
+  UsageListType      m_Usage;
+  itk::SizeValueType m_NumberOfHits;
+  itk::SizeValueType m_NumberOfMisses;
+
+  /** Information of the input when the cache was filled */
+  unsigned long                    m_InputPipelineMTime;
+  RegionType                       m_InputLargestPossibleRegion;
+}; // end of class
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkProjectionsCacheImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkProjectionsCacheImageFilter_hxx
+#define __rtkProjectionsCacheImageFilter_hxx
+
+#include "rtkConfiguration.h"
+#ifdef RTK_TIME_EACH_FILTER
+# include "rtkGlobalTimer.h"
+#endif
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <algorithm>
+
+namespace rtk
+{
+
+template <class TImage>
+ProjectionsCacheImageFilter<TImage>
+::ProjectionsCacheImageFilter():
+  m_CacheSize(32),
+  m_NumberOfHits(0),
+  m_NumberOfMisses(0),
+  m_InputPipelineMTime(0)
+{
+}
+
+template <class TImage>
+double
+ProjectionsCacheImageFilter<TImage>
+::GetHitRate() const
+{
+  const itk::SizeValueType total = m_NumberOfHits + m_NumberOfMisses;
+  return (total)?double(m_NumberOfHits)/total:0.;
+}
+
+template <class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::ClearCache()
+{
+  m_Cache.clear();
+  m_Usage.clear();
+}
+
+template <class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const ImageType *input = this->GetInput();
+  if( input->GetPipelineMTime() != m_InputPipelineMTime ||
+      input->GetLargestPossibleRegion() != m_InputLargestPossibleRegion )
+    {
+    this->ClearCache();
+    m_InputPipelineMTime = input->GetPipelineMTime();
+    m_InputLargestPossibleRegion = input->GetLargestPossibleRegion();
+    }
+}
+
+template <class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::GenerateInputRequestedRegion()
+{
+  ImageType *input = const_cast<ImageType *>( this->GetInput() );
+  if( !input )
+    return;
+
+  // An empty region would be replaced by the largest possible region in
+  // ImageBase::UpdateOutputInformation, i.e., the whole stack would be read.
+  // The projections already held by the input are requested so that the
+  // input is not updated, one projection otherwise.
+  const RegionType largestRegion = input->GetLargestPossibleRegion();
+  RegionType region = input->GetBufferedRegion();
+  if( region.GetNumberOfPixels() == 0 || !largestRegion.IsInside(region) )
+    {
+    const int first = largestRegion.GetIndex(ImageDimension-1);
+    const int last = first + (int)largestRegion.GetSize(ImageDimension-1) - 1;
+    const int requested = this->GetOutput()->GetRequestedRegion().GetIndex(ImageDimension-1);
+    region = largestRegion;
+    region.SetIndex(ImageDimension-1, std::min(last, std::max(first, requested) ) );
+    region.SetSize(ImageDimension-1, 1);
+    }
+  input->SetRequestedRegion(region);
+}
+
+template <class TImage>
+const typename ProjectionsCacheImageFilter<TImage>::ProjectionBufferType &
+ProjectionsCacheImageFilter<TImage>
+::GetProjection(const int index)
+{
+  typename CacheType::iterator it = m_Cache.find(index);
+#ifdef RTK_TIME_EACH_FILTER
+  GlobalTimer::GetInstance()->CountCacheAccess(this->GetNameOfClass(), it != m_Cache.end());
+#endif
+  if( it != m_Cache.end() )
+    {
+    // Move to the front of the usage list
+    m_NumberOfHits++;
+    m_Usage.splice(m_Usage.begin(), m_Usage, it->second.Usage);
+    return it->second.Buffer;
+    }
+  m_NumberOfMisses++;
+
+  // Evict the least recently used projections
+  while( !m_Usage.empty() && m_Cache.size() >= std::max(m_CacheSize, 1U) )
+    {
+    m_Cache.erase( m_Usage.back() );
+    m_Usage.pop_back();
+    }
+
+  // Request the projection alone from the input
+  ImageType *input = const_cast<ImageType *>( this->GetInput() );
+  RegionType region = m_InputLargestPossibleRegion;
+  region.SetIndex(ImageDimension-1, index);
+  region.SetSize(ImageDimension-1, 1);
+  input->SetRequestedRegion(region);
+  input->Update();
+
+  m_Usage.push_front(index);
+  CacheEntry &entry = m_Cache[index];
+  entry.Usage = m_Usage.begin();
+  entry.Buffer.resize( region.GetNumberOfPixels() );
+  itk::ImageRegionConstIterator<ImageType> itIn(input, region);
+  typename ProjectionBufferType::iterator itBuffer = entry.Buffer.begin();
+  for(itIn.GoToBegin(); !itIn.IsAtEnd(); ++itIn, ++itBuffer)
+    *itBuffer = itIn.Get();
+
+  return entry.Buffer;
+}
+
+template <class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::GenerateData()
+{
+  ImageType *output = this->GetOutput();
+  output->SetBufferedRegion( output->GetRequestedRegion() );
+  output->Allocate();
+
+  const RegionType outputRegion = output->GetRequestedRegion();
+
+  // Offsets of the cached projections, which cover the largest possible
+  // region of the input in all but the last dimension
+  itk::OffsetValueType strides[ImageDimension];
+  strides[0] = 1;
+  for(unsigned int i=1; i<ImageDimension; i++)
+    strides[i] = strides[i-1] * m_InputLargestPossibleRegion.GetSize(i-1);
+
+  const int firstProjection = outputRegion.GetIndex(ImageDimension-1);
+  const int lastProjection = firstProjection + (int)outputRegion.GetSize(ImageDimension-1);
+  for(int k=firstProjection; k<lastProjection; k++)
+    {
+    const ProjectionBufferType &buffer = this->GetProjection(k);
+
+    RegionType projectionRegion = outputRegion;
+    projectionRegion.SetIndex(ImageDimension-1, k);
+    projectionRegion.SetSize(ImageDimension-1, 1);
+    itk::ImageRegionIteratorWithIndex<ImageType> itOut(output, projectionRegion);
+    for(itOut.GoToBegin(); !itOut.IsAtEnd(); ++itOut)
+      {
+      itk::OffsetValueType offset = 0;
+      for(unsigned int i=0; i<ImageDimension-1; i++)
+        offset += (itOut.GetIndex()[i] - m_InputLargestPossibleRegion.GetIndex(i)) * strides[i];
+      itOut.Set( buffer[offset] );
+      }
+    }
+}
+
+template <class TImage>
+void
+ProjectionsCacheImageFilter<TImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "CacheSize: " << m_CacheSize << std::endl
+     << indent << "NumberOfCachedProjections: " << m_Cache.size() << std::endl
+     << indent << "NumberOfHits: " << m_NumberOfHits << std::endl
+     << indent << "NumberOfMisses: " << m_NumberOfMisses << std::endl;
+}
+
+} // end namespace rtk
+
+#endif
@@ -36,6 +36,8 @@ RayCastInterpolatorForwardProjectionImageFilter<TInputImage,TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType itkNotUsed(threadId) )
 {
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
   const unsigned int Dimension = TInputImage::ImageDimension;
   const unsigned int nPixelPerProj = outputRegionForThread.GetSize(0)*outputRegionForThread.GetSize(1);
   const typename Superclass::GeometryPointer geometry = this->GetGeometry();
@@ -49,7 +51,7 @@ RayCastInterpolatorForwardProjectionImageFilter<TInputImage,TOutputImage>
 
   // Iterators on volume input and output
   typedef itk::ImageRegionConstIterator<TInputImage> InputRegionIterator;
-  InputRegionIterator itIn(this->GetInput(), outputRegionForThread);
+  InputRegionIterator itIn(this->InitializeAccumulation(outputRegionForThread), outputRegionForThread);
   typedef itk::ImageRegionIteratorWithIndex<TOutputImage> OutputRegionIterator;
   OutputRegionIterator itOut(this->GetOutput(), outputRegionForThread);
 
@@ -25,6 +25,7 @@
   #include "rtkTotalVariationDenoisingBPDQImageFilter.h"
 #endif
 #include "rtkDeconstructSoftThresholdReconstructImageFilter.h"
+#include "rtkTraceCollector.h"
 
 #include <itkThresholdImageFilter.h>
 
@@ -222,6 +222,8 @@ RegularizedConjugateGradientConeBeamReconstructionFilter<TImage>
 
   for (int i=0; i<m_MainLoop_iterations; i++)
     {
+    TraceSpan iterationSpan("Regularized conjugate gradient iteration", this, i);
+
     // After the first iteration, we need to use the output as input
     if (i>0)
       {
@@ -24,16 +24,20 @@
 
 #include <itkExtractImageFilter.h>
 #include <itkMultiplyImageFilter.h>
-#include <itkSubtractImageFilter.h>
-#include <itkAddImageAdaptor.h>
-#include <itkDivideOrZeroOutImageFilter.h>
 #include <itkTimeProbe.h>
-#include <itkThresholdImageFilter.h>
+#if !defined(ITK_LEGACY_REMOVE)
+# include <itkSubtractImageFilter.h>
+# include <itkAddImageFilter.h>
+# include <itkDivideOrZeroOutImageFilter.h>
+# include <itkThresholdImageFilter.h>
+#endif
 
 #include "rtkRayBoxIntersectionImageFilter.h"
 #include "rtkConstantImageSource.h"
 #include "rtkIterativeConeBeamReconstructionFilter.h"
 #include "rtkDisplacedDetectorImageFilter.h"
+#include "rtkFusedArithmeticImageFilter.h"
+#include "rtkTraceCollector.h"
 
 namespace rtk
 {
@@ -45,7 +49,8 @@ namespace rtk
  * the different steps of the SART cone-beam reconstruction, mainly:
  * - ExtractFilterType to work on one projection at a time
  * - ForwardProjectionImageFilter,
- * - SubtractImageFilter,
+ * - FusedArithmeticImageFilter for the correction of the projection and the
+ *   update of the volume,
  * - BackProjectionImageFilter.
  * The input stack of projections is processed piece by piece (the size is
  * controlled with ProjectionSubsetSize) via the use of itk::ExtractImageFilter
@@ -77,50 +82,42 @@ namespace rtk
  * Extract [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * MultiplyByZero [ label="itk::MultiplyImageFilter (by zero)" URL="\ref itk::MultiplyImageFilter"];
  * AfterExtract [label="", fixedsize="false", width=0, height=0, shape=none];
- * Subtract [ label="itk::SubtractImageFilter" URL="\ref itk::SubtractImageFilter"];
- * MultiplyByLambda [ label="itk::MultiplyImageFilter (by lambda)" URL="\ref itk::MultiplyImageFilter"];
- * Divide [ label="itk::DivideOrZeroOutImageFilter" URL="\ref itk::DivideOrZeroOutImageFilter"];
- * GatingWeight [ label="itk::MultiplyImageFilter (by gating weight)" URL="\ref itk::MultiplyImageFilter", style=dashed];
+ * Correction [ label="rtk::FusedArithmeticImageFilter (SART correction)" URL="\ref rtk::FusedArithmeticImageFilter"];
  * Displaced [ label="rtk::DisplacedDetectorImageFilter" URL="\ref rtk::DisplacedDetectorImageFilter"];
  * ConstantProjectionStack [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * ExtractConstantProjection [ label="itk::ExtractImageFilter" URL="\ref itk::ExtractImageFilter"];
  * RayBox [ label="rtk::RayBoxIntersectionImageFilter" URL="\ref rtk::RayBoxIntersectionImageFilter"];
  * ConstantVolume [ label="rtk::ConstantImageSource" URL="\ref rtk::ConstantImageSource"];
  * BackProjection [ label="rtk::BackProjectionImageFilter" URL="\ref rtk::BackProjectionImageFilter"];
- * Add [ label="itk::AddImageFilter" URL="\ref itk::AddImageFilter"];
+ * Update [ label="rtk::FusedArithmeticImageFilter (sum and positivity)" URL="\ref rtk::FusedArithmeticImageFilter"];
  * OutofInput0 [label="", fixedsize="false", width=0, height=0, shape=none];
- * Threshold [ label="itk::ThresholdImageFilter" URL="\ref itk::ThresholdImageFilter"];
- * OutofThreshold [label="", fixedsize="false", width=0, height=0, shape=none];
+ * OutofUpdate [label="", fixedsize="false", width=0, height=0, shape=none];
  * OutofBP [label="", fixedsize="false", width=0, height=0, shape=none];
  * BeforeBP [label="", fixedsize="false", width=0, height=0, shape=none];
  * BeforeAdd [label="", fixedsize="false", width=0, height=0, shape=none];
  * Input0 -> OutofInput0 [arrowhead=none];
  * OutofInput0 -> ForwardProject;
  * OutofInput0 -> BeforeAdd [arrowhead=none];
- * BeforeAdd -> Add;
+ * BeforeAdd -> Update;
  * ConstantVolume -> BeforeBP [arrowhead=none];
  * BeforeBP -> BackProjection;
  * Extract -> AfterExtract[arrowhead=none];
  * AfterExtract -> MultiplyByZero;
- * AfterExtract -> Subtract;
+ * AfterExtract -> Correction;
  * MultiplyByZero -> ForwardProject;
  * Input1 -> Extract;
- * ForwardProject -> Subtract;
- * Subtract -> MultiplyByLambda;
- * MultiplyByLambda -> Divide;
- * Divide -> GatingWeight;
- * GatingWeight -> Displaced;
+ * ForwardProject -> Correction;
+ * Correction -> Displaced;
  * ConstantProjectionStack -> ExtractConstantProjection;
  * ExtractConstantProjection -> RayBox;
- * RayBox -> Divide;
+ * RayBox -> Correction;
  * Displaced -> BackProjection;
  * BackProjection -> OutofBP [arrowhead=none];
- * OutofBP -> Add;
+ * OutofBP -> Update;
  * OutofBP -> BeforeBP [style=dashed, constraint=false];
- * Add -> Threshold;
- * Threshold -> OutofThreshold [arrowhead=none];
- * OutofThreshold -> OutofInput0 [headport="se", style=dashed];
- * OutofThreshold -> Output;
+ * Update -> OutofUpdate [arrowhead=none];
+ * OutofUpdate -> OutofInput0 [headport="se", style=dashed];
+ * OutofUpdate -> Output;
  * }
  * \enddot
  *
@@ -149,15 +146,22 @@ public:
   typedef itk::ExtractImageFilter< InputImageType, InputImageType >                          ExtractFilterType;
   typedef itk::MultiplyImageFilter< OutputImageType, OutputImageType, OutputImageType >      MultiplyFilterType;
   typedef rtk::ForwardProjectionImageFilter< OutputImageType, OutputImageType >              ForwardProjectionFilterType;
-  typedef itk::SubtractImageFilter< OutputImageType, OutputImageType >                       SubtractFilterType;
-  typedef itk::AddImageFilter< OutputImageType, OutputImageType >                            AddFilterType;
   typedef rtk::BackProjectionImageFilter< OutputImageType, OutputImageType >                 BackProjectionFilterType;
   typedef rtk::RayBoxIntersectionImageFilter<OutputImageType, OutputImageType>               RayBoxIntersectionFilterType;
-  typedef itk::DivideOrZeroOutImageFilter<OutputImageType, OutputImageType, OutputImageType> DivideFilterType;
   typedef rtk::ConstantImageSource<OutputImageType>                                          ConstantImageSourceType;
-  typedef itk::ThresholdImageFilter<OutputImageType>                                         ThresholdFilterType;
   typedef rtk::DisplacedDetectorImageFilter<InputImageType>                                  DisplacedDetectorFilterType;
+  typedef rtk::FusedArithmeticImageFilter<OutputImageType>                                   FusedArithmeticFilterType;
+
+#if !defined(ITK_LEGACY_REMOVE)
+  /** \deprecated The subtraction, the division, the multiplication by the
+   * gating weights, the addition and the threshold are fused in
+   * FusedArithmeticFilterType. These types are not used anymore. */
+  typedef itk::SubtractImageFilter< OutputImageType, OutputImageType >                       SubtractFilterType;
+  typedef itk::AddImageFilter< OutputImageType, OutputImageType >                            AddFilterType;
+  typedef itk::DivideOrZeroOutImageFilter<OutputImageType, OutputImageType, OutputImageType> DivideFilterType;
+  typedef itk::ThresholdImageFilter<OutputImageType>                                         ThresholdFilterType;
   typedef itk::MultiplyImageFilter<InputImageType,InputImageType, InputImageType>            GatingWeightsFilterType;
+#endif
 
 /** Standard New method. */
   itkNewMacro(Self);
@@ -215,17 +219,13 @@ protected:
   typename ExtractFilterType::Pointer            m_ExtractFilterRayBox;
   typename MultiplyFilterType::Pointer           m_ZeroMultiplyFilter;
   typename ForwardProjectionFilterType::Pointer  m_ForwardProjectionFilter;
-  typename SubtractFilterType::Pointer           m_SubtractFilter;
-  typename AddFilterType::Pointer                m_AddFilter;
-  typename MultiplyFilterType::Pointer           m_MultiplyFilter;
+  typename FusedArithmeticFilterType::Pointer    m_CorrectionFilter;
+  typename FusedArithmeticFilterType::Pointer    m_UpdateFilter;
   typename BackProjectionFilterType::Pointer     m_BackProjectionFilter;
   typename RayBoxIntersectionFilterType::Pointer m_RayBoxFilter;
-  typename DivideFilterType::Pointer             m_DivideFilter;
   typename ConstantImageSourceType::Pointer      m_ConstantProjectionStackSource;
   typename ConstantImageSourceType::Pointer      m_ConstantVolumeSource;
-  typename ThresholdFilterType::Pointer          m_ThresholdFilter;
   typename DisplacedDetectorFilterType::Pointer  m_DisplacedDetectorFilter;
-  typename GatingWeightsFilterType::Pointer      m_GatingWeightsFilter;
 
   bool m_EnforcePositivity;
 
@@ -257,15 +257,11 @@ private:
   itk::TimeProbe m_ExtractProbe;
   itk::TimeProbe m_ZeroMultiplyProbe;
   itk::TimeProbe m_ForwardProjectionProbe;
-  itk::TimeProbe m_SubtractProbe;
+  itk::TimeProbe m_CorrectionProbe;
   itk::TimeProbe m_DisplacedDetectorProbe;
-  itk::TimeProbe m_MultiplyProbe;
   itk::TimeProbe m_RayBoxProbe;
-  itk::TimeProbe m_DivideProbe;
   itk::TimeProbe m_BackProjectionProbe;
-  itk::TimeProbe m_ThresholdProbe;
-  itk::TimeProbe m_AddProbe;
-  itk::TimeProbe m_GatingProbe;
+  itk::TimeProbe m_UpdateProbe;
 
 }; // end of class
 
@@ -41,37 +41,30 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   // Create each filter of the composite filter
   m_ExtractFilter = ExtractFilterType::New();
   m_ZeroMultiplyFilter = MultiplyFilterType::New();
-  m_SubtractFilter = SubtractFilterType::New();
-  m_AddFilter = AddFilterType::New();
+  m_CorrectionFilter = FusedArithmeticFilterType::New();
+  m_UpdateFilter = FusedArithmeticFilterType::New();
   m_DisplacedDetectorFilter = DisplacedDetectorFilterType::New();
-  m_MultiplyFilter = MultiplyFilterType::New();
-  m_GatingWeightsFilter = GatingWeightsFilterType::New();
   m_ConstantVolumeSource = ConstantImageSourceType::New();
 
   // Create the filters required for correct weighting of the difference
   // projection
   m_ExtractFilterRayBox = ExtractFilterType::New();
   m_RayBoxFilter = RayBoxIntersectionFilterType::New();
-  m_DivideFilter = DivideFilterType::New();
   m_ConstantProjectionStackSource = ConstantImageSourceType::New();
 
-  // Create the filter that enforces positivity
-  m_ThresholdFilter = ThresholdFilterType::New();
-  
   //Permanent internal connections
   m_ZeroMultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
   m_ZeroMultiplyFilter->SetInput2( m_ExtractFilter->GetOutput() );
 
-  m_SubtractFilter->SetInput(0, m_ExtractFilter->GetOutput() );
-
-  m_MultiplyFilter->SetInput1( itk::NumericTraits<typename InputImageType::PixelType>::ZeroValue() );
-  m_MultiplyFilter->SetInput2( m_SubtractFilter->GetOutput() );
+  // The correction lambda * (measured - forward projection) / ray length is
+  // computed in a single pass, in place of the forward projection
+  m_CorrectionFilter->SetInput(1, m_ExtractFilter->GetOutput() );
+  m_CorrectionFilter->SetSARTCorrection(0.);
 
   m_ExtractFilterRayBox->SetInput(m_ConstantProjectionStackSource->GetOutput());
   m_RayBoxFilter->SetInput(m_ExtractFilterRayBox->GetOutput());
-  m_DivideFilter->SetInput1(m_MultiplyFilter->GetOutput());
-  m_DivideFilter->SetInput2(m_RayBoxFilter->GetOutput());
-  m_DisplacedDetectorFilter->SetInput(m_DivideFilter->GetOutput());
+  m_CorrectionFilter->SetInput(2, m_RayBoxFilter->GetOutput());
+  m_DisplacedDetectorFilter->SetInput(m_CorrectionFilter->GetOutput());
 
   // Default parameters
   m_ExtractFilter->SetDirectionCollapseToSubmatrix();
@@ -125,16 +118,8 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   if ( !inputPtr )
     return;
 
-  if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_ThresholdFilter->GetOutput()->PropagateRequestedRegion();
-    }
-  else
-    {
-    m_BackProjectionFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
-    m_BackProjectionFilter->GetOutput()->PropagateRequestedRegion();
-    }
+  m_UpdateFilter->GetOutput()->SetRequestedRegion(this->GetOutput()->GetRequestedRegion() );
+  m_UpdateFilter->GetOutput()->PropagateRequestedRegion();
 }
 
 template<class TInputImage, class TOutputImage>
@@ -147,6 +132,7 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   typename ExtractFilterType::InputImageRegionType projRegion;
 
   projRegion = this->GetInput(1)->GetLargestPossibleRegion();
+  projRegion.SetSize(this->InputImageDimension-1, 1);
   m_ExtractFilter->SetExtractionRegion(projRegion);
   m_ExtractFilterRayBox->SetExtractionRegion(projRegion);
 
@@ -160,13 +146,14 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_BackProjectionFilter->SetInput(1, m_DisplacedDetectorFilter->GetOutput() );
   m_BackProjectionFilter->SetTranspose(false);
 
-  m_AddFilter->SetInput1(m_BackProjectionFilter->GetOutput());
-  m_AddFilter->SetInput2(this->GetInput(0));
+  m_UpdateFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
+  m_UpdateFilter->SetInput(1, this->GetInput(0));
+  m_UpdateFilter->SetSum(m_EnforcePositivity);
 
   m_ForwardProjectionFilter->SetInput( 0, m_ZeroMultiplyFilter->GetOutput() );
   m_ForwardProjectionFilter->SetInput( 1, this->GetInput(0) );
   m_ExtractFilter->SetInput( this->GetInput(1) );
-  m_SubtractFilter->SetInput(1, m_ForwardProjectionFilter->GetOutput() );
+  m_CorrectionFilter->SetInput(0, m_ForwardProjectionFilter->GetOutput() );
 
   // For the same reason, set geometry now
   // Check and set geometry
@@ -178,13 +165,6 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_BackProjectionFilter->SetGeometry(this->m_Geometry.GetPointer());
   m_DisplacedDetectorFilter->SetGeometry(this->m_Geometry);
 
-  if (m_IsGated) // For gated SART, insert a gating filter into the pipeline
-    {
-    m_GatingWeightsFilter->SetInput1(m_DivideFilter->GetOutput());
-    m_GatingWeightsFilter->SetConstant2(1);
-    m_DisplacedDetectorFilter->SetInput(m_GatingWeightsFilter->GetOutput());
-    }
-
   m_ConstantProjectionStackSource->SetInformationFromImage(const_cast<TInputImage *>(this->GetInput(1)));
   m_ConstantProjectionStackSource->SetConstant(0);
   m_ConstantProjectionStackSource->UpdateOutputInformation();
@@ -204,41 +184,19 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   m_RayBoxFilter->SetBoxMin(Corner1);
   m_RayBoxFilter->SetBoxMax(Corner2);
   
-  if(m_EnforcePositivity)
-    {
-    m_ThresholdFilter->SetOutsideValue(0);
-    m_ThresholdFilter->ThresholdBelow(0);
-    m_ThresholdFilter->SetInput(m_AddFilter->GetOutput() );
-
-    // Update output information
-    m_ThresholdFilter->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_ThresholdFilter->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_ThresholdFilter->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_ThresholdFilter->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_ThresholdFilter->GetOutput()->GetLargestPossibleRegion() );
-    }
-  else
-    {
-    // Update output information
-    m_AddFilter->UpdateOutputInformation();
-    this->GetOutput()->SetOrigin( m_AddFilter->GetOutput()->GetOrigin() );
-    this->GetOutput()->SetSpacing( m_AddFilter->GetOutput()->GetSpacing() );
-    this->GetOutput()->SetDirection( m_AddFilter->GetOutput()->GetDirection() );
-    this->GetOutput()->SetLargestPossibleRegion( m_AddFilter->GetOutput()->GetLargestPossibleRegion() );
-    }
+  // Update output information
+  m_UpdateFilter->UpdateOutputInformation();
+  this->GetOutput()->SetOrigin( m_UpdateFilter->GetOutput()->GetOrigin() );
+  this->GetOutput()->SetSpacing( m_UpdateFilter->GetOutput()->GetSpacing() );
+  this->GetOutput()->SetDirection( m_UpdateFilter->GetOutput()->GetDirection() );
+  this->GetOutput()->SetLargestPossibleRegion( m_UpdateFilter->GetOutput()->GetLargestPossibleRegion() );
 
   // Set memory management flags
   m_ZeroMultiplyFilter->ReleaseDataFlagOn();
   m_ForwardProjectionFilter->ReleaseDataFlagOn();
-  m_SubtractFilter->ReleaseDataFlagOn();
-  m_MultiplyFilter->ReleaseDataFlagOn();
   m_RayBoxFilter->ReleaseDataFlagOn();
-  m_DivideFilter->ReleaseDataFlagOn();
+  m_CorrectionFilter->ReleaseDataFlagOn();
   m_DisplacedDetectorFilter->ReleaseDataFlagOn();
-
-  if (m_EnforcePositivity)
-    m_AddFilter->ReleaseDataFlagOn();
-
 }
 
 template<class TInputImage, class TOutputImage>
@@ -262,8 +220,8 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
     projOrder[i] = i;
   std::random_shuffle( projOrder.begin(), projOrder.end() );
 
-  m_MultiplyFilter->SetInput1( (const float) m_Lambda/(double)m_NumberOfProjectionsPerSubset  );
-  
+  const double lambda = m_Lambda/(double)m_NumberOfProjectionsPerSubset;
+
   // Create the zero projection stack used as input by RayBoxIntersectionFilter
   m_ConstantProjectionStackSource->Update();
 
@@ -273,6 +231,8 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
   // For each iteration, go over each projection
   for(unsigned int iter = 0; iter < m_NumberOfIterations; iter++)
     {
+    TraceSpan iterationSpan("SART iteration", this, iter);
+
     unsigned int projectionsProcessedInSubset = 0;
 
     for(unsigned int i = 0; i < nProj; i++)
@@ -283,15 +243,11 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       // - reset the projectionsProcessedInSubset to zero
       if (projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset)
         {
-        if (m_EnforcePositivity)
-          pimg = m_ThresholdFilter->GetOutput();
-        else
-          pimg = m_AddFilter->GetOutput();
-
+        pimg = m_UpdateFilter->GetOutput();
         pimg->DisconnectPipeline();
 
         m_ForwardProjectionFilter->SetInput(1, pimg );
-        m_AddFilter->SetInput2(pimg);
+        m_UpdateFilter->SetInput(1, pimg);
         m_BackProjectionFilter->SetInput(0, m_ConstantVolumeSource->GetOutput());
 
         projectionsProcessedInSubset = 0;
@@ -318,11 +274,11 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       m_ExtractFilter->SetExtractionRegion(subsetRegion);
       m_ExtractFilterRayBox->SetExtractionRegion(subsetRegion);
 
-      // Set gating weight for the current projection
+      // Set the convergence factor and the gating weight for the current projection
       if (m_IsGated)
-        {
-        m_GatingWeightsFilter->SetConstant2(m_GatingWeights[i]);
-        }
+        m_CorrectionFilter->SetSARTCorrection(lambda, m_GatingWeights[i]);
+      else
+        m_CorrectionFilter->SetSARTCorrection(lambda);
 
       // This is required to reset the full pipeline
       m_BackProjectionFilter->GetOutput()->UpdateOutputInformation();
@@ -341,28 +297,13 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       m_ForwardProjectionFilter->Update();
       m_ForwardProjectionProbe.Stop();
 
-      m_SubtractProbe.Start();
-      m_SubtractFilter->Update();
-      m_SubtractProbe.Stop();
-
-      m_MultiplyProbe.Start();
-      m_MultiplyFilter->Update();
-      m_MultiplyProbe.Stop();
-
       m_RayBoxProbe.Start();
       m_RayBoxFilter->Update();
       m_RayBoxProbe.Stop();
 
-      m_DivideProbe.Start();
-      m_DivideFilter->Update();
-      m_DivideProbe.Stop();
-
-      if (m_IsGated)
-        {
-        m_GatingProbe.Start();
-        m_GatingWeightsFilter->Update();
-        m_GatingProbe.Stop();
-        }
+      m_CorrectionProbe.Start();
+      m_CorrectionFilter->Update();
+      m_CorrectionProbe.Stop();
 
       m_DisplacedDetectorProbe.Start();
       m_DisplacedDetectorFilter->Update();
@@ -375,30 +316,16 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
       projectionsProcessedInSubset++;
       if ((projectionsProcessedInSubset == m_NumberOfProjectionsPerSubset) || (i == nProj - 1))
         {
-        m_AddFilter->SetInput1(m_BackProjectionFilter->GetOutput());
-
-        m_AddProbe.Start();
-        m_AddFilter->Update();
-        m_AddProbe.Start();
+        m_UpdateFilter->SetInput(0, m_BackProjectionFilter->GetOutput());
 
-        if (m_EnforcePositivity)
-          {
-          m_ThresholdProbe.Start();
-          m_ThresholdFilter->Update();
-          m_ThresholdProbe.Stop();
-          }
+        m_UpdateProbe.Start();
+        m_UpdateFilter->Update();
+        m_UpdateProbe.Stop();
         }
 
       }
     }
-  if (m_EnforcePositivity)
-    {
-    this->GraftOutput( m_ThresholdFilter->GetOutput() );
-    }
-  else
-    {
-    this->GraftOutput( m_AddFilter->GetOutput() );
-    }
+  this->GraftOutput( m_UpdateFilter->GetOutput() );
 }
 
 template<class TInputImage, class TOutputImage>
@@ -413,27 +340,16 @@ SARTConeBeamReconstructionFilter<TInputImage, TOutputImage>
      << ' ' << m_ZeroMultiplyProbe.GetUnit() << std::endl;
   os << "  Forward projection: " << m_ForwardProjectionProbe.GetTotal()
      << ' ' << m_ForwardProjectionProbe.GetUnit() << std::endl;
-  os << "  Subtraction: " << m_SubtractProbe.GetTotal()
-     << ' ' << m_SubtractProbe.GetUnit() << std::endl;
-  os << "  Multiplication by lambda: " << m_MultiplyProbe.GetTotal()
-     << ' ' << m_MultiplyProbe.GetUnit() << std::endl;
   os << "  Ray box intersection: " << m_RayBoxProbe.GetTotal()
      << ' ' << m_RayBoxProbe.GetUnit() << std::endl;
-  os << "  Division: " << m_DivideProbe.GetTotal()
-     << ' ' << m_DivideProbe.GetUnit() << std::endl;
-  os << "  Multiplication by the gating weights: " << m_GatingProbe.GetTotal()
-     << ' ' << m_GatingProbe.GetUnit() << std::endl;
+  os << "  Correction of the projections: " << m_CorrectionProbe.GetTotal()
+     << ' ' << m_CorrectionProbe.GetUnit() << std::endl;
   os << "  Displaced detector: " << m_DisplacedDetectorProbe.GetTotal()
      << ' ' << m_DisplacedDetectorProbe.GetUnit() << std::endl;
   os << "  Back projection: " << m_BackProjectionProbe.GetTotal()
      << ' ' << m_BackProjectionProbe.GetUnit() << std::endl;
-  os << "  Volume update: " << m_AddProbe.GetTotal()
-     << ' ' << m_AddProbe.GetUnit() << std::endl;
-  if (m_EnforcePositivity)
-    {  
-    os << "  Positivity enforcement: " << m_ThresholdProbe.GetTotal()
-    << ' ' << m_ThresholdProbe.GetUnit() << std::endl;
-    }
+  os << "  Volume update: " << m_UpdateProbe.GetTotal()
+     << ' ' << m_UpdateProbe.GetUnit() << std::endl;
 }
 
 } // end namespace rtk
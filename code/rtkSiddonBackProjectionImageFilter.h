@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkSiddonBackProjectionImageFilter_h
+#define __rtkSiddonBackProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+#include "rtkSiddonRayCache.h"
+#include "rtkTraceCollector.h"
+
+namespace rtk
+{
+
+/** \class SiddonBackProjectionImageFilter
+ * \brief Siddon back projection.
+ *
+ * Performs a back projection, i.e. smearing of ray value along its path,
+ * with the exact intersection lengths of the rays with the voxels [Siddon,
+ * Med Phys, 1985] computed with the incremental traversal of [Jacobs et al, J
+ * Comput Inf Tech, 1998]. The rays are traversed exactly as in
+ * rtk::SiddonForwardProjectionImageFilter so that the back projector is the
+ * adjoint of the forward projector.
+ *
+ * Each thread processes a slab of the volume, which avoids concurrent writes
+ * in the same voxel, and only traces the rays of the detector pixels in the
+ * shadow of its slab, i.e., the bounding box of the projection of the slab
+ * corners (see GetSlabShadow), through its slab. Like in the
+ * forward projector, the intersections of the rays with the volume can be
+ * stored in a rtk::SiddonRayCache, e.g., the cache of the forward projector
+ * of an iterative reconstruction.
+ *
+ * \test rtksiddonprojectorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT SiddonBackProjectionImageFilter :
+  public BackProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonBackProjectionImageFilter                        Self;
+  typedef BackProjectionImageFilter<TInputImage,TOutputImage>    Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef rtk::ThreeDCircularProjectionGeometry                  GeometryType;
+  typedef typename GeometryType::Pointer                         GeometryPointer;
+  typedef rtk::SiddonRayCache                                    RayCacheType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonBackProjectionImageFilter, BackProjectionImageFilter);
+
+  /** Get / Set whether the ray-volume intersections are cached. Default is off. */
+  itkGetMacro(UseRayCache, bool);
+  itkSetMacro(UseRayCache, bool);
+  itkBooleanMacro(UseRayCache);
+
+  /** Get / Set the cache of the ray-volume intersections. It is created at
+   * the first update if UseRayCache is on and no cache has been set. */
+  itkGetObjectMacro(RayCache, RayCacheType);
+  itkSetObjectMacro(RayCache, RayCacheType);
+
+protected:
+  SiddonBackProjectionImageFilter();
+  virtual ~SiddonBackProjectionImageFilter() {}
+
+  /** Checks the geometry and computes the missing entries of the cache. */
+  virtual void BeforeThreadedGenerateData();
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId );
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  virtual void VerifyInputInformation() {}
+
+  /** Ray geometry of projection iProj: source position in volume indices,
+   * source position in mm, and matrices from the projection index to the
+   * volume index and to the physical coordinates in mm. */
+  void GetRayGeometry(const int iProj,
+                      double source[3],
+                      double sourceMM[3],
+                      typename GeometryType::ThreeDHomogeneousMatrixType &matrix,
+                      typename GeometryType::ThreeDHomogeneousMatrixType &matrixMM);
+
+private:
+  SiddonBackProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                  //purposely not implemented
+
+  bool                  m_UseRayCache;
+  RayCacheType::Pointer m_RayCache;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkSiddonBackProjectionImageFilter.hxx"
+#endif
+
+#endif
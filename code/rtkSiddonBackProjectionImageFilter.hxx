@@ -0,0 +1,250 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkSiddonBackProjectionImageFilter_hxx
+#define __rtkSiddonBackProjectionImageFilter_hxx
+
+#include "rtkHomogeneousMatrix.h"
+#include "rtkSiddonRayTracing.h"
+
+
+namespace rtk
+{
+
+template <class TInputImage, class TOutputImage>
+SiddonBackProjectionImageFilter<TInputImage, TOutputImage>
+::SiddonBackProjectionImageFilter():
+  m_UseRayCache(false)
+{
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonBackProjectionImageFilter<TInputImage, TOutputImage>
+::GetRayGeometry(const int iProj,
+                 double source[3],
+                 double sourceMM[3],
+                 typename GeometryType::ThreeDHomogeneousMatrixType &matrix,
+                 typename GeometryType::ThreeDHomogeneousMatrixType &matrixMM)
+{
+  GeometryType *geometry = dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer());
+
+  // volPPToIndex maps the physical 3D coordinates of a point (in mm) to the
+  // corresponding 3D volume index
+  typename GeometryType::ThreeDHomogeneousMatrixType volPPToIndex;
+  volPPToIndex = GetPhysicalPointToIndexMatrix( this->GetOutput() );
+
+  typename GeometryType::HomogeneousVectorType sourcePosition;
+  sourcePosition = volPPToIndex * geometry->GetSourcePosition(iProj);
+  for(unsigned int i=0; i<3; i++)
+    {
+    source[i] = sourcePosition[i];
+    sourceMM[i] = geometry->GetSourcePosition(iProj)[i];
+    }
+
+  matrixMM = geometry->GetProjectionCoordinatesToFixedSystemMatrix(iProj).GetVnlMatrix() *
+             GetIndexToPhysicalPointMatrix( this->GetInput(1) ).GetVnlMatrix();
+  matrix = volPPToIndex.GetVnlMatrix() * matrixMM.GetVnlMatrix();
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonBackProjectionImageFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if( !dynamic_cast<GeometryType*>(this->GetGeometry().GetPointer()) )
+    {
+    itkGenericExceptionMacro(<< "Error, ThreeDCircularProjectionGeometry expected");
+    }
+
+  if(!m_UseRayCache)
+    return;
+
+  // The box of the cache is the requested volume, the slabs of the threads
+  // are clipped from the cached intersections
+  const OutputImageRegionType volRegion = this->GetOutput()->GetRequestedRegion();
+  double boxMin[3], boxMax[3];
+  for(unsigned int i=0; i<3; i++)
+    {
+    boxMin[i] = volRegion.GetIndex()[i] - 0.5;
+    boxMax[i] = volRegion.GetIndex()[i] + (int)volRegion.GetSize()[i] - 0.5;
+    }
+
+  if(m_RayCache.IsNull())
+    m_RayCache = RayCacheType::New();
+  m_RayCache->SetKey( RayCacheType::MakeKey(this->GetGeometry().GetPointer(),
+                                            this->GetOutput(),
+                                            volRegion,
+                                            this->GetInput(1)) );
+
+  // Compute the missing entries. This is done here and not in the threads
+  // because the shadows of the slabs of the threads overlap.
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  const typename TInputImage::RegionType largest = this->GetInput(1)->GetLargestPossibleRegion();
+  for(int iProj=buffReg.GetIndex(2);
+          iProj<buffReg.GetIndex(2)+(int)buffReg.GetSize(2);
+          iProj++)
+    {
+    m_RayCache->AllocateProjection(iProj, largest.GetSize(0) * largest.GetSize(1));
+    double *cacheEntries = m_RayCache->GetProjectionEntries(iProj);
+
+    double source[3], sourceMM[3], dirVox[3];
+    typename GeometryType::ThreeDHomogeneousMatrixType matrix, matrixMM;
+    this->GetRayGeometry(iProj, source, sourceMM, matrix, matrixMM);
+    for(int j=buffReg.GetIndex(1); j<buffReg.GetIndex(1)+(int)buffReg.GetSize(1); j++)
+      for(int i=buffReg.GetIndex(0); i<buffReg.GetIndex(0)+(int)buffReg.GetSize(0); i++)
+        {
+        double *entry = cacheEntries + 2 * ( (i-largest.GetIndex(0)) + (j-largest.GetIndex(1))*(int)largest.GetSize(0) );
+        if(entry[0] >= 0.)
+          continue;
+        for(unsigned int k=0; k<3; k++)
+          dirVox[k] = matrix[k][0] * i + matrix[k][1] * j + matrix[k][2] * iProj + matrix[k][3] - source[k];
+        double alphaMin = 0.;
+        double alphaMax = 1.;
+        const bool intersect = SiddonRayBoxIntersection(source, dirVox, boxMin, boxMax, alphaMin, alphaMax);
+        entry[0] = (intersect)?alphaMin:2.;
+        entry[1] = (intersect)?alphaMax:2.;
+        }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SiddonBackProjectionImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       ThreadIdType itkNotUsed(threadId) )
+{
+  TraceSpan threadSpan(this->GetNameOfClass(), this);
+
+  const unsigned int Dimension = TInputImage::ImageDimension;
+  const typename TInputImage::RegionType buffReg = this->GetInput(1)->GetBufferedRegion();
+  const OutputImageRegionType outRegion = this->GetOutput()->GetBufferedRegion();
+  int offsets[3];
+  offsets[0] = 1;
+  offsets[1] = outRegion.GetSize()[0];
+  offsets[2] = outRegion.GetSize()[0] * outRegion.GetSize()[1];
+
+  // Initialize output region with input region in case the filter is not in
+  // place
+  this->InitializeOutputRegion(outputRegionForThread);
+
+  // beginBuffer is pointing at point with index (0,0,0) in memory, even if
+  // it is not in the allocated memory
+  OutputPixelType *beginBuffer =
+      this->GetOutput()->GetBufferPointer() -
+      offsets[0] * outRegion.GetIndex()[0] -
+      offsets[1] * outRegion.GetIndex()[1] -
+      offsets[2] * outRegion.GetIndex()[2];
+
+  // The rays are only traced in the slab of the thread
+  int regionMin[3], regionMax[3];
+  double boxMin[3], boxMax[3];
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    regionMin[i] = outputRegionForThread.GetIndex()[i];
+    regionMax[i] = outputRegionForThread.GetIndex()[i] + outputRegionForThread.GetSize()[i] - 1;
+    boxMin[i] = regionMin[i] - 0.5;
+    boxMax[i] = regionMax[i] + 0.5;
+    }
+
+  // Layout of the entries of the cache
+  const typename TInputImage::RegionType largest = this->GetInput(1)->GetLargestPossibleRegion();
+  const int cacheIndex0 = largest.GetIndex(0);
+  const int cacheIndex1 = largest.GetIndex(1);
+  const int cacheSize0 = largest.GetSize(0);
+
+  // Layout of the projections buffer
+  const InputPixelType *projBuffer = this->GetInput(1)->GetBufferPointer();
+  const int projOffset1 = buffReg.GetSize(0);
+  const int projOffset2 = buffReg.GetSize(0) * buffReg.GetSize(1);
+
+  // Go over each projection
+  for(int iProj=buffReg.GetIndex(2);
+          iProj<buffReg.GetIndex(2)+(int)buffReg.GetSize(2);
+          iProj++)
+    {
+    double source[3], sourceMM[3], dirVox[3];
+    typename GeometryType::ThreeDHomogeneousMatrixType matrix, matrixMM;
+    this->GetRayGeometry(iProj, source, sourceMM, matrix, matrixMM);
+
+    double *cacheEntries = NULL;
+    if(m_UseRayCache)
+      cacheEntries = m_RayCache->GetProjectionEntries(iProj);
+
+    // Only the pixels in the shadow of the slab of the thread have a ray
+    // crossing the slab
+    int pixMin[2], pixMax[2];
+    this->GetSlabShadow(iProj, boxMin, boxMax, pixMin, pixMax);
+
+    // Go over each pixel of the shadow
+    typename TInputImage::IndexType index;
+    index[2] = iProj;
+    for(index[1]=pixMin[1]; index[1]<=pixMax[1]; index[1]++)
+      for(index[0]=pixMin[0]; index[0]<=pixMax[0]; index[0]++)
+      {
+      const InputPixelType value = projBuffer[ (index[0]-buffReg.GetIndex(0)) +
+                                               (index[1]-buffReg.GetIndex(1)) * projOffset1 +
+                                               (index[2]-buffReg.GetIndex(2)) * projOffset2 ];
+      if(value == 0)
+        continue;
+
+      // Skip the rays which miss the volume and start from the cached
+      // intersection
+      double alphaMin = 0.;
+      double alphaMax = 1.;
+      if(cacheEntries)
+        {
+        const double *entry = cacheEntries + 2 * ( (index[0]-cacheIndex0) + (index[1]-cacheIndex1)*cacheSize0 );
+        if(entry[0] >= entry[1])
+          continue;
+        alphaMin = entry[0];
+        alphaMax = entry[1];
+        }
+
+      // Ray direction in volume indices and length in mm
+      double rayLength = 0.;
+      for(unsigned int i=0; i<Dimension; i++)
+        {
+        dirVox[i] = matrix[i][Dimension];
+        double pixelMM = matrixMM[i][Dimension];
+        for(unsigned int j=0; j<Dimension; j++)
+          {
+          dirVox[i] += matrix[i][j] * index[j];
+          pixelMM += matrixMM[i][j] * index[j];
+          }
+        dirVox[i] -= source[i];
+        rayLength += (pixelMM - sourceMM[i]) * (pixelMM - sourceMM[i]);
+        }
+      rayLength = sqrt(rayLength);
+
+      // Intersection with the slab of the thread
+      if( !SiddonRayBoxIntersection(source, dirVox, boxMin, boxMax, alphaMin, alphaMax) )
+        continue;
+
+      Functor::SiddonRaySplat<OutputPixelType> splat(beginBuffer, value);
+      SiddonRayTraversal(source, dirVox, alphaMin, alphaMax,
+                         regionMin, regionMax, offsets, rayLength, splat);
+      }
+    }
+}
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkSiddonForwardProjectionImageFilter_h
+#define __rtkSiddonForwardProjectionImageFilter_h
+
+#include "rtkConfiguration.h"
+#include "rtkForwardProjectionImageFilter.h"
+#include "rtkSiddonRayCache.h"
+#include "rtkMacro.h"
+#include "rtkTraceCollector.h"
+
+namespace rtk
+{
+
+/** \class SiddonForwardProjectionImageFilter
+ * \brief Siddon forward projection.
+ *
+ * Performs a forward projection, i.e. accumulation along x-ray lines, with
+ * the exact intersection lengths of the rays with the voxels [Siddon, Med
+ * Phys, 1985] computed with the incremental traversal of [Jacobs et al, J
+ * Comput Inf Tech, 1998], see SiddonRayTraversal. Contrary to
+ * rtk::JosephForwardProjectionImageFilter, there is no interpolation: each
+ * voxel is a box of constant value. The adjoint operator is
+ * rtk::SiddonBackProjectionImageFilter.
+ *
+ * The intersection of each ray with the volume can be stored in a
+ * rtk::SiddonRayCache to save the ray-box intersections of the next updates
+ * with the same geometry, e.g., in iterative reconstruction. The cache can be
+ * shared with a rtk::SiddonBackProjectionImageFilter.
+ *
+ * \test rtksiddonprojectorstest.cxx
+ *
+ * \ingroup Projector
+ */
+
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT SiddonForwardProjectionImageFilter :
+  public ForwardProjectionImageFilter<TInputImage,TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonForwardProjectionImageFilter                     Self;
+  typedef ForwardProjectionImageFilter<TInputImage,TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                                Pointer;
+  typedef itk::SmartPointer<const Self>                          ConstPointer;
+  typedef typename TInputImage::PixelType                        InputPixelType;
+  typedef typename TOutputImage::PixelType                       OutputPixelType;
+  typedef typename TOutputImage::RegionType                      OutputImageRegionType;
+  typedef rtk::SiddonRayCache                                    RayCacheType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonForwardProjectionImageFilter, ForwardProjectionImageFilter);
+
+  /** Get / Set whether the ray-volume intersections are cached. Default is off. */
+  itkGetMacro(UseRayCache, bool);
+  itkSetMacro(UseRayCache, bool);
+  itkBooleanMacro(UseRayCache);
+
+  /** Get / Set the cache of the ray-volume intersections. It is created at
+   * the first update if UseRayCache is on and no cache has been set. */
+  itkGetObjectMacro(RayCache, RayCacheType);
+  itkSetObjectMacro(RayCache, RayCacheType);
+
+protected:
+  SiddonForwardProjectionImageFilter();
+  virtual ~SiddonForwardProjectionImageFilter() {}
+
+  /** Prepares the cache of the ray-volume intersections. */
+  virtual void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  virtual void ThreadedGenerateData( const OutputImageRegionType& outputRegionForThread, ThreadIdType threadId ) ITK_OVERRIDE;
+
+  /** The two inputs should not be in the same space so there is nothing
+   * to verify. */
+  virtual void VerifyInputInformation() ITK_OVERRIDE {}
+
+private:
+  SiddonForwardProjectionImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);                     //purposely not implemented
+
+  bool                  m_UseRayCache;
+  RayCacheType::Pointer m_RayCache;
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkSiddonForwardProjectionImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,82 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkSiddonRayCache.h"
+
+namespace rtk
+{
+
+void
+SiddonRayCache
+::SetKey(const KeyType &key)
+{
+  if(key == m_Key)
+    return;
+  this->Clear();
+  m_Key = key;
+}
+
+void
+SiddonRayCache
+::AllocateProjection(const int iProj, const unsigned int nPixels)
+{
+  std::vector<double> &entries = m_Entries[iProj];
+  if(entries.size() != 2*nPixels)
+    entries.assign(2*nPixels, -1.);
+}
+
+double *
+SiddonRayCache
+::GetProjectionEntries(const int iProj)
+{
+  std::map<int, std::vector<double> >::iterator it = m_Entries.find(iProj);
+  if(it == m_Entries.end() || it->second.empty())
+    return NULL;
+  return &(it->second[0]);
+}
+
+void
+SiddonRayCache
+::Clear()
+{
+  m_Entries.clear();
+  m_Key.clear();
+  this->Modified();
+}
+
+size_t
+SiddonRayCache
+::GetMemorySize() const
+{
+  size_t size = 0;
+  std::map<int, std::vector<double> >::const_iterator it;
+  for(it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    size += it->second.size() * sizeof(double);
+  return size;
+}
+
+void
+SiddonRayCache
+::PrintSelf(std::ostream & os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of projections: " << m_Entries.size() << std::endl;
+  os << indent << "Memory size (bytes): " << this->GetMemorySize() << std::endl;
+}
+
+} // end namespace rtk
@@ -0,0 +1,140 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkSiddonRayCache_h
+#define __rtkSiddonRayCache_h
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include "rtkWin32Header.h"
+
+#include <vector>
+#include <map>
+
+namespace rtk
+{
+
+/** \class SiddonRayCache
+ * \brief Stores the parameters of the intersection of each ray with the
+ * volume for rtk::SiddonForwardProjectionImageFilter and
+ * rtk::SiddonBackProjectionImageFilter.
+ *
+ * For each pixel of each projection, the cache stores the two parameters
+ * alphaMin and alphaMax of the entry and exit points of the ray in the volume,
+ * see SiddonRayBoxIntersection. The entries only depend on the geometry, on
+ * the box of the volume and on the layout of the projections, which are
+ * summarized in a key. The cache is cleared when the key changes, otherwise
+ * the entries are reused across iterations of an iterative reconstruction and
+ * can be shared by a forward and a back projector.
+ *
+ * An entry with a negative alphaMin has not been computed yet and an entry
+ * with alphaMin>=alphaMax is a ray which misses the volume. The cache uses 16
+ * bytes per pixel of each cached projection.
+ *
+ * \ingroup Projector
+ */
+class RTK_EXPORT SiddonRayCache : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef SiddonRayCache                Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  typedef std::vector<double>           KeyType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SiddonRayCache, itk::Object);
+
+  /** Build the key of the entries computed with a geometry for a box of a
+   * volume and for projections with the layout of projections. The index of
+   * the projections along the third dimension is not part of the key so that
+   * subsets of the same stack of projections share the cache. */
+  template <class TGeometry, class TVolume, class TProjections>
+  static KeyType MakeKey(const TGeometry *geometry,
+                         const TVolume *volume,
+                         const typename TVolume::RegionType &box,
+                         const TProjections *projections)
+  {
+    KeyType key;
+    key.push_back( geometry->GetMTime() );
+    for(unsigned int i=0; i<3; i++)
+      {
+      key.push_back( volume->GetOrigin()[i] );
+      key.push_back( volume->GetSpacing()[i] );
+      key.push_back( box.GetIndex()[i] );
+      key.push_back( box.GetSize()[i] );
+      key.push_back( projections->GetOrigin()[i] );
+      key.push_back( projections->GetSpacing()[i] );
+      for(unsigned int j=0; j<3; j++)
+        {
+        key.push_back( volume->GetDirection()[i][j] );
+        key.push_back( projections->GetDirection()[i][j] );
+        }
+      }
+    for(unsigned int i=0; i<2; i++)
+      {
+      key.push_back( projections->GetLargestPossibleRegion().GetIndex()[i] );
+      key.push_back( projections->GetLargestPossibleRegion().GetSize()[i] );
+      }
+    return key;
+  }
+
+  /** Set the key of the entries. The cache is cleared if it differs from the
+   * key of the current entries. */
+  void SetKey(const KeyType &key);
+  const KeyType &GetKey() const { return m_Key; }
+
+  /** Allocate the entries of projection iProj for nPixels pixels if they are
+   * not allocated yet. New entries are marked as not computed. This method is
+   * not thread safe and must be called before the threaded part of the
+   * projectors. */
+  void AllocateProjection(const int iProj, const unsigned int nPixels);
+
+  /** Pointer to the 2 x nPixels entries of projection iProj, NULL if they have
+   * not been allocated. */
+  double *GetProjectionEntries(const int iProj);
+
+  /** Release all entries. */
+  void Clear();
+
+  /** Memory used by the entries in bytes. */
+  size_t GetMemorySize() const;
+
+protected:
+  SiddonRayCache() {}
+  virtual ~SiddonRayCache() {}
+
+  virtual void PrintSelf(std::ostream & os, itk::Indent indent) const;
+
+private:
+  SiddonRayCache(const Self &); //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  KeyType                              m_Key;
+  std::map<int, std::vector<double> >  m_Entries;
+};
+
+} // end namespace rtk
+
+#endif // __rtkSiddonRayCache_h
@@ -0,0 +1,217 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkSiddonRayTracing_h
+#define __rtkSiddonRayTracing_h
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rtk
+{
+
+//--------------------------------------------------------------------
+/** \brief Intersection of a ray with a box using the slab method.
+ *
+ * The ray is defined by source + alpha * direction and the box by its two
+ * corners boxMin and boxMax. The intersection is clipped to the input values
+ * of [alphaMin,alphaMax], e.g., [0,1] to restrict the ray between the source
+ * and the detector pixel. Returns false if the clipped ray does not intersect
+ * the box, in which case alphaMin and alphaMax are undefined.
+ *
+ * \ingroup Functions
+ */
+inline bool
+SiddonRayBoxIntersection(const double source[3],
+                         const double direction[3],
+                         const double boxMin[3],
+                         const double boxMax[3],
+                         double &alphaMin,
+                         double &alphaMax)
+{
+  for(unsigned int i=0; i<3; i++)
+    {
+    if(direction[i] == 0.)
+      {
+      if(source[i]<boxMin[i] || source[i]>boxMax[i])
+        return false;
+      continue;
+      }
+    double a1 = (boxMin[i] - source[i]) / direction[i];
+    double a2 = (boxMax[i] - source[i]) / direction[i];
+    if(a1>a2)
+      std::swap(a1, a2);
+    alphaMin = std::max(alphaMin, a1);
+    alphaMax = std::min(alphaMax, a2);
+    }
+  return alphaMin < alphaMax;
+}
+
+//--------------------------------------------------------------------
+/** \brief Incremental Siddon traversal of the voxels crossed by a ray.
+ *
+ * Implements the incremental version of Siddon's algorithm proposed by
+ * [Jacobs et al, J Comput Inf Tech, 1998]: the parameters alpha of the next
+ * crossing of the voxel boundaries are updated incrementally along each
+ * direction, so that each voxel of the ray costs one comparison and one
+ * addition. The source, the direction and the region are in voxel indices,
+ * i.e., voxel i covers [i-0.5,i+0.5] in each direction. The ray is traversed
+ * from alphaMin to alphaMax, typically computed with
+ * SiddonRayBoxIntersection, and the traversal stops when it leaves
+ * [regionMin,regionMax].
+ *
+ * For each crossed voxel, visitor(offset, length) is called where offset is
+ * the memory offset of the voxel from index (0,0,0) given the offsets of the
+ * three dimensions, and length is the intersection length of the ray with the
+ * voxel, i.e., the alpha interval multiplied by rayLength. The same traversal
+ * is used by the forward and the back projectors which are therefore exactly
+ * matched.
+ *
+ * \ingroup Functions
+ */
+template <class TVisitor>
+inline void
+SiddonRayTraversal(const double source[3],
+                   const double direction[3],
+                   const double alphaMin,
+                   const double alphaMax,
+                   const int regionMin[3],
+                   const int regionMax[3],
+                   const int offsets[3],
+                   const double rayLength,
+                   TVisitor &visitor)
+{
+  int index[3], step[3];
+  double alphaNext[3], alphaStep[3];
+  int offset = 0;
+  for(unsigned int i=0; i<3; i++)
+    {
+    // Voxel of the entry point. On a voxel boundary, the voxel in the
+    // direction of the ray is selected.
+    const double x = source[i] + alphaMin * direction[i] + 0.5;
+    if(direction[i]<0.)
+      index[i] = (int)std::ceil(x) - 1;
+    else
+      index[i] = (int)std::floor(x);
+    index[i] = std::max(regionMin[i], std::min(regionMax[i], index[i]));
+    offset += index[i] * offsets[i];
+
+    if(direction[i] > 0.)
+      {
+      step[i] = 1;
+      alphaNext[i] = (index[i] + 0.5 - source[i]) / direction[i];
+      alphaStep[i] = 1. / direction[i];
+      }
+    else if(direction[i] < 0.)
+      {
+      step[i] = -1;
+      alphaNext[i] = (index[i] - 0.5 - source[i]) / direction[i];
+      alphaStep[i] = -1. / direction[i];
+      }
+    else
+      {
+      step[i] = 0;
+      alphaNext[i] = std::numeric_limits<double>::max();
+      alphaStep[i] = 0.;
+      }
+    }
+
+  double alphaCurrent = alphaMin;
+  while(true)
+    {
+    unsigned int m = (alphaNext[0]<alphaNext[1])?0:1;
+    if(alphaNext[2]<alphaNext[m])
+      m = 2;
+
+    const double alpha = std::min(alphaNext[m], alphaMax);
+    if(alpha > alphaCurrent)
+      {
+      visitor(offset, (alpha - alphaCurrent) * rayLength);
+      alphaCurrent = alpha;
+      }
+    if(alphaNext[m] >= alphaMax)
+      break;
+
+    index[m] += step[m];
+    if(index[m]<regionMin[m] || index[m]>regionMax[m])
+      break;
+    offset += step[m] * offsets[m];
+    alphaNext[m] += alphaStep[m];
+    }
+}
+
+namespace Functor
+{
+/** \class SiddonRayAccumulation
+ * \brief Visitor of the ray traversals accumulating the voxel values weighted
+ * by the intersection lengths, i.e., the forward projection of a ray.
+ *
+ * \ingroup Functions
+ */
+template <class TPixel>
+class SiddonRayAccumulation
+{
+public:
+  SiddonRayAccumulation(const TPixel *beginBuffer):
+    m_BeginBuffer(beginBuffer),
+    m_Sum(0.)
+    {}
+
+  inline void operator()(const int offset, const double length)
+    {
+    m_Sum += length * m_BeginBuffer[offset];
+    }
+
+  double GetSum() const { return m_Sum; }
+
+private:
+  const TPixel *m_BeginBuffer;
+  double        m_Sum;
+};
+
+/** \class SiddonRaySplat
+ * \brief Visitor of the ray traversals adding the ray value weighted by the
+ * intersection lengths to the voxels, i.e., the back projection of a ray.
+ *
+ * \ingroup Functions
+ */
+template <class TPixel>
+class SiddonRaySplat
+{
+public:
+  SiddonRaySplat(TPixel *beginBuffer, const double value):
+    m_BeginBuffer(beginBuffer),
+    m_Value(value)
+    {}
+
+  inline void operator()(const int offset, const double length)
+    {
+    m_BeginBuffer[offset] += m_Value * length;
+    }
+
+private:
+  TPixel *m_BeginBuffer;
+  double  m_Value;
+};
+
+} // end namespace Functor
+
+} // end namespace rtk
+
+#endif // __rtkSiddonRayTracing_h
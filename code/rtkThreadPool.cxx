@@ -0,0 +1,576 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkThreadPool.h"
+
+#include <itkObjectFactory.h>
+#include <itksys/SystemTools.hxx>
+
+#if defined(__linux__)
+# include <pthread.h>
+# include <sched.h>
+#elif defined(_WIN32)
+# include <windows.h>
+#endif
+
+#if defined(_MSC_VER)
+# define RTK_THREAD_LOCAL __declspec(thread)
+#else
+# define RTK_THREAD_LOCAL __thread
+#endif
+
+namespace rtk
+{
+
+namespace
+{
+/** Index of the worker of the calling thread, -1 if it is not a worker */
+RTK_THREAD_LOCAL int currentWorker = -1;
+
+/** Creation of the singleton */
+itk::SimpleFastMutexLock instanceMutex;
+
+/** Runtime deactivation without recompilation */
+bool GetGlobalDefaultEnabledFromEnvironment()
+{
+  std::string value;
+  if( itksys::SystemTools::GetEnv("RTK_THREAD_POOL", value) )
+    return value != "0";
+  return true;
+}
+
+bool GetThreadPinningFromEnvironment()
+{
+  std::string value;
+  if( itksys::SystemTools::GetEnv("RTK_PIN_THREADS", value) )
+    return value == "1";
+  return false;
+}
+
+/** Processors on which the process is allowed to run */
+std::vector<unsigned int> GetAllowedProcessors()
+{
+  std::vector<unsigned int> processors;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if( sched_getaffinity(0, sizeof(set), &set) == 0 )
+    for(unsigned int cpu=0; cpu<CPU_SETSIZE; cpu++)
+      if( CPU_ISSET(cpu, &set) )
+        processors.push_back(cpu);
+#elif defined(_WIN32)
+  DWORD_PTR processMask, systemMask;
+  if( GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) )
+    for(unsigned int cpu=0; cpu<8*sizeof(DWORD_PTR); cpu++)
+      if( processMask & (DWORD_PTR(1) << cpu) )
+        processors.push_back(cpu);
+#endif
+  return processors;
+}
+
+/** Pin the calling thread to processor cpu */
+bool PinCurrentThread(unsigned int cpu)
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+}
+
+ThreadPool::Pointer ThreadPool::m_Instance = ITK_NULLPTR;
+bool ThreadPool::m_GlobalDefaultEnabled = GetGlobalDefaultEnabledFromEnvironment();
+
+ThreadPool
+::ThreadPool():
+  m_NextQueue(0),
+  m_ThreadPinning(GetThreadPinningFromEnvironment()),
+  m_NumberOfRunningParallelFors(0),
+  m_Restarting(false),
+  m_NumberOfQueuedTasks(0),
+  m_NumberOfStartedWorkers(0),
+  m_Stop(false),
+  m_NumberOfParallelFors(0),
+  m_NumberOfStolenTasks(0)
+{
+  m_Threader = itk::MultiThreader::New();
+  m_TasksAvailable = itk::ConditionVariable::New();
+  m_ConfigurationChanged = itk::ConditionVariable::New();
+
+  // The calling thread executes tasks too
+  const unsigned int n = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->StartWorkers( (n>1)?n-1:0 );
+}
+
+ThreadPool
+::~ThreadPool()
+{
+  this->StopWorkers();
+}
+
+void
+ThreadPool
+::PrintSelf(std::ostream & os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "ThreadPool (single instance): "
+     << (void *)ThreadPool::m_Instance << std::endl;
+  os << indent << "NumberOfWorkers: " << this->GetNumberOfWorkers() << std::endl;
+  os << indent << "ThreadPinning: " << this->GetThreadPinning() << std::endl;
+  os << indent << "NumberOfParallelFors: " << this->GetNumberOfParallelFors() << std::endl;
+  os << indent << "NumberOfStolenTasks: " << this->GetNumberOfStolenTasks() << std::endl;
+}
+
+/**
+ * Return the single instance of the ThreadPool
+ */
+ThreadPool::Pointer
+ThreadPool
+::GetInstance()
+{
+  instanceMutex.Lock();
+  if ( !ThreadPool::m_Instance )
+    {
+    // Try the factory first
+    ThreadPool::m_Instance  = itk::ObjectFactory< Self >::Create();
+    // if the factory did not provide one, then create it here
+    if ( !ThreadPool::m_Instance )
+      {
+      ThreadPool::m_Instance = new ThreadPool;
+      // Remove extra reference from construction.
+      ThreadPool::m_Instance->UnRegister();
+      }
+    }
+  Pointer instance = ThreadPool::m_Instance;
+  instanceMutex.Unlock();
+  /**
+   * return the instance
+   */
+  return instance;
+}
+
+/**
+ * This just calls GetInstance
+ */
+ThreadPool::Pointer
+ThreadPool
+::New()
+{
+  return GetInstance();
+}
+
+bool
+ThreadPool
+::GetGlobalDefaultEnabled()
+{
+  return m_GlobalDefaultEnabled;
+}
+
+void
+ThreadPool
+::SetGlobalDefaultEnabled(bool enabled)
+{
+  m_GlobalDefaultEnabled = enabled;
+}
+
+unsigned int
+ThreadPool
+::GetNumberOfWorkers() const
+{
+  m_ConfigurationMutex.Lock();
+  const unsigned int n = m_Queues.size();
+  m_ConfigurationMutex.Unlock();
+  return n;
+}
+
+void
+ThreadPool
+::SetNumberOfWorkers(unsigned int n)
+{
+  this->RestartWorkers(n, this->GetThreadPinning());
+}
+
+bool
+ThreadPool
+::GetThreadPinning() const
+{
+  m_ConfigurationMutex.Lock();
+  const bool pinning = m_ThreadPinning;
+  m_ConfigurationMutex.Unlock();
+  return pinning;
+}
+
+void
+ThreadPool
+::SetThreadPinning(bool pinning)
+{
+  this->RestartWorkers(this->GetNumberOfWorkers(), pinning);
+}
+
+void
+ThreadPool
+::RestartWorkers(unsigned int n, bool pinning)
+{
+  // Wait until no ParallelFor uses the workers and block the new ones
+  m_ConfigurationMutex.Lock();
+  while(m_Restarting || m_NumberOfRunningParallelFors>0)
+    m_ConfigurationChanged->Wait(&m_ConfigurationMutex);
+  const bool restart = (n != m_Queues.size() || pinning != m_ThreadPinning);
+  if(restart)
+    {
+    m_Restarting = true;
+    m_ConfigurationMutex.Unlock();
+
+    this->StopWorkers();
+    m_ThreadPinning = pinning;
+    this->StartWorkers(n);
+
+    m_ConfigurationMutex.Lock();
+    m_Restarting = false;
+    m_ConfigurationChanged->Broadcast();
+    }
+  m_ConfigurationMutex.Unlock();
+
+  if(restart)
+    this->Modified();
+}
+
+void
+ThreadPool
+::BeginParallelFor()
+{
+  m_ConfigurationMutex.Lock();
+  while(m_Restarting)
+    m_ConfigurationChanged->Wait(&m_ConfigurationMutex);
+  m_NumberOfRunningParallelFors++;
+  m_ConfigurationMutex.Unlock();
+}
+
+void
+ThreadPool
+::EndParallelFor()
+{
+  m_ConfigurationMutex.Lock();
+  if(--m_NumberOfRunningParallelFors == 0)
+    m_ConfigurationChanged->Broadcast();
+  m_ConfigurationMutex.Unlock();
+}
+
+itk::SizeValueType
+ThreadPool
+::GetNumberOfParallelFors() const
+{
+  m_Mutex.Lock();
+  const itk::SizeValueType n = m_NumberOfParallelFors;
+  m_Mutex.Unlock();
+  return n;
+}
+
+itk::SizeValueType
+ThreadPool
+::GetNumberOfStolenTasks() const
+{
+  m_Mutex.Lock();
+  const itk::SizeValueType n = m_NumberOfStolenTasks;
+  m_Mutex.Unlock();
+  return n;
+}
+
+void
+ThreadPool
+::StartWorkers(unsigned int n)
+{
+  m_Stop = false;
+  m_NumberOfStartedWorkers = 0;
+  m_NextQueue = 0;
+  if(m_ThreadPinning)
+    m_Processors = GetAllowedProcessors();
+  for(unsigned int i=0; i<n; i++)
+    m_Queues.push_back(new WorkerQueueType);
+  for(unsigned int i=0; i<n; i++)
+    m_ThreadIds.push_back( m_Threader->SpawnThread(WorkerCallback, this) );
+}
+
+void
+ThreadPool
+::StopWorkers()
+{
+  // Workers exit once all queued tasks have been executed
+  m_Mutex.Lock();
+  m_Stop = true;
+  m_TasksAvailable->Broadcast();
+  m_Mutex.Unlock();
+
+  for(unsigned int i=0; i<m_ThreadIds.size(); i++)
+    m_Threader->TerminateThread(m_ThreadIds[i]);
+  m_ThreadIds.clear();
+
+  for(unsigned int i=0; i<m_Queues.size(); i++)
+    delete m_Queues[i];
+  m_Queues.clear();
+}
+
+bool
+ThreadPool
+::PopTask(int worker, TaskType &task)
+{
+  const int nQueues = m_Queues.size();
+
+  // Last task of its own queue for a worker...
+  if(worker>=0 && worker<nQueues)
+    {
+    WorkerQueueType *queue = m_Queues[worker];
+    queue->Mutex.Lock();
+    const bool found = !queue->Tasks.empty();
+    if(found)
+      {
+      task = queue->Tasks.back();
+      queue->Tasks.pop_back();
+      }
+    queue->Mutex.Unlock();
+    if(found)
+      {
+      m_Mutex.Lock();
+      m_NumberOfQueuedTasks--;
+      m_Mutex.Unlock();
+      return true;
+      }
+    }
+
+  // ... otherwise, first task of the queue of another worker. Pinned workers
+  // do not steal tasks so that each part of the data stays on its processor.
+  if(m_ThreadPinning)
+    return false;
+  const int first = (worker>=0)?worker+1:0;
+  for(int i=0; i<nQueues; i++)
+    {
+    const int victim = (first+i) % nQueues;
+    if(victim == worker)
+      continue;
+    WorkerQueueType *queue = m_Queues[victim];
+    queue->Mutex.Lock();
+    const bool found = !queue->Tasks.empty();
+    if(found)
+      {
+      task = queue->Tasks.front();
+      queue->Tasks.pop_front();
+      }
+    queue->Mutex.Unlock();
+    if(found)
+      {
+      m_Mutex.Lock();
+      m_NumberOfQueuedTasks--;
+      m_NumberOfStolenTasks++;
+      m_Mutex.Unlock();
+      return true;
+      }
+    }
+  return false;
+}
+
+bool
+ThreadPool
+::HasQueuedTasks(int worker)
+{
+  // Pinned workers only execute the tasks of their own queue
+  if(!m_ThreadPinning)
+    return m_NumberOfQueuedTasks>0;
+  WorkerQueueType *queue = m_Queues[worker];
+  queue->Mutex.Lock();
+  const bool found = !queue->Tasks.empty();
+  queue->Mutex.Unlock();
+  return found;
+}
+
+void
+ThreadPool
+::RunTask(const TaskType &task)
+{
+  BatchType *batch = task.Batch;
+  std::string error;
+  try
+    {
+    batch->Function(batch->UserData, task.TaskId, batch->NumberOfTasks);
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    error = e.GetDescription();
+    }
+  catch( std::exception & e )
+    {
+    error = e.what();
+    }
+  catch( ... )
+    {
+    error = "Unknown exception in a task of the thread pool";
+    }
+
+  // The batch belongs to the stack of the caller of ParallelFor and must not
+  // be accessed after the last task is signaled as completed
+  m_Mutex.Lock();
+  if( !error.empty() && batch->ErrorDescription.empty() )
+    batch->ErrorDescription = error;
+  if( --(batch->NumberOfRemainingTasks) == 0 )
+    batch->Completed->Broadcast();
+  m_Mutex.Unlock();
+}
+
+void
+ThreadPool
+::ParallelFor(unsigned int numberOfTasks, TaskFunctionType function, void *userData)
+{
+  if(numberOfTasks == 0)
+    return;
+
+  // The workers cannot be restarted while they run the tasks
+  this->BeginParallelFor();
+  try
+    {
+    this->RunParallelFor(numberOfTasks, function, userData);
+    }
+  catch( ... )
+    {
+    this->EndParallelFor();
+    throw;
+    }
+  this->EndParallelFor();
+}
+
+void
+ThreadPool
+::RunParallelFor(unsigned int numberOfTasks, TaskFunctionType function, void *userData)
+{
+  m_Mutex.Lock();
+  m_NumberOfParallelFors++;
+  m_Mutex.Unlock();
+
+  // Nothing to share. Tasks of pinned workers are not stolen, a pinned
+  // worker therefore executes a nested loop itself instead of waiting for
+  // tasks queued to workers which may be waiting for it.
+  const unsigned int nQueues = m_Queues.size();
+  if(numberOfTasks == 1 || nQueues == 0 || (m_ThreadPinning && currentWorker>=0))
+    {
+    for(unsigned int i=0; i<numberOfTasks; i++)
+      function(userData, i, numberOfTasks);
+    return;
+    }
+
+  BatchType batch;
+  batch.Function = function;
+  batch.UserData = userData;
+  batch.NumberOfTasks = numberOfTasks;
+  batch.NumberOfRemainingTasks = numberOfTasks;
+  batch.Completed = itk::ConditionVariable::New();
+
+  // Distribute the tasks to the queues of the workers, round robin or, with
+  // pinned workers, in contiguous blocks so that a given part of the data is
+  // always processed by the same worker
+  m_Mutex.Lock();
+  const unsigned int firstQueue = m_NextQueue;
+  if(!m_ThreadPinning)
+    m_NextQueue = (m_NextQueue + numberOfTasks) % nQueues;
+  m_Mutex.Unlock();
+  for(unsigned int i=0; i<numberOfTasks; i++)
+    {
+    TaskType task;
+    task.Batch = &batch;
+    task.TaskId = i;
+    unsigned int q = (firstQueue+i) % nQueues;
+    if(m_ThreadPinning)
+      q = (unsigned int)( (unsigned long long)i * nQueues / numberOfTasks );
+    WorkerQueueType *queue = m_Queues[q];
+    queue->Mutex.Lock();
+    queue->Tasks.push_back(task);
+    queue->Mutex.Unlock();
+    }
+  m_Mutex.Lock();
+  m_NumberOfQueuedTasks += numberOfTasks;
+  m_TasksAvailable->Broadcast();
+  m_Mutex.Unlock();
+
+  // The calling thread helps until all queues are empty, unless the workers
+  // are pinned...
+  TaskType task;
+  if(!m_ThreadPinning)
+    while( this->PopTask(currentWorker, task) )
+      this->RunTask(task);
+
+  // ... and waits for the tasks still running on the workers
+  m_Mutex.Lock();
+  while(batch.NumberOfRemainingTasks)
+    batch.Completed->Wait(&m_Mutex);
+  m_Mutex.Unlock();
+
+  if( !batch.ErrorDescription.empty() )
+    {
+    itkExceptionMacro(<< batch.ErrorDescription);
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+ThreadPool
+::WorkerCallback(void *arg)
+{
+  typedef itk::MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadPool *pool = static_cast<ThreadPool *>( static_cast<ThreadInfoType *>(arg)->UserData );
+
+  pool->m_Mutex.Lock();
+  const int worker = pool->m_NumberOfStartedWorkers++;
+  pool->m_Mutex.Unlock();
+  currentWorker = worker;
+
+  if(pool->m_ThreadPinning)
+    {
+    const std::vector<unsigned int> &processors = pool->m_Processors;
+    if( processors.empty() ||
+        !PinCurrentThread(processors[worker % processors.size()]) )
+      itkGenericOutputMacro(<< "Worker " << worker << " of rtk::ThreadPool could not be pinned");
+    }
+
+  TaskType task;
+  for(;;)
+    {
+    if( pool->PopTask(worker, task) )
+      {
+      pool->RunTask(task);
+      continue;
+      }
+
+    // Sleep until tasks are queued or the pool is stopped
+    pool->m_Mutex.Lock();
+    while(!pool->m_Stop && !pool->HasQueuedTasks(worker))
+      pool->m_TasksAvailable->Wait(&pool->m_Mutex);
+    const bool stop = pool->m_Stop && !pool->HasQueuedTasks(worker);
+    pool->m_Mutex.Unlock();
+    if(stop)
+      break;
+    }
+
+  currentWorker = -1;
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+} // end namespace rtk
@@ -0,0 +1,230 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkThreadPool_h
+#define __rtkThreadPool_h
+
+#include <itkObject.h>
+#include <itkMultiThreader.h>
+#include <itkSimpleMutexLock.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkConditionVariable.h>
+
+#include "rtkWin32Header.h"
+
+#include <vector>
+#include <deque>
+#include <string>
+
+namespace rtk
+{
+
+/** \class ThreadPool
+ * \brief Persistent pool of worker threads with work stealing, shared by
+ * all RTK filters.
+ *
+ * itk::MultiThreader creates and joins one OS thread per piece of the
+ * output each time a filter executes its ThreadedGenerateData. Iterative
+ * reconstructions update their projection filters once per projection (or
+ * subset) and per iteration, which amounts to hundreds of thousands of
+ * threads per reconstruction. The ThreadPool is a singleton whose worker
+ * threads are started once and wait for tasks between two updates.
+ *
+ * ParallelFor executes a function for each task of a loop. The tasks are
+ * distributed to the queues of the workers. Each worker pops the tasks of
+ * its own queue and, when it is empty, steals tasks from the queues of the
+ * other workers. The calling thread also steals tasks until all tasks have
+ * been picked up, then waits for the completion of the tasks run by the
+ * workers. ParallelFor can therefore be called concurrently from several
+ * application threads and from the tasks themselves. GetInstance is
+ * thread-safe and the workers are only restarted (SetNumberOfWorkers,
+ * SetThreadPinning) once no ParallelFor is running, new ones waiting for the
+ * end of the restart.
+ *
+ * Filters with the usual ThreadedGenerateData are dispatched onto the pool
+ * with the rtk::ThreadPoolImageFilter adapter. The adapter can be disabled
+ * at runtime with SetGlobalDefaultEnabled or by setting the environment
+ * variable RTK_THREAD_POOL to 0, in which case itk::MultiThreader is used.
+ * The tasks of a ParallelFor are not guaranteed to run concurrently: a task
+ * must never wait for another task of the same loop, e.g., with an
+ * itk::Barrier, since it could wait forever.
+ *
+ * On NUMA machines, the workers can be pinned to processors with
+ * SetThreadPinning or by setting the environment variable RTK_PIN_THREADS to
+ * 1, worker i being pinned to the i-th processor of the affinity mask of the
+ * process (modulo its number of processors). The tasks of a ParallelFor are
+ * then distributed in contiguous blocks, task i going to worker
+ * i*NumberOfWorkers/numberOfTasks, and they are not stolen: the calling
+ * thread waits for their completion, or executes them all itself if it is a
+ * worker. Since ThreadedGenerateData splits the output region along its last
+ * dimension, the same part of an image buffer is processed by the same
+ * worker, hence the same processor, at each update, including its first
+ * touch by rtk::ImageBufferPool::Zero.
+ *
+ * \test rtkthreadpooltest.cxx
+ *
+ * \ingroup OSSystemObjects
+ */
+class RTK_EXPORT ThreadPool : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadPool                      Self;
+  typedef itk::Object                     Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadPool, itk::Object);
+
+  /** This is a singleton pattern New. There will only be ONE reference to a
+   * ThreadPool object per process. */
+  static Pointer New();
+
+  /** Return the singleton instance with no reference counting. */
+  static Pointer GetInstance();
+
+  /** Function executing the task taskId among numberOfTasks tasks. */
+  typedef void (*TaskFunctionType)(void *userData, unsigned int taskId, unsigned int numberOfTasks);
+
+  /** Execute function for all tasks from 0 to numberOfTasks-1 and return once
+   * they are all completed. If tasks throw exceptions, the description of the
+   * first one is rethrown in an itk::ExceptionObject after the completion of
+   * all tasks. */
+  void ParallelFor(unsigned int numberOfTasks, TaskFunctionType function, void *userData);
+
+  /** Get / Set the number of worker threads. The default is the global
+   * default number of threads of ITK minus one since the calling thread also
+   * executes tasks. Setting it waits for the running ParallelFor calls, then
+   * joins the current workers and starts the new ones. It must not be called
+   * from a task. */
+  unsigned int GetNumberOfWorkers() const;
+  void SetNumberOfWorkers(unsigned int n);
+
+  /** Get / Set whether worker i is pinned to the i-th allowed processor and
+   * tasks are distributed in contiguous blocks without stealing. The default is
+   * false unless the environment variable RTK_PIN_THREADS is 1. Setting it
+   * restarts the workers as SetNumberOfWorkers. Pinning is only supported on
+   * Linux and Windows. */
+  bool GetThreadPinning() const;
+  void SetThreadPinning(bool pinning);
+  itkBooleanMacro(ThreadPinning);
+
+  /** Get / Set whether rtk::ThreadPoolImageFilter dispatches onto the pool.
+   * The default is true unless the environment variable RTK_THREAD_POOL is 0. */
+  static bool GetGlobalDefaultEnabled();
+  static void SetGlobalDefaultEnabled(bool enabled);
+
+  /** Statistics of the pool: number of calls to ParallelFor and number of
+   * tasks executed by another thread than the one they were given to. */
+  itk::SizeValueType GetNumberOfParallelFors() const;
+  itk::SizeValueType GetNumberOfStolenTasks() const;
+
+protected:
+  ThreadPool();
+  virtual ~ThreadPool();
+  virtual void PrintSelf(std::ostream & os, itk::Indent indent) const;
+
+  /** Group of tasks of one call to ParallelFor */
+  struct BatchType
+  {
+    TaskFunctionType                Function;
+    void *                          UserData;
+    unsigned int                    NumberOfTasks;
+    unsigned int                    NumberOfRemainingTasks;
+    std::string                     ErrorDescription;
+    itk::ConditionVariable::Pointer Completed;
+  };
+
+  /** Task of a queue */
+  struct TaskType
+  {
+    BatchType *  Batch;
+    unsigned int TaskId;
+  };
+
+  /** Queue of tasks of a worker */
+  struct WorkerQueueType
+  {
+    itk::SimpleFastMutexLock Mutex;
+    std::deque<TaskType>     Tasks;
+  };
+
+  /** Start and join the worker threads */
+  void StartWorkers(unsigned int n);
+  void StopWorkers();
+
+  /** Restart the workers with a new configuration once no ParallelFor is
+   * running */
+  void RestartWorkers(unsigned int n, bool pinning);
+
+  /** Register a running ParallelFor, waiting for the end of a restart of the
+   * workers, and unregister it */
+  void BeginParallelFor();
+  void EndParallelFor();
+
+  /** Body of ParallelFor */
+  void RunParallelFor(unsigned int numberOfTasks, TaskFunctionType function, void *userData);
+
+  /** Pop a task from the queue of worker (if it is a worker) or, unless the
+   * workers are pinned, steal one from the other queues. Returns false if no
+   * task has been found. */
+  bool PopTask(int worker, TaskType &task);
+
+  /** Whether worker has tasks to execute. Must be called with m_Mutex locked. */
+  bool HasQueuedTasks(int worker);
+
+  /** Run a task and signal the completion of its batch */
+  void RunTask(const TaskType &task);
+
+  /** Main function of the worker threads */
+  static ITK_THREAD_RETURN_TYPE WorkerCallback(void *arg);
+
+private:
+  ThreadPool(const Self &);     //purposely not implemented
+  void operator=(const Self &); //purposely not implemented
+
+  static Pointer m_Instance;
+  static bool    m_GlobalDefaultEnabled;
+
+  itk::MultiThreader::Pointer   m_Threader;
+  std::vector<ThreadIdType>     m_ThreadIds;
+  std::vector<WorkerQueueType*> m_Queues;
+  unsigned int                  m_NextQueue;
+  bool                          m_ThreadPinning;
+  std::vector<unsigned int>     m_Processors;
+
+  /** Configuration of the workers, protected by m_ConfigurationMutex */
+  mutable itk::SimpleMutexLock    m_ConfigurationMutex;
+  itk::ConditionVariable::Pointer m_ConfigurationChanged;
+  unsigned int                    m_NumberOfRunningParallelFors;
+  bool                            m_Restarting;
+
+  /** State shared by the workers, protected by m_Mutex */
+  mutable itk::SimpleMutexLock    m_Mutex;
+  itk::ConditionVariable::Pointer m_TasksAvailable;
+  int                             m_NumberOfQueuedTasks;
+  unsigned int                    m_NumberOfStartedWorkers;
+  bool                            m_Stop;
+  itk::SizeValueType              m_NumberOfParallelFors;
+  itk::SizeValueType              m_NumberOfStolenTasks;
+};
+
+} // end namespace rtk
+
+#endif
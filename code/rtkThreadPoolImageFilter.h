@@ -0,0 +1,96 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkThreadPoolImageFilter_h
+#define __rtkThreadPoolImageFilter_h
+
+#include "rtkThreadPool.h"
+
+namespace rtk
+{
+
+/** \class ThreadPoolImageFilter
+ * \brief Dispatches the ThreadedGenerateData of an image filter onto the
+ * rtk::ThreadPool instead of spawning threads with itk::MultiThreader.
+ *
+ * The adapter derives from the filter TFilter and only replaces the default
+ * GenerateData of itk::ImageSource: the output is allocated, then
+ * BeforeThreadedGenerateData is called, each piece of the requested region
+ * given by SplitRequestedRegion is a task of the pool whose id is passed as
+ * the threadId of ThreadedGenerateData and AfterThreadedGenerateData is
+ * called once all pieces are done. The filter is therefore used in place of
+ * TFilter without any modification, e.g.,
+ * \code
+ * typename BackProjectionFilterType::Pointer bp =
+ *   ThreadPoolImageFilter< BackProjectionFilterType >::New();
+ * \endcode
+ * The name of the class is that of TFilter. Filters which override
+ * GenerateData, e.g., rtk::JosephBackProjectionImageFilter and
+ * rtk::NormalizedJosephBackProjectionImageFilter which splat the rays
+ * sequentially, must not be wrapped since their GenerateData would be
+ * skipped.
+ *
+ * Filters whose ThreadedGenerateData synchronizes its threads, e.g., with an
+ * itk::Barrier as rtk::ConjugateGradientGetR_kPlusOneImageFilter, must not be
+ * wrapped either: the pieces are tasks of the pool which are not guaranteed
+ * to run concurrently, so that a piece waiting for the others may never be
+ * released.
+ *
+ * If the pool is disabled (see ThreadPool::SetGlobalDefaultEnabled), the
+ * GenerateData of TFilter is used.
+ *
+ * \test rtkthreadpooltest.cxx
+ *
+ * \ingroup ImageToImageFilter
+ */
+template<class TFilter>
+class ThreadPoolImageFilter : public TFilter
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadPoolImageFilter           Self;
+  typedef TFilter                         Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+protected:
+  ThreadPoolImageFilter() {}
+  ~ThreadPoolImageFilter() {}
+
+  virtual void GenerateData();
+
+  /** Task of the pool computing one piece of the requested region */
+  static void ThreadPoolCallback(void *arg, unsigned int taskId, unsigned int numberOfTasks);
+
+private:
+  ThreadPoolImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&);        //purposely not implemented
+};
+
+} // end namespace rtk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "rtkThreadPoolImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkThreadPoolImageFilter_hxx
+#define __rtkThreadPoolImageFilter_hxx
+
+namespace rtk
+{
+
+template<class TFilter>
+void
+ThreadPoolImageFilter<TFilter>
+::GenerateData()
+{
+  if( !ThreadPool::GetGlobalDefaultEnabled() )
+    {
+    Superclass::GenerateData();
+    return;
+    }
+
+  this->AllocateOutputs();
+  this->BeforeThreadedGenerateData();
+
+  // Same pieces as with itk::MultiThreader
+  OutputImageRegionType splitRegion;
+  const unsigned int numberOfPieces = this->SplitRequestedRegion(0, this->GetNumberOfThreads(), splitRegion);
+  ThreadPool::GetInstance()->ParallelFor(numberOfPieces, ThreadPoolCallback, this);
+
+  this->AfterThreadedGenerateData();
+}
+
+template<class TFilter>
+void
+ThreadPoolImageFilter<TFilter>
+::ThreadPoolCallback(void *arg, unsigned int taskId, unsigned int numberOfTasks)
+{
+  Self *filter = static_cast<Self *>(arg);
+  OutputImageRegionType splitRegion;
+  filter->SplitRequestedRegion(taskId, numberOfTasks, splitRegion);
+  filter->ThreadedGenerateData(splitRegion, taskId);
+}
+
+} // end namespace rtk
+
+#endif
@@ -20,7 +20,6 @@
 #include "rtkMacro.h"
 
 #include <algorithm>
-#include <itkCenteredEuler3DTransform.h>
 
 double rtk::ThreeDCircularProjectionGeometry::ConvertAngleBetween0And360Degrees(const double a)
 {
@@ -84,20 +83,116 @@ void rtk::ThreeDCircularProjectionGeometry::AddProjectionInRadians(
     this->GetRotationMatrices().back().GetVnlMatrix();
   this->AddMatrix(matrix);
 
-  // Calculate source angle
+  // Cache the inverse matrices and calculate source angle
+  const unsigned int i = m_GantryAngles.size()-1;
+  m_SourcePositions.push_back( ComputeSourcePosition(i) );
+  m_ProjectionCoordinatesToFixedSystemMatrices.push_back( ComputeProjectionCoordinatesToFixedSystemMatrix(i) );
+  m_SourceAngles.push_back( ComputeSourceAngle( m_SourcePositions.back() ) );
+
+  this->Modified();
+}
+
+void rtk::ThreeDCircularProjectionGeometry::AddProjectionsInRadians(
+  const std::vector<double> &sids,
+  const std::vector<double> &sdds,
+  const std::vector<double> &gantryAngles,
+  const std::vector<double> &projOffsetsX,
+  const std::vector<double> &projOffsetsY,
+  const std::vector<double> &outOfPlaneAngles,
+  const std::vector<double> &inPlaneAngles,
+  const std::vector<double> &sourceOffsetsX,
+  const std::vector<double> &sourceOffsetsY)
+{
+  const unsigned int nNew = gantryAngles.size();
+  const std::vector<double> *optional[6] = { &projOffsetsX, &projOffsetsY,
+                                             &outOfPlaneAngles, &inPlaneAngles,
+                                             &sourceOffsetsX, &sourceOffsetsY };
+  if(sids.size() != nNew || sdds.size() != nNew)
+    itkExceptionMacro(<< "The vectors of source to isocenter and source to detector distances must have the size of the vector of gantry angles.");
+  for(unsigned int p=0; p<6; p++)
+    if(!optional[p]->empty() && optional[p]->size() != nNew)
+      itkExceptionMacro(<< "Optional vectors of parameters must be empty or have the size of the vector of gantry angles.");
+  if(nNew == 0)
+    return;
+
+  // Avoid successive reallocations
+  const unsigned int nProj = m_GantryAngles.size() + nNew;
+  m_GantryAngles.reserve(nProj);
+  m_OutOfPlaneAngles.reserve(nProj);
+  m_InPlaneAngles.reserve(nProj);
+  m_SourceAngles.reserve(nProj);
+  m_SourceToIsocenterDistances.reserve(nProj);
+  m_SourceOffsetsX.reserve(nProj);
+  m_SourceOffsetsY.reserve(nProj);
+  m_SourceToDetectorDistances.reserve(nProj);
+  m_ProjectionOffsetsX.reserve(nProj);
+  m_ProjectionOffsetsY.reserve(nProj);
+  m_ProjectionTranslationMatrices.reserve(nProj);
+  m_MagnificationMatrices.reserve(nProj);
+  m_RotationMatrices.reserve(nProj);
+  m_SourceTranslationMatrices.reserve(nProj);
+  m_SourcePositions.reserve(nProj);
+  m_ProjectionCoordinatesToFixedSystemMatrices.reserve(nProj);
+
+  for(unsigned int i=0; i<nNew; i++)
+    {
+    const double sid = sids[i];
+    const double sdd = sdds[i];
+    const double gantryAngle = gantryAngles[i];
+    const double projOffsetX = (projOffsetsX.empty())?0.:projOffsetsX[i];
+    const double projOffsetY = (projOffsetsY.empty())?0.:projOffsetsY[i];
+    const double outOfPlaneAngle = (outOfPlaneAngles.empty())?0.:outOfPlaneAngles[i];
+    const double inPlaneAngle = (inPlaneAngles.empty())?0.:inPlaneAngles[i];
+    const double sourceOffsetX = (sourceOffsetsX.empty())?0.:sourceOffsetsX[i];
+    const double sourceOffsetY = (sourceOffsetsY.empty())?0.:sourceOffsetsY[i];
+
+    m_GantryAngles.push_back( ConvertAngleBetween0And2PIRadians(gantryAngle) );
+    m_OutOfPlaneAngles.push_back( ConvertAngleBetween0And2PIRadians(outOfPlaneAngle) );
+    m_InPlaneAngles.push_back( ConvertAngleBetween0And2PIRadians(inPlaneAngle) );
+    m_SourceToIsocenterDistances.push_back( sid );
+    m_SourceOffsetsX.push_back( sourceOffsetX );
+    m_SourceOffsetsY.push_back( sourceOffsetY );
+    m_SourceToDetectorDistances.push_back( sdd );
+    m_ProjectionOffsetsX.push_back( projOffsetX );
+    m_ProjectionOffsetsY.push_back( projOffsetY );
+
+    // Sub-matrices, pushed directly to avoid one modification per matrix
+    m_ProjectionTranslationMatrices.push_back( ComputeTranslationHomogeneousMatrix(sourceOffsetX-projOffsetX, sourceOffsetY-projOffsetY) );
+    m_MagnificationMatrices.push_back( ComputeProjectionMagnificationMatrix(-sdd, -sid) );
+    m_RotationMatrices.push_back( ComputeRotationHomogeneousMatrix(-outOfPlaneAngle, -gantryAngle, -inPlaneAngle) );
+    m_SourceTranslationMatrices.push_back( ComputeTranslationHomogeneousMatrix(-sourceOffsetX, -sourceOffsetY, 0.) );
+
+    Superclass::MatrixType matrix;
+    matrix =
+      m_ProjectionTranslationMatrices.back().GetVnlMatrix() *
+      m_MagnificationMatrices.back().GetVnlMatrix() *
+      m_SourceTranslationMatrices.back().GetVnlMatrix()*
+      m_RotationMatrices.back().GetVnlMatrix();
+    this->AddMatrix(matrix);
+
+    // Source position, inverse matrix and source angle
+    const unsigned int iProj = m_GantryAngles.size()-1;
+    m_SourcePositions.push_back( ComputeSourcePosition(iProj) );
+    m_ProjectionCoordinatesToFixedSystemMatrices.push_back( ComputeProjectionCoordinatesToFixedSystemMatrix(iProj) );
+    m_SourceAngles.push_back( ComputeSourceAngle( m_SourcePositions.back() ) );
+    }
+
+  this->Modified();
+}
+
+double rtk::ThreeDCircularProjectionGeometry::ComputeSourceAngle(const HomogeneousVectorType &sourcePosition)
+{
   VectorType z;
   z.Fill(0.);
   z[2] = 1.;
-  HomogeneousVectorType sph = GetSourcePosition( m_GantryAngles.size()-1 );
+  HomogeneousVectorType sph = sourcePosition;
   sph[1] = 0.; // Project position to central plane
   VectorType sp( &(sph[0]) );
   sp.Normalize();
   double a = acos(sp*z);
   if(sp[0] > 0.)
     a = 2. * vnl_math::pi - a;
-  m_SourceAngles.push_back( ConvertAngleBetween0And2PIRadians(a) );
-
-  this->Modified();
+  return ConvertAngleBetween0And2PIRadians(a);
 }
 
 void rtk::ThreeDCircularProjectionGeometry::Clear()
@@ -119,6 +214,8 @@ void rtk::ThreeDCircularProjectionGeometry::Clear()
   m_MagnificationMatrices.clear();
   m_RotationMatrices.clear();
   m_SourceTranslationMatrices.clear();
+  m_SourcePositions.clear();
+  m_ProjectionCoordinatesToFixedSystemMatrices.clear();
   this->Modified();
 }
 
@@ -252,16 +349,38 @@ ComputeRotationHomogeneousMatrix(double angleX,
                                  double angleY,
                                  double angleZ)
 {
-  typedef itk::CenteredEuler3DTransform<double> ThreeDTransformType;
-  ThreeDTransformType::Pointer xfm = ThreeDTransformType::New();
-  xfm->SetIdentity();
-  xfm->SetRotation( angleX, angleY, angleZ );
+  // Same computation as itk::Euler3DTransform with the ZXY convention but
+  // without the cost of creating a transform through the object factory.
+  typedef itk::Matrix<double, 3, 3> RotationType;
+  const double cx = vcl_cos(angleX);
+  const double sx = vcl_sin(angleX);
+  const double cy = vcl_cos(angleY);
+  const double sy = vcl_sin(angleY);
+  const double cz = vcl_cos(angleZ);
+  const double sz = vcl_sin(angleZ);
+
+  RotationType rotationX;
+  rotationX[0][0] = 1.; rotationX[0][1] = 0.; rotationX[0][2] = 0.;
+  rotationX[1][0] = 0.; rotationX[1][1] = cx; rotationX[1][2] = -sx;
+  rotationX[2][0] = 0.; rotationX[2][1] = sx; rotationX[2][2] = cx;
+
+  RotationType rotationY;
+  rotationY[0][0] = cy;  rotationY[0][1] = 0.; rotationY[0][2] = sy;
+  rotationY[1][0] = 0.;  rotationY[1][1] = 1.; rotationY[1][2] = 0.;
+  rotationY[2][0] = -sy; rotationY[2][1] = 0.; rotationY[2][2] = cy;
+
+  RotationType rotationZ;
+  rotationZ[0][0] = cz; rotationZ[0][1] = -sz; rotationZ[0][2] = 0.;
+  rotationZ[1][0] = sz; rotationZ[1][1] = cz;  rotationZ[1][2] = 0.;
+  rotationZ[2][0] = 0.; rotationZ[2][1] = 0.;  rotationZ[2][2] = 1.;
+
+  const RotationType rotation = rotationZ * rotationX * rotationY;
 
   ThreeDHomogeneousMatrixType matrix;
   matrix.SetIdentity();
   for(int i=0; i<3; i++)
     for(int j=0; j<3; j++)
-      matrix[i][j] = xfm->GetMatrix()[i][j];
+      matrix[i][j] = rotation[i][j];
 
   return matrix;
 }
@@ -307,7 +426,7 @@ ComputeProjectionMagnificationMatrix(double sdd, const double sid)
 
 const rtk::ThreeDCircularProjectionGeometry::HomogeneousVectorType
 rtk::ThreeDCircularProjectionGeometry::
-GetSourcePosition(const unsigned int i) const
+ComputeSourcePosition(const unsigned int i) const
 {
   HomogeneousVectorType sourcePosition;
   sourcePosition[0] = this->GetSourceOffsetsX()[i];
@@ -315,14 +434,14 @@ GetSourcePosition(const unsigned int i) const
   sourcePosition[2] = this->GetSourceToIsocenterDistances()[i];
   sourcePosition[3] = 1.;
 
-  // Rotate
-  sourcePosition.SetVnlVector(GetRotationMatrices()[i].GetInverse() * sourcePosition.GetVnlVector());
+  // Rotate, the inverse of the rotation is its transpose
+  sourcePosition.SetVnlVector(GetRotationMatrices()[i].GetTranspose() * sourcePosition.GetVnlVector());
   return sourcePosition;
 }
 
 const rtk::ThreeDCircularProjectionGeometry::ThreeDHomogeneousMatrixType
 rtk::ThreeDCircularProjectionGeometry::
-GetProjectionCoordinatesToFixedSystemMatrix(const unsigned int i) const
+ComputeProjectionCoordinatesToFixedSystemMatrix(const unsigned int i) const
 {
   // Compute projection inverse and distance to source
   ThreeDHomogeneousMatrixType matrix;
@@ -332,11 +451,31 @@ GetProjectionCoordinatesToFixedSystemMatrix(const unsigned int i) const
   matrix[2][3] = this->GetSourceToIsocenterDistances()[i]-this->GetSourceToDetectorDistances()[i];
   matrix[2][2] = 0.; // Force z to axis to detector distance
 
-  // Rotate
-  matrix = this->GetRotationMatrices()[i].GetInverse() * matrix.GetVnlMatrix();
+  // Rotate, the inverse of the rotation is its transpose
+  matrix = this->GetRotationMatrices()[i].GetTranspose() * matrix.GetVnlMatrix();
   return matrix;
 }
 
+const rtk::ThreeDCircularProjectionGeometry::HomogeneousVectorType
+rtk::ThreeDCircularProjectionGeometry::
+GetSourcePosition(const unsigned int i) const
+{
+  if(i >= m_SourcePositions.size())
+    itkExceptionMacro(<< "Requested source position of projection " << i
+                      << " but the geometry has " << m_SourcePositions.size() << " projections.");
+  return m_SourcePositions[i];
+}
+
+const rtk::ThreeDCircularProjectionGeometry::ThreeDHomogeneousMatrixType
+rtk::ThreeDCircularProjectionGeometry::
+GetProjectionCoordinatesToFixedSystemMatrix(const unsigned int i) const
+{
+  if(i >= m_ProjectionCoordinatesToFixedSystemMatrices.size())
+    itkExceptionMacro(<< "Requested matrix of projection " << i
+                      << " but the geometry has " << m_ProjectionCoordinatesToFixedSystemMatrices.size() << " projections.");
+  return m_ProjectionCoordinatesToFixedSystemMatrices[i];
+}
+
 
 double
 rtk::ThreeDCircularProjectionGeometry::
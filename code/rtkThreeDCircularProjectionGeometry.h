@@ -41,6 +41,12 @@ namespace rtk
  *
  * If SDD equals 0., then one is dealing with a parallel geometry.
  *
+ * The source positions and the matrices of
+ * GetProjectionCoordinatesToFixedSystemMatrix are computed when the
+ * projections are added and stored with the other matrices, so that the
+ * accessors only read the geometry and can be called concurrently by the
+ * threads of the projectors.
+ *
  * \author Simon Rit
  *
  * \ingroup ProjectionGeometry
@@ -76,6 +82,22 @@ public:
                                       const double outOfPlaneAngle=0., const double inPlaneAngle=0.,
                                       const double sourceOffsetX=0., const double sourceOffsetY=0.);
 
+  /** Add a set of projections at once with angles in radians. All vectors
+   * must have the same size, except the vectors of parameters which default to
+   * 0. in AddProjectionInRadians that can also be empty. All the matrices are
+   * computed in a single pass and the geometry is only modified once, which is
+   * much faster than successive calls to AddProjectionInRadians for large
+   * acquisitions. */
+  void AddProjectionsInRadians(const std::vector<double> &sids,
+                               const std::vector<double> &sdds,
+                               const std::vector<double> &gantryAngles,
+                               const std::vector<double> &projOffsetsX=std::vector<double>(),
+                               const std::vector<double> &projOffsetsY=std::vector<double>(),
+                               const std::vector<double> &outOfPlaneAngles=std::vector<double>(),
+                               const std::vector<double> &inPlaneAngles=std::vector<double>(),
+                               const std::vector<double> &sourceOffsetsX=std::vector<double>(),
+                               const std::vector<double> &sourceOffsetsY=std::vector<double>());
+
   /** Empty the geometry object. */
   virtual void Clear() ITK_OVERRIDE;
 
@@ -216,6 +238,15 @@ protected:
     this->Modified();
   }
 
+  /** Compute the source position and the projection coordinates to fixed
+   * system matrix of the ith projection from its sub-matrices. */
+  const HomogeneousVectorType ComputeSourcePosition(const unsigned int i) const;
+  const ThreeDHomogeneousMatrixType ComputeProjectionCoordinatesToFixedSystemMatrix(const unsigned int i) const;
+
+  /** Compute the source angle from the source position in homogeneous
+   * coordinates, see GetSourceAngles. */
+  static double ComputeSourceAngle(const HomogeneousVectorType &sourcePosition);
+
   /** Circular geometry parameters per projection (angles in degrees between 0
     and 360). */
   std::vector<double> m_GantryAngles;
@@ -234,6 +265,11 @@ protected:
   std::vector<ThreeDHomogeneousMatrixType>       m_RotationMatrices;
   std::vector<ThreeDHomogeneousMatrixType>       m_SourceTranslationMatrices;
 
+  /** Source positions and projection coordinates to fixed system matrices,
+   * computed once per projection. */
+  std::vector<HomogeneousVectorType>             m_SourcePositions;
+  std::vector<ThreeDHomogeneousMatrixType>       m_ProjectionCoordinatesToFixedSystemMatrices;
+
 private:
   ThreeDCircularProjectionGeometry(const Self&); //purposely not implemented
   void operator=(const Self&);                   //purposely not implemented
@@ -0,0 +1,127 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkThreeDCircularProjectionGeometryBinaryFile.h"
+
+#include <itkByteSwapper.h>
+
+#include <fstream>
+#include <cstring>
+
+namespace rtk
+{
+
+ThreeDCircularProjectionGeometryBinaryFileReader::
+ThreeDCircularProjectionGeometryBinaryFileReader():
+  m_Geometry(GeometryType::New() )
+{
+}
+
+bool
+ThreeDCircularProjectionGeometryBinaryFileReader::
+CanReadFile(const char* name)
+{
+  std::ifstream is(name, std::ios::in | std::ios::binary);
+  if( !is.is_open() )
+    return false;
+
+  char magic[8];
+  is.read(magic, 8);
+  return is.good() && std::memcmp(magic, GetMagicString(), 8) == 0;
+}
+
+void
+ThreeDCircularProjectionGeometryBinaryFileReader::
+GenerateOutputInformation()
+{
+  std::ifstream is(m_Filename.c_str(), std::ios::in | std::ios::binary);
+  if( !is.is_open() )
+    itkExceptionMacro(<< "Could not open file " << m_Filename);
+
+  char magic[8];
+  is.read(magic, 8);
+  if( !is.good() || std::memcmp(magic, GetMagicString(), 8) != 0 )
+    itkExceptionMacro(<< m_Filename << " is not an RTK binary geometry file");
+
+  itk::uint32_t header[2];
+  is.read(reinterpret_cast<char*>(header), sizeof(header) );
+  itk::ByteSwapper<itk::uint32_t>::SwapRangeFromSystemToLittleEndian(header, 2);
+  if( !is.good() )
+    itkExceptionMacro(<< "Could not read the header of " << m_Filename);
+  if( header[0] > CurrentVersion )
+    itkExceptionMacro(<< "Version " << header[0] << " of " << m_Filename
+                      << " is more recent than the version of RTK (" << CurrentVersion << ')');
+
+  const itk::uint32_t nProj = header[1];
+  std::vector<double> parameters[NumberOfParameters];
+  for(unsigned int p=0; p<NumberOfParameters && nProj; p++)
+    {
+    parameters[p].resize(nProj);
+    is.read(reinterpret_cast<char*>(&(parameters[p][0])), nProj*sizeof(double) );
+    itk::ByteSwapper<double>::SwapRangeFromSystemToLittleEndian(&(parameters[p][0]), nProj);
+    }
+  if( !is.good() )
+    itkExceptionMacro(<< "File " << m_Filename << " is truncated");
+
+  m_Geometry->AddProjectionsInRadians(parameters[0], parameters[1], parameters[2],
+                                      parameters[3], parameters[4], parameters[5],
+                                      parameters[6], parameters[7], parameters[8]);
+}
+
+void
+ThreeDCircularProjectionGeometryBinaryFileWriter::
+WriteFile()
+{
+  if( m_Object.IsNull() )
+    itkExceptionMacro(<< "No geometry to write");
+
+  std::ofstream os(m_Filename.c_str(), std::ios::out | std::ios::binary);
+  if( !os.is_open() )
+    itkExceptionMacro(<< "Could not open file " << m_Filename << " for writing");
+
+  os.write(ThreeDCircularProjectionGeometryBinaryFileReader::GetMagicString(), 8);
+
+  const unsigned int nProj = m_Object->GetGantryAngles().size();
+  itk::uint32_t header[2];
+  header[0] = ThreeDCircularProjectionGeometryBinaryFileReader::CurrentVersion;
+  header[1] = nProj;
+  itk::ByteSwapper<itk::uint32_t>::SwapRangeFromSystemToLittleEndian(header, 2);
+  os.write(reinterpret_cast<const char*>(header), sizeof(header) );
+
+  const std::vector<double> *parameters[ThreeDCircularProjectionGeometryBinaryFileReader::NumberOfParameters] =
+    { &(m_Object->GetSourceToIsocenterDistances()),
+      &(m_Object->GetSourceToDetectorDistances()),
+      &(m_Object->GetGantryAngles()),
+      &(m_Object->GetProjectionOffsetsX()),
+      &(m_Object->GetProjectionOffsetsY()),
+      &(m_Object->GetOutOfPlaneAngles()),
+      &(m_Object->GetInPlaneAngles()),
+      &(m_Object->GetSourceOffsetsX()),
+      &(m_Object->GetSourceOffsetsY()) };
+  for(unsigned int p=0; p<ThreeDCircularProjectionGeometryBinaryFileReader::NumberOfParameters && nProj; p++)
+    {
+    std::vector<double> buffer( *(parameters[p]) );
+    itk::ByteSwapper<double>::SwapRangeFromSystemToLittleEndian(&(buffer[0]), nProj);
+    os.write(reinterpret_cast<const char*>(&(buffer[0])), nProj*sizeof(double) );
+    }
+
+  if( !os.good() )
+    itkExceptionMacro(<< "Could not write file " << m_Filename);
+}
+
+} // end namespace rtk
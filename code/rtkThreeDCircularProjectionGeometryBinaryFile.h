@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkThreeDCircularProjectionGeometryBinaryFile_h
+#define __rtkThreeDCircularProjectionGeometryBinaryFile_h
+
+#include "rtkWin32Header.h"
+#include "rtkThreeDCircularProjectionGeometry.h"
+
+#include <itkIntTypes.h>
+
+namespace rtk
+{
+
+/** \class ThreeDCircularProjectionGeometryBinaryFileReader
+ *
+ * Reads a binary file containing geometry for reconstruction. The file
+ * starts with the 8 characters "RTKGEOB\n", followed by the version of the
+ * format and the number of projections as two 32-bit unsigned integers. The
+ * nine parameters of ThreeDCircularProjectionGeometry::AddProjectionInRadians
+ * then follow, one array of doubles per parameter in the order SID, SDD,
+ * gantry angle, projection offset x, projection offset y, out of plane angle,
+ * in plane angle, source offset x and source offset y. Angles are in radians
+ * and all values are stored in little endian.
+ *
+ * The projections are added to the geometry with
+ * ThreeDCircularProjectionGeometry::AddProjectionsInRadians so that large
+ * geometries are read in a fraction of the time of the XML format. Note that
+ * ThreeDCircularProjectionGeometryXMLFileReader also reads binary files with
+ * this reader.
+ *
+ * \test rtkgeometryfiletest.cxx
+ *
+ * \ingroup IOFilters
+ */
+class RTK_EXPORT ThreeDCircularProjectionGeometryBinaryFileReader :
+  public itk::Object
+{
+public:
+  /** Standard typedefs */
+  typedef ThreeDCircularProjectionGeometryBinaryFileReader Self;
+  typedef itk::Object                                      Superclass;
+  typedef itk::SmartPointer<Self>                          Pointer;
+
+  /** Convenient typedefs */
+  typedef ThreeDCircularProjectionGeometry GeometryType;
+  typedef GeometryType::Pointer            GeometryPointer;
+
+  /** Latest version */
+  static const unsigned int CurrentVersion = 1;
+
+  /** Number of parameters per projection */
+  static const unsigned int NumberOfParameters = 9;
+
+  /** Header of the files */
+  static const char *GetMagicString() { return "RTKGEOB\n"; }
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreeDCircularProjectionGeometryBinaryFileReader, itk::Object);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Get / Set the file name */
+  itkSetStringMacro(Filename);
+  itkGetStringMacro(Filename);
+
+  /** Determine if a file can be read, i.e., if it starts with the magic
+   * string. */
+  static bool CanReadFile(const char* name);
+
+  /** Get / Set the geometry to which the projections of the file are added.
+   * An empty geometry is created by the constructor. */
+  itkGetMacro(Geometry, GeometryPointer);
+  itkSetMacro(Geometry, GeometryPointer);
+
+  /** Read the file and add its projections to the geometry. The name mimics
+   * the API of ThreeDCircularProjectionGeometryXMLFileReader. */
+  void GenerateOutputInformation();
+
+protected:
+  ThreeDCircularProjectionGeometryBinaryFileReader();
+  ~ThreeDCircularProjectionGeometryBinaryFileReader() {}
+
+private:
+  //purposely not implemented
+  ThreeDCircularProjectionGeometryBinaryFileReader(const Self&);
+  void operator=(const Self&);
+
+  std::string     m_Filename;
+  GeometryPointer m_Geometry;
+};
+
+/** \class ThreeDCircularProjectionGeometryBinaryFileWriter
+ *
+ * Writes a binary file containing geometry for reconstruction, see
+ * ThreeDCircularProjectionGeometryBinaryFileReader for the format. Contrary
+ * to the XML format, the parameters are written without loss of precision.
+ *
+ * \test rtkgeometryfiletest.cxx
+ *
+ * \ingroup IOFilters
+ */
+class RTK_EXPORT ThreeDCircularProjectionGeometryBinaryFileWriter :
+  public itk::Object
+{
+public:
+  /** Standard typedefs */
+  typedef ThreeDCircularProjectionGeometryBinaryFileWriter Self;
+  typedef itk::Object                                      Superclass;
+  typedef itk::SmartPointer<Self>                          Pointer;
+
+  /** Convenient typedefs */
+  typedef ThreeDCircularProjectionGeometry GeometryType;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreeDCircularProjectionGeometryBinaryFileWriter, itk::Object);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Get / Set the file name */
+  itkSetStringMacro(Filename);
+  itkGetStringMacro(Filename);
+
+  /** Set the geometry to write */
+  void SetObject(const GeometryType *geometry) { m_Object = geometry; }
+
+  /** Actually write out the file */
+  void WriteFile();
+
+protected:
+  ThreeDCircularProjectionGeometryBinaryFileWriter() {}
+  ~ThreeDCircularProjectionGeometryBinaryFileWriter() {}
+
+private:
+  //purposely not implemented
+  ThreeDCircularProjectionGeometryBinaryFileWriter(const Self&);
+  void operator=(const Self&);
+
+  std::string                m_Filename;
+  GeometryType::ConstPointer         m_Object;
+};
+}
+
+#endif
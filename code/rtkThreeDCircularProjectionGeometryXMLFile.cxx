@@ -20,6 +20,7 @@
 #define _rtkThreeDCircularProjectionGeometryXMLFile_cxx
 
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkThreeDCircularProjectionGeometryBinaryFile.h"
 
 #include <itksys/SystemTools.hxx>
 #include <itkMetaDataObject.h>
@@ -59,6 +60,22 @@ CanReadFile(const char *name)
   return 1;
 }
 
+void
+ThreeDCircularProjectionGeometryXMLFileReader::
+GenerateOutputInformation()
+{
+  if( ThreeDCircularProjectionGeometryBinaryFileReader::CanReadFile(m_Filename.c_str()) )
+    {
+    ThreeDCircularProjectionGeometryBinaryFileReader::Pointer binaryReader;
+    binaryReader = ThreeDCircularProjectionGeometryBinaryFileReader::New();
+    binaryReader->SetFilename(m_Filename);
+    binaryReader->SetGeometry(this->m_OutputObject);
+    binaryReader->GenerateOutputInformation();
+    }
+  else
+    Superclass::GenerateOutputInformation();
+}
+
 void
 ThreeDCircularProjectionGeometryXMLFileReader::
 StartElement(const char * name,const char **atts)
@@ -164,8 +181,7 @@ void
 ThreeDCircularProjectionGeometryXMLFileReader::
 CharacterDataHandler(const char *inData, int inLength)
 {
-  for(int i = 0; i < inLength; i++)
-    m_CurCharacterData = m_CurCharacterData + inData[i];
+  m_CurCharacterData.append(inData, inLength);
 }
 
 int
@@ -32,7 +32,9 @@ namespace rtk
 
 /** \class ThreeDCircularProjectionGeometryXMLFileReader
  *
- * Reads an XML-format file containing geometry for reconstruction
+ * Reads an XML-format file containing geometry for reconstruction. Binary
+ * geometry files written by ThreeDCircularProjectionGeometryBinaryFileWriter
+ * are detected and read transparently.
  *
  * \test rtkgeometryfiletest.cxx, rtkvariantest.cxx, rtkxradtest.cxx,
  * rtkdigisenstest.cxx, rtkelektatest.cxx
@@ -69,6 +71,11 @@ public:
   /** Get smart pointer to projection geometry. */
   itkGetMacro(Geometry, GeometryPointer);
 
+  /** Parse the file. Files in the binary format of
+   * ThreeDCircularProjectionGeometryBinaryFileReader are also accepted and
+   * read with this reader. */
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
 protected:
   ThreeDCircularProjectionGeometryXMLFileReader();
   ~ThreeDCircularProjectionGeometryXMLFileReader() { };
@@ -0,0 +1,519 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkTraceCollector.h"
+
+#include <itkObjectFactory.h>
+#include <itkCommand.h>
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <algorithm>
+#include <cstring>
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+# define RTK_THREAD_LOCAL __declspec(thread)
+#else
+# define RTK_THREAD_LOCAL __thread
+#endif
+
+namespace rtk
+{
+TraceCollector::Pointer TraceCollector::m_Instance = ITK_NULLPTR;
+
+namespace
+{
+/** Buffer of the calling thread */
+RTK_THREAD_LOCAL TraceCollector::LockedThreadBufferType *currentThreadBuffer = ITK_NULLPTR;
+
+/** Protects the creation of the singleton */
+itk::SimpleFastMutexLock instanceMutex;
+
+/** Singleton without reference counting for the spans, published once it is
+ * constructed */
+TraceCollector *rawInstance = ITK_NULLPTR;
+
+/** Atomic accesses to the flags and to rawInstance, with acquire and
+ * release semantics */
+#if defined(_MSC_VER)
+long AtomicLoad(long *value)
+{
+  return _InterlockedCompareExchange(value, 0, 0);
+}
+void AtomicStore(long *value, long newValue)
+{
+  _InterlockedExchange(value, newValue);
+}
+TraceCollector *AtomicLoad(TraceCollector **pointer)
+{
+  return static_cast<TraceCollector *>(
+    _InterlockedCompareExchangePointer(reinterpret_cast<void * volatile *>(pointer), ITK_NULLPTR, ITK_NULLPTR) );
+}
+void AtomicStore(TraceCollector **pointer, TraceCollector *newPointer)
+{
+  _InterlockedExchangePointer(reinterpret_cast<void * volatile *>(pointer), newPointer);
+}
+#else
+long AtomicLoad(long *value)
+{
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+void AtomicStore(long *value, long newValue)
+{
+  __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+TraceCollector *AtomicLoad(TraceCollector **pointer)
+{
+  return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+void AtomicStore(TraceCollector **pointer, TraceCollector *newPointer)
+{
+  __atomic_store_n(pointer, newPointer, __ATOMIC_RELEASE);
+}
+#endif
+
+/** Singleton if it records spans, NULL otherwise. The singleton is only
+ * created, with the lock, the first time. */
+TraceCollector *GetRecordingInstance()
+{
+  TraceCollector *collector = AtomicLoad(&rawInstance);
+  if( !collector )
+    collector = TraceCollector::GetInstance().GetPointer();
+  return (collector->GetEnabled())?collector:ITK_NULLPTR;
+}
+
+/** Command observing the StartEvent and EndEvent of watched process objects */
+class TraceWatchCommand : public itk::Command
+{
+public:
+  typedef TraceWatchCommand         Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro(Self);
+
+  virtual void Execute(itk::Object *caller, const itk::EventObject & event)
+    {
+    // The collector has been created to watch the caller
+    TraceCollector *collector = AtomicLoad(&rawInstance);
+    if( itk::StartEvent().CheckEvent(&event) )
+      collector->Begin(caller->GetNameOfClass(), caller);
+    else if( itk::EndEvent().CheckEvent(&event) )
+      collector->End(caller->GetNameOfClass(), caller);
+    }
+
+  virtual void Execute(const itk::Object *caller, const itk::EventObject & event)
+    {
+    this->Execute(const_cast<itk::Object *>(caller), event);
+    }
+
+protected:
+  TraceWatchCommand() {}
+};
+
+/** Aggregated durations of the spans of a name and an instance */
+struct StatisticsType
+{
+  unsigned int Count;
+  double       Total;
+  double       Max;
+};
+}
+
+TraceCollector
+::TraceCollector():
+  m_Enabled(0)
+{
+  m_Clock = itk::RealTimeClock::New();
+  m_Origin = m_Clock->GetTimeInSeconds();
+  m_WatchCommand = TraceWatchCommand::New().GetPointer();
+
+  // Runtime activation without recompilation
+  std::string fileName;
+  if( itksys::SystemTools::GetEnv("RTK_TRACE", fileName) && !fileName.empty() )
+    {
+    m_FileName = fileName;
+    m_Enabled = 1;
+    }
+}
+
+TraceCollector
+::~TraceCollector()
+{
+  // Buffers are referenced by thread-local pointers of threads which may
+  // still be running, they are therefore not deleted.
+}
+
+void
+TraceCollector
+::PrintSelf(std::ostream & os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "TraceCollector (single instance): "
+     << (void *)TraceCollector::m_Instance << std::endl;
+  os << indent << "Enabled: " << this->GetEnabled() << std::endl;
+  os << indent << "FileName: " << m_FileName << std::endl;
+}
+
+/**
+ * Return the single instance of the TraceCollector
+ */
+TraceCollector::Pointer
+TraceCollector
+::GetInstance()
+{
+  instanceMutex.Lock();
+  if ( !TraceCollector::m_Instance )
+    {
+    // Try the factory first
+    TraceCollector::m_Instance  = itk::ObjectFactory< Self >::Create();
+    // if the factory did not provide one, then create it here
+    if ( !TraceCollector::m_Instance )
+      {
+      TraceCollector::m_Instance = new TraceCollector;
+      // Remove extra reference from construction.
+      TraceCollector::m_Instance->UnRegister();
+      }
+    AtomicStore(&rawInstance, TraceCollector::m_Instance.GetPointer());
+    }
+  Pointer instance = TraceCollector::m_Instance;
+  instanceMutex.Unlock();
+  /**
+   * return the instance
+   */
+  return instance;
+}
+
+/**
+ * This just calls GetInstance
+ */
+TraceCollector::Pointer
+TraceCollector
+::New()
+{
+  return GetInstance();
+}
+
+bool
+TraceCollector
+::GetEnabled() const
+{
+  return AtomicLoad(const_cast<long *>(&m_Enabled)) != 0;
+}
+
+void
+TraceCollector
+::SetEnabled(bool enabled)
+{
+  if( enabled != this->GetEnabled() )
+    {
+    AtomicStore(&m_Enabled, enabled);
+    this->Modified();
+    }
+}
+
+bool
+TraceCollector
+::IsEnabled()
+{
+  return GetRecordingInstance() != ITK_NULLPTR;
+}
+
+double
+TraceCollector
+::GetTime() const
+{
+  return m_Clock->GetTimeInSeconds() - m_Origin;
+}
+
+TraceCollector::LockedThreadBufferType *
+TraceCollector
+::GetCurrentThreadBuffer()
+{
+  if( !currentThreadBuffer )
+    {
+    LockedThreadBufferType *buffer = new LockedThreadBufferType;
+    m_RegistrationMutex.Lock();
+    std::ostringstream name;
+    name << "Thread " << m_ThreadBuffers.size();
+    buffer->ThreadName = name.str();
+    m_ThreadBuffers.push_back(buffer);
+    m_RegistrationMutex.Unlock();
+    currentThreadBuffer = buffer;
+    }
+  return currentThreadBuffer;
+}
+
+void
+TraceCollector
+::BeginInBuffer(LockedThreadBufferType *buffer, const char *name, const void *instance, int iteration)
+{
+  SpanType span;
+  span.Name = name;
+  span.Instance = instance;
+  span.Iteration = iteration;
+  span.Depth = buffer->OpenSpans.size();
+  span.Start = GetTime();
+  span.End = span.Start;
+  buffer->Mutex.Lock();
+  buffer->OpenSpans.push_back(buffer->Spans.size());
+  buffer->Spans.push_back(span);
+  buffer->Mutex.Unlock();
+}
+
+void
+TraceCollector
+::EndInBuffer(LockedThreadBufferType *buffer, const char *name, const void *instance)
+{
+  const double end = GetTime();
+
+  // Look for the span from the top of the stack. Spans which are not open,
+  // e.g., because they were opened before the collector was enabled, are
+  // ignored.
+  buffer->Mutex.Lock();
+  std::size_t n = buffer->OpenSpans.size();
+  while( n>0 )
+    {
+    const SpanType &span = buffer->Spans[buffer->OpenSpans[n-1]];
+    if( span.Instance == instance && std::strcmp(span.Name, name) == 0 )
+      break;
+    n--;
+    }
+
+  // Close the span and the spans left open above it, e.g., by an exception
+  while( n>0 && buffer->OpenSpans.size() >= n )
+    {
+    buffer->Spans[buffer->OpenSpans.back()].End = end;
+    buffer->OpenSpans.pop_back();
+    }
+  buffer->Mutex.Unlock();
+}
+
+void
+TraceCollector
+::Begin(const char *name, const void *instance, int iteration)
+{
+  if( !this->GetEnabled() )
+    return;
+  BeginInBuffer(GetCurrentThreadBuffer(), name, instance, iteration);
+}
+
+void
+TraceCollector
+::End(const char *name, const void *instance)
+{
+  // Spans opened before recording was disabled are closed anyway
+  if( !currentThreadBuffer )
+    return;
+  EndInBuffer(currentThreadBuffer, name, instance);
+}
+
+void
+TraceCollector
+::Watch(itk::ProcessObject *o)
+{
+  o->AddObserver(itk::StartEvent(), m_WatchCommand);
+  o->AddObserver(itk::EndEvent(), m_WatchCommand);
+}
+
+unsigned int
+TraceCollector
+::GetNumberOfThreadBuffers() const
+{
+  m_RegistrationMutex.Lock();
+  const unsigned int n = m_ThreadBuffers.size();
+  m_RegistrationMutex.Unlock();
+  return n;
+}
+
+const TraceCollector::ThreadBufferType *
+TraceCollector
+::GetThreadBuffer(unsigned int i) const
+{
+  m_RegistrationMutex.Lock();
+  const ThreadBufferType *buffer = m_ThreadBuffers[i];
+  m_RegistrationMutex.Unlock();
+  return buffer;
+}
+
+std::vector<TraceCollector::ThreadBufferType>
+TraceCollector
+::GetSnapshot() const
+{
+  m_RegistrationMutex.Lock();
+  const std::vector<LockedThreadBufferType*> lockedBuffers = m_ThreadBuffers;
+  m_RegistrationMutex.Unlock();
+
+  std::vector<ThreadBufferType> buffers(lockedBuffers.size());
+  for(unsigned int i=0; i<lockedBuffers.size(); i++)
+    {
+    lockedBuffers[i]->Mutex.Lock();
+    buffers[i] = *lockedBuffers[i];
+    lockedBuffers[i]->Mutex.Unlock();
+    }
+  return buffers;
+}
+
+void
+TraceCollector
+::WriteChromeTrace(std::ostream & os) const
+{
+  const std::vector<ThreadBufferType> buffers = this->GetSnapshot();
+
+  // The format of the stream of the caller is restored after the trace
+  const std::ios_base::fmtflags flags = os.flags();
+  const std::streamsize precision = os.precision();
+  os << "{\"traceEvents\":[" << std::endl;
+  bool first = true;
+  os << std::fixed << std::setprecision(3);
+  for(unsigned int tid=0; tid<buffers.size(); tid++)
+    {
+    if( buffers[tid].Spans.empty() )
+      continue;
+    if(!first)
+      os << "," << std::endl;
+    first = false;
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+       << ",\"args\":{\"name\":\"" << buffers[tid].ThreadName << "\"}}";
+    for(unsigned int i=0; i<buffers[tid].Spans.size(); i++)
+      {
+      const SpanType &span = buffers[tid].Spans[i];
+      os << "," << std::endl
+         << "{\"name\":\"" << span.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+         << ",\"ts\":" << span.Start * 1e6
+         << ",\"dur\":" << (span.End - span.Start) * 1e6
+         << ",\"args\":{\"instance\":\"" << span.Instance << "\""
+         << ",\"depth\":" << span.Depth;
+      if(span.Iteration>=0)
+        os << ",\"iteration\":" << span.Iteration;
+      os << "}}";
+      }
+    }
+  os << std::endl << "]}" << std::endl;
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void
+TraceCollector
+::Report(std::ostream & os) const
+{
+  const std::vector<ThreadBufferType> buffers = this->GetSnapshot();
+
+  // Instances are numbered per name in their order of appearance
+  typedef std::pair<std::string, const void*> KeyType;
+  std::map<const void*, unsigned int> instanceNumbers;
+  std::map<std::string, unsigned int> numberOfInstances;
+  std::map<KeyType, StatisticsType> statistics;
+  std::vector<KeyType> order;
+  for(unsigned int tid=0; tid<buffers.size(); tid++)
+    for(unsigned int i=0; i<buffers[tid].Spans.size(); i++)
+      {
+      const SpanType &span = buffers[tid].Spans[i];
+      const KeyType key(span.Name, span.Instance);
+      const double duration = span.End - span.Start;
+      if( statistics.find(key) == statistics.end() )
+        {
+        StatisticsType s = {0, 0., 0.};
+        statistics[key] = s;
+        order.push_back(key);
+        if( span.Instance && instanceNumbers.find(span.Instance) == instanceNumbers.end() )
+          instanceNumbers[span.Instance] = numberOfInstances[span.Name]++;
+        }
+      StatisticsType &s = statistics[key];
+      s.Count++;
+      s.Total += duration;
+      s.Max = std::max(s.Max, duration);
+      }
+
+  const std::ios_base::fmtflags flags = os.flags();
+  os << std::left << std::setw(50) << "Span"
+     << std::right << std::setw(10) << "Count"
+     << std::setw(15) << "Total (s)"
+     << std::setw(15) << "Mean (s)"
+     << std::setw(15) << "Max (s)" << std::endl;
+  for(unsigned int i=0; i<order.size(); i++)
+    {
+    std::ostringstream name;
+    name << order[i].first;
+    if( order[i].second )
+      name << "#" << instanceNumbers[order[i].second];
+    const StatisticsType &s = statistics[order[i]];
+    os << std::left << std::setw(50) << name.str()
+       << std::right << std::setw(10) << s.Count
+       << std::setw(15) << s.Total
+       << std::setw(15) << s.Total / s.Count
+       << std::setw(15) << s.Max << std::endl;
+    }
+  os.flags(flags);
+}
+
+void
+TraceCollector
+::Clear()
+{
+  m_RegistrationMutex.Lock();
+  for(unsigned int i=0; i<m_ThreadBuffers.size(); i++)
+    {
+    m_ThreadBuffers[i]->Mutex.Lock();
+    m_ThreadBuffers[i]->Spans.clear();
+    m_ThreadBuffers[i]->OpenSpans.clear();
+    m_ThreadBuffers[i]->Mutex.Unlock();
+    }
+  m_RegistrationMutex.Unlock();
+}
+
+void
+TraceCollector
+::Flush(std::ostream & os)
+{
+  if( !this->GetEnabled() || m_FileName.empty() )
+    return;
+
+  std::ofstream ofs(m_FileName.c_str());
+  if( !ofs )
+    {
+    itkExceptionMacro(<< "Could not open " << m_FileName << " to write the trace.");
+    }
+  WriteChromeTrace(ofs);
+  Report(os);
+  Clear();
+}
+
+TraceSpan
+::TraceSpan(const char *name, const void *instance, int iteration):
+  m_Name(name),
+  m_Instance(instance)
+{
+  m_Collector = GetRecordingInstance();
+  if(m_Collector)
+    m_Collector->Begin(name, instance, iteration);
+}
+
+TraceSpan
+::~TraceSpan()
+{
+  if(m_Collector)
+    m_Collector->End(m_Name, m_Instance);
+}
+
+} // end namespace rtk
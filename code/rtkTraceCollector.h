@@ -0,0 +1,226 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkTraceCollector_h
+#define __rtkTraceCollector_h
+
+#include <itkObject.h>
+#include <itkProcessObject.h>
+#include <itkCommand.h>
+#include <itkRealTimeClock.h>
+#include <itkSimpleFastMutexLock.h>
+
+#include "rtkWin32Header.h"
+#include "rtkConfiguration.h"
+
+#include <vector>
+#include <string>
+
+namespace rtk
+{
+
+/** \class TraceCollector
+ * \brief Records nested time spans per filter instance, per iteration and
+ * per thread.
+ *
+ * The TraceCollector is a singleton which records spans, i.e., named time
+ * intervals, in one buffer per thread. Spans opened by the same thread are
+ * nested. Each span optionally refers to an object instance (e.g., a filter,
+ * so that two filters of the same class are distinguished) and to an
+ * iteration number (e.g., the iterations of a conjugate gradient).
+ *
+ * Each thread, whether it is an application thread, an ITK worker thread of
+ * ThreadedGenerateData or a worker of rtk::ThreadPool, gets a thread-local
+ * buffer the first time it opens a span while recording is enabled. Recording
+ * a span only locks the buffer of the calling thread, which is not contended
+ * except while the trace is copied by WriteChromeTrace, Report or Clear, even
+ * when several pipelines run concurrently, e.g., the jobs of
+ * rtkreconstructiond. When recording is disabled, a span only tests the
+ * Enabled flag. A span is closed by name and instance: closing a span which
+ * is not open in the calling thread, e.g., because it was opened before
+ * recording was enabled, is ignored, and the spans left open above the closed
+ * span are closed with it.
+ *
+ * Recording is disabled by default. It is enabled at runtime, without
+ * recompiling, either with SetEnabled or by setting the environment variable
+ * RTK_TRACE to the name of the file where Flush writes the trace in the
+ * Chrome trace event format (chrome://tracing). The process objects created
+ * with the New macros of rtkMacro.h while recording is enabled are watched,
+ * i.e., each of their updates is recorded as a span. The trace can also be
+ * summarized with Report, which aggregates the spans per name and instance.
+ *
+ * \ingroup OSSystemObjects
+ */
+class RTK_EXPORT TraceCollector : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef TraceCollector                  Self;
+  typedef itk::Object                     Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TraceCollector, itk::Object);
+
+  /** This is a singleton pattern New. There will only be ONE reference to a
+   * TraceCollector object per process. */
+  static Pointer New();
+
+  /** Return the singleton instance with no reference counting. */
+  static Pointer GetInstance();
+
+  /** Description of one recorded span. The name must remain valid until the
+   * trace has been written, e.g., a string literal or GetNameOfClass(). */
+  struct SpanType
+    {
+    const char   *Name;
+    const void   *Instance;
+    int           Iteration;
+    unsigned int  Depth;
+    double        Start;
+    double        End;
+    };
+
+  /** Spans of one thread and stack of its open spans. */
+  struct ThreadBufferType
+    {
+    std::string              ThreadName;
+    std::vector<SpanType>    Spans;
+    std::vector<std::size_t> OpenSpans;
+    };
+
+  /** ThreadBufferType with the lock taken by its thread while recording */
+  struct LockedThreadBufferType : public ThreadBufferType
+    {
+    itk::SimpleFastMutexLock Mutex;
+    };
+
+  /** Get / Set whether spans are recorded. The flag is read without lock by
+   * all recording threads. */
+  bool GetEnabled() const;
+  void SetEnabled(bool enabled);
+  itkBooleanMacro(Enabled);
+
+  /** Return true if the collector records spans, without creating a
+   * reference to the singleton. */
+  static bool IsEnabled();
+
+  /** Get / Set the file name of the Chrome trace written by Flush. */
+  itkGetStringMacro(FileName);
+  itkSetStringMacro(FileName);
+
+  /** Open a span in the calling application thread. A negative iteration
+   * means that the span is not related to an iteration. */
+  void Begin(const char *name, const void *instance=ITK_NULLPTR, int iteration=-1);
+
+  /** Close the last span with this name and instance opened by the calling
+   * thread. */
+  void End(const char *name, const void *instance=ITK_NULLPTR);
+
+  /** Add observers to the StartEvent and EndEvent of a process object so
+   * that each of its updates is recorded as a span. */
+  void Watch(itk::ProcessObject *o);
+
+  /** Access to the buffers of the threads which have recorded spans. The
+   * buffers must not be accessed while the threads record spans, see
+   * GetSnapshot. */
+  unsigned int GetNumberOfThreadBuffers() const;
+  const ThreadBufferType *GetThreadBuffer(unsigned int i) const;
+
+  /** Copy of the buffers of all threads, safe while spans are recorded. */
+  std::vector<ThreadBufferType> GetSnapshot() const;
+
+  /** Write all recorded spans in the Chrome trace event format. */
+  void WriteChromeTrace(std::ostream & os) const;
+
+  /** Report the number of calls, total, mean and maximum durations of the
+   * spans aggregated per name and instance. */
+  void Report(std::ostream & os = std::cout) const;
+
+  /** Remove all recorded spans. */
+  void Clear();
+
+  /** Write the Chrome trace in FileName and the report in os if recording is
+   * enabled and a file name has been set. */
+  void Flush(std::ostream & os = std::cout);
+
+protected:
+  TraceCollector();
+  virtual ~TraceCollector();
+  virtual void PrintSelf(std::ostream & os, itk::Indent indent) const;
+
+  /** Get the buffer of the calling thread, created on first use */
+  LockedThreadBufferType *GetCurrentThreadBuffer();
+
+  /** Current time in seconds since the creation of the collector */
+  double GetTime() const;
+
+  void BeginInBuffer(LockedThreadBufferType *buffer, const char *name, const void *instance, int iteration);
+  void EndInBuffer(LockedThreadBufferType *buffer, const char *name, const void *instance);
+
+  /** Boolean accessed with atomic operations */
+  long        m_Enabled;
+  std::string m_FileName;
+
+  itk::RealTimeClock::Pointer m_Clock;
+  double                      m_Origin;
+
+  /** Buffers of all the threads which have recorded spans */
+  std::vector<LockedThreadBufferType*> m_ThreadBuffers;
+
+  /** Only used when a new thread registers its buffer */
+  mutable itk::SimpleFastMutexLock m_RegistrationMutex;
+
+  /** Shared observer command of all watched process objects */
+  itk::Command::Pointer m_WatchCommand;
+
+private:
+  TraceCollector(const Self &);  //purposely not implemented
+  void operator=(const Self &);  //purposely not implemented
+
+  static Pointer m_Instance;
+};
+
+/** \class TraceSpan
+ * \brief Records a span of the calling thread during the lifetime of the
+ * object, i.e., typically a scope. It may be used in any thread, e.g., in
+ * ThreadedGenerateData: the span is recorded in the buffer of the calling
+ * thread and not in a buffer selected by the ITK thread id, which is the same
+ * for the threads of concurrent pipelines.
+ *
+ * \ingroup OSSystemObjects
+ */
+class RTK_EXPORT TraceSpan
+{
+public:
+  TraceSpan(const char *name, const void *instance=ITK_NULLPTR, int iteration=-1);
+  ~TraceSpan();
+
+private:
+  TraceSpan(const TraceSpan &);      //purposely not implemented
+  void operator=(const TraceSpan &); //purposely not implemented
+
+  TraceCollector *m_Collector;
+  const char     *m_Name;
+  const void     *m_Instance;
+};
+
+} // end namespace rtk
+
+#endif
@@ -0,0 +1,136 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "rtkTuningCache.h"
+
+#include <itksys/SystemInformation.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+# include <process.h>
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif
+
+namespace rtk
+{
+
+std::string
+TuningCache
+::MakeKey(const std::string &problem, const unsigned int numberOfThreads)
+{
+  itksys::SystemInformation info;
+  info.RunCPUCheck();
+
+  std::ostringstream key;
+  key << problem
+      << '_' << info.GetExtendedProcessorName()
+      << '_' << info.GetNumberOfLogicalCPU() << "cpus"
+      << '_' << numberOfThreads << "threads";
+
+  // No space in keys
+  std::string result = key.str();
+  for(std::string::size_type i=0; i<result.size(); i++)
+    if(result[i]==' ' || result[i]=='\t')
+      result[i] = '_';
+  return result;
+}
+
+bool
+TuningCache
+::Read(const std::string &fileName, const std::string &key, ValuesType &values)
+{
+  std::ifstream is(fileName.c_str());
+  if( !is.is_open() )
+    return false;
+
+  bool found = false;
+  std::string line;
+  while( std::getline(is, line) )
+    {
+    if( line.empty() || line[0]=='#' )
+      continue;
+
+    std::istringstream iss(line);
+    std::string lineKey;
+    iss >> lineKey;
+    if(lineKey != key)
+      continue;
+
+    ValuesType lineValues;
+    double value;
+    while(iss >> value)
+      lineValues.push_back(value);
+    values = lineValues;
+    found = true;
+    }
+  return found;
+}
+
+bool
+TuningCache
+::Write(const std::string &fileName, const std::string &key, const ValuesType &values)
+{
+  // Keep the lines of the current file except the entries of key
+  std::ostringstream contents;
+  std::ifstream is(fileName.c_str());
+  std::string line;
+  while( std::getline(is, line) )
+    {
+    std::istringstream iss(line);
+    std::string lineKey;
+    iss >> lineKey;
+    if(line.empty() || line[0]=='#' || lineKey != key)
+      contents << line << '\n';
+    }
+  is.close();
+  contents << key;
+  for(unsigned int i=0; i<values.size(); i++)
+    contents << ' ' << values[i];
+  contents << '\n';
+
+  // Write a temporary file, unique per process, and rename it
+  std::ostringstream tmpFileName;
+  tmpFileName << fileName << ".tmp" << getpid();
+  std::ofstream os(tmpFileName.str().c_str());
+  if( !os.is_open() )
+    return false;
+  os << contents.str();
+  os.close();
+  if( os.fail() )
+    {
+    std::remove(tmpFileName.str().c_str());
+    return false;
+    }
+#ifdef _WIN32
+  // rename does not replace an existing file on Windows
+  std::remove(fileName.c_str());
+#endif
+  if( std::rename(tmpFileName.str().c_str(), fileName.c_str()) )
+    {
+    std::remove(tmpFileName.str().c_str());
+    return false;
+    }
+  return true;
+}
+
+} // end namespace rtk
@@ -0,0 +1,67 @@
+/*=========================================================================
+ *
+ *  Copyright RTK Consortium
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#ifndef __rtkTuningCache_h
+#define __rtkTuningCache_h
+
+#include "rtkWin32Header.h"
+
+#include <string>
+#include <vector>
+
+namespace rtk
+{
+
+/** \class TuningCache
+ * \brief Stores tuned parameters in a local text file.
+ *
+ * Each line of the file is an entry made of a key without space followed by
+ * the tuned values separated by spaces. Lines starting with # are comments.
+ * The key is built from a description of the problem, e.g., the sizes of the
+ * projections and of the volume, and from the processor name and the number
+ * of threads so that the file may be shared by several machines. When an
+ * entry is written, the file is rewritten with the new entry replacing the
+ * previous entries of the same key. The new file is first written next to the
+ * cache and then renamed so that concurrent readers never see a partially
+ * written file.
+ *
+ * \test rtkfdktest.cxx
+ *
+ * \ingroup OSSystemObjects
+ */
+class RTK_EXPORT TuningCache
+{
+public:
+  typedef std::vector<double> ValuesType;
+
+  /** Builds the key of a problem on the current machine with the given number
+   * of threads. */
+  static std::string MakeKey(const std::string &problem, const unsigned int numberOfThreads);
+
+  /** Reads the values of the last entry of key in fileName. Returns false if
+   * the file cannot be read or if it does not contain key. */
+  static bool Read(const std::string &fileName, const std::string &key, ValuesType &values);
+
+  /** Writes the entry of key in fileName, keeping the entries of the other
+   * keys. Returns false if the file cannot be written. */
+  static bool Write(const std::string &fileName, const std::string &key, const ValuesType &values);
+};
+
+} // end namespace rtk
+
+#endif
@@ -49,14 +49,14 @@ void
 WatcherForTimer
 ::StartFilter()
 {
-  rtk::GlobalTimer::GetInstance()->Start(m_Process->GetNameOfClass());
+  rtk::GlobalTimer::GetInstance()->Start(m_Process->GetNameOfClass(), m_Process);
 }
 
 void
 WatcherForTimer
 ::EndFilter()
 {
-  rtk::GlobalTimer::GetInstance()->Stop(m_Process->GetNameOfClass());
+  rtk::GlobalTimer::GetInstance()->Stop(m_Process->GetNameOfClass(), m_Process);
 }
 
 void
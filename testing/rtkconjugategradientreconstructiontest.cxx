@@ -4,6 +4,7 @@
 #include "rtkConstantImageSource.h"
 #include "rtkNormalizedJosephBackProjectionImageFilter.h"
 #include "rtkConjugateGradientConeBeamReconstructionFilter.h"
+#include "rtkIterationCommands.h"
 
 #ifdef USE_CUDA
   #include "itkCudaImage.h"
@@ -17,7 +18,10 @@
  * This test generates the projections of an ellipsoid and reconstructs the CT
  * image using the ConjugateGradient algorithm with different backprojectors (Voxel-Based,
  * Joseph). The generated results are compared to the
- * expected results (analytical calculation).
+ * expected results (analytical calculation). Case 5 checks that the
+ * iterations stop when the relative residual reaches the tolerance and case 6
+ * that preconditioned conjugate gradient with a ramp filter reaches the
+ * residual of 10 conjugate gradient iterations in fewer iterations.
  *
  * \author Cyril Mory
  */
@@ -182,5 +186,57 @@ int main(int, char** )
   CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), dsl->GetOutput(), 0.08, 23, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 5: Joseph Backprojector, residual tolerance  ******" << std::endl;
+
+  // The CUDA conjugate gradient ignores the tolerance
+  conjugategradient->SetCudaConjugateGradient(false);
+  conjugategradient->AddObserver(itk::IterationEvent(), rtk::VerboseIterationCommand<ConjugateGradientType>::New());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+  const std::vector<double> residuals = conjugategradient->GetResidualNorms();
+  if(residuals.size() != 5 || conjugategradient->GetElapsedTimes().size() != 5)
+    {
+    std::cerr << "Test Failed, " << residuals.size() << " residuals instead of 5" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Same reconstruction stopped at the residual of the third iteration
+  conjugategradient->SetTolerance(residuals[2]);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+  if(conjugategradient->GetResidualNorms().size() != 3)
+    {
+    std::cerr << "Test Failed, stopped after " << conjugategradient->GetResidualNorms().size()
+              << " iterations instead of 3" << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 6: Joseph Backprojector, ramp preconditioned conjugate gradient  ******" << std::endl;
+
+  // Residual of 10 iterations without preconditioning
+  uniformWeightsSource->SetConstant(1.0);
+  conjugategradient->SetPreconditioned(false);
+  conjugategradient->SetTolerance(0.);
+  conjugategradient->SetNumberOfIterations( 10 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+  OutputImageType::Pointer cgOutput = conjugategradient->GetOutput();
+  cgOutput->DisconnectPipeline();
+
+  conjugategradient->SetRampPreconditioned(true);
+  conjugategradient->SetTolerance(conjugategradient->GetResidualNorms().back());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( conjugategradient->Update() );
+#if !(FAST_TESTS_NO_CHECKS)
+  if(conjugategradient->GetResidualNorms().size() >= 10)
+    {
+    std::cerr << "Test Failed, preconditioned conjugate gradient needed "
+              << conjugategradient->GetResidualNorms().size()
+              << " iterations instead of less than 10" << std::endl;
+    return EXIT_FAILURE;
+    }
+#endif
+
+  CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), cgOutput, 0.08, 23, 2.0);
+  CheckImageQuality<OutputImageType>(conjugategradient->GetOutput(), dsl->GetOutput(), 0.08, 23, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
   return EXIT_SUCCESS;
 }
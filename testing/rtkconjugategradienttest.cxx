@@ -1,5 +1,8 @@
 #include <itkRandomImageSource.h>
 #include <itkImageRegionIterator.h>
+#include <itkMultiplyImageFilter.h>
+
+#include <algorithm>
 
 #include "rtkConstantImageSource.h"
 #include "rtkTestConfiguration.h"
@@ -81,6 +84,33 @@ void CheckImageQuality(typename TImage1::Pointer recon, typename TImage2::Pointe
 }
 #endif
 
+// Operator multiplying X by a diagonal image D, i.e., AX = D.X
+template<typename TImage>
+class DiagonalConjugateGradientOperator : public rtk::ConjugateGradientOperator<TImage>
+{
+public:
+  typedef DiagonalConjugateGradientOperator      Self;
+  typedef rtk::ConjugateGradientOperator<TImage> Superclass;
+  typedef itk::SmartPointer< Self >              Pointer;
+
+  itkNewMacro(Self)
+  itkTypeMacro(DiagonalConjugateGradientOperator, rtk::ConjugateGradientOperator)
+
+  void SetDiagonal(const TImage* D) {this->SetNthInput(1, const_cast<TImage*>(D));}
+
+protected:
+  DiagonalConjugateGradientOperator() {this->SetNumberOfRequiredInputs(2);}
+
+  void ThreadedGenerateData(const typename TImage::RegionType& outputRegionForThread, ThreadIdType itkNotUsed(threadId))
+  {
+    itk::ImageRegionConstIterator<TImage> itX(this->GetInput(0), outputRegionForThread);
+    itk::ImageRegionConstIterator<TImage> itD(this->GetInput(1), outputRegionForThread);
+    itk::ImageRegionIterator<TImage>      itO(this->GetOutput(), outputRegionForThread);
+    for(; !itO.IsAtEnd(); ++itX, ++itD, ++itO)
+      itO.Set(itX.Get() * itD.Get());
+  }
+};
+
 /**
  * \file rtkconjugategradienttest.cxx
  *
@@ -100,6 +130,11 @@ void CheckImageQuality(typename TImage1::Pointer recon, typename TImage2::Pointe
  * X = f
  * B = div(g)
  *
+ * It then solves D.X = B, D being a diagonal operator with values between 1
+ * and 100, and checks that preconditioned conjugate gradient with the inverse
+ * of D as preconditioner reaches the tolerance in fewer iterations than
+ * conjugate gradient, and in one iteration.
+ *
  *
  * \author Cyril Mory
  */
@@ -193,5 +228,64 @@ int main(int, char** )
 
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  // Diagonal operator D and its inverse
+  OutputImageType::Pointer diagonal = OutputImageType::New();
+  diagonal->CopyInformation(randomVolumeSource->GetOutput());
+  diagonal->SetRegions(randomVolumeSource->GetOutput()->GetLargestPossibleRegion());
+  diagonal->Allocate();
+  OutputImageType::Pointer inverseDiagonal = OutputImageType::New();
+  inverseDiagonal->CopyInformation(diagonal);
+  inverseDiagonal->SetRegions(diagonal->GetLargestPossibleRegion());
+  inverseDiagonal->Allocate();
+  itk::ImageRegionConstIterator<OutputImageType> itR(randomVolumeSource->GetOutput(), diagonal->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<OutputImageType> itD(diagonal, diagonal->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<OutputImageType> itI(inverseDiagonal, diagonal->GetLargestPossibleRegion());
+  for(; !itD.IsAtEnd(); ++itR, ++itD, ++itI)
+    {
+    itD.Set(1. + 99. * itR.Get());
+    itI.Set(1. / itD.Get());
+    }
+
+  typedef DiagonalConjugateGradientOperator<OutputImageType> DiagonalOperatorType;
+  DiagonalOperatorType::Pointer diagonalOperator = DiagonalOperatorType::New();
+  diagonalOperator->SetDiagonal(diagonal);
+
+  CGFilterType::Pointer pcg = CGFilterType::New();
+  pcg->SetA(diagonalOperator.GetPointer());
+  pcg->SetX(constantVolumeSource->GetOutput());
+  pcg->SetB(randomVolumeSource->GetOutput());
+  pcg->SetNumberOfIterations(100);
+  pcg->SetTolerance(1e-3);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( pcg->Update() );
+  const unsigned int cgIterations = pcg->GetResidualNorms().size();
+
+  typedef itk::MultiplyImageFilter<OutputImageType> MultiplyFilterType;
+  MultiplyFilterType::Pointer preconditioner = MultiplyFilterType::New();
+  preconditioner->SetInput2(inverseDiagonal);
+  preconditioner->InPlaceOff();
+  pcg->SetPreconditioner(preconditioner.GetPointer());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( pcg->Update() );
+  const unsigned int pcgIterations = pcg->GetResidualNorms().size();
+  std::cout << "Conjugate gradient: " << cgIterations << " iterations, preconditioned conjugate gradient: "
+            << pcgIterations << " iterations" << std::endl;
+  if(pcgIterations != 1 || pcgIterations >= cgIterations)
+    {
+    std::cerr << "Test Failed, preconditioned conjugate gradient needed " << pcgIterations
+              << " iterations and conjugate gradient " << cgIterations << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Check the solution B/D
+  double maxError = 0.;
+  itk::ImageRegionConstIterator<OutputImageType> itX(pcg->GetOutput(), diagonal->GetLargestPossibleRegion());
+  for(itR.GoToBegin(), itI.GoToBegin(); !itX.IsAtEnd(); ++itX, ++itR, ++itI)
+    maxError = std::max(maxError, (double)vcl_abs(itX.Get() - itR.Get() * itI.Get()));
+  if(maxError > 1e-4)
+    {
+    std::cerr << "Test Failed, preconditioned conjugate gradient solution error " << maxError << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
   return EXIT_SUCCESS;
 }
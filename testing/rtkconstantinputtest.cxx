@@ -0,0 +1,228 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkJosephBackProjectionImageFilter.h"
+
+#include <itkImageDuplicator.h>
+
+/**
+ * \file rtkconstantinputtest.cxx
+ *
+ * \brief Test of the projectors with an input produced by rtk::ConstantImageSource
+ *
+ * When input 0 of a projector is the output of rtk::ConstantImageSource, the
+ * projector only requests one pixel of it and initializes its output with the
+ * constant. This test compares the forward and back projections obtained in
+ * this case with those obtained with a copy of the constant image which is not
+ * connected to the source, for a zero and a nonzero constant.
+ */
+
+typedef itk::Image< float, 3 >                   OutputImageType;
+typedef rtk::ConstantImageSource<OutputImageType> ConstantImageSourceType;
+
+/** Returns a copy of the output of the source which is not connected to it */
+OutputImageType::Pointer DisconnectedCopy(ConstantImageSourceType *source)
+{
+  source->UpdateLargestPossibleRegion();
+  typedef itk::ImageDuplicator<OutputImageType> DuplicatorType;
+  DuplicatorType::Pointer duplicator = DuplicatorType::New();
+  duplicator->SetInputImage( source->GetOutput() );
+  duplicator->Update();
+  return duplicator->GetOutput();
+}
+
+/** Checks that a single pixel of the constant image has been generated */
+bool CheckSinglePixel(ConstantImageSourceType *source)
+{
+  if( source->GetOutput()->GetBufferedRegion().GetNumberOfPixels() != 1 )
+    {
+    std::cerr << "The constant image has " << source->GetOutput()->GetBufferedRegion().GetNumberOfPixels()
+              << " pixels instead of 1." << std::endl;
+    return false;
+    }
+  return true;
+}
+
+int main(int, char** )
+{
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 45;
+#endif
+
+  // Constant image sources
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Shepp Logan volume and projections
+  typedef rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType> DSLType;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  dsl->SetPhantomScale(128);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() );
+
+  typedef rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType> JFPType;
+  JFPType::Pointer projections = JFPType::New();
+  projections->SetInput( DisconnectedCopy(projectionsSource) );
+  projections->SetInput( 1, dsl->GetOutput() );
+  projections->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( projections->Update() );
+
+  const float constants[2] = {0., 1.};
+  for(unsigned int c=0; c<2; c++)
+    {
+    std::cout << "\n\n****** Constant " << constants[c] << " ******" << std::endl;
+
+    ConstantImageSourceType::Pointer projectionsConstant = ConstantImageSourceType::New();
+    projectionsConstant->SetInformationFromImage( projectionsSource->GetOutput() );
+    projectionsConstant->SetConstant( constants[c] );
+    OutputImageType::Pointer projectionsCopy = DisconnectedCopy(projectionsConstant);
+
+    ConstantImageSourceType::Pointer tomographyConstant = ConstantImageSourceType::New();
+    tomographyConstant->SetInformationFromImage( tomographySource->GetOutput() );
+    tomographyConstant->SetConstant( constants[c] );
+    OutputImageType::Pointer tomographyCopy = DisconnectedCopy(tomographyConstant);
+
+    std::cout << "\n\n****** Joseph forward projector ******" << std::endl;
+
+    JFPType::Pointer jfp = JFPType::New();
+    jfp->SetInput( projectionsCopy );
+    jfp->SetInput( 1, dsl->GetOutput() );
+    jfp->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( jfp->Update() );
+
+    projectionsConstant->Modified();
+    JFPType::Pointer jfpConstant = JFPType::New();
+    jfpConstant->SetInput( projectionsConstant->GetOutput() );
+    jfpConstant->SetInput( 1, dsl->GetOutput() );
+    jfpConstant->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( jfpConstant->Update() );
+
+    if( !CheckSinglePixel(projectionsConstant) )
+      return EXIT_FAILURE;
+    CheckImageQuality<OutputImageType>(jfpConstant->GetOutput(), jfp->GetOutput(), 1.e-6, 100, 2.0);
+    std::cout << "Test PASSED! " << std::endl;
+
+    std::cout << "\n\n****** Siddon forward projector ******" << std::endl;
+
+    typedef rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType> SFPType;
+    SFPType::Pointer sfp = SFPType::New();
+    sfp->SetInput( projectionsCopy );
+    sfp->SetInput( 1, dsl->GetOutput() );
+    sfp->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( sfp->Update() );
+
+    projectionsConstant->Modified();
+    SFPType::Pointer sfpConstant = SFPType::New();
+    sfpConstant->SetInput( projectionsConstant->GetOutput() );
+    sfpConstant->SetInput( 1, dsl->GetOutput() );
+    sfpConstant->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( sfpConstant->Update() );
+
+    if( !CheckSinglePixel(projectionsConstant) )
+      return EXIT_FAILURE;
+    CheckImageQuality<OutputImageType>(sfpConstant->GetOutput(), sfp->GetOutput(), 1.e-6, 100, 2.0);
+    std::cout << "Test PASSED! " << std::endl;
+
+    std::cout << "\n\n****** Voxel-based back projector ******" << std::endl;
+
+    typedef rtk::BackProjectionImageFilter<OutputImageType, OutputImageType> BPType;
+    BPType::Pointer bp = BPType::New();
+    bp->SetInput( tomographyCopy );
+    bp->SetInput( 1, projections->GetOutput() );
+    bp->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+    tomographyConstant->Modified();
+    BPType::Pointer bpConstant = BPType::New();
+    bpConstant->SetInput( tomographyConstant->GetOutput() );
+    bpConstant->SetInput( 1, projections->GetOutput() );
+    bpConstant->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( bpConstant->Update() );
+
+    if( !CheckSinglePixel(tomographyConstant) )
+      return EXIT_FAILURE;
+    CheckImageQuality<OutputImageType>(bpConstant->GetOutput(), bp->GetOutput(), 1.e-6, 100, 2.0);
+    std::cout << "Test PASSED! " << std::endl;
+
+    std::cout << "\n\n****** Joseph back projector ******" << std::endl;
+
+    typedef rtk::JosephBackProjectionImageFilter<OutputImageType, OutputImageType> JBPType;
+    JBPType::Pointer jbp = JBPType::New();
+    jbp->SetInput( tomographyCopy );
+    jbp->SetInput( 1, projections->GetOutput() );
+    jbp->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( jbp->Update() );
+
+    tomographyConstant->Modified();
+    JBPType::Pointer jbpConstant = JBPType::New();
+    jbpConstant->SetInput( tomographyConstant->GetOutput() );
+    jbpConstant->SetInput( 1, projections->GetOutput() );
+    jbpConstant->SetGeometry( geometry );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( jbpConstant->Update() );
+
+    if( !CheckSinglePixel(tomographyConstant) )
+      return EXIT_FAILURE;
+    CheckImageQuality<OutputImageType>(jbpConstant->GetOutput(), jbp->GetOutput(), 1.e-6, 100, 2.0);
+    std::cout << "Test PASSED! " << std::endl;
+    }
+
+  return EXIT_SUCCESS;
+}
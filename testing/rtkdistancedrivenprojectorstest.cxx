@@ -0,0 +1,231 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkRayBoxIntersectionImageFilter.h"
+#include "rtkDistanceDrivenForwardProjectionImageFilter.h"
+#include "rtkDistanceDrivenBackProjectionImageFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+
+#include <itkRandomImageSource.h>
+#include <itkStreamingImageFilter.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+/**
+ * \file rtkdistancedrivenprojectorstest.cxx
+ *
+ * \brief Functional test for the distance-driven forward and back projectors
+ *
+ * The test first projects a volume filled with ones with
+ * rtk::DistanceDrivenForwardProjectionImageFilter and compares the result
+ * with the analytical intersection of the rays with the box of the volume.
+ * It then checks that rtk::DistanceDrivenBackProjectionImageFilter is the
+ * adjoint of the forward projector by comparing the scalar products <Rv, p>
+ * and <v, R* p> for a random volume v and random projections p. The
+ * projections of a smooth Gaussian volume are compared with those of
+ * rtk::JosephForwardProjectionImageFilter, which must agree when the
+ * footprints of the pixels are small compared to the variations of the
+ * volume. Finally, the back projection must not depend on the number of
+ * slabs processed by the threads.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+  typedef itk::Vector<double, 3>                   VectorType;
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 45;
+#endif
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  // Volume of ones, the voxels cover [-128,128]^3
+  ConstantImageSourceType::Pointer volInput = ConstantImageSourceType::New();
+#if FAST_TESTS_NO_CHECKS
+  origin.Fill(-64.);
+  size.Fill(2);
+  spacing.Fill(128.);
+#else
+  origin.Fill(-126.);
+  size.Fill(64);
+  spacing.Fill(4.);
+#endif
+  volInput->SetOrigin( origin );
+  volInput->SetSpacing( spacing );
+  volInput->SetSize( size );
+  volInput->SetConstant( 1. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volInput->Update() );
+
+  // Empty volume for the back projections
+  ConstantImageSourceType::Pointer volZero = ConstantImageSourceType::New();
+  volZero->SetOrigin( origin );
+  volZero->SetSpacing( spacing );
+  volZero->SetSize( size );
+  volZero->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volZero->Update() );
+
+  // Random volume
+  typedef itk::RandomImageSource< OutputImageType > RandomImageSourceType;
+  RandomImageSourceType::Pointer randomVolumeSource = RandomImageSourceType::New();
+  randomVolumeSource->SetOrigin( origin );
+  randomVolumeSource->SetSpacing( spacing );
+  randomVolumeSource->SetSize( size );
+  randomVolumeSource->SetMin( 0. );
+  randomVolumeSource->SetMax( 1. );
+  randomVolumeSource->SetNumberOfThreads(2); //With 1, it's deterministic
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomVolumeSource->Update() );
+
+  // Projections
+  ConstantImageSourceType::Pointer projInput = ConstantImageSourceType::New();
+#if FAST_TESTS_NO_CHECKS
+  origin[0] = -252.;
+  origin[1] = -252.;
+  size[0] = 2;
+  size[1] = 2;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+#else
+  origin[0] = -508.;
+  origin[1] = -508.;
+  size[0] = 128;
+  size[1] = 128;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  origin[2] = 0.;
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projInput->SetOrigin( origin );
+  projInput->SetSpacing( spacing );
+  projInput->SetSize( size );
+  projInput->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( projInput->Update() );
+
+  RandomImageSourceType::Pointer randomProjectionsSource = RandomImageSourceType::New();
+  randomProjectionsSource->SetOrigin( origin );
+  randomProjectionsSource->SetSpacing( spacing );
+  randomProjectionsSource->SetSize( size );
+  randomProjectionsSource->SetMin( 0. );
+  randomProjectionsSource->SetMax( 100. );
+  randomProjectionsSource->SetNumberOfThreads(2); //With 1, it's deterministic
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomProjectionsSource->Update() );
+
+  // Geometry with out of plane angles and offsets
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    geometry->AddProjection(600., 1200., i*360./NumberOfProjectionImages, 3., -7., 10.*(i%3), 2.);
+
+  std::cout << "\n\n****** Case 1: projection of a box ******" << std::endl;
+
+  typedef rtk::RayBoxIntersectionImageFilter<OutputImageType, OutputImageType> RBIType;
+  RBIType::Pointer rbi = RBIType::New();
+  rbi->InPlaceOff();
+  rbi->SetInput( projInput->GetOutput() );
+  VectorType boxMin, boxMax;
+  boxMin.Fill(-128.);
+  boxMax.Fill(128.);
+  rbi->SetBoxMin(boxMin);
+  rbi->SetBoxMax(boxMax);
+  rbi->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rbi->Update() );
+
+  typedef rtk::DistanceDrivenForwardProjectionImageFilter<OutputImageType, OutputImageType> FPType;
+  FPType::Pointer fp = FPType::New();
+  fp->InPlaceOff();
+  fp->SetInput( projInput->GetOutput() );
+  fp->SetInput( 1, volInput->GetOutput() );
+  fp->SetGeometry( geometry );
+
+  // Streaming filter to test for unusual regions
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamingFilterType;
+  StreamingFilterType::Pointer stream = StreamingFilterType::New();
+  stream->SetInput(fp->GetOutput());
+  stream->SetNumberOfStreamDivisions(3);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( stream->Update() );
+
+  // The footprints blur the edges of the box
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), rbi->GetOutput(), 6., 40., 512.);
+
+  std::cout << "\n\n****** Case 2: adjoint operators ******" << std::endl;
+
+  fp = FPType::New();
+  fp->InPlaceOff();
+  fp->SetInput( projInput->GetOutput() );
+  fp->SetInput( 1, randomVolumeSource->GetOutput() );
+  fp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fp->Update() );
+
+  typedef rtk::DistanceDrivenBackProjectionImageFilter<OutputImageType, OutputImageType> BPType;
+  BPType::Pointer bp = BPType::New();
+  bp->SetInput( volZero->GetOutput() );
+  bp->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bp->SetGeometry( geometry.GetPointer() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+  CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), bp->GetOutput(), randomProjectionsSource->GetOutput(), fp->GetOutput());
+
+  std::cout << "\n\n****** Case 3: smooth volume compared to Joseph ******" << std::endl;
+
+  // Gaussian with a standard deviation of 30 mm centered on the origin
+  OutputImageType::Pointer gaussian = OutputImageType::New();
+  gaussian->CopyInformation( volZero->GetOutput() );
+  gaussian->SetRegions( volZero->GetOutput()->GetLargestPossibleRegion() );
+  gaussian->Allocate();
+  itk::ImageRegionIteratorWithIndex<OutputImageType> itG( gaussian, gaussian->GetLargestPossibleRegion() );
+  for(itG.GoToBegin(); !itG.IsAtEnd(); ++itG)
+    {
+    OutputImageType::PointType point;
+    gaussian->TransformIndexToPhysicalPoint( itG.GetIndex(), point );
+    const double r2 = point[0]*point[0] + point[1]*point[1] + point[2]*point[2];
+    itG.Set( exp(-0.5 * r2 / (30.*30.)) );
+    }
+
+  FPType::Pointer fpGaussian = FPType::New();
+  fpGaussian->InPlaceOff();
+  fpGaussian->SetInput( projInput->GetOutput() );
+  fpGaussian->SetInput( 1, gaussian );
+  fpGaussian->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fpGaussian->Update() );
+
+  typedef rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType> JosephType;
+  JosephType::Pointer joseph = JosephType::New();
+  joseph->InPlaceOff();
+  joseph->SetInput( projInput->GetOutput() );
+  joseph->SetInput( 1, gaussian );
+  joseph->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( joseph->Update() );
+
+  // The line integral of the Gaussian is at most sqrt(2 pi) 30 = 75
+  CheckImageQuality<OutputImageType>(fpGaussian->GetOutput(), joseph->GetOutput(), 0.5, 40., 75.);
+
+  std::cout << "\n\n****** Case 4: shadows of the slabs of the threads ******" << std::endl;
+
+  // Each thread only processes the pixels in the shadow of its slab, the
+  // result must not depend on the number of slabs
+  BPType::Pointer bpOneSlab = BPType::New();
+  bpOneSlab->SetInput( volZero->GetOutput() );
+  bpOneSlab->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bpOneSlab->SetGeometry( geometry.GetPointer() );
+  bpOneSlab->SetNumberOfThreads(1);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpOneSlab->Update() );
+
+  BPType::Pointer bpManySlabs = BPType::New();
+  bpManySlabs->SetInput( volZero->GetOutput() );
+  bpManySlabs->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bpManySlabs->SetGeometry( geometry.GetPointer() );
+  bpManySlabs->SetNumberOfThreads(7);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpManySlabs->Update() );
+  CheckImageQuality<OutputImageType>(bpManySlabs->GetOutput(), bpOneSlab->GetOutput(), 1.e-2, 100., 1.e5);
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
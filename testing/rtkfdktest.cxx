@@ -1,5 +1,6 @@
 #include <itkImageRegionConstIterator.h>
 #include <itkStreamingImageFilter.h>
+#include <cstdio>
 
 #include "rtkTest.h"
 #include "rtkSheppLoganPhantomFilter.h"
@@ -220,5 +221,75 @@ int main(int, char** )
   TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->UpdateLargestPossibleRegion() )
   CheckImageQuality<OutputImageType>(fov->GetOutput(), dsl->GetOutput(), 0.03, 26, 2.0);
   std::cout << "Test PASSED! " << std::endl;
+
+#if !defined(USE_CUDA) && !defined(USE_OPENCL)
+  std::cout << "\n\n****** Case 6: skip voxels outside the field of view ******" << std::endl;
+  direction.SetIdentity();
+  tomographySource->SetDirection(direction);
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size.Fill(32);
+#else
+  size.Fill(128);
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSize( size );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fov->UpdateLargestPossibleRegion() );
+
+  FDKType::Pointer feldkampSkip = FDKType::New();
+  feldkampSkip->SetInput( 0, tomographySource->GetOutput() );
+  feldkampSkip->SetInput( 1, slp->GetOutput() );
+  feldkampSkip->SetGeometry( geometry );
+  feldkampSkip->GetBackProjectionFilter()->SetSkipOutsideFieldOfView(true);
+
+  FOVFilterType::Pointer fovSkip=FOVFilterType::New();
+  fovSkip->SetInput(0, feldkampSkip->GetOutput());
+  fovSkip->SetProjectionsStack(slp->GetOutput());
+  fovSkip->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fovSkip->Update() );
+
+  CheckImageQuality<OutputImageType>(fovSkip->GetOutput(), fov->GetOutput(), 1e-4, 80, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 7: auto tuning ******" << std::endl;
+  const char *tuningCacheFileName = "rtkfdktest_tuning.txt";
+  remove(tuningCacheFileName);
+
+  FDKType::Pointer feldkampTuned = FDKType::New();
+  feldkampTuned->SetInput( 0, tomographySource->GetOutput() );
+  feldkampTuned->SetInput( 1, slp->GetOutput() );
+  feldkampTuned->SetGeometry( geometry );
+  feldkampTuned->SetAutoTuning(true);
+  feldkampTuned->SetTuningCacheFileName(tuningCacheFileName);
+
+  FOVFilterType::Pointer fovTuned=FOVFilterType::New();
+  fovTuned->SetInput(0, feldkampTuned->GetOutput());
+  fovTuned->SetProjectionsStack(slp->GetOutput());
+  fovTuned->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fovTuned->Update() );
+
+  CheckImageQuality<OutputImageType>(fovTuned->GetOutput(), fov->GetOutput(), 1e-4, 80, 2.0);
+
+  // Same parameters read in the tuning cache
+  FDKType::Pointer feldkampCached = FDKType::New();
+  feldkampCached->SetInput( 0, tomographySource->GetOutput() );
+  feldkampCached->SetInput( 1, slp->GetOutput() );
+  feldkampCached->SetGeometry( geometry );
+  feldkampCached->SetAutoTuning(true);
+  feldkampCached->SetTuningCacheFileName(tuningCacheFileName);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkampCached->Update() );
+  remove(tuningCacheFileName);
+
+  if( feldkampCached->GetProjectionSubsetSize() != feldkampTuned->GetProjectionSubsetSize() ||
+      feldkampCached->GetBackProjectionBlockSize() != feldkampTuned->GetBackProjectionBlockSize() )
+    {
+    std::cerr << "Test Failed, tuned parameters not read in the cache." << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  std::cout << "Test PASSED! " << std::endl;
+#endif
+
   return EXIT_SUCCESS;
 }
@@ -11,6 +11,9 @@
 #include "rtkCyclicDeformationImageFilter.h"
 #include "rtkFourDConjugateGradientConeBeamReconstructionFilter.h"
 #include "rtkPhasesToInterpolationWeights.h"
+#include "rtkHalf.h"
+
+#include <itkCastImageFilter.h>
 
 /**
  * \file rtkfourdconjugategradienttest.cxx
@@ -279,8 +282,32 @@ int main(int, char** )
   CheckImageQuality<VolumeSeriesType>(conjugategradient->GetOutput(), join->GetOutput(), 0.4, 12, 2.0);
   std::cout << "\n\nTest PASSED! " << std::endl;
 
+  std::cout << "\n\n****** Case 2: same as case 1 with the projection stack stored in half precision ******" << std::endl;
+
+  typedef itk::Image< rtk::Half, 3 > HalfProjectionStackType;
+  typedef itk::CastImageFilter< ProjectionStackType, HalfProjectionStackType > ToHalfType;
+  ToHalfType::Pointer toHalf = ToHalfType::New();
+  toHalf->SetInput( pasteFilter->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( toHalf->Update() );
+
+  typedef rtk::FourDConjugateGradientConeBeamReconstructionFilter<VolumeSeriesType,
+                                                                  ProjectionStackType,
+                                                                  HalfProjectionStackType> HalfConjugateGradientFilterType;
+  HalfConjugateGradientFilterType::Pointer halfconjugategradient = HalfConjugateGradientFilterType::New();
+  halfconjugategradient->SetInputVolumeSeries(fourdSource->GetOutput() );
+  halfconjugategradient->SetInputProjectionStack(toHalf->GetOutput());
+  halfconjugategradient->SetGeometry(geometry);
+  halfconjugategradient->SetNumberOfIterations(3);
+  halfconjugategradient->SetWeights(phaseReader->GetOutput());
+  halfconjugategradient->SetBackProjectionFilter( 0 ); // Voxel based
+  halfconjugategradient->SetForwardProjectionFilter( 0 ); // Joseph
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( halfconjugategradient->Update() );
+
+  CheckImageQuality<VolumeSeriesType>(halfconjugategradient->GetOutput(), join->GetOutput(), 0.4, 12, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
 #ifdef USE_CUDA
-  std::cout << "\n\n****** Case 2: CUDA ray cast forward projector, CUDA Voxel-Based back projector, GPU interpolation and splat ******" << std::endl;
+  std::cout << "\n\n****** Case 3: CUDA ray cast forward projector, CUDA Voxel-Based back projector, GPU interpolation and splat ******" << std::endl;
 
   conjugategradient->SetBackProjectionFilter( 2 ); // Cuda voxel based
   conjugategradient->SetForwardProjectionFilter( 2 ); // Cuda ray cast
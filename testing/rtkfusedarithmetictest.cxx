@@ -0,0 +1,245 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkFusedArithmeticImageFilter.h"
+#include "rtkForwardDifferenceGradientImageFilter.h"
+
+#include <itkRandomImageSource.h>
+#include <itkSubtractImageFilter.h>
+#include <itkMultiplyImageFilter.h>
+#include <itkDivideOrZeroOutImageFilter.h>
+#include <itkAddImageFilter.h>
+#include <itkThresholdImageFilter.h>
+#include <itkStreamingImageFilter.h>
+
+/**
+ * \file rtkfusedarithmetictest.cxx
+ *
+ * \brief Test rtk::FusedArithmeticImageFilter
+ *
+ * This test compares the programs of rtk::FusedArithmeticImageFilter, the
+ * correction and the update of SART and the right-hand side of ADMM, with the
+ * chains of itk::SubtractImageFilter, itk::MultiplyImageFilter,
+ * itk::DivideOrZeroOutImageFilter, itk::AddImageFilter and
+ * itk::ThresholdImageFilter that they replace, with and without streaming and
+ * for images of gradient vectors. The lines of the images are longer than the
+ * blocks evaluated by the filter. It finally checks that invalid programs are
+ * rejected.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+
+  // Random images
+  typedef itk::RandomImageSource< OutputImageType > RandomImageSourceType;
+  RandomImageSourceType::SizeType size;
+  size[0] = 700;
+  size[1] = 5;
+  size[2] = 3;
+
+  RandomImageSourceType::Pointer random0 = RandomImageSourceType::New();
+  random0->SetSize( size );
+  random0->SetMin( -5. );
+  random0->SetMax( 5. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( random0->Update() );
+
+  RandomImageSourceType::Pointer random1 = RandomImageSourceType::New();
+  random1->SetSize( size );
+  random1->SetMin( -3. );
+  random1->SetMax( 7. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( random1->Update() );
+
+  // Lengths of rays, some of them are below the threshold of the division
+  RandomImageSourceType::Pointer random2 = RandomImageSourceType::New();
+  random2->SetSize( size );
+  random2->SetMin( -1. );
+  random2->SetMax( 10. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( random2->Update() );
+
+  typedef rtk::FusedArithmeticImageFilter<OutputImageType> FusedType;
+
+  std::cout << "\n\n****** Case 1: SART correction ******" << std::endl;
+
+  const double lambda = 0.3;
+  const double weight = 0.7;
+
+  typedef itk::SubtractImageFilter<OutputImageType> SubtractType;
+  SubtractType::Pointer subtract = SubtractType::New();
+  subtract->SetInput1( random1->GetOutput() );
+  subtract->SetInput2( random0->GetOutput() );
+  subtract->InPlaceOff();
+
+  typedef itk::MultiplyImageFilter<OutputImageType> MultiplyType;
+  MultiplyType::Pointer multiplyLambda = MultiplyType::New();
+  multiplyLambda->SetInput1( subtract->GetOutput() );
+  multiplyLambda->SetConstant2( lambda );
+
+  typedef itk::DivideOrZeroOutImageFilter<OutputImageType, OutputImageType, OutputImageType> DivideType;
+  DivideType::Pointer divide = DivideType::New();
+  divide->SetInput1( multiplyLambda->GetOutput() );
+  divide->SetInput2( random2->GetOutput() );
+
+  MultiplyType::Pointer multiplyWeight = MultiplyType::New();
+  multiplyWeight->SetInput1( divide->GetOutput() );
+  multiplyWeight->SetConstant2( weight );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multiplyWeight->Update() );
+
+  FusedType::Pointer correction = FusedType::New();
+  correction->SetInput(0, random0->GetOutput() );
+  correction->SetInput(1, random1->GetOutput() );
+  correction->SetInput(2, random2->GetOutput() );
+  correction->SetSARTCorrection(lambda, weight);
+  correction->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( correction->Update() );
+
+  CheckImageQuality<OutputImageType>(correction->GetOutput(), multiplyWeight->GetOutput(), 1.e-6, 100, 1.);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: SART update with positivity and streaming ******" << std::endl;
+
+  typedef itk::AddImageFilter<OutputImageType> AddType;
+  AddType::Pointer add = AddType::New();
+  add->SetInput1( random0->GetOutput() );
+  add->SetInput2( random1->GetOutput() );
+  add->InPlaceOff();
+
+  typedef itk::ThresholdImageFilter<OutputImageType> ThresholdType;
+  ThresholdType::Pointer threshold = ThresholdType::New();
+  threshold->SetInput( add->GetOutput() );
+  threshold->SetOutsideValue(0);
+  threshold->ThresholdBelow(0);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( threshold->Update() );
+
+  FusedType::Pointer update = FusedType::New();
+  update->SetInput(0, random0->GetOutput() );
+  update->SetInput(1, random1->GetOutput() );
+  update->SetSum(true);
+  update->InPlaceOff();
+
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamingType;
+  StreamingType::Pointer streaming = StreamingType::New();
+  streaming->SetInput( update->GetOutput() );
+  streaming->SetNumberOfStreamDivisions(3);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( streaming->Update() );
+
+  CheckImageQuality<OutputImageType>(streaming->GetOutput(), threshold->GetOutput(), 1.e-6, 100, 1.);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: ADMM wavelets right-hand side, in place ******" << std::endl;
+
+  const double beta = 2.5;
+  AddType::Pointer add1 = AddType::New();
+  add1->SetInput1( random1->GetOutput() );
+  add1->SetInput2( random2->GetOutput() );
+  add1->InPlaceOff();
+
+  MultiplyType::Pointer multiplyBeta = MultiplyType::New();
+  multiplyBeta->SetInput1( add1->GetOutput() );
+  multiplyBeta->SetConstant2( beta );
+
+  AddType::Pointer add2 = AddType::New();
+  add2->SetInput1( multiplyBeta->GetOutput() );
+  add2->SetInput2( random0->GetOutput() );
+  add2->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( add2->Update() );
+
+  // The first input is modified in place
+  MultiplyType::Pointer copy = MultiplyType::New();
+  copy->SetInput1( random0->GetOutput() );
+  copy->SetConstant2( 1. );
+  copy->InPlaceOff();
+
+  FusedType::Pointer rhs = FusedType::New();
+  rhs->SetInput(0, copy->GetOutput() );
+  rhs->SetInput(1, random1->GetOutput() );
+  rhs->SetInput(2, random2->GetOutput() );
+  rhs->SetADMMWaveletsRightHandSide(beta);
+  rhs->InPlaceOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rhs->Update() );
+
+  CheckImageQuality<OutputImageType>(rhs->GetOutput(), add2->GetOutput(), 1.e-5, 100, 1.);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 4: sum of gradients ******" << std::endl;
+
+  typedef itk::CovariantVector<OutputPixelType, Dimension> GradientPixelType;
+  typedef itk::Image<GradientPixelType, Dimension>         GradientImageType;
+  typedef rtk::ForwardDifferenceGradientImageFilter<OutputImageType,
+                                                    OutputPixelType,
+                                                    OutputPixelType,
+                                                    GradientImageType> GradientType;
+  GradientType::Pointer gradient0 = GradientType::New();
+  gradient0->SetInput( random0->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( gradient0->Update() );
+  GradientType::Pointer gradient1 = GradientType::New();
+  gradient1->SetInput( random1->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( gradient1->Update() );
+
+  typedef rtk::FusedArithmeticImageFilter<GradientImageType> FusedGradientType;
+  FusedGradientType::Pointer gradientSum = FusedGradientType::New();
+  gradientSum->SetInput(0, gradient0->GetOutput() );
+  gradientSum->SetInput(1, gradient1->GetOutput() );
+  gradientSum->SetSum();
+  gradientSum->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( gradientSum->Update() );
+
+  typedef itk::ImageRegionConstIterator<GradientImageType> GradientIteratorType;
+  GradientIteratorType it0(gradient0->GetOutput(), gradient0->GetOutput()->GetBufferedRegion());
+  GradientIteratorType it1(gradient1->GetOutput(), gradient1->GetOutput()->GetBufferedRegion());
+  GradientIteratorType itSum(gradientSum->GetOutput(), gradientSum->GetOutput()->GetBufferedRegion());
+  for(; !itSum.IsAtEnd(); ++it0, ++it1, ++itSum)
+    for(unsigned int i=0; i<Dimension; i++)
+      if( itSum.Get()[i] != it0.Get()[i] + it1.Get()[i] )
+        {
+        std::cerr << "Test Failed, wrong sum of gradients at " << itSum.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 5: invalid programs ******" << std::endl;
+
+  FusedType::Pointer invalid = FusedType::New();
+  invalid->SetInput(0, random0->GetOutput() );
+  invalid->Push(FusedType::INPUT, 0);
+  invalid->Push(FusedType::ADD);
+  bool thrown = false;
+  try
+    {
+    invalid->Update();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception caught: " << e.GetDescription() << std::endl;
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "Test Failed, a program without the operands of ADD has been evaluated." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  invalid->ClearProgram();
+  invalid->Push(FusedType::INPUT, 0);
+  invalid->Push(FusedType::INPUT, 1);
+  invalid->Push(FusedType::ADD);
+  thrown = false;
+  try
+    {
+    invalid->Update();
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception caught: " << e.GetDescription() << std::endl;
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "Test Failed, a program using a missing input has been evaluated." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkDisplacedDetectorForOffsetFieldOfViewImageFilter.h"
+#include "rtkParkerShortScanImageFilter.h"
+#include "rtkFDKWeightProjectionFilter.h"
+#include "rtkFusedFDKWeightProjectionFilter.h"
+
+#include <itkStreamingImageFilter.h>
+
+/**
+ * \file rtkfusedfdkweighttest.cxx
+ *
+ * \brief Test rtk::FusedFDKWeightProjectionFilter vs the three weighting filters
+ *
+ * This test compares the projections weighted in a single pass by
+ * rtk::FusedFDKWeightProjectionFilter with the projections weighted
+ * successively by rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter,
+ * rtk::ParkerShortScanImageFilter and rtk::FDKWeightProjectionFilter for a
+ * short scan with a displaced detector.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 60;
+#endif
+  const double ArcSize = 240.;
+
+  // Constant image source
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer projSource  = ConstantImageSourceType::New();
+  origin[0] = -400.;
+  origin[1] = -63.;
+  origin[2] = 0.;
+  size[0] = 64;
+  size[1] = 32;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 8.;
+  spacing[1] = 4.;
+  spacing[2] = 1.;
+  projSource->SetOrigin( origin );
+  projSource->SetSpacing( spacing );
+  projSource->SetSize( size );
+
+  // Short scan geometry with a displaced detector
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*ArcSize/NumberOfProjectionImages, 20., 4.);
+
+  // Projections
+  typedef rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType> SLPType;
+  SLPType::Pointer slp=SLPType::New();
+  slp->SetInput( projSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(116);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  // Reference: three successive weighting filters
+  typedef rtk::DisplacedDetectorForOffsetFieldOfViewImageFilter<OutputImageType> DDFType;
+  DDFType::Pointer ddf = DDFType::New();
+  ddf->SetInput( slp->GetOutput() );
+  ddf->SetGeometry(geometry);
+  ddf->InPlaceOff();
+
+  typedef rtk::ParkerShortScanImageFilter<OutputImageType> PSSFType;
+  PSSFType::Pointer pssf = PSSFType::New();
+  pssf->SetInput( ddf->GetOutput() );
+  pssf->SetGeometry(geometry);
+  pssf->InPlaceOff();
+
+  typedef rtk::FDKWeightProjectionFilter<OutputImageType> WeightType;
+  WeightType::Pointer weight = WeightType::New();
+  weight->SetInput( pssf->GetOutput() );
+  weight->SetGeometry(geometry);
+  weight->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( weight->Update() );
+
+  std::cout << "\n\n****** Case 1: no streaming ******" << std::endl;
+
+  typedef rtk::FusedFDKWeightProjectionFilter<OutputImageType> FusedType;
+  FusedType::Pointer fused = FusedType::New();
+  fused->SetInput( slp->GetOutput() );
+  fused->SetGeometry(geometry);
+  fused->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fused->Update() );
+
+  CheckImageQuality< OutputImageType >(fused->GetOutput(), weight->GetOutput(), 1.e-6, 100, 1.);
+
+  std::cout << "\n\n****** Case 2: with streaming ******" << std::endl;
+
+  fused = FusedType::New();
+  fused->SetInput( slp->GetOutput() );
+  fused->SetGeometry(geometry);
+  fused->InPlaceOff();
+
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamingType;
+  StreamingType::Pointer streaming = StreamingType::New();
+  streaming->SetInput( fused->GetOutput() );
+  streaming->SetNumberOfStreamDivisions(4);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( streaming->Update() );
+
+  CheckImageQuality< OutputImageType >(streaming->GetOutput(), weight->GetOutput(), 1.e-6, 100, 1.);
+
+  std::cout << "\n\n****** Case 3: in place with a padded output ******" << std::endl;
+
+  // The output is padded by the displaced detector so the input must be
+  // neither overwritten nor released although InPlace is on.
+  fused = FusedType::New();
+  fused->SetInput( slp->GetOutput() );
+  fused->SetGeometry(geometry);
+  fused->InPlaceOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fused->Update() );
+
+  CheckImageQuality< OutputImageType >(fused->GetOutput(), weight->GetOutput(), 1.e-6, 100, 1.);
+  if( fused->GetOutput()->GetBufferPointer() == slp->GetOutput()->GetBufferPointer() ||
+      slp->GetOutput()->GetBufferedRegion() != slp->GetOutput()->GetLargestPossibleRegion() )
+    {
+    std::cerr << "Test Failed, the input of the padded output has been reused" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
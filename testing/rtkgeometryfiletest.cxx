@@ -1,21 +1,34 @@
 #include "rtkTestConfiguration.h"
 #include "rtkThreeDCircularProjectionGeometryXMLFile.h"
+#include "rtkThreeDCircularProjectionGeometryBinaryFile.h"
 #include "rtkMacro.h"
 #include <itksys/SystemTools.hxx>
 
 typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
 
-void WriteReadAndCheck(GeometryType *geometry)
+void WriteReadAndCheck(GeometryType *geometry, bool binary=false)
 {
   const char fileName[] = "rtkgeometryfiletest.out";
   const double epsilon = 1e-13;
 
-  rtk::ThreeDCircularProjectionGeometryXMLFileWriter::Pointer xmlWriter =
-    rtk::ThreeDCircularProjectionGeometryXMLFileWriter::New();
-  xmlWriter->SetFilename(fileName);
-  xmlWriter->SetObject(geometry);
-  TRY_AND_EXIT_ON_ITK_EXCEPTION( xmlWriter->WriteFile() )
+  if(binary)
+    {
+    rtk::ThreeDCircularProjectionGeometryBinaryFileWriter::Pointer binaryWriter =
+      rtk::ThreeDCircularProjectionGeometryBinaryFileWriter::New();
+    binaryWriter->SetFilename(fileName);
+    binaryWriter->SetObject(geometry);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( binaryWriter->WriteFile() )
+    }
+  else
+    {
+    rtk::ThreeDCircularProjectionGeometryXMLFileWriter::Pointer xmlWriter =
+      rtk::ThreeDCircularProjectionGeometryXMLFileWriter::New();
+    xmlWriter->SetFilename(fileName);
+    xmlWriter->SetObject(geometry);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( xmlWriter->WriteFile() )
+    }
 
+  // The XML reader reads both formats
   rtk::ThreeDCircularProjectionGeometryXMLFileReader::Pointer xmlReader;
   xmlReader = rtk::ThreeDCircularProjectionGeometryXMLFileReader::New();
   xmlReader->SetFilename(fileName);
@@ -24,6 +37,11 @@ void WriteReadAndCheck(GeometryType *geometry)
   itksys::SystemTools::RemoveFile(fileName);
 
   GeometryType *geoRead = xmlReader->GetOutputObject();
+  if( geoRead->GetGantryAngles().size() != geometry->GetGantryAngles().size() )
+    {
+    std::cerr << "Wrong number of projections read from written file." << std::endl;
+    exit(1);
+    }
   for(unsigned int i=0; i<geometry->GetGantryAngles().size(); i++)
     {
 #define CHECK_GEOMETRY_PARAMETER(paramName)                                \
@@ -53,6 +71,78 @@ void WriteReadAndCheck(GeometryType *geometry)
     CHECK_GEOMETRY_PARAMETER(SourceToDetectorDistances);
     CHECK_GEOMETRY_PARAMETER(ProjectionOffsetsX);
     CHECK_GEOMETRY_PARAMETER(ProjectionOffsetsY);
+    CHECK_GEOMETRY_PARAMETER(SourceAngles);
+
+    // Matrices, computed in a single pass for binary files
+    for(unsigned int j=0; j<3 && binary; j++)
+      for(unsigned int k=0; k<4; k++)
+        {
+        const double m1 = geoRead->GetMatrices()[i][j][k];
+        const double m2 = geometry->GetMatrices()[i][j][k];
+        if( std::abs(m1 - m2) > epsilon * std::max(1., std::abs(m2)) )
+          {
+          std::cerr << "Matrix of projection " << i << " read from written file differs from the reference." << std::endl;
+          exit(1);
+          }
+        }
+    }
+}
+
+void CheckSourcePositionsAndMatrices(GeometryType *geometry)
+{
+  const double epsilon = 1e-13;
+
+  // Add a projection to a geometry which already has projections
+  geometry->AddProjection(1000., 1500., 27., 3., -4., 5., 6., 7., 8.);
+
+  // Reference geometry with the same projections added in one call
+  GeometryType::Pointer ref = GeometryType::New();
+  ref->AddProjectionsInRadians(geometry->GetSourceToIsocenterDistances(),
+                               geometry->GetSourceToDetectorDistances(),
+                               geometry->GetGantryAngles(),
+                               geometry->GetProjectionOffsetsX(),
+                               geometry->GetProjectionOffsetsY(),
+                               geometry->GetOutOfPlaneAngles(),
+                               geometry->GetInPlaneAngles(),
+                               geometry->GetSourceOffsetsX(),
+                               geometry->GetSourceOffsetsY());
+
+  for(unsigned int i=0; i<ref->GetGantryAngles().size(); i++)
+    {
+    const GeometryType::HomogeneousVectorType sp = geometry->GetSourcePosition(i);
+    const GeometryType::ThreeDHomogeneousMatrixType m = geometry->GetProjectionCoordinatesToFixedSystemMatrix(i);
+    const GeometryType::HomogeneousVectorType refSP = ref->GetSourcePosition(i);
+    const GeometryType::ThreeDHomogeneousMatrixType refM = ref->GetProjectionCoordinatesToFixedSystemMatrix(i);
+    for(unsigned int j=0; j<4; j++)
+      {
+      if( std::abs(sp[j] - refSP[j]) > epsilon * std::max(1., std::abs(refSP[j])) )
+        {
+        std::cerr << "Cached source position of projection " << i << " differs from the reference." << std::endl;
+        exit(1);
+        }
+      for(unsigned int k=0; k<4; k++)
+        if( std::abs(m[j][k] - refM[j][k]) > epsilon * std::max(1., std::abs(refM[j][k])) )
+          {
+          std::cerr << "Cached matrix of projection " << i << " differs from the reference." << std::endl;
+          exit(1);
+          }
+      }
+    }
+
+  // Out of range projections must not be read
+  bool thrown = false;
+  try
+    {
+    ref->GetSourcePosition( ref->GetGantryAngles().size() );
+    }
+  catch(itk::ExceptionObject &)
+    {
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "No exception when requesting the source position of a missing projection." << std::endl;
+    exit(1);
     }
 }
 
@@ -63,6 +153,8 @@ void WriteReadAndCheck(GeometryType *geometry)
  *
  * This test creates different RTK geometries and compares the result to
  * to the expected one, read from a baseline .txt file in the RTK format.
+ * It also checks the source positions and matrices stored when projections
+ * are added, one at a time or in one call, and the binary geometry format.
  *
  * \author Simon Rit
  */
@@ -73,12 +165,14 @@ int main(int, char** )
   GeometryType::Pointer geometry = GeometryType::New();
   geometry->AddProjection(615., 548., 36., 1.3, 1.57, 15.4, 13.48, 5.42, 7.56);
   WriteReadAndCheck(geometry);
+  WriteReadAndCheck(geometry, true);
 
   // Create a geometry object with 5 projections with similar geometry parameters
   geometry = GeometryType::New();
   for(int i=0; i<5; i++)
     geometry->AddProjection(615., 548., 36., 1.3, 1.57, 15.4, 13.48, 5.42, 7.56);
   WriteReadAndCheck(geometry);
+  WriteReadAndCheck(geometry, true);
 
   // Create a geometry object with 5 projections with different geometry parameters
   geometry = GeometryType::New();
@@ -88,6 +182,8 @@ int main(int, char** )
   geometry->AddProjection(1532., 3218., 98732., -184.5, 548.1, -659.4, 123.4, 87.4, -15476.);
   geometry->AddProjection(578., 68., 9879., -38.4, 2158.4, -158.4, -43.3, 3218.4, 325.4);
   WriteReadAndCheck(geometry);
+  WriteReadAndCheck(geometry, true);
+  CheckSourcePositionsAndMatrices(geometry);
 
   std::cout << "\n\nTest PASSED! " << std::endl;
   return EXIT_SUCCESS;
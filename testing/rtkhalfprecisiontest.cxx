@@ -0,0 +1,235 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkHalf.h"
+#include "rtkConstantImageSource.h"
+#include "rtkCyclicDeformationImageFilter.h"
+#include "rtkInterpolatorWithKnownWeightsImageFilter.h"
+
+#include <itkRandomImageSource.h>
+#include <itkCastImageFilter.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionConstIterator.h>
+
+#include <cmath>
+#include <limits>
+
+/**
+ * \file rtkhalfprecisiontest.cxx
+ *
+ * \brief Test of the storage of images with rtk::Half and rtk::BFloat16 pixels
+ *
+ * This test checks the rounding of the conversions from float to rtk::Half and
+ * rtk::BFloat16. It then checks that rtk::CyclicDeformationImageFilter and
+ * rtk::InterpolatorWithKnownWeightsImageFilter give the same result when
+ * their 4D input is stored in half precision as when it is stored in float
+ * with the same values.
+ */
+
+template <class T>
+bool CheckConversion(const char *name, float value, float expected)
+{
+  const float converted = T(value);
+  if( converted != expected && !(converted != converted && expected != expected) )
+    {
+    std::cerr << "Test Failed, " << name << "(" << value << ") is "
+              << converted << " instead of " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+int main(int, char** )
+{
+  std::cout << "\n\n****** Case 1: conversions ******" << std::endl;
+
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  bool ok = true;
+  ok &= CheckConversion<rtk::Half>("Half", 1.f, 1.f);
+  ok &= CheckConversion<rtk::Half>("Half", -2.5f, -2.5f);
+  ok &= CheckConversion<rtk::Half>("Half", 65504.f, 65504.f);
+  ok &= CheckConversion<rtk::Half>("Half", 65519.f, 65504.f);
+  ok &= CheckConversion<rtk::Half>("Half", 65520.f, inf);
+  ok &= CheckConversion<rtk::Half>("Half", -1e6f, -inf);
+  ok &= CheckConversion<rtk::Half>("Half", 1.f+1.f/2048.f, 1.f);                   // Tie to even
+  ok &= CheckConversion<rtk::Half>("Half", 1.f+3.f/2048.f, 1.f+2.f/1024.f);        // Tie to even
+  ok &= CheckConversion<rtk::Half>("Half", std::pow(2.f,-24.f), std::pow(2.f,-24.f)); // Smallest subnormal
+  ok &= CheckConversion<rtk::Half>("Half", std::pow(2.f,-25.f), 0.f);
+  ok &= CheckConversion<rtk::Half>("Half", 3.f*std::pow(2.f,-20.f), 3.f*std::pow(2.f,-20.f));
+  ok &= CheckConversion<rtk::Half>("Half", nan, nan);
+  ok &= CheckConversion<rtk::BFloat16>("BFloat16", 1.f+1.f/256.f, 1.f);
+  ok &= CheckConversion<rtk::BFloat16>("BFloat16", 1.f+3.f/256.f, 1.f+2.f/128.f);
+  ok &= CheckConversion<rtk::BFloat16>("BFloat16", 1e30f, rtk::BFloat16::BitsToFloat(0x714a));
+  ok &= CheckConversion<rtk::BFloat16>("BFloat16", nan, nan);
+  if(!ok)
+    return EXIT_FAILURE;
+
+  // All half values are converted back to themselves
+  for(unsigned int bits=0; bits<0x10000; bits++)
+    {
+    const float value = rtk::Half::BitsToFloat(bits);
+    if( value == value && rtk::Half::FloatToBits(value) != bits )
+      {
+      std::cerr << "Test Failed, half " << bits << " is not converted back to itself." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "\n\n****** Case 2: 4D DVF stored in half precision ******" << std::endl;
+
+  typedef itk::CovariantVector<float, 3>      DVFPixelType;
+  typedef itk::CovariantVector<rtk::Half, 3>  HalfDVFPixelType;
+  typedef itk::Image<DVFPixelType, 3>         DVFImageType;
+  typedef itk::Image<DVFPixelType, 4>         DVFSequenceImageType;
+  typedef itk::Image<HalfDVFPixelType, 4>     HalfDVFSequenceImageType;
+
+  DVFSequenceImageType::SizeType dvfSize;
+  dvfSize[0] = 17;
+  dvfSize[1] = 9;
+  dvfSize[2] = 5;
+  dvfSize[3] = 4;
+  DVFSequenceImageType::Pointer dvf = DVFSequenceImageType::New();
+  dvf->SetRegions(dvfSize);
+  dvf->Allocate();
+  itk::ImageRegionIterator<DVFSequenceImageType> itDVF(dvf, dvf->GetLargestPossibleRegion());
+  for(; !itDVF.IsAtEnd(); ++itDVF)
+    {
+    DVFPixelType v;
+    for(unsigned int i=0; i<3; i++)
+      v[i] = 20. * std::rand() / RAND_MAX - 10.;
+    itDVF.Set(v);
+    }
+
+  typedef itk::CastImageFilter<DVFSequenceImageType, HalfDVFSequenceImageType> ToHalfDVFType;
+  ToHalfDVFType::Pointer toHalfDVF = ToHalfDVFType::New();
+  toHalfDVF->SetInput(dvf);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( toHalfDVF->Update() );
+
+  typedef itk::CastImageFilter<HalfDVFSequenceImageType, DVFSequenceImageType> ToFloatDVFType;
+  ToFloatDVFType::Pointer toFloatDVF = ToFloatDVFType::New();
+  toFloatDVF->SetInput(toHalfDVF->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( toFloatDVF->Update() );
+
+  std::vector<double> signal;
+  signal.push_back(0.1);
+  signal.push_back(0.35);
+  signal.push_back(0.6);
+  signal.push_back(0.9);
+
+  typedef rtk::CyclicDeformationImageFilter<DVFImageType, HalfDVFSequenceImageType> HalfDeformationType;
+  HalfDeformationType::Pointer halfDef = HalfDeformationType::New();
+  halfDef->SetInput(toHalfDVF->GetOutput());
+  halfDef->SetSignalVector(signal);
+
+  typedef rtk::CyclicDeformationImageFilter<DVFImageType> DeformationType;
+  DeformationType::Pointer def = DeformationType::New();
+  def->SetInput(toFloatDVF->GetOutput());
+  def->SetSignalVector(signal);
+
+  DeformationType::Pointer refDef = DeformationType::New();
+  refDef->SetInput(dvf);
+  refDef->SetSignalVector(signal);
+
+  for(unsigned int frame=0; frame<signal.size(); frame++)
+    {
+    halfDef->SetFrame(frame);
+    def->SetFrame(frame);
+    refDef->SetFrame(frame);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( halfDef->Update() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( def->Update() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( refDef->Update() );
+
+    itk::ImageRegionConstIterator<DVFImageType> itHalf(halfDef->GetOutput(), halfDef->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<DVFImageType> itFloat(def->GetOutput(), def->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<DVFImageType> itRef(refDef->GetOutput(), refDef->GetOutput()->GetLargestPossibleRegion());
+    for(; !itHalf.IsAtEnd(); ++itHalf, ++itFloat, ++itRef)
+      for(unsigned int i=0; i<3; i++)
+        {
+        // Same values in float, same result
+        if( itHalf.Get()[i] != itFloat.Get()[i] )
+          {
+          std::cerr << "Test Failed, DVF stored in half differs from DVF in float at "
+                    << itHalf.GetIndex() << " in frame " << frame << std::endl;
+          return EXIT_FAILURE;
+          }
+        // The error of the rounding of the DVF is at most 10 * 2^-11
+        if( std::abs(itHalf.Get()[i] - itRef.Get()[i]) > 10./2048. )
+          {
+          std::cerr << "Test Failed, DVF stored in half is not accurate at "
+                    << itHalf.GetIndex() << " in frame " << frame << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+    }
+
+  std::cout << "\n\n****** Case 3: volume sequence stored in half precision ******" << std::endl;
+
+  typedef itk::Image<float, 3>      VolumeType;
+  typedef itk::Image<float, 4>      VolumeSeriesType;
+  typedef itk::Image<rtk::Half, 4>  HalfVolumeSeriesType;
+
+  typedef itk::RandomImageSource<VolumeSeriesType> RandomSourceType;
+  RandomSourceType::Pointer random = RandomSourceType::New();
+  RandomSourceType::SizeType randomSize;
+  randomSize[0] = 33;
+  randomSize[1] = 17;
+  randomSize[2] = 9;
+  randomSize[3] = 5;
+  random->SetSize(randomSize);
+  random->SetMin(-1.);
+  random->SetMax(1.);
+
+  typedef itk::CastImageFilter<VolumeSeriesType, HalfVolumeSeriesType> ToHalfType;
+  ToHalfType::Pointer toHalf = ToHalfType::New();
+  toHalf->SetInput(random->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( toHalf->Update() );
+
+  typedef itk::CastImageFilter<HalfVolumeSeriesType, VolumeSeriesType> ToFloatType;
+  ToFloatType::Pointer toFloat = ToFloatType::New();
+  toFloat->SetInput(toHalf->GetOutput());
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( toFloat->Update() );
+
+  typedef rtk::ConstantImageSource<VolumeType> ConstantImageSourceType;
+  ConstantImageSourceType::Pointer volume = ConstantImageSourceType::New();
+  ConstantImageSourceType::SizeType volumeSize;
+  for(unsigned int i=0; i<3; i++)
+    volumeSize[i] = randomSize[i];
+  volume->SetSize(volumeSize);
+  volume->SetConstant(1.);
+
+  const unsigned int nProj = 7;
+  itk::Array2D<float> weights(randomSize[3], nProj);
+  weights.Fill(0.);
+  for(unsigned int proj=0; proj<nProj; proj++)
+    {
+    const double phase = randomSize[3] * double(proj) / nProj;
+    const unsigned int inf = (unsigned int)phase;
+    weights[inf][proj] = 1. - (phase - inf);
+    weights[(inf+1) % randomSize[3]][proj] = phase - inf;
+    }
+
+  typedef rtk::InterpolatorWithKnownWeightsImageFilter<VolumeType, HalfVolumeSeriesType> HalfInterpolatorType;
+  HalfInterpolatorType::Pointer halfInterpolator = HalfInterpolatorType::New();
+  halfInterpolator->SetInputVolume(volume->GetOutput());
+  halfInterpolator->SetInputVolumeSeries(toHalf->GetOutput());
+  halfInterpolator->SetWeights(weights);
+
+  typedef rtk::InterpolatorWithKnownWeightsImageFilter<VolumeType, VolumeSeriesType> InterpolatorType;
+  InterpolatorType::Pointer interpolator = InterpolatorType::New();
+  interpolator->SetInputVolume(volume->GetOutput());
+  interpolator->SetInputVolumeSeries(toFloat->GetOutput());
+  interpolator->SetWeights(weights);
+
+  for(unsigned int proj=0; proj<nProj; proj++)
+    {
+    halfInterpolator->SetProjectionNumber(proj);
+    interpolator->SetProjectionNumber(proj);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( halfInterpolator->Update() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( interpolator->Update() );
+    CheckImageQuality<VolumeType>(halfInterpolator->GetOutput(), interpolator->GetOutput(), 1.e-7, 150, 2.0);
+    }
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkRayEllipsoidIntersectionImageFilter.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSARTConeBeamReconstructionFilter.h"
+#include "rtkImageBufferPool.h"
+
+#include <cstring>
+
+/**
+ * \file rtkimagebufferpooltest.cxx
+ *
+ * \brief Test rtk::ImageBufferPool
+ *
+ * This test checks that the buffers of images are allocated from the pool
+ * when it is enabled, that a released buffer is reused by the next image of
+ * the same size but not by images of another size. It then checks that a
+ * SART reconstruction is identical with and without the pool.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 60;
+#endif
+
+  rtk::ImageBufferPool::Pointer pool = rtk::ImageBufferPool::GetInstance();
+  pool->SetEnabled(true);
+  pool->SetMinimumBufferSize(0);
+
+  std::cout << "\n\n****** Case 1: allocation and reuse of buffers ******" << std::endl;
+
+  OutputImageType::RegionType region;
+  region.SetSize(0, 32);
+  region.SetSize(1, 32);
+  region.SetSize(2, 32);
+
+  OutputImageType::Pointer image = OutputImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  if( strcmp(image->GetPixelContainer()->GetNameOfClass(), "PooledImportImageContainer") )
+    {
+    std::cerr << "The pixel container is a " << image->GetPixelContainer()->GetNameOfClass()
+              << " instead of a PooledImportImageContainer." << std::endl;
+    return EXIT_FAILURE;
+    }
+  image->FillBuffer(1.);
+  const OutputPixelType *buffer = image->GetBufferPointer();
+
+  // The buffer goes back to the pool with the image
+  image = ITK_NULLPTR;
+  const itk::SizeValueType reuses = pool->GetNumberOfReuses();
+  image = OutputImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  if( pool->GetNumberOfReuses() != reuses+1 || image->GetBufferPointer() != buffer )
+    {
+    std::cerr << "The released buffer has not been reused." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Images of other sizes do not get the buffer
+  image->ReleaseData();
+  region.SetSize(2, 16);
+  OutputImageType::Pointer smallImage = OutputImageType::New();
+  smallImage->SetRegions(region);
+  smallImage->Allocate();
+  if( smallImage->GetBufferPointer() == buffer )
+    {
+    std::cerr << "A buffer of another size has been reused." << std::endl;
+    return EXIT_FAILURE;
+    }
+  smallImage = ITK_NULLPTR;
+  image = ITK_NULLPTR;
+  pool->Clear();
+  if( pool->GetPooledBytes() != 0 )
+    {
+    std::cerr << "The pool has not been cleared." << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: SART with and without pool ******" << std::endl;
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Create ellipsoid PROJECTIONS
+  typedef rtk::RayEllipsoidIntersectionImageFilter<OutputImageType, OutputImageType> REIType;
+  REIType::Pointer rei = REIType::New();
+  REIType::VectorType semiprincipalaxis, center;
+  semiprincipalaxis.Fill(90.);
+  center.Fill(0.);
+  rei->SetAngle(0.);
+  rei->SetDensity(1.);
+  rei->SetCenter(center);
+  rei->SetAxis(semiprincipalaxis);
+  rei->SetInput( projectionsSource->GetOutput() );
+  rei->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rei->Update() );
+
+  // Reference without pool
+  pool->SetEnabled(false);
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  SARTType::Pointer sart = SARTType::New();
+  sart->SetInput( tomographySource->GetOutput() );
+  sart->SetInput(1, rei->GetOutput());
+  sart->SetGeometry( geometry );
+  sart->SetNumberOfIterations( 2 );
+  sart->SetLambda( 0.5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+  OutputImageType::Pointer reference = sart->GetOutput();
+  reference->DisconnectPipeline();
+
+  // Same reconstruction with pool
+  pool->SetEnabled(true);
+  const itk::SizeValueType allocations = pool->GetNumberOfAllocations();
+  sart = SARTType::New();
+  sart->SetInput( tomographySource->GetOutput() );
+  sart->SetInput(1, rei->GetOutput());
+  sart->SetGeometry( geometry );
+  sart->SetNumberOfIterations( 2 );
+  sart->SetLambda( 0.5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+  pool->Report(std::cout);
+
+  CheckImageQuality<OutputImageType>(sart->GetOutput(), reference, 1.e-6, 100, 2.0);
+  if( pool->GetNumberOfAllocations() == allocations || pool->GetNumberOfReuses() == reuses+1 )
+    {
+    std::cerr << "The SART reconstruction has not used the pool." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkParkerShortScanImageFilter.h"
+#include "rtkFDKConeBeamReconstructionFilter.h"
+#include "rtkInlineFDKReconstructor.h"
+
+#include <itkExtractImageFilter.h>
+#include <itkBinShrinkImageFilter.h>
+
+#include <algorithm>
+
+/**
+ * \file rtkinlinefdktest.cxx
+ *
+ * \brief Test rtk::InlineFDKReconstructor vs rtk::FDKConeBeamReconstructionFilter
+ *
+ * This test pushes the projections of a simulated Shepp-Logan phantom in a
+ * random order to rtk::InlineFDKReconstructor and compares the reconstructed
+ * volume with the one obtained with rtk::FDKConeBeamReconstructionFilter for a
+ * full scan and for a short scan. The preview is compared with the FDK
+ * reconstruction of the binned projections on the coarse grid of the preview.
+ */
+
+const unsigned int Dimension = 3;
+typedef float                                    OutputPixelType;
+typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+
+// Pushes the projections in a random order and returns the reconstruction
+OutputImageType::Pointer
+InlineReconstruction(rtk::ThreeDCircularProjectionGeometry *geometry,
+                     OutputImageType *projections,
+                     ConstantImageSourceType *tomographySource,
+                     unsigned int previewShrinkFactor = 0,
+                     OutputImageType::Pointer *preview = NULL)
+{
+  typedef rtk::InlineFDKReconstructor< OutputImageType > InlineFDKType;
+  InlineFDKType::Pointer inlineFDK = InlineFDKType::New();
+  inlineFDK->SetGeometry( geometry );
+  inlineFDK->SetVolume( tomographySource->GetOutput() );
+  inlineFDK->SetNumberOfFilteringThreads( 3 );
+  inlineFDK->SetQueueSize( 4 );
+  inlineFDK->SetPreviewShrinkFactor( previewShrinkFactor );
+  inlineFDK->Start();
+
+  const unsigned int nProj = geometry->GetGantryAngles().size();
+  std::vector<unsigned int> order;
+  for(unsigned int i=0; i<nProj; i++)
+    order.push_back(i);
+  std::random_shuffle( order.begin(), order.end() );
+
+  typedef itk::ExtractImageFilter< OutputImageType, OutputImageType > ExtractType;
+  for(unsigned int i=0; i<nProj; i++)
+    {
+    OutputImageType::RegionType region = projections->GetLargestPossibleRegion();
+    region.SetIndex(Dimension-1, order[i]);
+    region.SetSize(Dimension-1, 1);
+    ExtractType::Pointer extract = ExtractType::New();
+    extract->SetInput( projections );
+    extract->SetExtractionRegion( region );
+    extract->SetDirectionCollapseToIdentity();
+    extract->Update();
+    OutputImageType::Pointer projection = extract->GetOutput();
+    projection->DisconnectPipeline();
+    inlineFDK->PushProjection( order[i], projection );
+    }
+
+  OutputImageType::Pointer volume = inlineFDK->Finalize();
+  if( inlineFDK->GetNumberOfBackProjectedProjections() != nProj )
+    {
+    std::cerr << "Test Failed, " << inlineFDK->GetNumberOfBackProjectedProjections()
+              << " projections backprojected instead of " << nProj << std::endl;
+    exit(EXIT_FAILURE);
+    }
+  volume->DisconnectPipeline();
+  if(preview)
+    *preview = inlineFDK->GetPreview();
+  return volume;
+}
+
+int main(int, char** )
+{
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 90;
+#endif
+
+  // Constant image sources
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 32;
+  size[1] = 32;
+  size[2] = 32;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+  spacing[2] = 8.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -254.;
+  origin[1] = -254.;
+  origin[2] = 0.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 32;
+  size[1] = 32;
+  spacing[0] = 32.;
+  spacing[1] = 32.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  typedef rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType> SLPType;
+  typedef rtk::FDKConeBeamReconstructionFilter< OutputImageType > FDKType;
+
+  std::cout << "\n\n****** Case 1: full scan ******" << std::endl;
+
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages, 0, 0, 0, 0, 20, 15);
+
+  SLPType::Pointer slp=SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(116);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  FDKType::Pointer feldkamp = FDKType::New();
+  feldkamp->SetInput( 0, tomographySource->GetOutput() );
+  feldkamp->SetInput( 1, slp->GetOutput() );
+  feldkamp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkamp->Update() );
+
+  OutputImageType::Pointer inlineVolume;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineVolume = InlineReconstruction(geometry, slp->GetOutput(), tomographySource) );
+
+  CheckImageQuality< OutputImageType >(inlineVolume, feldkamp->GetOutput(), 1.e-5, 100, 2.);
+
+  std::cout << "\n\n****** Case 2: short scan ******" << std::endl;
+
+  geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*240./NumberOfProjectionImages, 0, 0, 0, 0, 20, 15);
+
+  slp=SLPType::New();
+  slp->SetInput( projectionsSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(116);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+
+  typedef rtk::ParkerShortScanImageFilter<OutputImageType> PSSFType;
+  PSSFType::Pointer pssf = PSSFType::New();
+  pssf->SetInput( slp->GetOutput() );
+  pssf->SetGeometry( geometry );
+  pssf->InPlaceOff();
+
+  feldkamp = FDKType::New();
+  feldkamp->SetInput( 0, tomographySource->GetOutput() );
+  feldkamp->SetInput( 1, pssf->GetOutput() );
+  feldkamp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkamp->Update() );
+
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineVolume = InlineReconstruction(geometry, slp->GetOutput(), tomographySource) );
+
+  CheckImageQuality< OutputImageType >(inlineVolume, feldkamp->GetOutput(), 1.e-5, 100, 2.);
+
+  std::cout << "\n\n****** Case 3: preview ******" << std::endl;
+
+  OutputImageType::Pointer preview;
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( inlineVolume = InlineReconstruction(geometry, slp->GetOutput(), tomographySource, 2, &preview) );
+
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( tomographySource->UpdateOutputInformation() );
+  OutputImageType::Pointer tomography = tomographySource->GetOutput();
+  for(unsigned int i=0; i<Dimension; i++)
+    {
+    spacing[i] = 2. * tomography->GetSpacing()[i];
+    origin[i] = tomography->GetOrigin()[i] + 0.5 * tomography->GetSpacing()[i];
+    size[i] = tomography->GetLargestPossibleRegion().GetSize()[i] / 2;
+    }
+  ConstantImageSourceType::Pointer previewSource = ConstantImageSourceType::New();
+  previewSource->SetOrigin( origin );
+  previewSource->SetSpacing( spacing );
+  previewSource->SetSize( size );
+  previewSource->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( previewSource->UpdateOutputInformation() );
+  if( preview.IsNull() ||
+      preview->GetLargestPossibleRegion() != previewSource->GetOutput()->GetLargestPossibleRegion() ||
+      preview->GetSpacing() != previewSource->GetOutput()->GetSpacing() ||
+      preview->GetOrigin().EuclideanDistanceTo(previewSource->GetOutput()->GetOrigin()) > 1e-6 )
+    {
+    std::cerr << "Test Failed, wrong preview volume information" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+
+  typedef itk::BinShrinkImageFilter< OutputImageType, OutputImageType > BinType;
+  BinType::Pointer bin = BinType::New();
+  BinType::ShrinkFactorsType binFactors;
+  binFactors.Fill(2);
+  binFactors[Dimension-1] = 1;
+  bin->SetInput( pssf->GetOutput() );
+  bin->SetShrinkFactors( binFactors );
+
+  feldkamp = FDKType::New();
+  feldkamp->SetInput( 0, previewSource->GetOutput() );
+  feldkamp->SetInput( 1, bin->GetOutput() );
+  feldkamp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( feldkamp->Update() );
+
+  // Binning after or before ramp filtering only differs in the high frequencies
+  CheckImageQuality< OutputImageType >(preview, feldkamp->GetOutput(), 0.1, 20, 2.);
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include "rtkMacro.h"
+#include "rtkMemoryProbesCollector.h"
+#include "rtkConstantImageSource.h"
+#include "rtkHalf.h"
+
+#include <itkCastImageFilter.h>
+
+#include <vector>
+
+/**
+ * \file rtkmemoryprobescollectortest.cxx
+ *
+ * \brief Test of rtk::MemoryProbesCollector
+ *
+ * This test checks the output bytes counted for a filter, also with
+ * rtk::Half pixels, and that the peak
+ * RSS increases are paired per filter when the probes of two filters are
+ * interleaved, as for filters running concurrently.
+ */
+
+int main(int, char** )
+{
+  typedef itk::Image< float, 3 >                ImageType;
+  typedef rtk::ConstantImageSource< ImageType > ConstantImageSourceType;
+  typedef rtk::MemoryProbesCollector::SizeValueType SizeValueType;
+
+  ConstantImageSourceType::SizeType size;
+  size.Fill(32);
+  ConstantImageSourceType::Pointer first = ConstantImageSourceType::New();
+  first->SetSize(size);
+  ConstantImageSourceType::Pointer second = ConstantImageSourceType::New();
+  second->SetSize(size);
+
+  std::cout << "\n\n****** Case 1: output bytes ******" << std::endl;
+
+  rtk::MemoryProbesCollector collector;
+  collector.Start("First", first);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( first->Update() );
+  collector.Stop("First", first);
+  const SizeValueType expectedBytes = 32*32*32*sizeof(float);
+  if( !collector.GetProbe("First") || collector.GetProbe("First")->TotalOutputBytes != expectedBytes )
+    {
+    std::cerr << "Test Failed, output bytes are not " << expectedBytes << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef itk::Image< rtk::Half, 3 > HalfImageType;
+  typedef itk::CastImageFilter< ImageType, HalfImageType > CastType;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput( first->GetOutput() );
+  collector.Start("Cast", cast);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( cast->Update() );
+  collector.Stop("Cast", cast);
+  if( collector.GetProbe("Cast")->TotalOutputBytes != 32*32*32*sizeof(rtk::Half) )
+    {
+    std::cerr << "Test Failed, output bytes of half precision image are not "
+              << 32*32*32*sizeof(rtk::Half) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::cout << "\n\n****** Case 2: interleaved probes ******" << std::endl;
+
+  if( rtk::MemoryProbesCollector::GetPeakResidentSetSize() == 0 )
+    {
+    std::cout << "Peak RSS unavailable, skipped." << std::endl;
+    }
+  else
+    {
+    // The first filter is started before a large allocation which raises the
+    // peak RSS, the second one after. The first one is stopped first, it must
+    // be paired with its own start and not with the last one.
+    collector.Clear();
+    const SizeValueType allocation = 32*1024*1024;
+    collector.Start("First", first);
+    std::vector<char> *buffer = new std::vector<char>(allocation, 1);
+    collector.Start("Second", second);
+    collector.Stop("First", first);
+    collector.Stop("Second", second);
+    delete buffer;
+
+    collector.Report(std::cout);
+    if( collector.GetProbe("First")->MaxPeakIncrease < allocation/2 ||
+        collector.GetProbe("Second")->MaxPeakIncrease >= allocation/2 )
+      {
+      std::cerr << "Test Failed, peak increases have been paired with the wrong starts" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  std::cout << "\n\n****** Case 3: stop without start ******" << std::endl;
+
+  collector.Clear();
+  collector.Start("First", first);
+  collector.Stop("First", second);
+  collector.Stop("First", first);
+  if( collector.GetProbe("First")->NumberOfStops != 1 )
+    {
+    std::cerr << "Test Failed, a stop without start has been counted" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+#include "rtkTest.h"
+#include "rtkDrawEllipsoidImageFilter.h"
+#include "rtkRayEllipsoidIntersectionImageFilter.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSARTConeBeamReconstructionFilter.h"
+#include "rtkMultiResolutionConeBeamReconstructionFilter.h"
+
+#include <itkMinimumMaximumImageCalculator.h>
+
+/**
+ * \file rtkmultiresolutiontest.cxx
+ *
+ * \brief Functional test for the multi-resolution reconstruction driver
+ *
+ * This test generates the projections of an ellipsoid and reconstructs the CT
+ * image with SART driven by rtk::MultiResolutionConeBeamReconstructionFilter.
+ * A single full resolution level must give the same result as SART alone and
+ * a coarse-to-fine reconstruction is compared to the expected results
+ * (analytical calculation). A constant volume must be preserved up to the
+ * borders by the resampling between levels.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 180;
+#endif
+
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+  spacing[2] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+  spacing[2] = 8.;
+#endif
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Create ellipsoid PROJECTIONS
+  typedef rtk::RayEllipsoidIntersectionImageFilter<OutputImageType, OutputImageType> REIType;
+  REIType::Pointer rei;
+
+  rei = REIType::New();
+  REIType::VectorType semiprincipalaxis, center;
+  semiprincipalaxis.Fill(90.);
+  center.Fill(0.);
+  rei->SetAngle(0.);
+  rei->SetDensity(1.);
+  rei->SetCenter(center);
+  rei->SetAxis(semiprincipalaxis);
+
+  rei->SetInput( projectionsSource->GetOutput() );
+  rei->SetGeometry( geometry );
+
+  //Update
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rei->Update() );
+
+  // Create REFERENCE object (3D ellipsoid).
+  typedef rtk::DrawEllipsoidImageFilter<OutputImageType, OutputImageType> DEType;
+  DEType::Pointer dsl = DEType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() )
+
+  // Reference SART reconstruction
+  typedef rtk::SARTConeBeamReconstructionFilter< OutputImageType > SARTType;
+  SARTType::Pointer sart = SARTType::New();
+  sart->SetInput( tomographySource->GetOutput() );
+  sart->SetInput(1, rei->GetOutput());
+  sart->SetGeometry( geometry );
+  sart->SetNumberOfIterations( 1 );
+  sart->SetLambda( 0.5 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( sart->Update() );
+
+  typedef rtk::MultiResolutionConeBeamReconstructionFilter< OutputImageType > MultiResolutionType;
+
+  std::cout << "\n\n****** Case 1: single full resolution level ******" << std::endl;
+
+  SARTType::Pointer levelSart = SARTType::New();
+  levelSart->SetGeometry( geometry );
+  levelSart->SetNumberOfIterations( 1 );
+  levelSart->SetLambda( 0.5 );
+
+  MultiResolutionType::Pointer multires = MultiResolutionType::New();
+  multires->SetInput( tomographySource->GetOutput() );
+  multires->SetInput(1, rei->GetOutput());
+  multires->AddLevel(1, levelSart);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+
+  CheckImageQuality<OutputImageType>(multires->GetOutput(), sart->GetOutput(), 1.e-6, 100, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 2: coarse-to-fine, shrink factors 4, 2 and 1 ******" << std::endl;
+
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int coarsestShrinkFactor = 2;
+#else
+  const unsigned int coarsestShrinkFactor = 4;
+#endif
+
+  multires = MultiResolutionType::New();
+  multires->SetInput( tomographySource->GetOutput() );
+  multires->SetInput(1, rei->GetOutput());
+  for(unsigned int factor=coarsestShrinkFactor; factor>=1; factor/=2)
+    {
+    levelSart = SARTType::New();
+    levelSart->SetGeometry( geometry );
+    levelSart->SetNumberOfIterations( 1 );
+    levelSart->SetLambda( 0.5 );
+    multires->AddLevel(factor, levelSart);
+    }
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+
+  if( multires->GetOutput()->GetLargestPossibleRegion() != tomographySource->GetOutput()->GetLargestPossibleRegion() )
+    {
+    std::cerr << "Test Failed, the output is not on the grid of the input volume" << std::endl;
+    return EXIT_FAILURE;
+    }
+  CheckImageQuality<OutputImageType>(multires->GetOutput(), dsl->GetOutput(), 0.032, 28.6, 2.0);
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: resampling of a constant volume up to the borders ******" << std::endl;
+
+  // With a null relaxation, SART leaves its input unchanged so the output
+  // must be the constant input volume, including at the borders of the finer
+  // grids where the coarse voxel centers do not reach
+  tomographySource->SetConstant( 1. );
+  multires = MultiResolutionType::New();
+  multires->SetInput( tomographySource->GetOutput() );
+  multires->SetInput(1, rei->GetOutput());
+  for(unsigned int factor=coarsestShrinkFactor; factor>=coarsestShrinkFactor/2 && factor>=1; factor/=2)
+    {
+    levelSart = SARTType::New();
+    levelSart->SetGeometry( geometry );
+    levelSart->SetNumberOfIterations( 1 );
+    levelSart->SetLambda( 0. );
+    multires->AddLevel(factor, levelSart);
+    }
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( multires->Update() );
+
+  typedef itk::MinimumMaximumImageCalculator< OutputImageType > MinMaxType;
+  MinMaxType::Pointer minMax = MinMaxType::New();
+  minMax->SetImage( multires->GetOutput() );
+  minMax->Compute();
+  if( std::abs(minMax->GetMinimum()-1.) > 1.e-5 || std::abs(minMax->GetMaximum()-1.) > 1.e-5 )
+    {
+    std::cerr << "Test Failed, the constant volume is not preserved: min="
+              << minMax->GetMinimum() << ", max=" << minMax->GetMaximum() << std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout << "\n\nTest PASSED! " << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkProjectionNoiseImageFilter.h"
+
+#include <itkStreamingImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+
+/**
+ * \file rtkprojectionnoisetest.cxx
+ *
+ * \brief Test of rtk::ProjectionNoiseImageFilter and rtk::PhiloxRandomGenerator
+ *
+ * This test first checks the output of rtk::PhiloxRandomGenerator against the
+ * known answers of the Philox4x32-10 reference implementation. It then checks
+ * that rtk::ProjectionNoiseImageFilter gives exactly the same noise whatever
+ * the number of threads and of streaming divisions, and that the mean and the
+ * variance of the noise of constant images are those of the Gaussian, Poisson
+ * and Poisson-Gaussian models.
+ */
+
+const unsigned int Dimension = 3;
+typedef float OutputPixelType;
+typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+typedef rtk::ProjectionNoiseImageFilter< OutputImageType > NoiseFilterType;
+
+bool CheckIdentical(OutputImageType::Pointer test, OutputImageType::Pointer ref)
+{
+  itk::ImageRegionConstIterator<OutputImageType> itTest(test, test->GetBufferedRegion());
+  itk::ImageRegionConstIterator<OutputImageType> itRef(ref, ref->GetBufferedRegion());
+  for(; !itRef.IsAtEnd(); ++itTest, ++itRef)
+    {
+    if(itTest.Get() != itRef.Get())
+      {
+      std::cerr << "Test Failed, noise differs at index " << itRef.GetIndex() << ": "
+                << itTest.Get() << " instead of " << itRef.Get() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+bool CheckMoments(NoiseFilterType *noise,
+                  double expectedMean,
+                  double expectedVariance,
+                  double tolerance)
+{
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( noise->Update() );
+
+  OutputImageType::Pointer output = noise->GetOutput();
+  itk::ImageRegionConstIterator<OutputImageType> it(output, output->GetBufferedRegion());
+  double sum = 0., sum2 = 0.;
+  for(; !it.IsAtEnd(); ++it)
+    {
+    sum += it.Get();
+    sum2 += it.Get() * it.Get();
+    }
+  const double n = output->GetBufferedRegion().GetNumberOfPixels();
+  const double mean = sum / n;
+  const double variance = sum2 / n - mean * mean;
+  std::cout << "Mean = " << mean << " (expected " << expectedMean << "), "
+            << "variance = " << variance << " (expected " << expectedVariance << ")" << std::endl;
+
+  // The standard error of the mean is sqrt(variance/n), that of the variance
+  // is about variance*sqrt(2/n).
+  if( vcl_abs(mean-expectedMean) > tolerance * vcl_sqrt(expectedVariance/n) ||
+      vcl_abs(variance-expectedVariance) > tolerance * expectedVariance * vcl_sqrt(2./n) )
+    {
+    std::cerr << "Test Failed, moments of the noise are not the expected ones" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+int main(int, char** )
+{
+  std::cout << "\n\n****** Case 1: Philox4x32-10 known answers ******" << std::endl;
+
+  const itk::uint32_t kat[3][10] = {
+    {0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+     0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+    {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+     0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+    {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+     0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+  for(unsigned int t=0; t<3; t++)
+    {
+    itk::uint32_t output[4];
+    rtk::PhiloxRandomGenerator::Generate(kat[t]+4, kat[t], output);
+    for(unsigned int i=0; i<4; i++)
+      if(output[i] != kat[t][6+i])
+        {
+        std::cerr << "Test Failed, Philox4x32-10 known answer " << t << " is wrong" << std::endl;
+        return EXIT_FAILURE;
+        }
+    }
+
+  // Constant image source
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+  origin.Fill(0.);
+  spacing.Fill(1.);
+  size[0] = 64;
+  size[1] = 64;
+#if FAST_TESTS_NO_CHECKS
+  size[2] = 2;
+#else
+  size[2] = 16;
+#endif
+  ConstantImageSourceType::Pointer source = ConstantImageSourceType::New();
+  source->SetOrigin( origin );
+  source->SetSpacing( spacing );
+  source->SetSize( size );
+  source->SetConstant( 2. );
+
+  std::cout << "\n\n****** Case 2: reproducibility ******" << std::endl;
+
+  NoiseFilterType::Pointer ref = NoiseFilterType::New();
+  ref->SetInput( source->GetOutput() );
+  ref->SetNoiseModel( NoiseFilterType::POISSONGAUSSIAN );
+  ref->SetSeed( 1234 );
+  ref->SetI0( 1000. );
+  ref->SetStandardDeviation( 5. );
+  ref->SetNumberOfThreads( 1 );
+  ref->InPlaceOff();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( ref->Update() );
+
+  NoiseFilterType::Pointer multi = NoiseFilterType::New();
+  multi->SetInput( source->GetOutput() );
+  multi->SetNoiseModel( NoiseFilterType::POISSONGAUSSIAN );
+  multi->SetSeed( 1234 );
+  multi->SetI0( 1000. );
+  multi->SetStandardDeviation( 5. );
+  multi->SetNumberOfThreads( 4 );
+  multi->InPlaceOff();
+
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamingType;
+  StreamingType::Pointer streaming = StreamingType::New();
+  streaming->SetInput( multi->GetOutput() );
+  streaming->SetNumberOfStreamDivisions( 3 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( streaming->Update() );
+  if( !CheckIdentical(streaming->GetOutput(), ref->GetOutput()) )
+    return EXIT_FAILURE;
+
+  // Another seed must give another noise
+  multi->SetSeed( 1235 );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( streaming->Update() );
+  if( CheckIdentical(streaming->GetOutput(), ref->GetOutput()) )
+    {
+    std::cerr << "Test Failed, two seeds give the same noise" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The remaining cases check the statistics of the noise. A tolerance of 5
+  // standard errors avoids failures by chance for a given seed.
+#if !(FAST_TESTS_NO_CHECKS)
+  const double tolerance = 5.;
+
+  std::cout << "\n\n****** Case 3: Gaussian noise ******" << std::endl;
+
+  NoiseFilterType::Pointer noise = NoiseFilterType::New();
+  noise->SetInput( source->GetOutput() );
+  noise->InPlaceOff();
+  noise->SetNoiseModel( NoiseFilterType::GAUSSIAN );
+  noise->SetMean( 0.5 );
+  noise->SetStandardDeviation( 0.1 );
+  if( !CheckMoments(noise, 2.5, 0.01, tolerance) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 4: Poisson noise on counts, small mean ******" << std::endl;
+
+  noise->SetNoiseModel( NoiseFilterType::POISSON );
+  noise->LineIntegralOff();
+  source->SetConstant( 5. );
+  if( !CheckMoments(noise, 5., 5., tolerance) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 5: Poisson noise on counts, large mean ******" << std::endl;
+
+  source->SetConstant( 100. );
+  if( !CheckMoments(noise, 100., 100., tolerance) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 6: Poisson-Gaussian noise on counts ******" << std::endl;
+
+  noise->SetNoiseModel( NoiseFilterType::POISSONGAUSSIAN );
+  noise->SetMean( 0. );
+  noise->SetStandardDeviation( 5. );
+  if( !CheckMoments(noise, 100., 125., tolerance) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 7: Poisson noise on line integrals ******" << std::endl;
+
+  // With many photons, the log transform is nearly linear and the variance of
+  // the line integral is about 1/(I0 exp(-p)).
+  noise->SetNoiseModel( NoiseFilterType::POISSON );
+  noise->LineIntegralOn();
+  noise->SetI0( 1e5 );
+  source->SetConstant( 2. );
+  if( !CheckMoments(noise, 2., vcl_exp(2.)/1e5, tolerance) )
+    return EXIT_FAILURE;
+#endif
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkSheppLoganPhantomFilter.h"
+#include "rtkProjectionsCacheImageFilter.h"
+#include "rtkProjectionsReader.h"
+
+#include <itkExtractImageFilter.h>
+#include <itkImageFileWriter.h>
+
+#include <sstream>
+
+#include <algorithm>
+#include <list>
+
+/**
+ * \file rtkprojectionscachetest.cxx
+ *
+ * \brief Test rtk::ProjectionsCacheImageFilter
+ *
+ * This test extracts projections one by one in a random order from a cache
+ * of projections of the Shepp-Logan phantom and compares them to the
+ * projections computed without cache. It also checks the number of hits and
+ * misses of the least recently used cache. Finally, the projections are
+ * written in files and read through the cache with rtk::ProjectionsReader to
+ * check that the reader never produces more than one projection at a time.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+  const unsigned int NumberOfProjectionImages = 12;
+
+  // Constant image source
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer projSource = ConstantImageSourceType::New();
+  origin[0] = -254.;
+  origin[1] = -254.;
+  origin[2] = 0.;
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = NumberOfProjectionImages;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+  spacing[2] = 1.;
+  projSource->SetOrigin( origin );
+  projSource->SetSpacing( spacing );
+  projSource->SetSize( size );
+
+  // Geometry
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Reference projections
+  typedef rtk::SheppLoganPhantomFilter<OutputImageType, OutputImageType> SLPType;
+  SLPType::Pointer slp = SLPType::New();
+  slp->SetInput( projSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(116);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( slp->Update() );
+  OutputImageType::Pointer reference = slp->GetOutput();
+  reference->DisconnectPipeline();
+
+  // Projections computed on demand through the cache
+  slp = SLPType::New();
+  slp->SetInput( projSource->GetOutput() );
+  slp->SetGeometry(geometry);
+  slp->SetPhantomScale(116);
+
+  typedef rtk::ProjectionsCacheImageFilter<OutputImageType> CacheType;
+  CacheType::Pointer cache = CacheType::New();
+  cache->SetInput( slp->GetOutput() );
+  cache->SetCacheSize(4);
+
+  typedef itk::ExtractImageFilter<OutputImageType, OutputImageType> ExtractType;
+  ExtractType::Pointer extract = ExtractType::New();
+  extract->SetInput( cache->GetOutput() );
+  extract->SetDirectionCollapseToSubmatrix();
+
+  ExtractType::Pointer extractRef = ExtractType::New();
+  extractRef->SetInput( reference );
+  extractRef->SetDirectionCollapseToSubmatrix();
+
+  std::cout << "\n\n****** Case 1: projections in random order ******" << std::endl;
+
+  // Two passes over the projections, the second one with a few hits only
+  const unsigned int nAccesses = 2*NumberOfProjectionImages;
+  std::vector<unsigned int> order(nAccesses);
+  for(unsigned int i=0; i<nAccesses; i++)
+    order[i] = i%NumberOfProjectionImages;
+  std::random_shuffle( order.begin(), order.end() );
+
+  // Expected hits and misses with an LRU cache of 4 projections. The cache is
+  // not accessed if the same projection is requested twice in a row because
+  // the pipeline does not update its output.
+  std::list<unsigned int> lru;
+  itk::SizeValueType expectedHits = 0;
+  itk::SizeValueType expectedMisses = 0;
+  for(unsigned int i=0; i<nAccesses; i++)
+    {
+    std::list<unsigned int>::iterator it = std::find(lru.begin(), lru.end(), order[i]);
+    if(it != lru.end())
+      {
+      if(it != lru.begin())
+        expectedHits++;
+      lru.erase(it);
+      }
+    else
+      {
+      expectedMisses++;
+      if(lru.size() == 4)
+        lru.pop_back();
+      }
+    lru.push_front(order[i]);
+
+    OutputImageType::RegionType region = reference->GetLargestPossibleRegion();
+    region.SetIndex(2, order[i]);
+    region.SetSize(2, 1);
+    extract->SetExtractionRegion(region);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( extract->Update() );
+    extractRef->SetExtractionRegion(region);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( extractRef->Update() );
+    CheckImageQuality< OutputImageType >(extract->GetOutput(), extractRef->GetOutput(), 1.e-7, 100, 2.);
+    }
+
+  if( cache->GetNumberOfHits() != expectedHits ||
+      cache->GetNumberOfMisses() != expectedMisses ||
+      cache->GetNumberOfCachedProjections() != 4 )
+    {
+    std::cerr << "Test Failed, " << cache->GetNumberOfHits() << " hits and "
+              << cache->GetNumberOfMisses() << " misses instead of "
+              << expectedHits << " and " << expectedMisses << std::endl;
+    exit(EXIT_FAILURE);
+    }
+
+  std::cout << "\n\n****** Case 2: full stack ******" << std::endl;
+
+  cache->SetCacheSize(NumberOfProjectionImages);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( cache->UpdateLargestPossibleRegion() );
+  CheckImageQuality< OutputImageType >(cache->GetOutput(), reference, 1.e-7, 100, 2.);
+
+  std::cout << "\n\n****** Case 3: modified input ******" << std::endl;
+
+  slp->SetPhantomScale(100);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( cache->UpdateLargestPossibleRegion() );
+  if( cache->GetNumberOfCachedProjections() != NumberOfProjectionImages ||
+      cache->GetNumberOfMisses() != expectedMisses+2*NumberOfProjectionImages-4 )
+    {
+    std::cerr << "Test Failed, the cache has not been emptied after the modification of the input" << std::endl;
+    exit(EXIT_FAILURE);
+    }
+
+  std::cout << "\n\n****** Case 4: projections reader ******" << std::endl;
+
+  // One file per projection
+  typedef itk::Image< OutputPixelType, Dimension-1 > ProjectionImageType;
+  typedef itk::ExtractImageFilter<OutputImageType, ProjectionImageType> ExtractProjectionType;
+  typedef itk::ImageFileWriter<ProjectionImageType> WriterType;
+  std::vector<std::string> fileNames;
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    {
+    OutputImageType::RegionType region = reference->GetLargestPossibleRegion();
+    region.SetIndex(2, i);
+    region.SetSize(2, 0);
+    ExtractProjectionType::Pointer extractProjection = ExtractProjectionType::New();
+    extractProjection->SetInput( reference );
+    extractProjection->SetExtractionRegion(region);
+    extractProjection->SetDirectionCollapseToSubmatrix();
+
+    std::ostringstream fileName;
+    fileName << "rtkprojectionscachetest" << i << ".mha";
+    fileNames.push_back( fileName.str() );
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( extractProjection->GetOutput() );
+    writer->SetFileName( fileNames.back() );
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( writer->Update() );
+    }
+
+  typedef rtk::ProjectionsReader< OutputImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileNames( fileNames );
+
+  cache = CacheType::New();
+  cache->SetInput( reader->GetOutput() );
+  cache->SetCacheSize(4);
+  extract->SetInput( cache->GetOutput() );
+
+  for(unsigned int i=0; i<nAccesses; i++)
+    {
+    OutputImageType::RegionType region = reference->GetLargestPossibleRegion();
+    region.SetIndex(2, order[i]);
+    region.SetSize(2, 1);
+    extract->SetExtractionRegion(region);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( extract->Update() );
+    extractRef->SetExtractionRegion(region);
+    TRY_AND_EXIT_ON_ITK_EXCEPTION( extractRef->Update() );
+    CheckImageQuality< OutputImageType >(extract->GetOutput(), extractRef->GetOutput(), 1.e-7, 100, 2.);
+
+    if( reader->GetOutput()->GetBufferedRegion().GetSize(2) > 1 )
+      {
+      std::cerr << "Test Failed, the reader has produced "
+                << reader->GetOutput()->GetBufferedRegion().GetSize(2)
+                << " projections at once" << std::endl;
+      exit(EXIT_FAILURE);
+      }
+    }
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkRayBoxIntersectionImageFilter.h"
+#include "rtkSiddonForwardProjectionImageFilter.h"
+#include "rtkSiddonBackProjectionImageFilter.h"
+
+#include <itkRandomImageSource.h>
+#include <itkStreamingImageFilter.h>
+
+/**
+ * \file rtksiddonprojectorstest.cxx
+ *
+ * \brief Functional test for the Siddon forward and back projectors
+ *
+ * The test first projects a volume filled with ones with
+ * rtk::SiddonForwardProjectionImageFilter and compares the result with the
+ * analytical intersection of the rays with the box of the volume. It then
+ * checks that rtk::SiddonBackProjectionImageFilter is the adjoint of the
+ * forward projector by comparing the scalar products <Rv, p> and <v, R* p>
+ * for a random volume v and random projections p. Finally, it checks that
+ * the ray cache shared by the two projectors does not change their outputs.
+ */
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float                                    OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+  typedef itk::Vector<double, 3>                   VectorType;
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+#else
+  const unsigned int NumberOfProjectionImages = 45;
+#endif
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  // Volume of ones, the voxels cover [-128,128]^3
+  ConstantImageSourceType::Pointer volInput = ConstantImageSourceType::New();
+#if FAST_TESTS_NO_CHECKS
+  origin.Fill(-64.);
+  size.Fill(2);
+  spacing.Fill(128.);
+#else
+  origin.Fill(-126.);
+  size.Fill(64);
+  spacing.Fill(4.);
+#endif
+  volInput->SetOrigin( origin );
+  volInput->SetSpacing( spacing );
+  volInput->SetSize( size );
+  volInput->SetConstant( 1. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volInput->Update() );
+
+  // Empty volume for the back projections
+  ConstantImageSourceType::Pointer volZero = ConstantImageSourceType::New();
+  volZero->SetOrigin( origin );
+  volZero->SetSpacing( spacing );
+  volZero->SetSize( size );
+  volZero->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( volZero->Update() );
+
+  // Random volume
+  typedef itk::RandomImageSource< OutputImageType > RandomImageSourceType;
+  RandomImageSourceType::Pointer randomVolumeSource = RandomImageSourceType::New();
+  randomVolumeSource->SetOrigin( origin );
+  randomVolumeSource->SetSpacing( spacing );
+  randomVolumeSource->SetSize( size );
+  randomVolumeSource->SetMin( 0. );
+  randomVolumeSource->SetMax( 1. );
+  randomVolumeSource->SetNumberOfThreads(2); //With 1, it's deterministic
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomVolumeSource->Update() );
+
+  // Projections, larger than the magnified volume so that some rays miss it
+  ConstantImageSourceType::Pointer projInput = ConstantImageSourceType::New();
+#if FAST_TESTS_NO_CHECKS
+  origin[0] = -252.;
+  origin[1] = -252.;
+  size[0] = 2;
+  size[1] = 2;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+#else
+  origin[0] = -508.;
+  origin[1] = -508.;
+  size[0] = 128;
+  size[1] = 128;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  origin[2] = 0.;
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projInput->SetOrigin( origin );
+  projInput->SetSpacing( spacing );
+  projInput->SetSize( size );
+  projInput->SetConstant( 0. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( projInput->Update() );
+
+  RandomImageSourceType::Pointer randomProjectionsSource = RandomImageSourceType::New();
+  randomProjectionsSource->SetOrigin( origin );
+  randomProjectionsSource->SetSpacing( spacing );
+  randomProjectionsSource->SetSize( size );
+  randomProjectionsSource->SetMin( 0. );
+  randomProjectionsSource->SetMax( 100. );
+  randomProjectionsSource->SetNumberOfThreads(2); //With 1, it's deterministic
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( randomProjectionsSource->Update() );
+
+  // Geometry with out of plane angles and offsets
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int i=0; i<NumberOfProjectionImages; i++)
+    geometry->AddProjection(600., 1200., i*360./NumberOfProjectionImages, 3., -7., 10.*(i%3), 2.);
+
+  std::cout << "\n\n****** Case 1: projection of a box ******" << std::endl;
+
+  typedef rtk::RayBoxIntersectionImageFilter<OutputImageType, OutputImageType> RBIType;
+  RBIType::Pointer rbi = RBIType::New();
+  rbi->InPlaceOff();
+  rbi->SetInput( projInput->GetOutput() );
+  VectorType boxMin, boxMax;
+  boxMin.Fill(-128.);
+  boxMax.Fill(128.);
+  rbi->SetBoxMin(boxMin);
+  rbi->SetBoxMax(boxMax);
+  rbi->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( rbi->Update() );
+
+  typedef rtk::SiddonForwardProjectionImageFilter<OutputImageType, OutputImageType> FPType;
+  FPType::Pointer fp = FPType::New();
+  fp->InPlaceOff();
+  fp->SetInput( projInput->GetOutput() );
+  fp->SetInput( 1, volInput->GetOutput() );
+  fp->SetGeometry( geometry );
+
+  // Streaming filter to test for unusual regions
+  typedef itk::StreamingImageFilter<OutputImageType, OutputImageType> StreamingFilterType;
+  StreamingFilterType::Pointer stream = StreamingFilterType::New();
+  stream->SetInput(fp->GetOutput());
+  stream->SetNumberOfStreamDivisions(3);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( stream->Update() );
+
+  CheckImageQuality<OutputImageType>(stream->GetOutput(), rbi->GetOutput(), 0.01, 60., 512.);
+
+  std::cout << "\n\n****** Case 2: adjoint operators ******" << std::endl;
+
+  fp = FPType::New();
+  fp->InPlaceOff();
+  fp->SetInput( projInput->GetOutput() );
+  fp->SetInput( 1, randomVolumeSource->GetOutput() );
+  fp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fp->Update() );
+
+  typedef rtk::SiddonBackProjectionImageFilter<OutputImageType, OutputImageType> BPType;
+  BPType::Pointer bp = BPType::New();
+  bp->SetInput( volZero->GetOutput() );
+  bp->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bp->SetGeometry( geometry.GetPointer() );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+  CheckScalarProducts<OutputImageType, OutputImageType>(randomVolumeSource->GetOutput(), bp->GetOutput(), randomProjectionsSource->GetOutput(), fp->GetOutput());
+
+  std::cout << "\n\n****** Case 3: ray cache ******" << std::endl;
+
+  FPType::Pointer fpCache = FPType::New();
+  fpCache->InPlaceOff();
+  fpCache->SetInput( projInput->GetOutput() );
+  fpCache->SetInput( 1, randomVolumeSource->GetOutput() );
+  fpCache->SetGeometry( geometry );
+  fpCache->UseRayCacheOn();
+
+  // The first update fills the cache, the second one uses it
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fpCache->Update() );
+  fpCache->Modified();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( fpCache->Update() );
+  CheckImageQuality<OutputImageType>(fpCache->GetOutput(), fp->GetOutput(), 1.e-6, 100., 512.);
+
+  // The back projector reuses the cache of the forward projector
+  BPType::Pointer bpCache = BPType::New();
+  bpCache->SetInput( volZero->GetOutput() );
+  bpCache->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bpCache->SetGeometry( geometry.GetPointer() );
+  bpCache->SetRayCache( fpCache->GetRayCache() );
+  bpCache->UseRayCacheOn();
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpCache->Update() );
+  CheckImageQuality<OutputImageType>(bpCache->GetOutput(), bp->GetOutput(), 1.e-2, 100., 1.e5);
+
+  std::cout << "\n\n****** Case 4: shadows of the slabs of the threads ******" << std::endl;
+
+  // Each thread only traces the rays in the shadow of its slab, the result
+  // must not depend on the number of slabs
+  BPType::Pointer bpOneSlab = BPType::New();
+  bpOneSlab->SetInput( volZero->GetOutput() );
+  bpOneSlab->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bpOneSlab->SetGeometry( geometry.GetPointer() );
+  bpOneSlab->SetNumberOfThreads(1);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpOneSlab->Update() );
+
+  BPType::Pointer bpManySlabs = BPType::New();
+  bpManySlabs->SetInput( volZero->GetOutput() );
+  bpManySlabs->SetInput( 1, randomProjectionsSource->GetOutput() );
+  bpManySlabs->SetGeometry( geometry.GetPointer() );
+  bpManySlabs->SetNumberOfThreads(7);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpManySlabs->Update() );
+  CheckImageQuality<OutputImageType>(bpManySlabs->GetOutput(), bpOneSlab->GetOutput(), 1.e-2, 100., 1.e5);
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
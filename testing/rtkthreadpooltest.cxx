@@ -0,0 +1,262 @@
+#include "rtkTest.h"
+#include "rtkMacro.h"
+#include "rtkConstantImageSource.h"
+#include "rtkDrawSheppLoganFilter.h"
+#include "rtkJosephForwardProjectionImageFilter.h"
+#include "rtkBackProjectionImageFilter.h"
+#include "rtkThreadPool.h"
+#include "rtkThreadPoolImageFilter.h"
+
+#include <itkAddImageFilter.h>
+#include <itkTimeProbe.h>
+
+#include <algorithm>
+
+/**
+ * \file rtkthreadpooltest.cxx
+ *
+ * \brief Test rtk::ThreadPool and rtk::ThreadPoolImageFilter
+ *
+ * This test checks that each task of a parallel loop of the pool is executed
+ * exactly once, including with nested loops, and that exceptions of the tasks
+ * are forwarded to the caller. It then compares the Joseph forward projection
+ * and the voxel-based back projection dispatched onto the pool with those
+ * computed with itk::MultiThreader. Finally, the dispatch overhead per Update
+ * of a small filter is measured with and without the pool.
+ */
+
+/** Increments the counter of each task */
+void CountTask(void *arg, unsigned int taskId, unsigned int itkNotUsed(numberOfTasks))
+{
+  static_cast<unsigned int *>(arg)[taskId]++;
+}
+
+/** Runs a nested loop of 8 tasks counting in the rows of a 8x8 table */
+void NestedTask(void *arg, unsigned int taskId, unsigned int itkNotUsed(numberOfTasks))
+{
+  rtk::ThreadPool::GetInstance()->ParallelFor(8, CountTask, static_cast<unsigned int *>(arg) + 8 * taskId);
+}
+
+/** Throws in one task out of the loop */
+void ThrowingTask(void *itkNotUsed(arg), unsigned int taskId, unsigned int itkNotUsed(numberOfTasks))
+{
+  if(taskId == 3)
+    itkGenericExceptionMacro(<< "Exception of task 3");
+}
+
+bool CheckCounts(const std::vector<unsigned int> &counts)
+{
+  for(unsigned int i=0; i<counts.size(); i++)
+    if(counts[i] != 1)
+      {
+      std::cerr << "Task " << i << " has been executed " << counts[i] << " times." << std::endl;
+      return false;
+      }
+  return true;
+}
+
+int main(int, char** )
+{
+  const unsigned int Dimension = 3;
+  typedef float OutputPixelType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+#if FAST_TESTS_NO_CHECKS
+  const unsigned int NumberOfProjectionImages = 3;
+  const unsigned int NumberOfUpdates = 10;
+#else
+  const unsigned int NumberOfProjectionImages = 45;
+  const unsigned int NumberOfUpdates = 1000;
+#endif
+
+  rtk::ThreadPool::Pointer pool = rtk::ThreadPool::GetInstance();
+  std::cout << "Number of workers: " << pool->GetNumberOfWorkers() << std::endl;
+
+  std::cout << "\n\n****** Case 1: parallel loops ******" << std::endl;
+
+  std::vector<unsigned int> counts(1000, 0);
+  pool->ParallelFor(counts.size(), CountTask, &(counts[0]));
+  if( !CheckCounts(counts) )
+    return EXIT_FAILURE;
+
+  counts.assign(64, 0);
+  pool->ParallelFor(8, NestedTask, &(counts[0]));
+  if( !CheckCounts(counts) )
+    return EXIT_FAILURE;
+
+  bool thrown = false;
+  try
+    {
+    pool->ParallelFor(8, ThrowingTask, ITK_NULLPTR);
+    }
+  catch( itk::ExceptionObject & e )
+    {
+    std::cout << "Expected exception caught: " << e.GetDescription() << std::endl;
+    thrown = true;
+    }
+  if(!thrown)
+    {
+    std::cerr << "The exception of a task has not been forwarded." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Same loops without any worker
+  const unsigned int numberOfWorkers = pool->GetNumberOfWorkers();
+  pool->SetNumberOfWorkers(0);
+  counts.assign(64, 0);
+  pool->ParallelFor(8, NestedTask, &(counts[0]));
+  if( !CheckCounts(counts) )
+    return EXIT_FAILURE;
+  pool->SetNumberOfWorkers( std::max(numberOfWorkers, 3U) );
+  counts.assign(64, 0);
+  pool->ParallelFor(8, NestedTask, &(counts[0]));
+  if( !CheckCounts(counts) )
+    return EXIT_FAILURE;
+  std::cout << "Test PASSED! " << std::endl;
+
+  // Constant image sources
+  typedef rtk::ConstantImageSource< OutputImageType > ConstantImageSourceType;
+  ConstantImageSourceType::PointType origin;
+  ConstantImageSourceType::SizeType size;
+  ConstantImageSourceType::SpacingType spacing;
+
+  ConstantImageSourceType::Pointer tomographySource  = ConstantImageSourceType::New();
+  origin[0] = -127.;
+  origin[1] = -127.;
+  origin[2] = -127.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  size[2] = 2;
+  spacing[0] = 252.;
+  spacing[1] = 252.;
+  spacing[2] = 252.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  size[2] = 64;
+  spacing[0] = 4.;
+  spacing[1] = 4.;
+  spacing[2] = 4.;
+#endif
+  tomographySource->SetOrigin( origin );
+  tomographySource->SetSpacing( spacing );
+  tomographySource->SetSize( size );
+  tomographySource->SetConstant( 0. );
+
+  ConstantImageSourceType::Pointer projectionsSource = ConstantImageSourceType::New();
+  origin[0] = -255.;
+  origin[1] = -255.;
+  origin[2] = -255.;
+#if FAST_TESTS_NO_CHECKS
+  size[0] = 2;
+  size[1] = 2;
+  spacing[0] = 504.;
+  spacing[1] = 504.;
+#else
+  size[0] = 64;
+  size[1] = 64;
+  spacing[0] = 8.;
+  spacing[1] = 8.;
+#endif
+  size[2] = NumberOfProjectionImages;
+  spacing[2] = 1.;
+  projectionsSource->SetOrigin( origin );
+  projectionsSource->SetSpacing( spacing );
+  projectionsSource->SetSize( size );
+  projectionsSource->SetConstant( 0. );
+
+  // Geometry object
+  typedef rtk::ThreeDCircularProjectionGeometry GeometryType;
+  GeometryType::Pointer geometry = GeometryType::New();
+  for(unsigned int noProj=0; noProj<NumberOfProjectionImages; noProj++)
+    geometry->AddProjection(600., 1200., noProj*360./NumberOfProjectionImages);
+
+  // Shepp Logan volume
+  typedef rtk::DrawSheppLoganFilter<OutputImageType, OutputImageType> DSLType;
+  DSLType::Pointer dsl = DSLType::New();
+  dsl->SetInput( tomographySource->GetOutput() );
+  dsl->SetPhantomScale(128);
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( dsl->Update() );
+
+  std::cout << "\n\n****** Case 2: Joseph forward projector ******" << std::endl;
+
+  typedef rtk::JosephForwardProjectionImageFilter<OutputImageType, OutputImageType> JFPType;
+  JFPType::Pointer jfp = JFPType::New();
+  jfp->SetInput( projectionsSource->GetOutput() );
+  jfp->SetInput( 1, dsl->GetOutput() );
+  jfp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( jfp->Update() );
+
+  JFPType::Pointer jfpPool = rtk::ThreadPoolImageFilter<JFPType>::New();
+  jfpPool->SetInput( projectionsSource->GetOutput() );
+  jfpPool->SetInput( 1, dsl->GetOutput() );
+  jfpPool->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( jfpPool->Update() );
+
+  CheckImageQuality<OutputImageType>(jfpPool->GetOutput(), jfp->GetOutput(), 1.e-6, 100, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 3: voxel-based back projector ******" << std::endl;
+
+  typedef rtk::BackProjectionImageFilter<OutputImageType, OutputImageType> BPType;
+  BPType::Pointer bp = BPType::New();
+  bp->SetInput( tomographySource->GetOutput() );
+  bp->SetInput( 1, jfp->GetOutput() );
+  bp->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bp->Update() );
+
+  BPType::Pointer bpPool = rtk::ThreadPoolImageFilter<BPType>::New();
+  bpPool->SetInput( tomographySource->GetOutput() );
+  bpPool->SetInput( 1, jfp->GetOutput() );
+  bpPool->SetGeometry( geometry );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( bpPool->Update() );
+
+  CheckImageQuality<OutputImageType>(bpPool->GetOutput(), bp->GetOutput(), 1.e-6, 100, 2.0);
+  std::cout << "Test PASSED! " << std::endl;
+
+  std::cout << "\n\n****** Case 4: dispatch overhead per Update ******" << std::endl;
+
+  // Small image so that the time is dominated by the dispatch of the threads
+  ConstantImageSourceType::Pointer smallSource = ConstantImageSourceType::New();
+  size.Fill(16);
+  smallSource->SetSize( size );
+  smallSource->SetConstant( 1. );
+  TRY_AND_EXIT_ON_ITK_EXCEPTION( smallSource->Update() );
+
+  typedef itk::AddImageFilter<OutputImageType, OutputImageType, OutputImageType> AddType;
+  AddType::Pointer add = rtk::ThreadPoolImageFilter<AddType>::New();
+  add->SetInput1( smallSource->GetOutput() );
+  add->SetInput2( smallSource->GetOutput() );
+
+  for(unsigned int enabled=0; enabled<2; enabled++)
+    {
+    rtk::ThreadPool::SetGlobalDefaultEnabled(enabled!=0);
+    itk::TimeProbe probe;
+    probe.Start();
+    for(unsigned int i=0; i<NumberOfUpdates; i++)
+      {
+      add->Modified();
+      TRY_AND_EXIT_ON_ITK_EXCEPTION( add->Update() );
+      }
+    probe.Stop();
+    std::cout << ((enabled)?"rtk::ThreadPool":"itk::MultiThreader")
+              << ": " << 1.e6 * probe.GetTotal() / NumberOfUpdates
+              << " us per Update" << std::endl;
+
+    // 1 + 1 everywhere
+    OutputImageType::IndexType index;
+    index.Fill(0);
+    if( add->GetOutput()->GetPixel(index) != 2. )
+      {
+      std::cerr << "Wrong output of the filter dispatched onto the pool." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  rtk::ThreadPool::SetGlobalDefaultEnabled(true);
+  std::cout << "Parallel loops: " << pool->GetNumberOfParallelFors()
+            << ", stolen tasks: " << pool->GetNumberOfStolenTasks() << std::endl;
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include "rtkMacro.h"
+#include "rtkTraceCollector.h"
+#include "rtkConstantImageSource.h"
+
+#include <itkMultiThreader.h>
+
+#include <cstring>
+
+/**
+ * \file rtktracecollectortest.cxx
+ *
+ * \brief Test of the nesting of the spans recorded by rtk::TraceCollector
+ *
+ * This test checks that the updates of the filters created with the New
+ * macros of RTK are recorded in a default build if tracing is enabled when
+ * they are created, that the spans of each thread are properly nested, also
+ * when several pipelines run concurrently, and that closing a span which has
+ * never been opened is ignored.
+ */
+
+typedef itk::Image< float, 3 >                      ImageType;
+typedef rtk::ConstantImageSource< ImageType >       ConstantImageSourceType;
+typedef rtk::TraceCollector::SpanType               SpanType;
+typedef rtk::TraceCollector::ThreadBufferType       ThreadBufferType;
+
+ConstantImageSourceType::Pointer CreateSource(float value)
+{
+  ConstantImageSourceType::SizeType size;
+  size.Fill(32);
+  ConstantImageSourceType::Pointer source = ConstantImageSourceType::New();
+  source->SetSize(size);
+  source->SetConstant(value);
+  return source;
+}
+
+// Check that each span of each thread is contained in the span of the
+// previous depth which was open when it started.
+bool CheckNesting(rtk::TraceCollector *collector)
+{
+  for(unsigned int t=0; t<collector->GetNumberOfThreadBuffers(); t++)
+    {
+    const ThreadBufferType *buffer = collector->GetThreadBuffer(t);
+    if( !buffer->OpenSpans.empty() )
+      {
+      std::cerr << "Test Failed, spans left open in " << buffer->ThreadName << std::endl;
+      return false;
+      }
+    std::vector<const SpanType *> stack;
+    for(unsigned int i=0; i<buffer->Spans.size(); i++)
+      {
+      const SpanType &span = buffer->Spans[i];
+      if( span.Depth > stack.size() )
+        {
+        std::cerr << "Test Failed, span " << span.Name << " of " << buffer->ThreadName
+                  << " has depth " << span.Depth << " without parent" << std::endl;
+        return false;
+        }
+      stack.resize(span.Depth);
+      if( span.End < span.Start ||
+          ( !stack.empty() && ( span.Start < stack.back()->Start || span.End > stack.back()->End ) ) )
+        {
+        std::cerr << "Test Failed, span " << span.Name << " of " << buffer->ThreadName
+                  << " is not nested in its parent" << std::endl;
+        return false;
+        }
+      stack.push_back(&span);
+      }
+    }
+  return true;
+}
+
+// Find a span by name and instance, depth is -1 if it is not found
+int FindSpanDepth(rtk::TraceCollector *collector, const char *name, const void *instance, unsigned int &count)
+{
+  int depth = -1;
+  count = 0;
+  for(unsigned int t=0; t<collector->GetNumberOfThreadBuffers(); t++)
+    {
+    const ThreadBufferType *buffer = collector->GetThreadBuffer(t);
+    for(unsigned int i=0; i<buffer->Spans.size(); i++)
+      if( buffer->Spans[i].Instance == instance && !std::strcmp(buffer->Spans[i].Name, name) )
+        {
+        depth = buffer->Spans[i].Depth;
+        count++;
+        }
+    }
+  return depth;
+}
+
+ITK_THREAD_RETURN_TYPE RunJob(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  ConstantImageSourceType **sources = static_cast<ConstantImageSourceType **>(info->UserData);
+  ConstantImageSourceType *source = sources[info->ThreadID];
+  for(unsigned int i=0; i<10; i++)
+    {
+    rtk::TraceSpan jobSpan("Job", source, i);
+    source->SetConstant(i);
+    source->Update();
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+int main(int, char** )
+{
+  rtk::TraceCollector::Pointer collector = rtk::TraceCollector::GetInstance();
+  collector->SetFileName("");
+  collector->EnabledOn();
+  collector->Clear();
+
+  std::cout << "\n\n****** Case 1: filter nested in a span ******" << std::endl;
+
+  ConstantImageSourceType::Pointer source = CreateSource(1.);
+  int outer = 0;
+  {
+  rtk::TraceSpan outerSpan("Outer", &outer, 0);
+  source->Update();
+  }
+  unsigned int count;
+  if( FindSpanDepth(collector, "Outer", &outer, count) != 0 || count != 1 ||
+      FindSpanDepth(collector, source->GetNameOfClass(), source.GetPointer(), count) != 1 || count != 1 )
+    {
+    std::cerr << "Test Failed, the update of the filter has not been recorded in the outer span" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( !CheckNesting(collector) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 2: unmatched spans ******" << std::endl;
+
+  collector->Clear();
+  int before = 0, after = 0;
+  collector->SetEnabled(false);
+  collector->Begin("Before", &before);
+  collector->SetEnabled(true);
+  collector->Begin("After", &after);
+  collector->End("Before", &before); // Must not close "After"
+  collector->Begin("Inner", &after);
+  collector->End("Inner", &after);
+  collector->End("After", &after);
+  collector->End("Never opened", &after);
+  if( FindSpanDepth(collector, "Before", &before, count) != -1 ||
+      FindSpanDepth(collector, "After", &after, count) != 0 ||
+      FindSpanDepth(collector, "Inner", &after, count) != 1 )
+    {
+    std::cerr << "Test Failed, unmatched spans have modified the nesting" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if( !CheckNesting(collector) )
+    return EXIT_FAILURE;
+
+  std::cout << "\n\n****** Case 3: concurrent pipelines ******" << std::endl;
+
+  collector->Clear();
+  const unsigned int nJobs = 4;
+  std::vector<ConstantImageSourceType::Pointer> sources(nJobs);
+  std::vector<ConstantImageSourceType *> rawSources(nJobs);
+  for(unsigned int i=0; i<nJobs; i++)
+    {
+    sources[i] = CreateSource(0.);
+    rawSources[i] = sources[i].GetPointer();
+    }
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(nJobs);
+  threader->SetSingleMethod(RunJob, &(rawSources[0]));
+  threader->SingleMethodExecute();
+
+  for(unsigned int i=0; i<nJobs; i++)
+    {
+    if( FindSpanDepth(collector, "Job", rawSources[i], count) != 0 || count != 10 ||
+        FindSpanDepth(collector, rawSources[i]->GetNameOfClass(), rawSources[i], count) != 1 || count != 10 )
+      {
+      std::cerr << "Test Failed, the spans of job " << i << " have not been recorded" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if( !CheckNesting(collector) )
+    return EXIT_FAILURE;
+
+  collector->Report(std::cout);
+
+  std::cout << "\n\n****** Case 4: filter created while tracing is disabled ******" << std::endl;
+
+  collector->Clear();
+  collector->EnabledOff();
+  ConstantImageSourceType::Pointer unwatched = CreateSource(2.);
+  collector->EnabledOn();
+  unwatched->Update();
+  if( FindSpanDepth(collector, unwatched->GetNameOfClass(), unwatched.GetPointer(), count) != -1 )
+    {
+    std::cerr << "Test Failed, a filter created while tracing was disabled is watched" << std::endl;
+    return EXIT_FAILURE;
+    }
+  collector->Clear();
+  collector->EnabledOff();
+
+  // If all succeed
+  std::cout << "\n\nTest PASSED! " << std::endl;
+  return EXIT_SUCCESS;
+}